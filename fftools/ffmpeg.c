@@ -43,6 +43,7 @@
 #include "libavformat/avformat.h"
 #include "libavdevice/avdevice.h"
 #include "libswresample/swresample.h"
+#include "libswscale/swscale.h"
 #include "libavutil/opt.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/parseutils.h"
@@ -166,50 +167,119 @@ static int restore_tty;
    This is a temporary solution until libavfilter gets real subtitles support.
  */
 
-static int sub2video_get_blank_frame(InputStream *ist)
+/**
+ * Get a transparent canvas. Canvases are recycled once no filter holds a
+ * reference to them anymore; only the areas painted last time are cleared
+ * then, which avoids wiping the whole frame on every subtitle update.
+ */
+static AVFrame *sub2video_get_blank_frame(InputStream *ist)
 {
-    int ret;
-    AVFrame *frame = ist->sub2video.frame;
+    int w = ist->dec_ctx->width  ? ist->dec_ctx->width  : ist->sub2video.w;
+    int h = ist->dec_ctx->height ? ist->dec_ctx->height : ist->sub2video.h;
+    AVFrame *canvas;
+    int i, j;
 
-    av_frame_unref(frame);
-    ist->sub2video.frame->width  = ist->dec_ctx->width  ? ist->dec_ctx->width  : ist->sub2video.w;
-    ist->sub2video.frame->height = ist->dec_ctx->height ? ist->dec_ctx->height : ist->sub2video.h;
-    ist->sub2video.frame->format = AV_PIX_FMT_RGB32;
-    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
-        return ret;
-    memset(frame->data[0], 0, frame->height * frame->linesize[0]);
-    return 0;
+    av_frame_unref(ist->sub2video.frame);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ist->sub2video.canvas); i++) {
+        AVFrameSideData *sd;
+
+        canvas = ist->sub2video.canvas[i];
+        if (!canvas || !canvas->buf[0] || canvas->width != w || canvas->height != h ||
+            !av_frame_is_writable(canvas))
+            continue;
+
+        sd = av_frame_get_side_data(canvas, AV_FRAME_DATA_ACTIVE_RECTS);
+        if (sd) {
+            const AVFrameActiveRects *ar = (const AVFrameActiveRects *)sd->data;
+
+            for (j = 0; j < ar->nb_rects; j++) {
+                const AVFrameActiveRect *r = &ar->rects[j];
+                uint8_t *dst = canvas->data[0] + r->y * canvas->linesize[0] + r->x * 4;
+                int y;
+
+                for (y = 0; y < r->h; y++, dst += canvas->linesize[0])
+                    memset(dst, 0, r->w * 4);
+            }
+            av_frame_remove_side_data(canvas, AV_FRAME_DATA_ACTIVE_RECTS);
+        }
+        return canvas;
+    }
+
+    i = ist->sub2video.next_canvas;
+    ist->sub2video.next_canvas = (i + 1) % FF_ARRAY_ELEMS(ist->sub2video.canvas);
+    if (!ist->sub2video.canvas[i] && !(ist->sub2video.canvas[i] = av_frame_alloc()))
+        return NULL;
+    canvas = ist->sub2video.canvas[i];
+
+    av_frame_unref(canvas);
+    canvas->width  = w;
+    canvas->height = h;
+    canvas->format = AV_PIX_FMT_RGB32;
+    if (av_frame_get_buffer(canvas, 0) < 0)
+        return NULL;
+    memset(canvas->data[0], 0, canvas->height * canvas->linesize[0]);
+    return canvas;
 }
 
-static void sub2video_copy_rect(uint8_t *dst, int dst_linesize, int w, int h,
-                                AVSubtitleRect *r)
+static int sub2video_copy_rect(uint8_t *dst, int dst_linesize, int w, int h,
+                               AVSubtitleRect *r)
 {
-    uint32_t *pal, *dst2;
-    uint8_t *src, *src2;
-    int x, y;
+    uint8_t *src;
+    int y;
 
     if (r->type != SUBTITLE_BITMAP) {
         av_log(NULL, AV_LOG_WARNING, "sub2video: non-bitmap subtitle\n");
-        return;
+        return 0;
     }
     if (r->x < 0 || r->x + r->w > w || r->y < 0 || r->y + r->h > h) {
         av_log(NULL, AV_LOG_WARNING, "sub2video: rectangle (%d %d %d %d) overflowing %d %d\n",
             r->x, r->y, r->w, r->h, w, h
         );
-        return;
+        return 0;
     }
 
     dst += r->y * dst_linesize + r->x * 4;
     src = r->data[0];
-    pal = (uint32_t *)r->data[1];
     for (y = 0; y < r->h; y++) {
-        dst2 = (uint32_t *)dst;
-        src2 = src;
+#if CONFIG_SWSCALE
+        sws_convertPalette8ToPacked32(src, dst, r->w, r->data[1]);
+#else
+        const uint32_t *pal = (const uint32_t *)r->data[1];
+        uint32_t *dst2 = (uint32_t *)dst;
+        int x;
+
         for (x = 0; x < r->w; x++)
-            *(dst2++) = pal[*(src2++)];
+            dst2[x] = pal[src[x]];
+#endif
         dst += dst_linesize;
         src += r->linesize[0];
     }
+    return r->w > 0 && r->h > 0;
+}
+
+/* Record a painted rectangle; past the last slot, grow the last one to the
+ * union of the remaining rectangles. */
+static void sub2video_add_active_rect(AVFrameActiveRects *ar, const AVSubtitleRect *r)
+{
+    AVFrameActiveRect *dst;
+    int x1, y1;
+
+    if (ar->nb_rects < AV_FRAME_MAX_ACTIVE_RECTS) {
+        dst = &ar->rects[ar->nb_rects++];
+        dst->x = r->x;
+        dst->y = r->y;
+        dst->w = r->w;
+        dst->h = r->h;
+        return;
+    }
+    dst    = &ar->rects[AV_FRAME_MAX_ACTIVE_RECTS - 1];
+    x1     = FFMAX(dst->x + dst->w, r->x + r->w);
+    y1     = FFMAX(dst->y + dst->h, r->y + r->h);
+    dst->x = FFMIN(dst->x, r->x);
+    dst->y = FFMIN(dst->y, r->y);
+    dst->w = x1 - dst->x;
+    dst->h = y1 - dst->y;
 }
 
 static void sub2video_push_ref(InputStream *ist, int64_t pts)
@@ -233,8 +303,9 @@ static void sub2video_push_ref(InputStream *ist, int64_t pts)
 void sub2video_update(InputStream *ist, int64_t heartbeat_pts, AVSubtitle *sub)
 {
     AVFrame *frame = ist->sub2video.frame;
-    int8_t *dst;
-    int     dst_linesize;
+    AVFrame *canvas;
+    AVFrameSideData *sd;
+    AVFrameActiveRects *ar;
     int num_rects, i;
     int64_t pts, end_pts;
 
@@ -256,15 +327,27 @@ void sub2video_update(InputStream *ist, int64_t heartbeat_pts, AVSubtitle *sub)
         end_pts   = INT64_MAX;
         num_rects = 0;
     }
-    if (sub2video_get_blank_frame(ist) < 0) {
+    canvas = sub2video_get_blank_frame(ist);
+    sd     = canvas ? av_frame_new_side_data(canvas, AV_FRAME_DATA_ACTIVE_RECTS,
+                                             sizeof(*ar)) : NULL;
+    if (!sd) {
         av_log(NULL, AV_LOG_ERROR,
                "Impossible to get a blank canvas.\n");
         return;
     }
-    dst          = frame->data    [0];
-    dst_linesize = frame->linesize[0];
+    ar = (AVFrameActiveRects *)sd->data;
+    memset(ar, 0, sizeof(*ar));
+    ar->width  = canvas->width;
+    ar->height = canvas->height;
     for (i = 0; i < num_rects; i++)
-        sub2video_copy_rect(dst, dst_linesize, frame->width, frame->height, sub->rects[i]);
+        if (sub2video_copy_rect(canvas->data[0], canvas->linesize[0],
+                                canvas->width, canvas->height, sub->rects[i]))
+            sub2video_add_active_rect(ar, sub->rects[i]);
+    if (av_frame_ref(frame, canvas) < 0) {
+        av_log(NULL, AV_LOG_ERROR,
+               "Impossible to get a blank canvas.\n");
+        return;
+    }
     sub2video_push_ref(ist, pts);
     ist->sub2video.end_pts = end_pts;
     ist->sub2video.initialize = 0;
@@ -603,12 +686,15 @@ static void ffmpeg_cleanup(int ret)
         av_dict_free(&ist->decoder_opts);
         avsubtitle_free(&ist->prev_sub.subtitle);
         av_frame_free(&ist->sub2video.frame);
+        for (j = 0; j < FF_ARRAY_ELEMS(ist->sub2video.canvas); j++)
+            av_frame_free(&ist->sub2video.canvas[j]);
         av_freep(&ist->filters);
         av_freep(&ist->hwaccel_device);
         av_freep(&ist->dts_buffer);
 
         avcodec_free_context(&ist->dec_ctx);
         avcodec_parameters_free(&ist->par);
+        av_bsf_free(&ist->bsf_ctx);
 
         av_freep(&input_streams[i]);
     }
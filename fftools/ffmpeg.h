@@ -126,6 +126,7 @@ typedef struct OptionsContext {
     int accurate_seek;
     int thread_queue_size;
     int input_sync_ref;
+    const char *session_snapshot;
 
     SpecifierOpt *ts_scale;
     int        nb_ts_scale;
@@ -331,6 +332,8 @@ typedef struct InputStream {
     AVCodecParameters *par;
     AVCodecContext *dec_ctx;
     const AVCodec *dec;
+    /* input bitstream filters, only accessed by the demuxing thread */
+    AVBSFContext *bsf_ctx;
     AVFrame *decoded_frame;
     AVPacket *pkt;
 
@@ -378,6 +381,8 @@ typedef struct InputStream {
         int64_t end_pts;
         AVFifo *sub_queue;    ///< queue of AVSubtitle* before filter init
         AVFrame *frame;
+        AVFrame *canvas[4];   ///< canvases recycled once the filters release them
+        int next_canvas;
         int w, h;
         unsigned int initialize; ///< marks if sub2video_update should force an initialization
     } sub2video;
@@ -673,6 +678,7 @@ extern float max_error_rate;
 
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern int filter_complex_graph_nbthreads;
 extern int vstats_version;
 extern int auto_conversion_filters;
 
@@ -748,4 +754,25 @@ int ifile_get_packet(InputFile *f, AVPacket **pkt);
 int init_input_threads(void);
 void free_input_threads(void);
 
+/**
+ * Describe the streams of an opened but not yet probed input, to identify
+ * the session snapshots taken from it.
+ *
+ * @return a string to be freed with av_free(), NULL on allocation failure
+ */
+char *snapshot_input_key(const AVFormatContext *ic);
+/**
+ * Store the stream parameters of a probed input in a session snapshot file.
+ */
+int snapshot_save(AVFormatContext *ic, const char *path, const char *key);
+/**
+ * Restore the stream parameters of an opened input from a session snapshot
+ * file written by snapshot_save() with the same key.
+ *
+ * @return 1 if the parameters were restored, 0 if there is no usable
+ *         snapshot and the input must be probed, a negative error code on
+ *         failure
+ */
+int snapshot_load(AVFormatContext *ic, const char *path, const char *key);
+
 #endif /* FFTOOLS_FFMPEG_H */
@@ -169,21 +169,109 @@ static void ts_fixup(InputFile *ifile, AVPacket *pkt)
         pkt->dts += duration;
 }
 
+static int send_packet(InputFile *f, AVPacket *pkt, unsigned *flags)
+{
+    DemuxMsg msg = { NULL };
+    int ret;
+
+    ts_fixup(f, pkt);
+
+    msg.pkt = av_packet_alloc();
+    if (!msg.pkt) {
+        av_packet_unref(pkt);
+        return AVERROR(ENOMEM);
+    }
+    av_packet_move_ref(msg.pkt, pkt);
+    ret = av_thread_message_queue_send(f->in_thread_queue, &msg, *flags);
+    if (*flags && ret == AVERROR(EAGAIN)) {
+        *flags = 0;
+        ret = av_thread_message_queue_send(f->in_thread_queue, &msg, *flags);
+        av_log(f->ctx, AV_LOG_WARNING,
+               "Thread message queue blocking; consider raising the "
+               "thread_queue_size option (current value: %d)\n",
+               f->thread_queue_size);
+    }
+    if (ret < 0) {
+        if (ret != AVERROR_EOF)
+            av_log(f->ctx, AV_LOG_ERROR,
+                   "Unable to send packet to main thread: %s\n",
+                   av_err2str(ret));
+        av_packet_free(&msg.pkt);
+    }
+
+    return ret;
+}
+
+/* Run a packet, or the end of stream when pkt is NULL, through the input
+ * bitstream filters of ist and send what comes out to the main thread. */
+static int send_filtered_packet(InputFile *f, InputStream *ist,
+                                AVPacket *pkt, AVPacket *tmp, unsigned *flags)
+{
+    AVBSFContext *bsf = ist->bsf_ctx;
+    int ret;
+
+    ret = av_bsf_send_packet(bsf, pkt);
+    if (ret < 0) {
+        if (pkt)
+            av_packet_unref(pkt);
+        goto fail;
+    }
+
+    while (1) {
+        ret = av_bsf_receive_packet(bsf, tmp);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            return 0;
+        if (ret < 0)
+            goto fail;
+
+        tmp->stream_index = ist->st->index;
+        av_packet_rescale_ts(tmp, bsf->time_base_out, ist->st->time_base);
+        ret = send_packet(f, tmp, flags);
+        if (ret < 0)
+            return ret;
+    }
+
+fail:
+    av_log(NULL, exit_on_error ? AV_LOG_FATAL : AV_LOG_ERROR,
+           "Error applying bitstream filters to an input packet for stream #%d:%d: %s\n",
+           f->index, ist->st->index, av_err2str(ret));
+    return exit_on_error ? ret : 0;
+}
+
+static int flush_bsfs(InputFile *f, AVPacket *tmp, unsigned *flags)
+{
+    for (int i = 0; i < f->nb_streams; i++) {
+        InputStream *ist = input_streams[f->ist_index + i];
+        int ret;
+
+        if (!ist->bsf_ctx)
+            continue;
+
+        ret = send_filtered_packet(f, ist, NULL, tmp, flags);
+        if (ret < 0)
+            return ret;
+        av_bsf_flush(ist->bsf_ctx);
+    }
+    return 0;
+}
+
 static void *input_thread(void *arg)
 {
     InputFile *f = arg;
-    AVPacket *pkt;
+    AVPacket *pkt, *filtered_pkt;
     unsigned flags = f->non_blocking ? AV_THREAD_MESSAGE_NONBLOCK : 0;
     int ret = 0;
 
-    pkt = av_packet_alloc();
-    if (!pkt) {
+    pkt          = av_packet_alloc();
+    filtered_pkt = av_packet_alloc();
+    if (!pkt || !filtered_pkt) {
         ret = AVERROR(ENOMEM);
         goto finish;
     }
 
     while (1) {
         DemuxMsg msg = { NULL };
+        InputStream *ist;
 
         ret = av_read_frame(f->ctx, pkt);
 
@@ -192,6 +280,12 @@ static void *input_thread(void *arg)
             continue;
         }
         if (ret < 0) {
+            int err = flush_bsfs(f, filtered_pkt, &flags);
+            if (err < 0) {
+                ret = err;
+                break;
+            }
+
             if (f->loop) {
                 /* signal looping to the consumer thread */
                 msg.looping = 1;
@@ -231,32 +325,13 @@ static void *input_thread(void *arg)
             }
         }
 
-        ts_fixup(f, pkt);
-
-        msg.pkt = av_packet_alloc();
-        if (!msg.pkt) {
-            av_packet_unref(pkt);
-            ret = AVERROR(ENOMEM);
-            break;
-        }
-        av_packet_move_ref(msg.pkt, pkt);
-        ret = av_thread_message_queue_send(f->in_thread_queue, &msg, flags);
-        if (flags && ret == AVERROR(EAGAIN)) {
-            flags = 0;
-            ret = av_thread_message_queue_send(f->in_thread_queue, &msg, flags);
-            av_log(f->ctx, AV_LOG_WARNING,
-                   "Thread message queue blocking; consider raising the "
-                   "thread_queue_size option (current value: %d)\n",
-                   f->thread_queue_size);
-        }
-        if (ret < 0) {
-            if (ret != AVERROR_EOF)
-                av_log(f->ctx, AV_LOG_ERROR,
-                       "Unable to send packet to main thread: %s\n",
-                       av_err2str(ret));
-            av_packet_free(&msg.pkt);
+        ist = input_streams[f->ist_index + pkt->stream_index];
+        if (ist->bsf_ctx)
+            ret = send_filtered_packet(f, ist, pkt, filtered_pkt, &flags);
+        else
+            ret = send_packet(f, pkt, &flags);
+        if (ret < 0)
             break;
-        }
     }
 
 finish:
@@ -264,6 +339,7 @@ finish:
     av_thread_message_queue_set_err_recv(f->in_thread_queue, ret);
 
     av_packet_free(&pkt);
+    av_packet_free(&filtered_pkt);
 
     return NULL;
 }
@@ -982,6 +982,10 @@ int configure_filtergraph(FilterGraph *fg)
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
 
+    /* graphs are reconfigured on every change of the input parameters,
+     * often back and forth between the same few sets of them */
+    fg->graph->cache_formats = 1;
+
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
         char args[512];
@@ -1018,7 +1022,8 @@ int configure_filtergraph(FilterGraph *fg)
             args[strlen(args)-1] = 0;
         av_opt_set(fg->graph, "aresample_swr_opts", args, 0);
     } else {
-        fg->graph->nb_threads = filter_complex_nbthreads;
+        fg->graph->nb_threads    = filter_complex_nbthreads;
+        fg->graph->graph_threads = filter_complex_graph_nbthreads;
     }
 
     if ((ret = avfilter_graph_parse2(fg->graph, graph_desc, &inputs, &outputs)) < 0)
@@ -176,6 +176,7 @@ int stdin_interaction = 1;
 float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
+int filter_complex_graph_nbthreads = 0;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
 int64_t stats_period = 500000;
@@ -904,6 +905,7 @@ static void add_input_streams(OptionsContext *o, AVFormatContext *ic)
         const char *hwaccel = NULL;
         char *hwaccel_output_format = NULL;
         char *codec_tag = NULL;
+        char *bsfs = NULL;
         char *next;
         char *discard_str = NULL;
         const AVClass *cc = avcodec_get_class();
@@ -934,6 +936,30 @@ static void add_input_streams(OptionsContext *o, AVFormatContext *ic)
             st->codecpar->codec_tag = tag;
         }
 
+        /* input bitstream filters run in the demuxing thread; everything
+         * downstream sees the parameters of their output */
+        MATCH_PER_STREAM_OPT(bitstream_filters, str, bsfs, ic, st);
+        if (bsfs && *bsfs) {
+            ret = av_bsf_list_parse_str(bsfs, &ist->bsf_ctx);
+            if (ret < 0) {
+                av_log(NULL, AV_LOG_ERROR, "Error parsing bitstream filter sequence '%s': %s\n", bsfs, av_err2str(ret));
+                exit_program(1);
+            }
+
+            ret = avcodec_parameters_copy(ist->bsf_ctx->par_in, par);
+            if (ret < 0)
+                exit_program(1);
+            ist->bsf_ctx->time_base_in = st->time_base;
+
+            ret = av_bsf_init(ist->bsf_ctx);
+            if (ret < 0) {
+                av_log(NULL, AV_LOG_ERROR, "Error initializing bitstream filter: %s\n",
+                       ist->bsf_ctx->filter->name);
+                exit_program(1);
+            }
+            par = ist->bsf_ctx->par_out;
+        }
+
         if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
             MATCH_PER_STREAM_OPT(hwaccels, str, hwaccel, ic, st);
             MATCH_PER_STREAM_OPT(hwaccel_output_formats, str,
@@ -1191,6 +1217,8 @@ static int open_input_file(OptionsContext *o, const char *filename)
     char *subtitle_codec_name = NULL;
     char *    data_codec_name = NULL;
     int scan_all_pmts_set = 0;
+    char *snapshot_key = NULL;
+    int snapshot_loaded = 0;
 
     if (o->stop_time != INT64_MAX && o->recording_time != INT64_MAX) {
         o->stop_time = INT64_MAX;
@@ -1309,7 +1337,22 @@ static int open_input_file(OptionsContext *o, const char *filename)
     for (i = 0; i < ic->nb_streams; i++)
         choose_decoder(o, ic, ic->streams[i], HWACCEL_NONE, AV_HWDEVICE_TYPE_NONE);
 
-    if (find_stream_info) {
+    if (o->session_snapshot) {
+        snapshot_key = snapshot_input_key(ic);
+        if (!snapshot_key) {
+            print_error(filename, AVERROR(ENOMEM));
+            exit_program(1);
+        }
+        ret = snapshot_load(ic, o->session_snapshot, snapshot_key);
+        if (ret < 0) {
+            av_log(NULL, AV_LOG_FATAL, "Error reading session snapshot '%s': %s\n",
+                   o->session_snapshot, av_err2str(ret));
+            exit_program(1);
+        }
+        snapshot_loaded = ret;
+    }
+
+    if (find_stream_info && !snapshot_loaded) {
         AVDictionary **opts = setup_find_stream_info_opts(ic, o->g->codec_opts);
         int orig_nb_streams = ic->nb_streams;
 
@@ -1327,8 +1370,15 @@ static int open_input_file(OptionsContext *o, const char *filename)
                 avformat_close_input(&ic);
                 exit_program(1);
             }
+        } else if (o->session_snapshot && ic->nb_streams == orig_nb_streams) {
+            /* streams found while probing cannot be restored */
+            ret = snapshot_save(ic, o->session_snapshot, snapshot_key);
+            if (ret < 0)
+                av_log(NULL, AV_LOG_WARNING, "Error writing session snapshot '%s': %s\n",
+                       o->session_snapshot, av_err2str(ret));
         }
     }
+    av_freep(&snapshot_key);
 
     if (o->start_time != AV_NOPTS_VALUE && o->start_time_eof != AV_NOPTS_VALUE) {
         av_log(NULL, AV_LOG_WARNING, "Cannot use -ss and -sseof both, using -ss for %s\n", filename);
@@ -3868,6 +3918,9 @@ const OptionDef options[] = {
     { "re",             OPT_BOOL | OPT_EXPERT | OPT_OFFSET |
                         OPT_INPUT,                                   { .off = OFFSET(rate_emu) },
         "read input at native frame rate; equivalent to -readrate 1", "" },
+    { "session_snapshot", HAS_ARG | OPT_STRING | OPT_OFFSET |
+                        OPT_EXPERT | OPT_INPUT,                      { .off = OFFSET(session_snapshot) },
+        "restore stream parameters from a snapshot file instead of probing, or create it", "filename" },
     { "readrate",       HAS_ARG | OPT_FLOAT | OPT_OFFSET |
                         OPT_EXPERT | OPT_INPUT,                      { .off = OFFSET(readrate) },
         "read input at specified rate", "speed" },
@@ -3937,6 +3990,8 @@ const OptionDef options[] = {
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_threads", HAS_ARG | OPT_INT,                   { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "filter_complex_graph_threads", HAS_ARG | OPT_INT | OPT_EXPERT, { &filter_complex_graph_nbthreads },
+        "number of threads running independent -filter_complex filters concurrently" },
     { "lavfi",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_script", HAS_ARG | OPT_EXPERT,                 { .func_arg = opt_filter_complex_script },
@@ -4131,7 +4186,7 @@ const OptionDef options[] = {
         "0 = use frame rate (video) or sample rate (audio),"
         "-1 = match source time base", "ratio" },
 
-    { "bsf", HAS_ARG | OPT_STRING | OPT_SPEC | OPT_EXPERT | OPT_OUTPUT, { .off = OFFSET(bitstream_filters) },
+    { "bsf", HAS_ARG | OPT_STRING | OPT_SPEC | OPT_EXPERT | OPT_INPUT | OPT_OUTPUT, { .off = OFFSET(bitstream_filters) },
         "A comma-separated list of bitstream filters", "bitstream_filters" },
     { "absf", HAS_ARG | OPT_AUDIO | OPT_EXPERT| OPT_PERFILE | OPT_OUTPUT, { .func_arg = opt_old2new },
         "deprecated", "audio bitstream_filters" },
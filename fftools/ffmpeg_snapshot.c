@@ -0,0 +1,435 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Session snapshots: the stream parameters avformat_find_stream_info()
+ * produced for an input, stored as escaped key=value lines so that a later
+ * run on the same input can skip probing.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "ffmpeg.h"
+
+#include "libavutil/avstring.h"
+#include "libavutil/bprint.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/dict.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/random_seed.h"
+
+#include "libavcodec/avcodec.h"
+#include "libavcodec/version.h"
+
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+#include "libavformat/os_support.h"
+
+#define SNAPSHOT_MAX_SIZE  (16 << 20)
+/* larger indexes are built by the demuxers themselves when opening */
+#define SNAPSHOT_MAX_INDEX 4096
+
+typedef struct SnapshotField {
+    const char *name;
+    size_t      offset;
+} SnapshotField;
+
+#define PAR(x) { #x, offsetof(AVCodecParameters, x) }
+/* int sized fields of AVCodecParameters, enums included */
+static const SnapshotField par_int_fields[] = {
+    PAR(codec_tag),
+    PAR(format),
+    PAR(bits_per_coded_sample),
+    PAR(bits_per_raw_sample),
+    PAR(profile),
+    PAR(level),
+    PAR(width),
+    PAR(height),
+    PAR(field_order),
+    PAR(color_range),
+    PAR(color_primaries),
+    PAR(color_trc),
+    PAR(color_space),
+    PAR(chroma_location),
+    PAR(video_delay),
+    PAR(sample_rate),
+    PAR(block_align),
+    PAR(frame_size),
+    PAR(initial_padding),
+    PAR(trailing_padding),
+    PAR(seek_preroll),
+};
+#undef PAR
+
+static void put_str(AVBPrint *bp, const char *key, const char *val)
+{
+    av_bprintf(bp, "%s=", key);
+    av_bprint_escape(bp, val, "=\n", AV_ESCAPE_MODE_BACKSLASH,
+                     AV_ESCAPE_FLAG_WHITESPACE);
+    av_bprint_chars(bp, '\n', 1);
+}
+
+static void write_stream(AVBPrint *bp, AVStream *st)
+{
+    const AVCodecParameters *par = st->codecpar;
+    char layout[128];
+    int i, nb_entries;
+
+#define PUT(fmt, key, ...) \
+    av_bprintf(bp, "stream.%d." key "=" fmt "\n", st->index, __VA_ARGS__)
+    PUT("%s",        "codec_type",  av_get_media_type_string(par->codec_type) ?
+                                    av_get_media_type_string(par->codec_type) : "unknown");
+    PUT("%s",        "codec",       avcodec_get_name(par->codec_id));
+    PUT("%"PRId64,   "bit_rate",    par->bit_rate);
+    PUT("%d/%d",     "par_sar",     par->sample_aspect_ratio.num,
+                                    par->sample_aspect_ratio.den);
+    PUT("%d/%d",     "time_base",   st->time_base.num, st->time_base.den);
+    PUT("%d/%d",     "r_frame_rate",   st->r_frame_rate.num, st->r_frame_rate.den);
+    PUT("%d/%d",     "avg_frame_rate", st->avg_frame_rate.num, st->avg_frame_rate.den);
+    PUT("%d/%d",     "sar",         st->sample_aspect_ratio.num,
+                                    st->sample_aspect_ratio.den);
+    PUT("%"PRId64,   "start_time",  st->start_time);
+    PUT("%"PRId64,   "duration",    st->duration);
+    PUT("%"PRId64,   "nb_frames",   st->nb_frames);
+    for (i = 0; i < FF_ARRAY_ELEMS(par_int_fields); i++)
+        av_bprintf(bp, "stream.%d.%s=%d\n", st->index, par_int_fields[i].name,
+                   *(const int *)((const uint8_t *)par + par_int_fields[i].offset));
+#undef PUT
+
+    if (av_channel_layout_check(&par->ch_layout) &&
+        av_channel_layout_describe(&par->ch_layout, layout, sizeof(layout)) > 0) {
+        char key[64];
+        snprintf(key, sizeof(key), "stream.%d.ch_layout", st->index);
+        put_str(bp, key, layout);
+    }
+
+    /* seeking depends on the index entries probing collected */
+    nb_entries = avformat_index_get_entries_count(st);
+    if (nb_entries > 0 && nb_entries <= SNAPSHOT_MAX_INDEX) {
+        av_bprintf(bp, "stream.%d.index=", st->index);
+        for (i = 0; i < nb_entries; i++) {
+            const AVIndexEntry *e = avformat_index_get_entry(st, i);
+            av_bprintf(bp, "%s%"PRId64",%"PRId64",%d,%d,%d", i ? ";" : "",
+                       e->pos, e->timestamp, e->size, e->min_distance, e->flags);
+        }
+        av_bprint_chars(bp, '\n', 1);
+    }
+
+    if (par->extradata_size > 0) {
+        av_bprintf(bp, "stream.%d.extradata=", st->index);
+        for (i = 0; i < par->extradata_size; i++)
+            av_bprintf(bp, "%02x", par->extradata[i]);
+        av_bprint_chars(bp, '\n', 1);
+    }
+}
+
+/* Path of a file: URL in the local filesystem, NULL for other protocols. */
+static const char *local_path(const char *url)
+{
+    const char *proto = avio_find_protocol_name(url);
+
+    if (!proto || strcmp(proto, "file"))
+        return NULL;
+    av_strstart(url, "file:", &url);
+    return url;
+}
+
+int snapshot_save(AVFormatContext *ic, const char *path, const char *key)
+{
+    AVIOContext *pb;
+    AVBPrint bp;
+    const char *local = local_path(path);
+    char *tmp = NULL;
+    int i, ret;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprintf(&bp, "version=%u\n", LIBAVCODEC_VERSION_INT);
+    put_str(&bp, "input", key);
+    av_bprintf(&bp, "start_time=%"PRId64"\n", ic->start_time);
+    av_bprintf(&bp, "duration=%"PRId64"\n",   ic->duration);
+    av_bprintf(&bp, "bit_rate=%"PRId64"\n",   ic->bit_rate);
+    for (i = 0; i < ic->nb_streams; i++)
+        write_stream(&bp, ic->streams[i]);
+
+    if (!av_bprint_is_complete(&bp)) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    /* write local snapshots next to the final file and rename them into
+     * place, so that an interrupted write never leaves a truncated one */
+    if (local) {
+        tmp = av_asprintf("%s.%08x.tmp", local, av_get_random_seed());
+        if (!tmp) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    ret = avio_open2(&pb, tmp ? tmp : path, AVIO_FLAG_WRITE, &int_cb, NULL);
+    if (ret < 0)
+        goto fail;
+    avio_write(pb, bp.str, bp.len);
+    ret = avio_closep(&pb);
+
+    if (tmp) {
+        if (ret >= 0 && rename(tmp, local) < 0)
+            ret = AVERROR(errno);
+        if (ret < 0)
+            unlink(tmp);
+    }
+
+fail:
+    av_free(tmp);
+    av_bprint_finalize(&bp, NULL);
+    return ret;
+}
+
+static const char *get_stream_val(AVDictionary *d, int index, const char *key)
+{
+    char name[64];
+    const AVDictionaryEntry *e;
+
+    snprintf(name, sizeof(name), "stream.%d.%s", index, key);
+    e = av_dict_get(d, name, NULL, AV_DICT_MATCH_CASE);
+    return e ? e->value : NULL;
+}
+
+static int get_int64(AVDictionary *d, const char *key, int64_t *val)
+{
+    const AVDictionaryEntry *e = av_dict_get(d, key, NULL, AV_DICT_MATCH_CASE);
+    return e && sscanf(e->value, "%"SCNd64, val) == 1;
+}
+
+static int get_stream_int64(AVDictionary *d, int index, const char *key, int64_t *val)
+{
+    const char *s = get_stream_val(d, index, key);
+    return s && sscanf(s, "%"SCNd64, val) == 1;
+}
+
+static int get_stream_q(AVDictionary *d, int index, const char *key, AVRational *q)
+{
+    const char *s = get_stream_val(d, index, key);
+    return s && sscanf(s, "%d/%d", &q->num, &q->den) == 2;
+}
+
+static int parse_extradata(AVCodecParameters *par, const char *hex)
+{
+    size_t len = strlen(hex);
+    int i;
+
+    if (len & 1 || len / 2 > INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
+        return AVERROR_INVALIDDATA;
+
+    par->extradata = av_mallocz(len / 2 + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!par->extradata)
+        return AVERROR(ENOMEM);
+    par->extradata_size = len / 2;
+
+    for (i = 0; i < par->extradata_size; i++) {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1)
+            return AVERROR_INVALIDDATA;
+        par->extradata[i] = v;
+    }
+    return 0;
+}
+
+char *snapshot_input_key(const AVFormatContext *ic)
+{
+    AVBPrint bp;
+    const char *local = local_path(ic->url);
+    struct stat st;
+    char *key;
+    int64_t size;
+    int i;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprintf(&bp, "%s", ic->url);
+    /* a file replaced under the same name usually differs in either */
+    size = ic->pb ? avio_size(ic->pb) : -1;
+    if (size >= 0)
+        av_bprintf(&bp, "|size:%"PRId64, size);
+    if (local && !stat(local, &st))
+        av_bprintf(&bp, "|mtime:%"PRId64, (int64_t)st.st_mtime);
+    for (i = 0; i < ic->nb_streams; i++) {
+        const AVStream *st = ic->streams[i];
+        av_bprintf(&bp, "|%d:%s:%d/%d", st->codecpar->codec_type,
+                   avcodec_get_name(st->codecpar->codec_id),
+                   st->time_base.num, st->time_base.den);
+    }
+
+    if (av_bprint_finalize(&bp, &key) < 0)
+        return NULL;
+    return key;
+}
+
+/* The snapshot must have been taken from streams identical to the ones the
+ * demuxer just created; anything else means the input changed since. */
+static int snapshot_matches(AVDictionary *d, const char *key)
+{
+    const AVDictionaryEntry *e = av_dict_get(d, "input", NULL, AV_DICT_MATCH_CASE);
+    int64_t version;
+
+    return get_int64(d, "version", &version) && version == LIBAVCODEC_VERSION_INT &&
+           e && !strcmp(e->value, key);
+}
+
+static int parse_index(AVStream *st, const char *p)
+{
+    while (*p) {
+        int64_t pos, timestamp;
+        int size, distance, flags, n = 0, ret;
+
+        if (sscanf(p, "%"SCNd64",%"SCNd64",%d,%d,%d%n",
+                   &pos, &timestamp, &size, &distance, &flags, &n) != 5 || !n)
+            return AVERROR_INVALIDDATA;
+        ret = av_add_index_entry(st, pos, timestamp, size, distance, flags);
+        if (ret < 0)
+            return ret;
+        p += n;
+        if (*p == ';')
+            p++;
+    }
+    return 0;
+}
+
+static int apply_stream(AVStream *st, AVDictionary *d)
+{
+    AVCodecParameters *par = st->codecpar;
+    const char *codec  = get_stream_val(d, st->index, "codec");
+    const char *layout = get_stream_val(d, st->index, "ch_layout");
+    const char *extradata = get_stream_val(d, st->index, "extradata");
+    const char *index     = get_stream_val(d, st->index, "index");
+    const AVCodecDescriptor *desc = avcodec_descriptor_get_by_name(codec);
+    int64_t v;
+    int i, ret;
+
+    if (desc) {
+        par->codec_type = desc->type;
+        par->codec_id   = desc->id;
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(par_int_fields); i++)
+        if (get_stream_int64(d, st->index, par_int_fields[i].name, &v))
+            *(int *)((uint8_t *)par + par_int_fields[i].offset) = v;
+    if (get_stream_int64(d, st->index, "bit_rate", &v))
+        par->bit_rate = v;
+    get_stream_q(d, st->index, "par_sar", &par->sample_aspect_ratio);
+
+    get_stream_q(d, st->index, "r_frame_rate",   &st->r_frame_rate);
+    get_stream_q(d, st->index, "avg_frame_rate", &st->avg_frame_rate);
+    get_stream_q(d, st->index, "sar",            &st->sample_aspect_ratio);
+    if (get_stream_int64(d, st->index, "start_time", &v))
+        st->start_time = v;
+    if (get_stream_int64(d, st->index, "duration", &v))
+        st->duration = v;
+    if (get_stream_int64(d, st->index, "nb_frames", &v))
+        st->nb_frames = v;
+
+    if (layout) {
+        AVChannelLayout ch_layout = { 0 };
+        ret = av_channel_layout_from_string(&ch_layout, layout);
+        if (ret < 0)
+            return ret;
+        av_channel_layout_uninit(&par->ch_layout);
+        par->ch_layout = ch_layout;
+    }
+
+    if (index && !avformat_index_get_entries_count(st)) {
+        ret = parse_index(st, index);
+        if (ret < 0)
+            return ret;
+    }
+
+    /* what the demuxer exported itself is authoritative */
+    if (extradata && !par->extradata_size) {
+        av_freep(&par->extradata);
+        ret = parse_extradata(par, extradata);
+        if (ret < 0) {
+            av_freep(&par->extradata);
+            par->extradata_size = 0;
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int snapshot_load(AVFormatContext *ic, const char *path, const char *key)
+{
+    AVIOContext *pb;
+    AVDictionary *d = NULL;
+    AVBPrint bp;
+    int64_t v;
+    int i, ret;
+
+    ret = avio_open2(&pb, path, AVIO_FLAG_READ, &int_cb, NULL);
+    if (ret < 0)
+        return ret == AVERROR(ENOENT) ? 0 : ret;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    ret = avio_read_to_bprint(pb, &bp, SNAPSHOT_MAX_SIZE);
+    avio_closep(&pb);
+    if (ret < 0)
+        goto end;
+    if (!av_bprint_is_complete(&bp)) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = av_dict_parse_string(&d, bp.str, "=", "\n", 0);
+    if (ret < 0 || !snapshot_matches(d, key)) {
+        av_log(NULL, AV_LOG_WARNING, "Session snapshot '%s' does not match "
+               "input '%s', probing it again\n", path, ic->url);
+        ret = 0;
+        goto end;
+    }
+
+    for (i = 0; i < ic->nb_streams; i++) {
+        ret = apply_stream(ic->streams[i], d);
+        if (ret < 0)
+            goto end;
+    }
+    if (get_int64(d, "start_time", &v))
+        ic->start_time = v;
+    if (get_int64(d, "duration", &v))
+        ic->duration = v;
+    if (get_int64(d, "bit_rate", &v))
+        ic->bit_rate = v;
+
+    av_log(NULL, AV_LOG_VERBOSE, "Restored stream parameters of '%s' from "
+           "session snapshot '%s'\n", ic->url, path);
+    ret = 1;
+
+end:
+    av_dict_free(&d);
+    av_bprint_finalize(&bp, NULL);
+    return ret;
+}
@@ -63,6 +63,7 @@ int aac = 0;
 int hls = 0;
 int tonemap = 0;
 int thumbnail = 0;
+char thumbnail_vf[128] = {0};
 int ext_c;
 const char* ext_v[16];
 
@@ -88,15 +89,22 @@ static char* bufprintf(const char* fmt, ...) {
 static int conv(const char **arg) {
     int w,h;
     const char *p = NULL;
+    int keep_thumbnail = 0;
     if (!strcmp("-vf", *arg) || !strcmp("-filter_complex", *arg)) {
+        if (!strcmp("-vf", *arg) && (p = strstr(arg[1], "thumbnail="))) {
+            // the rest of the chain is replaced, but keep the thumbnail selection
+            thumbnail = keep_thumbnail = 1;
+            snprintf(thumbnail_vf, sizeof(thumbnail_vf), "%.*s:keyframes=1",
+                     (int)strcspn(p, ",;["), p);
+            ext_c = 2;
+            ext_v[0] = "-vf";
+            ext_v[1] = thumbnail_vf;
+        }
 #if CONFIG_SCALE_RGA_FILTER
         if (!strcmp("-vf", *arg)) {
             if (strstr(arg[1], "tonemap=")) {
                 tonemap = 1;
             }
-            if (strstr(arg[1], "thumbnail=")) {
-                thumbnail = 1;
-            }
         }
         p = strstr(arg[1], "scale=trunc(");
 
@@ -118,10 +126,9 @@ static int conv(const char **arg) {
             }
             h = w * 9 / 32 * 2;
             sprintf(scale_rga, "scale_rga=%dx%d", w, h);
-            return DROP|0x2;
         }
 #endif
-        return DROP|0x2;
+        return keep_thumbnail ? EXTEND|DROP|0x2 : DROP|0x2;
     } else if (!strncmp("-codec:v:", *arg, 9)) {
         if (!strcmp("libx264", arg[1])) {
             libx264_to_mpp = 1;
@@ -171,7 +178,8 @@ static int conv(const char **arg) {
         else if (!strcmp("image2", arg[1])) {
             ext_c = 2;
             ext_v[0] = "-vf";
-            ext_v[1] = "scale_rga=1280x720,hwdownload,scale";
+            ext_v[1] = thumbnail ? bufprintf("scale_rga=1280x720,hwdownload,%s,scale", thumbnail_vf)
+                                 : "scale_rga=1280x720,hwdownload,scale";
             return EXTEND;
         }
 #endif
@@ -220,7 +228,7 @@ typedef int (*Filter)(const char **) ;
 
 Filter filters[]={conv, arg_filter, flag_filter, NULL};
 
-#define MAX_MPP_DEC_ARGC 0
+#define MAX_MPP_DEC_ARGC 4
 
 static int conv_opts(int argc, const char **argv, const char* nargv[]) {
     int nargc = MAX_MPP_DEC_ARGC+1;
@@ -255,6 +263,14 @@ int main(int argc, const char **argv)
     int pargc = 0;
     int nargc = conv_opts(argc, argv, nargv);
 
+    if (thumbnail) {
+        // thumbnails are picked among key frames, do not demux or decode the others
+        nargv[MAX_MPP_DEC_ARGC - pargc++] = "nokey";
+        nargv[MAX_MPP_DEC_ARGC - pargc++] = "-skip_frame";
+        nargv[MAX_MPP_DEC_ARGC - pargc++] = "nokey";
+        nargv[MAX_MPP_DEC_ARGC - pargc++] = "-discard:v";
+    }
+
     if (!dump_attachment) {
         nargv[nargc] = NULL;
         nargv[MAX_MPP_DEC_ARGC - pargc] = "ffmpeg";
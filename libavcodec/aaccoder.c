@@ -108,10 +108,10 @@ static av_always_inline float quantize_and_encode_band_cost_template(
         return cost * lambda;
     }
     if (!scaled) {
-        s->abs_pow34(s->scoefs, in, size);
+        s->aacdsp.abs_pow34(s->scoefs, in, size);
         scaled = s->scoefs;
     }
-    s->quant_bands(s->qcoefs, in, scaled, size, !BT_UNSIGNED, aac_cb_maxval[cb], Q34, ROUNDING);
+    s->aacdsp.quant_bands(s->qcoefs, in, scaled, size, !BT_UNSIGNED, aac_cb_maxval[cb], Q34, ROUNDING);
     if (BT_UNSIGNED) {
         off = 0;
     } else {
@@ -311,7 +311,7 @@ static void encode_window_bands_info(AACEncContext *s, SingleChannelElement *sce
     float next_minrd = INFINITY;
     int next_mincb = 0;
 
-    s->abs_pow34(s->scoefs, sce->coeffs, 1024);
+    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
     start = win*128;
     for (cb = 0; cb < CB_TOT_ALL; cb++) {
         path[0][cb].cost     = 0.0f;
@@ -522,7 +522,7 @@ static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
         }
     }
     idx = 1;
-    s->abs_pow34(s->scoefs, sce->coeffs, 1024);
+    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
     for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
         start = w*128;
         for (g = 0; g < sce->ics.num_swb; g++) {
@@ -668,7 +668,7 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
 
     if (!allz)
         return;
-    s->abs_pow34(s->scoefs, sce->coeffs, 1024);
+    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
     ff_quantize_band_cost_cache_init(s);
 
     for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
@@ -762,6 +762,244 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
     } while (fflag && its < 10);
 }
 
+/**
+ * Set the scalefactors and codebooks of the realtime coder from per-group band
+ * energies, (lambda-scaled) thresholds and maxima of the scaled coefficients.
+ *
+ * Assuming uniform quantization noise in the |x|^(3/4) domain, a band quantized
+ * with step IQ has a noise energy of about 4/27 * IQ^(3/2) * sum(sqrt(|x|)).
+ * Approximating the sum from the band energy gives the scalefactor which puts
+ * the noise at the threshold in closed form, so no search over the bit cost is
+ * done. Rate control only acts through lambda.
+ */
+static void set_quantizers_rt(SingleChannelElement *sce, const float *energy,
+                              const float *thr, const float *maxvals)
+{
+    int w, g, minsf = INT_MAX, minsf_req = 0;
+
+    for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
+        for (g = 0; g < sce->ics.num_swb; g++) {
+            const int lines = sce->ics.group_len[w] * sce->ics.swb_sizes[g];
+            const int idx   = w*16 + g;
+            int sf, sf_req;
+
+            sce->band_type[idx] = 0;
+            if (energy[idx] <= thr[idx] || thr[idx] == 0.0f || maxvals[idx] == 0.0f) {
+                sce->zeroes[idx] = 1;
+                sce->sf_idx[idx] = SCALE_ONE_POS;
+                continue;
+            }
+            sce->zeroes[idx] = 0;
+
+            sf = lrintf(8.0f / 3.0f * (log2f(6.75f * thr[idx]) - 0.75f * log2f(lines) -
+                                       0.25f * log2f(energy[idx])));
+            /* keep the largest quantized value within the escape codebook range */
+            sf_req = ceilf(16.0f / 3.0f * (log2f(maxvals[idx]) - 13.0f));
+            sf     = FFMAX(sf, sf_req) + SCALE_ONE_POS - SCALE_DIV_512;
+            sf_req += SCALE_ONE_POS - SCALE_DIV_512;
+
+            sce->sf_idx[idx] = av_clip(sf, 0, 219);
+            minsf     = FFMIN(minsf, sce->sf_idx[idx]);
+            minsf_req = FFMAX(minsf_req, sf_req);
+        }
+    }
+
+    if (minsf == INT_MAX)
+        minsf = SCALE_ONE_POS;
+    minsf = FFMAX(minsf, minsf_req - SCALE_MAX_DIFF);
+    minsf = av_clip(minsf, 60, 255 - SCALE_MAX_DIFF);
+
+    for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
+        for (g = 0; g < sce->ics.num_swb; g++) {
+            const int idx = w*16 + g;
+            sce->sf_idx[idx] = av_clip(sce->sf_idx[idx], minsf, minsf + SCALE_MAX_DIFF);
+            sce->sf_idx[idx] = FFMIN(sce->sf_idx[idx], 219);
+            if (!sce->zeroes[idx])
+                sce->band_type[idx] = find_min_book(maxvals[idx], sce->sf_idx[idx]);
+        }
+    }
+}
+
+/**
+ * Noise floor per spectral line, 30 dB below the mean line energy of the
+ * channel. Added to the masking thresholds it spreads the quantization noise
+ * over the spectrum much like the threshold reduction of the full model does,
+ * instead of keeping the same SNR in every band when lambda drops.
+ */
+static float noise_floor_rt(AACEncContext *s, SingleChannelElement *sce, int channel)
+{
+    float energy = 0.0f;
+    int w, g;
+
+    for (w = 0; w < sce->ics.num_windows; w++)
+        for (g = 0; g < sce->ics.num_swb; g++)
+            energy += s->psy.ch[channel].psy_bands[w*16+g].energy;
+
+    return energy * (0.001f / 1024.0f);
+}
+
+static void search_for_quantizers_rt(AVCodecContext *avctx, AACEncContext *s,
+                                     SingleChannelElement *sce,
+                                     const float lambda)
+{
+    const float thr_mult = 120.0f / lambda;
+    float energy[128], thr[128], maxvals[128];
+    int start, w, w2, g;
+
+    const float noise = noise_floor_rt(s, sce, s->cur_channel);
+
+    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
+
+    for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
+        start = w*128;
+        for (g = 0; g < sce->ics.num_swb; g++) {
+            float e = 0.0f, t = 0.0f;
+            for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
+                FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
+                e += band->energy;
+                t += band->threshold + noise * sce->ics.swb_sizes[g];
+            }
+            energy [w*16+g] = e;
+            thr    [w*16+g] = t * thr_mult;
+            maxvals[w*16+g] = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g],
+                                           s->scoefs + start);
+            start += sce->ics.swb_sizes[g];
+        }
+    }
+
+    set_quantizers_rt(sce, energy, thr, maxvals);
+}
+
+/**
+ * Mid/side decision of the realtime coder: a band is coded as M/S when the
+ * sum of log2(energy/threshold) over both channels, an estimate of its
+ * perceptual entropy, is lower than for L/R. The noise of M and S both end up
+ * in L and R, so each gets half of the lower L/R threshold.
+ */
+static void search_for_ms_rt(AACEncContext *s, ChannelElement *cpe)
+{
+    const float thr_mult = 120.0f / s->lambda;
+    SingleChannelElement *sce0 = &cpe->ch[0];
+    SingleChannelElement *sce1 = &cpe->ch[1];
+    float noise0, noise1;
+    float *M   = s->scoefs + 128*0, *S   = s->scoefs + 128*1;
+    float *L34 = s->scoefs + 128*2, *R34 = s->scoefs + 128*3;
+    float *M34 = s->scoefs + 128*4, *S34 = s->scoefs + 128*5;
+    float energy[2][128], thr[2][128], maxvals[2][128];
+    int start, i, w, w2, g, ms = 0;
+
+    if (!cpe->common_window)
+        return;
+
+    noise0 = noise_floor_rt(s, sce0, s->cur_channel + 0);
+    noise1 = noise_floor_rt(s, sce1, s->cur_channel + 1);
+
+    for (w = 0; w < sce0->ics.num_windows; w += sce0->ics.group_len[w]) {
+        start = w*128;
+        for (g = 0; g < sce0->ics.num_swb; g++) {
+            const int size = sce0->ics.swb_sizes[g];
+            const int idx  = w*16 + g;
+            float el = 0.0f, er = 0.0f, tl = 0.0f, tr = 0.0f, em = 0.0f, es = 0.0f, tms;
+            float lmax = 0.0f, rmax = 0.0f, mmax = 0.0f, smax = 0.0f;
+
+            for (w2 = 0; w2 < sce0->ics.group_len[w]; w2++) {
+                const FFPsyBand *b0 = &s->psy.ch[s->cur_channel + 0].psy_bands[(w+w2)*16+g];
+                const FFPsyBand *b1 = &s->psy.ch[s->cur_channel + 1].psy_bands[(w+w2)*16+g];
+                const float *L = sce0->coeffs + start + w2*128;
+                const float *R = sce1->coeffs + start + w2*128;
+
+                el += b0->energy;
+                er += b1->energy;
+                tl += b0->threshold + noise0 * size;
+                tr += b1->threshold + noise1 * size;
+                for (i = 0; i < size; i++) {
+                    M[i] = (L[i] + R[i]) * 0.5f;
+                    S[i] =  M[i] - R[i];
+                    em  += M[i] * M[i];
+                    es  += S[i] * S[i];
+                }
+                s->aacdsp.abs_pow34(L34, L, size);
+                s->aacdsp.abs_pow34(R34, R, size);
+                s->aacdsp.abs_pow34(M34, M, size);
+                s->aacdsp.abs_pow34(S34, S, size);
+                for (i = 0; i < size; i++) {
+                    lmax = FFMAX(lmax, L34[i]);
+                    rmax = FFMAX(rmax, R34[i]);
+                    mmax = FFMAX(mmax, M34[i]);
+                    smax = FFMAX(smax, S34[i]);
+                }
+            }
+            tl *= thr_mult;
+            tr *= thr_mult;
+            tms = FFMIN(tl, tr) * 0.5f;
+
+            cpe->ms_mask[idx] = 0;
+            if ((el > tl || er > tr) && tms > 0.0f &&
+                sce0->band_type[idx] < RESERVED_BT && sce1->band_type[idx] < RESERVED_BT) {
+                float pe_lr = log2f(FFMAX(el, tl) / tl) + log2f(FFMAX(er, tr) / tr);
+                float pe_ms = log2f(FFMAX(em, tms) / tms) + log2f(FFMAX(es, tms) / tms);
+                cpe->ms_mask[idx] = pe_ms < pe_lr;
+            }
+
+            if (cpe->ms_mask[idx]) {
+                energy [0][idx] = em;
+                energy [1][idx] = es;
+                thr    [0][idx] = thr[1][idx] = tms;
+                maxvals[0][idx] = mmax;
+                maxvals[1][idx] = smax;
+                ms = 1;
+            } else {
+                energy [0][idx] = el;
+                energy [1][idx] = er;
+                thr    [0][idx] = tl;
+                thr    [1][idx] = tr;
+                maxvals[0][idx] = lmax;
+                maxvals[1][idx] = rmax;
+            }
+            start += size;
+        }
+    }
+
+    if (ms) {
+        set_quantizers_rt(sce0, energy[0], thr[0], maxvals[0]);
+        set_quantizers_rt(sce1, energy[1], thr[1], maxvals[1]);
+    }
+}
+
+/**
+ * Section the bands of a window group by merging runs of bands which use the
+ * same codebook, without evaluating the cost of any other codebook.
+ */
+static void encode_window_bands_info_rt(AACEncContext *s, SingleChannelElement *sce,
+                                        int win, int group_len, const float lambda)
+{
+    const int max_sfb  = sce->ics.max_sfb;
+    const int run_bits = sce->ics.num_windows == 1 ? 5 : 3;
+    const int run_esc  = (1 << run_bits) - 1;
+    int swb = 0, i;
+
+    while (swb < max_sfb) {
+        int cb = sce->zeroes[win*16 + swb] ? 0 : sce->band_type[win*16 + swb];
+        int count = 1;
+
+        while (swb + count < max_sfb &&
+               (sce->zeroes[win*16 + swb + count] ? 0 : sce->band_type[win*16 + swb + count]) == cb)
+            count++;
+
+        put_bits(&s->pb, 4, cb);
+        for (i = 0; i < count; i++) {
+            sce->band_type[win*16 + swb + i] = cb;
+            sce->zeroes   [win*16 + swb + i] = !cb;
+        }
+        swb += count;
+        while (count >= run_esc) {
+            put_bits(&s->pb, run_bits, run_esc);
+            count -= run_esc;
+        }
+        put_bits(&s->pb, run_bits, count);
+    }
+}
+
 static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChannelElement *sce)
 {
     FFPsyBand *band;
@@ -874,8 +1112,8 @@ static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChanne
                 s->fdsp->vector_fmul_scalar(PNS, PNS, scale, sce->ics.swb_sizes[g]);
                 pns_senergy = s->fdsp->scalarproduct_float(PNS, PNS, sce->ics.swb_sizes[g]);
                 pns_energy += pns_senergy;
-                s->abs_pow34(NOR34, &sce->coeffs[start_c], sce->ics.swb_sizes[g]);
-                s->abs_pow34(PNS34, PNS, sce->ics.swb_sizes[g]);
+                s->aacdsp.abs_pow34(NOR34, &sce->coeffs[start_c], sce->ics.swb_sizes[g]);
+                s->aacdsp.abs_pow34(PNS34, PNS, sce->ics.swb_sizes[g]);
                 dist1 += quantize_band_cost(s, &sce->coeffs[start_c],
                                             NOR34,
                                             sce->ics.swb_sizes[g],
@@ -1012,8 +1250,8 @@ static void search_for_ms(AACEncContext *s, ChannelElement *cpe)
                         S[i] =  M[i]
                               - sce1->coeffs[start+(w+w2)*128+i];
                     }
-                    s->abs_pow34(M34, M, sce0->ics.swb_sizes[g]);
-                    s->abs_pow34(S34, S, sce0->ics.swb_sizes[g]);
+                    s->aacdsp.abs_pow34(M34, M, sce0->ics.swb_sizes[g]);
+                    s->aacdsp.abs_pow34(S34, S, sce0->ics.swb_sizes[g]);
                     for (i = 0; i < sce0->ics.swb_sizes[g]; i++ ) {
                         Mmax = FFMAX(Mmax, M34[i]);
                         Smax = FFMAX(Smax, S34[i]);
@@ -1056,10 +1294,10 @@ static void search_for_ms(AACEncContext *s, ChannelElement *cpe)
                                   - sce1->coeffs[start+(w+w2)*128+i];
                         }
 
-                        s->abs_pow34(L34, sce0->coeffs+start+(w+w2)*128, sce0->ics.swb_sizes[g]);
-                        s->abs_pow34(R34, sce1->coeffs+start+(w+w2)*128, sce0->ics.swb_sizes[g]);
-                        s->abs_pow34(M34, M,                         sce0->ics.swb_sizes[g]);
-                        s->abs_pow34(S34, S,                         sce0->ics.swb_sizes[g]);
+                        s->aacdsp.abs_pow34(L34, sce0->coeffs+start+(w+w2)*128, sce0->ics.swb_sizes[g]);
+                        s->aacdsp.abs_pow34(R34, sce1->coeffs+start+(w+w2)*128, sce0->ics.swb_sizes[g]);
+                        s->aacdsp.abs_pow34(M34, M,                         sce0->ics.swb_sizes[g]);
+                        s->aacdsp.abs_pow34(S34, S,                         sce0->ics.swb_sizes[g]);
                         dist1 += quantize_band_cost(s, &sce0->coeffs[start + (w+w2)*128],
                                                     L34,
                                                     sce0->ics.swb_sizes[g],
@@ -1183,4 +1421,26 @@ const AACCoefficientsEncoder ff_aac_coders[AAC_CODER_NB] = {
         ff_aac_search_for_is,
         ff_aac_search_for_pred,
     },
+    [AAC_CODER_REALTIME] = {
+        search_for_quantizers_rt,
+        encode_window_bands_info_rt,
+        quantize_and_encode_band,
+        ff_aac_encode_tns_info,
+        ff_aac_encode_ltp_info,
+        ff_aac_encode_main_pred,
+        ff_aac_adjust_common_pred,
+        ff_aac_adjust_common_ltp,
+        ff_aac_apply_main_pred,
+        ff_aac_apply_tns,
+        ff_aac_update_ltp,
+        ff_aac_ltp_insert_new_frame,
+        set_special_band_scalefactors,
+        NULL,
+        NULL,
+        ff_aac_search_for_tns,
+        ff_aac_search_for_ltp,
+        search_for_ms_rt,
+        NULL,
+        ff_aac_search_for_pred,
+    },
 };
@@ -827,19 +827,135 @@ static void copy_input_samples(AACEncContext *s, const AVFrame *frame)
     }
 }
 
+typedef struct AACEncAnalysisArgs {
+    const AVFrame *frame;
+    FFPsyWindowInfo *windows;
+} AACEncAnalysisArgs;
+
+/*
+ * Window decision, transform and clipping analysis of one channel.
+ * Channels do not depend on each other here, so with the realtime coder
+ * this is run as one slice thread job per channel.
+ */
+static int analyze_channel(AVCodecContext *avctx, void *arg, int channel, int threadnr)
+{
+    AACEncContext *s = avctx->priv_data;
+    const AACEncAnalysisArgs *args = arg;
+    FFPsyWindowInfo *wi = &args->windows[channel];
+    SingleChannelElement *sce;
+    IndividualChannelStream *ics;
+    float *overlap, *samples2, *la;
+    float clip_avoidance_factor;
+    int i, w, k, tag, start_ch = 0;
+
+    for (i = 0; i < s->chan_map[0]; i++) {
+        int chans = s->chan_map[i+1] == TYPE_CPE ? 2 : 1;
+        if (channel < start_ch + chans)
+            break;
+        start_ch += chans;
+    }
+    tag = s->chan_map[i+1];
+    sce = &s->cpe[i].ch[channel - start_ch];
+    ics = &sce->ics;
+
+    overlap  = &s->planar_samples[channel][0];
+    samples2 = overlap + 1024;
+    la       = samples2 + (448+64);
+    if (!args->frame)
+        la = NULL;
+    if (tag == TYPE_LFE) {
+        wi->window_type[0] = wi->window_type[1] = ONLY_LONG_SEQUENCE;
+        wi->window_shape   = 0;
+        wi->num_windows    = 1;
+        wi->grouping[0]    = 1;
+        wi->clipping[0]    = 0;
+
+        /* Only the lowest 12 coefficients are used in a LFE channel.
+         * The expression below results in only the bottom 8 coefficients
+         * being used for 11.025kHz to 16kHz sample rates.
+         */
+        ics->num_swb = s->samplerate_index >= 8 ? 1 : 3;
+    } else {
+        *wi = s->psy.model->window(&s->psy, samples2, la, channel,
+                                   ics->window_sequence[0]);
+    }
+    ics->window_sequence[1] = ics->window_sequence[0];
+    ics->window_sequence[0] = wi->window_type[0];
+    ics->use_kb_window[1]   = ics->use_kb_window[0];
+    ics->use_kb_window[0]   = wi->window_shape;
+    ics->num_windows        = wi->num_windows;
+    ics->swb_sizes          = s->psy.bands    [ics->num_windows == 8];
+    ics->num_swb            = tag == TYPE_LFE ? ics->num_swb : s->psy.num_bands[ics->num_windows == 8];
+    ics->max_sfb            = FFMIN(ics->max_sfb, ics->num_swb);
+    ics->swb_offset         = wi->window_type[0] == EIGHT_SHORT_SEQUENCE ?
+                                ff_swb_offset_128 [s->samplerate_index]:
+                                ff_swb_offset_1024[s->samplerate_index];
+    ics->tns_max_bands      = wi->window_type[0] == EIGHT_SHORT_SEQUENCE ?
+                                ff_tns_max_bands_128 [s->samplerate_index]:
+                                ff_tns_max_bands_1024[s->samplerate_index];
+
+    for (w = 0; w < ics->num_windows; w++)
+        ics->group_len[w] = wi->grouping[w];
+
+    /* Calculate input sample maximums and evaluate clipping risk */
+    clip_avoidance_factor = 0.0f;
+    for (w = 0; w < ics->num_windows; w++) {
+        const float *wbuf = overlap + w * 128;
+        const int wlen = 2048 / ics->num_windows;
+        float max = 0;
+        int j;
+        /* mdct input is 2 * output */
+        for (j = 0; j < wlen; j++)
+            max = FFMAX(max, fabsf(wbuf[j]));
+        wi->clipping[w] = max;
+    }
+    for (w = 0; w < ics->num_windows; w++) {
+        if (wi->clipping[w] > CLIP_AVOIDANCE_FACTOR) {
+            ics->window_clipping[w] = 1;
+            clip_avoidance_factor = FFMAX(clip_avoidance_factor, wi->clipping[w]);
+        } else {
+            ics->window_clipping[w] = 0;
+        }
+    }
+    if (clip_avoidance_factor > CLIP_AVOIDANCE_FACTOR) {
+        ics->clip_avoidance_factor = CLIP_AVOIDANCE_FACTOR / clip_avoidance_factor;
+    } else {
+        ics->clip_avoidance_factor = 1.0f;
+    }
+
+    apply_window_and_mdct(s, sce, overlap);
+
+    if (s->options.ltp && s->coder->update_ltp) {
+        s->cur_channel = channel;
+        s->coder->update_ltp(s, sce);
+        apply_window[sce->ics.window_sequence[0]](s->fdsp, sce, &sce->ltp_state[0]);
+        s->mdct1024.mdct_calc(&s->mdct1024, sce->lcoeffs, sce->ret_buf);
+    }
+
+    for (k = 0; k < 1024; k++) {
+        if (!(fabs(sce->coeffs[k]) < 1E16)) { // Ensure headroom for energy calculation
+            av_log(avctx, AV_LOG_ERROR, "Input contains (near) NaN/+-Inf\n");
+            return AVERROR(EINVAL);
+        }
+    }
+    avoid_clipping(s, sce);
+
+    return 0;
+}
+
 static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                             const AVFrame *frame, int *got_packet_ptr)
 {
     AACEncContext *s = avctx->priv_data;
-    float **samples = s->planar_samples, *samples2, *la, *overlap;
+    AACEncAnalysisArgs args;
     ChannelElement *cpe;
     SingleChannelElement *sce;
-    IndividualChannelStream *ics;
     int i, its, ch, w, chans, tag, start_ch, ret, frame_bits;
     int target_bits, rate_bits, too_many_bits, too_few_bits;
     int ms_mode = 0, is_mode = 0, tns_mode = 0, pred_mode = 0;
     int chan_el_counter[4];
     FFPsyWindowInfo windows[AAC_MAX_CHANNELS];
+    int rets[AAC_MAX_CHANNELS];
 
     /* add current frame to queue */
     if (frame) {
@@ -857,100 +973,19 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
     if (!avctx->frame_number)
         return 0;
 
-    start_ch = 0;
-    for (i = 0; i < s->chan_map[0]; i++) {
-        FFPsyWindowInfo* wi = windows + start_ch;
-        tag      = s->chan_map[i+1];
-        chans    = tag == TYPE_CPE ? 2 : 1;
-        cpe      = &s->cpe[i];
-        for (ch = 0; ch < chans; ch++) {
-            int k;
-            float clip_avoidance_factor;
-            sce = &cpe->ch[ch];
-            ics = &sce->ics;
-            s->cur_channel = start_ch + ch;
-            overlap  = &samples[s->cur_channel][0];
-            samples2 = overlap + 1024;
-            la       = samples2 + (448+64);
-            if (!frame)
-                la = NULL;
-            if (tag == TYPE_LFE) {
-                wi[ch].window_type[0] = wi[ch].window_type[1] = ONLY_LONG_SEQUENCE;
-                wi[ch].window_shape   = 0;
-                wi[ch].num_windows    = 1;
-                wi[ch].grouping[0]    = 1;
-                wi[ch].clipping[0]    = 0;
-
-                /* Only the lowest 12 coefficients are used in a LFE channel.
-                 * The expression below results in only the bottom 8 coefficients
-                 * being used for 11.025kHz to 16kHz sample rates.
-                 */
-                ics->num_swb = s->samplerate_index >= 8 ? 1 : 3;
-            } else {
-                wi[ch] = s->psy.model->window(&s->psy, samples2, la, s->cur_channel,
-                                              ics->window_sequence[0]);
-            }
-            ics->window_sequence[1] = ics->window_sequence[0];
-            ics->window_sequence[0] = wi[ch].window_type[0];
-            ics->use_kb_window[1]   = ics->use_kb_window[0];
-            ics->use_kb_window[0]   = wi[ch].window_shape;
-            ics->num_windows        = wi[ch].num_windows;
-            ics->swb_sizes          = s->psy.bands    [ics->num_windows == 8];
-            ics->num_swb            = tag == TYPE_LFE ? ics->num_swb : s->psy.num_bands[ics->num_windows == 8];
-            ics->max_sfb            = FFMIN(ics->max_sfb, ics->num_swb);
-            ics->swb_offset         = wi[ch].window_type[0] == EIGHT_SHORT_SEQUENCE ?
-                                        ff_swb_offset_128 [s->samplerate_index]:
-                                        ff_swb_offset_1024[s->samplerate_index];
-            ics->tns_max_bands      = wi[ch].window_type[0] == EIGHT_SHORT_SEQUENCE ?
-                                        ff_tns_max_bands_128 [s->samplerate_index]:
-                                        ff_tns_max_bands_1024[s->samplerate_index];
-
-            for (w = 0; w < ics->num_windows; w++)
-                ics->group_len[w] = wi[ch].grouping[w];
-
-            /* Calculate input sample maximums and evaluate clipping risk */
-            clip_avoidance_factor = 0.0f;
-            for (w = 0; w < ics->num_windows; w++) {
-                const float *wbuf = overlap + w * 128;
-                const int wlen = 2048 / ics->num_windows;
-                float max = 0;
-                int j;
-                /* mdct input is 2 * output */
-                for (j = 0; j < wlen; j++)
-                    max = FFMAX(max, fabsf(wbuf[j]));
-                wi[ch].clipping[w] = max;
-            }
-            for (w = 0; w < ics->num_windows; w++) {
-                if (wi[ch].clipping[w] > CLIP_AVOIDANCE_FACTOR) {
-                    ics->window_clipping[w] = 1;
-                    clip_avoidance_factor = FFMAX(clip_avoidance_factor, wi[ch].clipping[w]);
-                } else {
-                    ics->window_clipping[w] = 0;
-                }
-            }
-            if (clip_avoidance_factor > CLIP_AVOIDANCE_FACTOR) {
-                ics->clip_avoidance_factor = CLIP_AVOIDANCE_FACTOR / clip_avoidance_factor;
-            } else {
-                ics->clip_avoidance_factor = 1.0f;
-            }
-
-            apply_window_and_mdct(s, sce, overlap);
-
-            if (s->options.ltp && s->coder->update_ltp) {
-                s->coder->update_ltp(s, sce);
-                apply_window[sce->ics.window_sequence[0]](s->fdsp, sce, &sce->ltp_state[0]);
-                s->mdct1024.mdct_calc(&s->mdct1024, sce->lcoeffs, sce->ret_buf);
-            }
-
-            for (k = 0; k < 1024; k++) {
-                if (!(fabs(cpe->ch[ch].coeffs[k]) < 1E16)) { // Ensure headroom for energy calculation
-                    av_log(avctx, AV_LOG_ERROR, "Input contains (near) NaN/+-Inf\n");
-                    return AVERROR(EINVAL);
-                }
-            }
-            avoid_clipping(s, sce);
-        }
-        start_ch += chans;
+    args.frame   = frame;
+    args.windows = windows;
+    if (s->options.coder != AAC_CODER_REALTIME || s->options.ltp) {
+        /* Only the fixed psy model is threaded; the LTP state update works
+         * on cur_channel, so keep it sequential too. */
+        for (ch = 0; ch < s->channels; ch++)
+            if ((ret = analyze_channel(avctx, &args, ch, 0)) < 0)
+                return ret;
+    } else {
+        avctx->execute2(avctx, analyze_channel, &args, rets, s->channels);
+        for (ch = 0; ch < s->channels; ch++)
+            if (rets[ch] < 0)
+                return rets[ch];
     }
     if ((ret = ff_alloc_packet(avctx, avpkt, 8192 * s->channels)) < 0)
         return ret;
@@ -1131,6 +1166,11 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             }
             s->lambda = av_clipf(s->lambda * ratio, FLT_EPSILON, 65536.f);
 
+            /* The realtime coder only steers lambda for the next frame and
+             * re-encodes only if the frame does not fit */
+            if (s->options.coder == AAC_CODER_REALTIME && frame_bits < 6144 * s->channels - 3)
+                break;
+
             /* Keep iterating if we must reduce and lambda is in the sky */
             if (ratio > 0.9f && ratio < 1.1f) {
                 break;
@@ -1336,6 +1376,9 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
                  "The ANMR coder is considered experimental, add -strict -2 to enable!\n");
         s->options.intensity_stereo = 0;
         s->options.pns = 0;
+    } else if (s->options.coder == AAC_CODER_REALTIME) {
+        s->options.intensity_stereo = 0;
+        s->options.pns = 0;
     }
     ERROR_IF(s->options.ltp && avctx->strict_std_compliance > FF_COMPLIANCE_EXPERIMENTAL,
              "The LPT profile requires experimental compliance, add -strict -2 to enable!\n");
@@ -1362,16 +1405,13 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
     if ((ret = ff_psy_init(&s->psy, avctx, 2, sizes, lengths,
                            s->chan_map[0], grouping)) < 0)
         return ret;
+    if (s->options.coder == AAC_CODER_REALTIME)
+        s->psy.model = &ff_aac_psy_model_fixed;
     s->psypp = ff_psy_preprocess_init(avctx);
     ff_lpc_init(&s->lpc, 2*avctx->frame_size, TNS_MAX_ORDER, FF_LPC_TYPE_LEVINSON);
     s->random_state = 0x1f2e3d4c;
 
-    s->abs_pow34   = abs_pow34_v;
-    s->quant_bands = quantize_bands;
-
-#if ARCH_X86
-    ff_aac_dsp_init_x86(s);
-#endif
+    ff_aacenc_dsp_init(&s->aacdsp);
 
 #if HAVE_MIPSDSP
     ff_aac_coder_init_mips(s);
@@ -1389,6 +1429,7 @@ static const AVOption aacenc_options[] = {
         {"anmr",     "ANMR method",               0, AV_OPT_TYPE_CONST, {.i64 = AAC_CODER_ANMR},    INT_MIN, INT_MAX, AACENC_FLAGS, "coder"},
         {"twoloop",  "Two loop searching method", 0, AV_OPT_TYPE_CONST, {.i64 = AAC_CODER_TWOLOOP}, INT_MIN, INT_MAX, AACENC_FLAGS, "coder"},
         {"fast",     "Default fast search",       0, AV_OPT_TYPE_CONST, {.i64 = AAC_CODER_FAST},    INT_MIN, INT_MAX, AACENC_FLAGS, "coder"},
+        {"realtime", "Low-complexity single pass", 0, AV_OPT_TYPE_CONST, {.i64 = AAC_CODER_REALTIME}, INT_MIN, INT_MAX, AACENC_FLAGS, "coder"},
     {"aac_ms", "Force M/S stereo coding", offsetof(AACEncContext, options.mid_side), AV_OPT_TYPE_BOOL, {.i64 = -1}, -1, 1, AACENC_FLAGS},
     {"aac_is", "Intensity stereo coding", offsetof(AACEncContext, options.intensity_stereo), AV_OPT_TYPE_BOOL, {.i64 = 1}, -1, 1, AACENC_FLAGS},
     {"aac_pns", "Perceptual noise substitution", offsetof(AACEncContext, options.pns), AV_OPT_TYPE_BOOL, {.i64 = 1}, -1, 1, AACENC_FLAGS},
@@ -1424,7 +1465,8 @@ const FFCodec ff_aac_encoder = {
     .defaults       = aac_encode_defaults,
     .p.supported_samplerates = ff_mpeg4audio_sample_rates,
     .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
-    .p.capabilities = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY,
+    .p.capabilities = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .p.sample_fmts  = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_FLTP,
                                                      AV_SAMPLE_FMT_NONE },
     .p.priv_class   = &aacenc_class,
@@ -30,6 +30,7 @@
 #include "put_bits.h"
 
 #include "aac.h"
+#include "aacencdsp.h"
 #include "audio_frame_queue.h"
 #include "psymodel.h"
 
@@ -39,6 +40,7 @@ typedef enum AACCoder {
     AAC_CODER_ANMR = 0,
     AAC_CODER_TWOLOOP,
     AAC_CODER_FAST,
+    AAC_CODER_REALTIME,
 
     AAC_CODER_NB,
 }AACCoder;
@@ -142,17 +144,13 @@ typedef struct AACEncContext {
     uint16_t quantize_band_cost_cache_generation;
     AACQuantizeBandCostCacheEntry quantize_band_cost_cache[256][128]; ///< memoization area for quantize_band_cost
 
-    void (*abs_pow34)(float *out, const float *in, const int size);
-    void (*quant_bands)(int *out, const float *in, const float *scaled,
-                        int size, int is_signed, int maxval, const float Q34,
-                        const float rounding);
+    AACEncDSPContext aacdsp;
 
     struct {
         float *samples;
     } buffer;
 } AACEncContext;
 
-void ff_aac_dsp_init_x86(AACEncContext *s);
 void ff_aac_coder_init_mips(AACEncContext *c);
 void ff_quantize_band_cost_cache_init(struct AACEncContext *s);
 
@@ -0,0 +1,38 @@
+/*
+ * AAC encoder DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+
+#include "aacencdsp.h"
+#include "aacenc_utils.h"
+
+av_cold void ff_aacenc_dsp_init(AACEncDSPContext *s)
+{
+    s->abs_pow34   = abs_pow34_v;
+    s->quant_bands = quantize_bands;
+
+#if ARCH_AARCH64
+    ff_aacenc_dsp_init_aarch64(s);
+#elif ARCH_X86
+    ff_aacenc_dsp_init_x86(s);
+#endif
+}
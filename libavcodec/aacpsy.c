@@ -855,6 +855,59 @@ static void psy_3gpp_analyze(FFPsyContext *ctx, int channel,
         psy_3gpp_analyze_channel(ctx, channel + ch, coeffs[ch], &wi[ch]);
 }
 
+static void psy_fixed_analyze_channel(FFPsyContext *ctx, int channel,
+                                      const float *coefs, const FFPsyWindowInfo *wi)
+{
+    AacPsyContext *pctx = (AacPsyContext*) ctx->model_priv_data;
+    const int      num_bands  = ctx->num_bands[wi->num_windows == 8];
+    const uint8_t *band_sizes = ctx->bands[wi->num_windows == 8];
+    AacPsyCoeffs  *coeffs     = pctx->psy_coef[wi->num_windows == 8];
+    const int bandwidth       = ctx->cutoff ? ctx->cutoff : AAC_CUTOFF(ctx->avctx);
+    const int cutoff          = bandwidth * 2048 / wi->num_windows / ctx->avctx->sample_rate;
+    FFPsyBand *bands;
+    int i, w, g, start = 0;
+
+    for (w = 0; w < wi->num_windows*16; w += 16) {
+        int wstart = 0;
+        for (g = 0; g < num_bands; g++) {
+            FFPsyBand *band = &ctx->ch[channel].psy_bands[w+g];
+            float energy = 0.0f;
+
+            if (wstart < cutoff)
+                for (i = 0; i < band_sizes[g]; i++)
+                    energy += coefs[start+i] * coefs[start+i];
+
+            band->energy    = energy;
+            band->threshold = energy * 0.001258925f;
+            band->spread    = 1.0f;
+            band->bits      = 0;
+
+            start  += band_sizes[g];
+            wstart += band_sizes[g];
+        }
+
+        /* 5.4.2.3 "Spreading" and 5.4.2.4 "Threshold in quiet" only */
+        bands = &ctx->ch[channel].psy_bands[w];
+        for (g = 1; g < num_bands; g++)
+            bands[g].threshold = FFMAX(bands[g].threshold, bands[g-1].threshold * coeffs[g].spread_hi[0]);
+        for (g = num_bands - 2; g >= 0; g--)
+            bands[g].threshold = FFMAX(bands[g].threshold, bands[g+1].threshold * coeffs[g].spread_low[0]);
+        for (g = 0; g < num_bands; g++)
+            bands[g].threshold = FFMAX(bands[g].threshold, coeffs[g].ath);
+    }
+    ctx->ch[channel].entropy = 0.0f;
+}
+
+static void psy_fixed_analyze(FFPsyContext *ctx, int channel,
+                              const float **coeffs, const FFPsyWindowInfo *wi)
+{
+    int ch;
+    FFPsyChannelGroup *group = ff_psy_find_group(ctx, channel);
+
+    for (ch = 0; ch < group->num_ch; ch++)
+        psy_fixed_analyze_channel(ctx, channel + ch, coeffs[ch], &wi[ch]);
+}
+
 static av_cold void psy_3gpp_end(FFPsyContext *apc)
 {
     AacPsyContext *pctx = (AacPsyContext*) apc->model_priv_data;
@@ -1027,3 +1080,12 @@ const FFPsyModel ff_aac_psy_model =
     .analyze = psy_3gpp_analyze,
     .end     = psy_3gpp_end,
 };
+
+const FFPsyModel ff_aac_psy_model_fixed =
+{
+    .name    = "Fixed SNR model",
+    .init    = psy_3gpp_init,
+    .window  = psy_lame_window,
+    .analyze = psy_fixed_analyze,
+    .end     = psy_3gpp_end,
+};
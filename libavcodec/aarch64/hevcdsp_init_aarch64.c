@@ -21,6 +21,7 @@
 #include <stdint.h>
 
 #include "libavutil/attributes.h"
+#include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/aarch64/cpu.h"
 #include "libavcodec/hevcdsp.h"
@@ -62,8 +63,91 @@ void ff_hevc_sao_edge_filter_16x16_8_neon(uint8_t *dst, const uint8_t *src, ptrd
 void ff_hevc_sao_edge_filter_8x8_8_neon(uint8_t *dst, const uint8_t *src, ptrdiff_t stride_dst,
                                         const int16_t *sao_offset_val, int eo, int width, int height);
 
+#define HEVC_LOOP_FILTER_PROTOS(depth)                                                    \
+void ff_hevc_h_loop_filter_luma_ ## depth ## _neon(uint8_t *pix, ptrdiff_t stride,         \
+                                                   int beta, const int32_t *tc,           \
+                                                   const uint8_t *no_p, const uint8_t *no_q); \
+void ff_hevc_v_loop_filter_luma_ ## depth ## _neon(uint8_t *pix, ptrdiff_t stride,         \
+                                                   int beta, const int32_t *tc,           \
+                                                   const uint8_t *no_p, const uint8_t *no_q); \
+void ff_hevc_h_loop_filter_chroma_ ## depth ## _neon(uint8_t *pix, ptrdiff_t stride,       \
+                                                     const int32_t *tc, const uint8_t *no_p, \
+                                                     const uint8_t *no_q);                \
+void ff_hevc_v_loop_filter_chroma_ ## depth ## _neon(uint8_t *pix, ptrdiff_t stride,       \
+                                                     const int32_t *tc, const uint8_t *no_p, \
+                                                     const uint8_t *no_q)
+
+HEVC_LOOP_FILTER_PROTOS(8);
+HEVC_LOOP_FILTER_PROTOS(10);
+
+/* The motion compensation functions handle any block width, so a single
+ * function is installed for all widths of a given filter type. */
+#define MC_PUT(name)                                                                      \
+void ff_hevc_put_hevc_ ## name ## _neon(int16_t *dst, const uint8_t *src,                \
+                                        ptrdiff_t srcstride, int height,                  \
+                                        intptr_t mx, intptr_t my, int width)
+#define MC_UNI(name)                                                                      \
+void ff_hevc_put_hevc_ ## name ## _neon(uint8_t *dst, ptrdiff_t dststride,               \
+                                        const uint8_t *src, ptrdiff_t srcstride,          \
+                                        int height, intptr_t mx, intptr_t my, int width)
+#define MC_BI(name)                                                                       \
+void ff_hevc_put_hevc_ ## name ## _neon(uint8_t *dst, ptrdiff_t dststride,               \
+                                        const uint8_t *src, ptrdiff_t srcstride,          \
+                                        const int16_t *src2, int height,                  \
+                                        intptr_t mx, intptr_t my, int width)
+#define MC_UNI_W(name)                                                                    \
+void ff_hevc_put_hevc_ ## name ## _neon(uint8_t *dst, ptrdiff_t dststride,               \
+                                        const uint8_t *src, ptrdiff_t srcstride,          \
+                                        int height, int denom, int wx, int ox,            \
+                                        intptr_t mx, intptr_t my, int width)
+#define MC_BI_W(name)                                                                     \
+void ff_hevc_put_hevc_ ## name ## _neon(uint8_t *dst, ptrdiff_t dststride,               \
+                                        const uint8_t *src, ptrdiff_t srcstride,          \
+                                        const int16_t *src2, int height, int denom,       \
+                                        int wx0, int wx1, int ox0, int ox1,               \
+                                        intptr_t mx, intptr_t my, int width)
+
+#define MC_PROTOS(type, depth)                                                            \
+    type(pel_pixels_ ## depth);                                                           \
+    type(qpel_h_ ## depth);                                                               \
+    type(qpel_v_ ## depth);                                                               \
+    type(qpel_hv_ ## depth);                                                              \
+    type(epel_h_ ## depth);                                                               \
+    type(epel_v_ ## depth);                                                               \
+    type(epel_hv_ ## depth)
+
+#define MC_PROTOS_VARIANT(type, variant, depth)                                           \
+    type(pel_ ## variant ## _pixels_ ## depth);                                           \
+    type(qpel_ ## variant ## _h_ ## depth);                                               \
+    type(qpel_ ## variant ## _v_ ## depth);                                               \
+    type(qpel_ ## variant ## _hv_ ## depth);                                              \
+    type(epel_ ## variant ## _h_ ## depth);                                               \
+    type(epel_ ## variant ## _v_ ## depth);                                               \
+    type(epel_ ## variant ## _hv_ ## depth)
+
+MC_PROTOS(MC_PUT, 8);
+MC_PROTOS(MC_PUT, 10);
+MC_PROTOS_VARIANT(MC_UNI, uni, 8);
+MC_PROTOS_VARIANT(MC_UNI, uni, 10);
+MC_PROTOS_VARIANT(MC_BI, bi, 8);
+MC_PROTOS_VARIANT(MC_BI, bi, 10);
+MC_PROTOS_VARIANT(MC_UNI_W, uni_w, 8);
+MC_PROTOS_VARIANT(MC_UNI_W, uni_w, 10);
+MC_PROTOS_VARIANT(MC_BI_W, bi_w, 8);
+MC_PROTOS_VARIANT(MC_BI_W, bi_w, 10);
+
+#define SET_MC(table, pixels, filter, depth)                                            \
+    for (i = 0; i < FF_ARRAY_ELEMS(c->table); i++) {                                      \
+        c->table[i][0][0] = ff_hevc_put_hevc_ ## pixels ## _ ## depth ## _neon;           \
+        c->table[i][0][1] = ff_hevc_put_hevc_ ## filter ## _h_ ## depth ## _neon;         \
+        c->table[i][1][0] = ff_hevc_put_hevc_ ## filter ## _v_ ## depth ## _neon;         \
+        c->table[i][1][1] = ff_hevc_put_hevc_ ## filter ## _hv_ ## depth ## _neon;        \
+    }
+
 av_cold void ff_hevc_dsp_init_aarch64(HEVCDSPContext *c, const int bit_depth)
 {
+    int i;
+
     if (!have_neon(av_get_cpu_flags())) return;
 
     if (bit_depth == 8) {
@@ -87,6 +171,21 @@ av_cold void ff_hevc_dsp_init_aarch64(HEVCDSPContext *c, const int bit_depth)
         c->sao_edge_filter[2]          =
         c->sao_edge_filter[3]          =
         c->sao_edge_filter[4]          = ff_hevc_sao_edge_filter_16x16_8_neon;
+        c->hevc_h_loop_filter_luma     = ff_hevc_h_loop_filter_luma_8_neon;
+        c->hevc_v_loop_filter_luma     = ff_hevc_v_loop_filter_luma_8_neon;
+        c->hevc_h_loop_filter_chroma   = ff_hevc_h_loop_filter_chroma_8_neon;
+        c->hevc_v_loop_filter_chroma   = ff_hevc_v_loop_filter_chroma_8_neon;
+
+        SET_MC(put_hevc_qpel,      pel_pixels,       qpel,       8);
+        SET_MC(put_hevc_epel,      pel_pixels,       epel,       8);
+        SET_MC(put_hevc_qpel_uni,  pel_uni_pixels,   qpel_uni,   8);
+        SET_MC(put_hevc_epel_uni,  pel_uni_pixels,   epel_uni,   8);
+        SET_MC(put_hevc_qpel_bi,   pel_bi_pixels,    qpel_bi,    8);
+        SET_MC(put_hevc_epel_bi,   pel_bi_pixels,    epel_bi,    8);
+        SET_MC(put_hevc_qpel_uni_w, pel_uni_w_pixels, qpel_uni_w, 8);
+        SET_MC(put_hevc_epel_uni_w, pel_uni_w_pixels, epel_uni_w, 8);
+        SET_MC(put_hevc_qpel_bi_w, pel_bi_w_pixels,  qpel_bi_w,  8);
+        SET_MC(put_hevc_epel_bi_w, pel_bi_w_pixels,  epel_bi_w,  8);
     }
     if (bit_depth == 10) {
         c->add_residual[0]             = ff_hevc_add_residual_4x4_10_neon;
@@ -99,5 +198,20 @@ av_cold void ff_hevc_dsp_init_aarch64(HEVCDSPContext *c, const int bit_depth)
         c->idct_dc[1]                  = ff_hevc_idct_8x8_dc_10_neon;
         c->idct_dc[2]                  = ff_hevc_idct_16x16_dc_10_neon;
         c->idct_dc[3]                  = ff_hevc_idct_32x32_dc_10_neon;
+        c->hevc_h_loop_filter_luma     = ff_hevc_h_loop_filter_luma_10_neon;
+        c->hevc_v_loop_filter_luma     = ff_hevc_v_loop_filter_luma_10_neon;
+        c->hevc_h_loop_filter_chroma   = ff_hevc_h_loop_filter_chroma_10_neon;
+        c->hevc_v_loop_filter_chroma   = ff_hevc_v_loop_filter_chroma_10_neon;
+
+        SET_MC(put_hevc_qpel,      pel_pixels,       qpel,       10);
+        SET_MC(put_hevc_epel,      pel_pixels,       epel,       10);
+        SET_MC(put_hevc_qpel_uni,  pel_uni_pixels,   qpel_uni,   10);
+        SET_MC(put_hevc_epel_uni,  pel_uni_pixels,   epel_uni,   10);
+        SET_MC(put_hevc_qpel_bi,   pel_bi_pixels,    qpel_bi,    10);
+        SET_MC(put_hevc_epel_bi,   pel_bi_pixels,    epel_bi,    10);
+        SET_MC(put_hevc_qpel_uni_w, pel_uni_w_pixels, qpel_uni_w, 10);
+        SET_MC(put_hevc_epel_uni_w, pel_uni_w_pixels, epel_uni_w, 10);
+        SET_MC(put_hevc_qpel_bi_w, pel_bi_w_pixels,  qpel_bi_w,  10);
+        SET_MC(put_hevc_epel_bi_w, pel_bi_w_pixels,  epel_bi_w,  10);
     }
 }
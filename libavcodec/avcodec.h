@@ -309,6 +309,14 @@ typedef struct RcOverride{
  * Place global headers at every keyframe instead of in extradata.
  */
 #define AV_CODEC_FLAG2_LOCAL_HEADER   (1 <<  3)
+/**
+ * Allocate video frames from pools shared by all the codec contexts of the
+ * process using this flag, which outlive the contexts themselves.
+ * Only has an effect with the default get_buffer2() implementation.
+ *
+ * @see avcodec_shared_pool_stats()
+ */
+#define AV_CODEC_FLAG2_SHARED_POOL    (1 <<  4)
 
 /**
  * timecode is in drop frame format. DEPRECATED!!!!
@@ -2476,6 +2484,48 @@ void avsubtitle_free(AVSubtitle *sub);
  */
 int avcodec_default_get_buffer2(AVCodecContext *s, AVFrame *frame, int flags);
 
+/**
+ * Statistics of the process-level frame pool registry used by codec contexts
+ * with AV_CODEC_FLAG2_SHARED_POOL set.
+ *
+ * New fields may be added to the end with a minor version bump.
+ */
+typedef struct AVCodecSharedPoolStats {
+    /**
+     * Number of frame pool lookups served by an already registered pool.
+     */
+    uint64_t hits;
+    /**
+     * Number of frame pool lookups which had to create a new pool.
+     */
+    uint64_t misses;
+    /**
+     * Number of pools currently in the registry.
+     */
+    int nb_pools;
+    /**
+     * Bytes currently allocated for frame buffers of the shared pools.
+     */
+    uint64_t bytes;
+    /**
+     * Maximum value reached by bytes.
+     */
+    uint64_t peak_bytes;
+} AVCodecSharedPoolStats;
+
+/**
+ * Get the statistics of the shared frame pool registry.
+ *
+ * @see AV_CODEC_FLAG2_SHARED_POOL
+ */
+void avcodec_shared_pool_stats(AVCodecSharedPoolStats *stats);
+
+/**
+ * Release the shared frame pools which are not used by any codec context.
+ * Buffers still referenced by frames are freed once the frames are.
+ */
+void avcodec_shared_pool_trim(void);
+
 /**
  * The default callback for AVCodecContext.get_encode_buffer(). It is made public so
  * it can be called by custom get_encode_buffer() implementations for encoders without
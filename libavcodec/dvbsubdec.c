@@ -375,6 +375,18 @@ static av_cold int dvbsub_close_decoder(AVCodecContext *avctx)
     return 0;
 }
 
+static av_always_inline uint8_t *fill_run(uint8_t *destbuf, int bits, int run_length,
+                                          int *pixels_read, int dbuf_len)
+{
+    run_length = FFMIN(run_length, dbuf_len - *pixels_read);
+    if (run_length <= 0)
+        return destbuf;
+
+    memset(destbuf, bits, run_length);
+    *pixels_read += run_length;
+    return destbuf + run_length;
+}
+
 static int dvbsub_read_2bit_string(AVCodecContext *avctx,
                                    uint8_t *destbuf, int dbuf_len,
                                    const uint8_t **srcbuf, int buf_size,
@@ -412,10 +424,7 @@ static int dvbsub_read_2bit_string(AVCodecContext *avctx,
                 else {
                     if (map_table)
                         bits = map_table[bits];
-                    while (run_length-- > 0 && pixels_read < dbuf_len) {
-                        *destbuf++ = bits;
-                        pixels_read++;
-                    }
+                    destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                 }
             } else {
                 bits = get_bits1(&gb);
@@ -430,10 +439,7 @@ static int dvbsub_read_2bit_string(AVCodecContext *avctx,
                         else {
                             if (map_table)
                                 bits = map_table[bits];
-                            while (run_length-- > 0 && pixels_read < dbuf_len) {
-                                *destbuf++ = bits;
-                                pixels_read++;
-                            }
+                            destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                         }
                     } else if (bits == 3) {
                         run_length = get_bits(&gb, 8) + 29;
@@ -444,10 +450,7 @@ static int dvbsub_read_2bit_string(AVCodecContext *avctx,
                         else {
                             if (map_table)
                                 bits = map_table[bits];
-                            while (run_length-- > 0 && pixels_read < dbuf_len) {
-                                *destbuf++ = bits;
-                                pixels_read++;
-                            }
+                            destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                         }
                     } else if (bits == 1) {
                         if (map_table)
@@ -455,10 +458,7 @@ static int dvbsub_read_2bit_string(AVCodecContext *avctx,
                         else
                             bits = 0;
                         run_length = 2;
-                        while (run_length-- > 0 && pixels_read < dbuf_len) {
-                            *destbuf++ = bits;
-                            pixels_read++;
-                        }
+                        destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                     } else {
                         (*srcbuf) += (get_bits_count(&gb) + 7) >> 3;
                         return pixels_read;
@@ -525,10 +525,7 @@ static int dvbsub_read_4bit_string(AVCodecContext *avctx, uint8_t *destbuf, int
                 else
                     bits = 0;
 
-                while (run_length-- > 0 && pixels_read < dbuf_len) {
-                    *destbuf++ = bits;
-                    pixels_read++;
-                }
+                destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
             } else {
                 bits = get_bits1(&gb);
                 if (bits == 0) {
@@ -540,10 +537,7 @@ static int dvbsub_read_4bit_string(AVCodecContext *avctx, uint8_t *destbuf, int
                     else {
                         if (map_table)
                             bits = map_table[bits];
-                        while (run_length-- > 0 && pixels_read < dbuf_len) {
-                            *destbuf++ = bits;
-                            pixels_read++;
-                        }
+                        destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                     }
                 } else {
                     bits = get_bits(&gb, 2);
@@ -556,10 +550,7 @@ static int dvbsub_read_4bit_string(AVCodecContext *avctx, uint8_t *destbuf, int
                         else {
                             if (map_table)
                                 bits = map_table[bits];
-                            while (run_length-- > 0 && pixels_read < dbuf_len) {
-                                *destbuf++ = bits;
-                                pixels_read++;
-                            }
+                            destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                         }
                     } else if (bits == 3) {
                         run_length = get_bits(&gb, 8) + 25;
@@ -570,10 +561,7 @@ static int dvbsub_read_4bit_string(AVCodecContext *avctx, uint8_t *destbuf, int
                         else {
                             if (map_table)
                                 bits = map_table[bits];
-                            while (run_length-- > 0 && pixels_read < dbuf_len) {
-                                *destbuf++ = bits;
-                                pixels_read++;
-                            }
+                            destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                         }
                     } else if (bits == 1) {
                         if (map_table)
@@ -581,10 +569,7 @@ static int dvbsub_read_4bit_string(AVCodecContext *avctx, uint8_t *destbuf, int
                         else
                             bits = 0;
                         run_length = 2;
-                        while (run_length-- > 0 && pixels_read < dbuf_len) {
-                            *destbuf++ = bits;
-                            pixels_read++;
-                        }
+                        destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
                     } else {
                         if (map_table)
                             bits = map_table[0];
@@ -646,10 +631,7 @@ static int dvbsub_read_8bit_string(AVCodecContext *avctx,
             else {
                 if (map_table)
                     bits = map_table[bits];
-                while (run_length-- > 0 && pixels_read < dbuf_len) {
-                    *destbuf++ = bits;
-                    pixels_read++;
-                }
+                destbuf = fill_run(destbuf, bits, run_length, &pixels_read, dbuf_len);
             }
         }
     }
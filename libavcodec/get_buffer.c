@@ -19,6 +19,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
@@ -28,6 +29,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/thread.h"
 #include "libavutil/version.h"
 
 #include "avcodec.h"
@@ -48,11 +50,27 @@ typedef struct FramePool {
     int width, height;
     int stride_align[AV_NUM_DATA_POINTERS];
     int linesize[4];
+    size_t sizes[4];
     int planes;
     int channels;
     int samples;
 } FramePool;
 
+/**
+ * Process-level registry of the video frame pools used by the codec contexts
+ * with AV_CODEC_FLAG2_SHARED_POOL. The registry holds a reference to each
+ * pool, so that a pool survives the contexts using it and is found again by
+ * the next context decoding the same format. Pools only referenced by the
+ * registry are evicted when it is full.
+ */
+#define MAX_SHARED_POOLS 16
+
+static AVMutex shared_pools_mutex = AV_MUTEX_INITIALIZER;
+static AVBufferRef *shared_pools[MAX_SHARED_POOLS];
+static int nb_shared_pools;
+static uint64_t shared_pool_hits, shared_pool_misses;
+static uint64_t shared_pool_bytes, shared_pool_peak_bytes;
+
 static void frame_pool_free(void *opaque, uint8_t *data)
 {
     FramePool *pool = (FramePool*)data;
@@ -82,6 +100,143 @@ static AVBufferRef *frame_pool_alloc(void)
     return buf;
 }
 
+static void shared_pool_buffer_free(void *opaque, uint8_t *data)
+{
+    ff_mutex_lock(&shared_pools_mutex);
+    shared_pool_bytes -= (uintptr_t)opaque;
+    ff_mutex_unlock(&shared_pools_mutex);
+
+    av_free(data);
+}
+
+static AVBufferRef *shared_pool_buffer_alloc(void *opaque, size_t size)
+{
+    uint8_t *data = CONFIG_MEMORY_POISONING ? av_malloc(size) : av_mallocz(size);
+    AVBufferRef *buf;
+
+    if (!data)
+        return NULL;
+
+    buf = av_buffer_create(data, size, shared_pool_buffer_free,
+                           (void*)(uintptr_t)size, 0);
+    if (!buf) {
+        av_free(data);
+        return NULL;
+    }
+
+    ff_mutex_lock(&shared_pools_mutex);
+    shared_pool_bytes     += size;
+    shared_pool_peak_bytes = FFMAX(shared_pool_peak_bytes, shared_pool_bytes);
+    ff_mutex_unlock(&shared_pools_mutex);
+
+    return buf;
+}
+
+static int frame_pool_matches(const FramePool *a, const FramePool *b)
+{
+    return a->format == b->format &&
+           a->width  == b->width  && a->height == b->height &&
+           !memcmp(a->stride_align, b->stride_align, sizeof(a->stride_align)) &&
+           !memcmp(a->linesize,     b->linesize,     sizeof(a->linesize))     &&
+           !memcmp(a->sizes,        b->sizes,        sizeof(a->sizes));
+}
+
+/**
+ * Replace the pool in *pool_buf, whose parameters are set but which has no
+ * buffer pools yet, by a matching pool from the registry, or create its
+ * buffer pools and register it.
+ */
+static int shared_frame_pool_get(AVBufferRef **pool_buf)
+{
+    FramePool *pool = (FramePool*)(*pool_buf)->data;
+    AVBufferRef *evicted = NULL, *ref;
+    int i, ret = 0;
+
+    ff_mutex_lock(&shared_pools_mutex);
+
+    for (i = 0; i < nb_shared_pools; i++) {
+        if (!frame_pool_matches((FramePool*)shared_pools[i]->data, pool))
+            continue;
+
+        ref = av_buffer_ref(shared_pools[i]);
+        if (!ref) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        shared_pool_hits++;
+        av_buffer_unref(pool_buf);
+        *pool_buf = ref;
+        goto end;
+    }
+
+    shared_pool_misses++;
+    for (i = 0; i < 4; i++) {
+        if (!pool->sizes[i])
+            continue;
+        pool->pools[i] = av_buffer_pool_init2(pool->sizes[i], NULL,
+                                              shared_pool_buffer_alloc, NULL);
+        if (!pool->pools[i]) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+    }
+
+    if (nb_shared_pools == MAX_SHARED_POOLS) {
+        /* evict the least recently registered pool nobody else uses */
+        for (i = 0; i < nb_shared_pools; i++)
+            if (av_buffer_get_ref_count(shared_pools[i]) == 1)
+                break;
+        if (i < nb_shared_pools) {
+            evicted = shared_pools[i];
+            memmove(shared_pools + i, shared_pools + i + 1,
+                    (nb_shared_pools - i - 1) * sizeof(*shared_pools));
+            nb_shared_pools--;
+        }
+    }
+    /* a pool that does not fit in the registry is used privately */
+    if (nb_shared_pools < MAX_SHARED_POOLS) {
+        ref = av_buffer_ref(*pool_buf);
+        if (ref)
+            shared_pools[nb_shared_pools++] = ref;
+    }
+
+end:
+    ff_mutex_unlock(&shared_pools_mutex);
+    /* freeing a pool frees buffers, which takes the lock */
+    av_buffer_unref(&evicted);
+    return ret;
+}
+
+void avcodec_shared_pool_stats(AVCodecSharedPoolStats *stats)
+{
+    ff_mutex_lock(&shared_pools_mutex);
+    stats->hits       = shared_pool_hits;
+    stats->misses     = shared_pool_misses;
+    stats->nb_pools   = nb_shared_pools;
+    stats->bytes      = shared_pool_bytes;
+    stats->peak_bytes = shared_pool_peak_bytes;
+    ff_mutex_unlock(&shared_pools_mutex);
+}
+
+void avcodec_shared_pool_trim(void)
+{
+    AVBufferRef *unused[MAX_SHARED_POOLS];
+    int i, nb_unused = 0, nb_used = 0;
+
+    ff_mutex_lock(&shared_pools_mutex);
+    for (i = 0; i < nb_shared_pools; i++) {
+        if (av_buffer_get_ref_count(shared_pools[i]) == 1)
+            unused[nb_unused++] = shared_pools[i];
+        else
+            shared_pools[nb_used++] = shared_pools[i];
+    }
+    nb_shared_pools = nb_used;
+    ff_mutex_unlock(&shared_pools_mutex);
+
+    for (i = 0; i < nb_unused; i++)
+        av_buffer_unref(&unused[i]);
+}
+
 static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
 {
     FramePool *pool = avctx->internal->pool ?
@@ -161,20 +316,33 @@ FF_ENABLE_DEPRECATION_WARNINGS
                     ret = AVERROR(EINVAL);
                     goto fail;
                 }
-                pool->pools[i] = av_buffer_pool_init(size[i] + 16 + STRIDE_ALIGN - 1,
-                                                     CONFIG_MEMORY_POISONING ?
-                                                        NULL :
-                                                        av_buffer_allocz);
-                if (!pool->pools[i]) {
-                    ret = AVERROR(ENOMEM);
-                    goto fail;
-                }
+                pool->sizes[i] = size[i] + 16 + STRIDE_ALIGN - 1;
             }
         }
         pool->format = frame->format;
         pool->width  = frame->width;
         pool->height = frame->height;
 
+        if (avctx->flags2 & AV_CODEC_FLAG2_SHARED_POOL) {
+            ret = shared_frame_pool_get(&pool_buf);
+            if (ret < 0)
+                goto fail;
+            break;
+        }
+
+        for (i = 0; i < 4; i++) {
+            if (!pool->sizes[i])
+                continue;
+            pool->pools[i] = av_buffer_pool_init(pool->sizes[i],
+                                                 CONFIG_MEMORY_POISONING ?
+                                                    NULL :
+                                                    av_buffer_allocz);
+            if (!pool->pools[i]) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        }
+
         break;
         }
     case AVMEDIA_TYPE_AUDIO: {
@@ -62,6 +62,17 @@ static void count_or_copy(uint8_t **out, uint64_t *out_size,
     *out_size += start_code_size + in_size;
 }
 
+/* Replace 4-byte length prefixes by 4-byte start codes; the NAL sizes have
+ * already been validated. */
+static void rewrite_in_place(uint8_t *buf, const uint8_t *buf_end)
+{
+    while (buf < buf_end) {
+        uint32_t nal_size = AV_RB32(buf);
+        AV_WB32(buf, 1);
+        buf += 4 + nal_size;
+    }
+}
+
 static int h264_extradata_to_annexb(AVBSFContext *ctx, const int padding)
 {
     H264BSFContext *s = ctx->priv_data;
@@ -170,7 +181,7 @@ static int h264_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *opkt)
 {
     H264BSFContext *s = ctx->priv_data;
     AVPacket *in;
-    uint8_t unit_type, new_idr, sps_seen, pps_seen;
+    uint8_t unit_type, new_idr, sps_seen, pps_seen, in_place;
     const uint8_t *buf;
     const uint8_t *buf_end;
     uint8_t *out;
@@ -189,6 +200,10 @@ static int h264_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *opkt)
     }
 
     buf_end  = in->data + in->size;
+    /* When nothing needs to be inserted and every NAL unit gets a 4-byte
+     * start code, the output has the layout of the input and the packet
+     * can be rewritten without a copy. */
+    in_place = s->length_size == 4 && in->buf && av_buffer_is_writable(in->buf);
 
 #define LOG_ONCE(...) \
     if (j) \
@@ -232,6 +247,7 @@ static int h264_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *opkt)
                     } else {
                         count_or_copy(&out, &out_size, s->sps, s->sps_size, -1, j);
                         sps_seen = 1;
+                        in_place = 0;
                     }
                 }
             }
@@ -244,9 +260,11 @@ static int h264_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *opkt)
 
             /* prepend only to the first type 5 NAL unit of an IDR picture, if no sps/pps are already present */
             if (new_idr && unit_type == H264_NAL_IDR_SLICE && !sps_seen && !pps_seen) {
-                if (ctx->par_out->extradata)
+                if (ctx->par_out->extradata) {
                     count_or_copy(&out, &out_size, ctx->par_out->extradata,
                                   ctx->par_out->extradata_size, -1, j);
+                    in_place = 0;
+                }
                 new_idr = 0;
             /* if only SPS has been seen, also insert PPS */
             } else if (new_idr && unit_type == H264_NAL_IDR_SLICE && sps_seen && !pps_seen) {
@@ -254,6 +272,7 @@ static int h264_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *opkt)
                     LOG_ONCE(ctx, AV_LOG_WARNING, "PPS not present in the stream, nor in AVCC, stream may be unreadable\n");
                 } else {
                     count_or_copy(&out, &out_size, s->pps, s->pps_size, -1, j);
+                    in_place = 0;
                 }
             }
 
@@ -269,6 +288,16 @@ static int h264_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *opkt)
         } while (buf < buf_end);
 
         if (!j) {
+            /* empty NAL units and 3-byte start codes change the size */
+            if (in_place && out_size == in->size) {
+                rewrite_in_place(in->data, buf_end);
+                s->new_idr      = new_idr;
+                s->idr_sps_seen = sps_seen;
+                s->idr_pps_seen = pps_seen;
+                av_packet_move_ref(opkt, in);
+                av_packet_free(&in);
+                return 0;
+            }
             if (out_size > INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE) {
                 ret = AVERROR_INVALIDDATA;
                 goto fail;
@@ -116,6 +116,41 @@ static int hevc_mp4toannexb_init(AVBSFContext *ctx)
     return 0;
 }
 
+/**
+ * Turn a packet with 4-byte length prefixes into Annex B in place, which is
+ * possible as long as no parameter sets have to be inserted.
+ *
+ * @return 1 if the packet was rewritten, 0 if it has to go through the
+ *         copying path
+ */
+static int hevc_rewrite_in_place(AVBSFContext *ctx, AVPacket *pkt)
+{
+    uint8_t *buf = pkt->data, *buf_end = pkt->data + pkt->size;
+
+    while (buf < buf_end) {
+        uint32_t nalu_size;
+        int nalu_type;
+
+        if (buf_end - buf < 4)
+            return 0;
+        nalu_size = AV_RB32(buf);
+        if (nalu_size < 2 || nalu_size > buf_end - buf - 4)
+            return 0;
+
+        nalu_type = (buf[4] >> 1) & 0x3f;
+        if (nalu_type >= 16 && nalu_type <= 23 && ctx->par_out->extradata_size)
+            return 0;
+        buf += 4 + nalu_size;
+    }
+
+    for (buf = pkt->data; buf < buf_end;) {
+        uint32_t nalu_size = AV_RB32(buf);
+        AV_WB32(buf, 1);
+        buf += 4 + nalu_size;
+    }
+    return 1;
+}
+
 static int hevc_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *out)
 {
     HEVCBSFContext *s = ctx->priv_data;
@@ -135,6 +170,13 @@ static int hevc_mp4toannexb_filter(AVBSFContext *ctx, AVPacket *out)
         return 0;
     }
 
+    if (s->length_size == 4 && in->buf && av_buffer_is_writable(in->buf) &&
+        hevc_rewrite_in_place(ctx, in)) {
+        av_packet_move_ref(out, in);
+        av_packet_free(&in);
+        return 0;
+    }
+
     bytestream2_init(&gb, in->data, in->size);
 
     while (bytestream2_get_bytes_left(&gb)) {
@@ -141,6 +141,15 @@ typedef struct FFPsyModel {
     void (*end)    (FFPsyContext *apc);
 } FFPsyModel;
 
+/**
+ * Low-complexity AAC model: band thresholds are derived from the band energy
+ * with a fixed SNR, spread to the neighbouring bands and floored at the
+ * threshold in quiet, without pre-echo control or bit allocation. It shares
+ * its private context with the default AAC model, so it may be swapped in
+ * after ff_psy_init().
+ */
+extern const FFPsyModel ff_aac_psy_model_fixed;
+
 /**
  * Initialize psychoacoustic model.
  *
@@ -22,57 +22,92 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 32
 
-float_abs_mask: times 4 dd 0x7fffffff
+float_abs_mask: times 8 dd 0x7fffffff
 
 SECTION .text
 
 ;*******************************************************************
 ;void ff_abs_pow34(float *out, const float *in, const int size);
 ;*******************************************************************
-INIT_XMM sse
+%macro ABS_POW34 0
 cglobal abs_pow34, 3, 3, 3, out, in, size
     mova   m2, [float_abs_mask]
     shl    sizeq, 2
     add    inq, sizeq
     add    outq, sizeq
     neg    sizeq
+%if mmsize == 32
+    ; size is a multiple of 4, do the odd xmm first
+    test   sizeq, 16
+    jz    .loop
+    andps  xm0, xm2, [inq+sizeq]
+    sqrtps xm1, xm0
+    mulps  xm0, xm1
+    sqrtps xm0, xm0
+    movu   [outq+sizeq], xm0
+    add    sizeq, 16
+    jz    .end
+%endif
 .loop:
     andps  m0, m2, [inq+sizeq]
     sqrtps m1, m0
     mulps  m0, m1
     sqrtps m0, m0
-    mova   [outq+sizeq], m0
+    movu   [outq+sizeq], m0
     add    sizeq, mmsize
     jl    .loop
+.end:
     RET
+%endmacro
+
+INIT_XMM sse
+ABS_POW34
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+ABS_POW34
+%endif
 
 ;*******************************************************************
 ;void ff_aac_quantize_bands(int *out, const float *in, const float *scaled,
 ;                           int size, int is_signed, int maxval, const float Q34,
 ;                           const float rounding)
 ;*******************************************************************
-INIT_XMM sse2
+%macro QUANTIZE_BANDS 0
 cglobal aac_quantize_bands, 5, 5, 6, out, in, scaled, size, is_signed, maxval, Q34, rounding
 %if UNIX64 == 0
-    movss     m0, Q34m
-    movss     m1, roundingm
-    cvtsi2ss  m3, dword maxvalm
+    movss     xm0, Q34m
+    movss     xm1, roundingm
+    cvtsi2ss  xm3, dword maxvalm
 %else
-    cvtsi2ss  m3, maxvald
+    cvtsi2ss  xm3, maxvald
 %endif
-    shufps    m0, m0, 0
-    shufps    m1, m1, 0
-    shufps    m3, m3, 0
+    VBROADCASTSS m0, xm0
+    VBROADCASTSS m1, xm1
+    VBROADCASTSS m3, xm3
     shl       is_signedd, 31
-    movd      m4, is_signedd
-    shufps    m4, m4, 0
+    movd      xm4, is_signedd
+    VBROADCASTSS m4, xm4
     shl       sized,   2
     add       inq, sizeq
     add       outq, sizeq
     add       scaledq, sizeq
     neg       sizeq
+%if mmsize == 32
+    ; size is a multiple of 4, do the odd xmm first
+    test      sizeq, 16
+    jz       .loop
+    mulps     xm2, xm0, [scaledq+sizeq]
+    addps     xm2, xm1
+    minps     xm2, xm3
+    andps     xm5, xm4, [inq+sizeq]
+    orps      xm2, xm5
+    cvttps2dq xm2, xm2
+    movu      [outq+sizeq], xm2
+    add       sizeq, 16
+    jz       .end
+%endif
 .loop:
     mulps     m2, m0, [scaledq+sizeq]
     addps     m2, m1
@@ -80,7 +115,16 @@ cglobal aac_quantize_bands, 5, 5, 6, out, in, scaled, size, is_signed, maxval, Q
     andps     m5, m4, [inq+sizeq]
     orps      m2, m5
     cvttps2dq m2, m2
-    mova      [outq+sizeq], m2
+    movu      [outq+sizeq], m2
     add       sizeq, mmsize
     jl       .loop
+.end:
     RET
+%endmacro
+
+INIT_XMM sse2
+QUANTIZE_BANDS
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+QUANTIZE_BANDS
+%endif
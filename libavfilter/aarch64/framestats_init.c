@@ -0,0 +1,47 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/aarch64/cpu.h"
+#include "libavfilter/framestats.h"
+
+void ff_framestats_hist8_neon(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                              ptrdiff_t width, ptrdiff_t height);
+void ff_framestats_hist8_uv_neon(uint32_t *hist_u, uint32_t *hist_v,
+                                 const uint8_t *src, ptrdiff_t stride,
+                                 ptrdiff_t width, ptrdiff_t height);
+void ff_framestats_hist16_neon(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                               ptrdiff_t width, ptrdiff_t height, int shift);
+void ff_framestats_hist16_uv_neon(uint32_t *hist_u, uint32_t *hist_v,
+                                  const uint8_t *src, ptrdiff_t stride,
+                                  ptrdiff_t width, ptrdiff_t height, int shift);
+void ff_framestats_hist8_rgb_neon(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                                  ptrdiff_t width, ptrdiff_t height, int step);
+
+av_cold void ff_framestats_init_aarch64(FrameStatsDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (have_neon(cpu_flags)) {
+        dsp->hist8     = ff_framestats_hist8_neon;
+        dsp->hist8_uv  = ff_framestats_hist8_uv_neon;
+        dsp->hist16    = ff_framestats_hist16_neon;
+        dsp->hist16_uv = ff_framestats_hist16_uv_neon;
+        dsp->hist8_rgb = ff_framestats_hist8_rgb_neon;
+    }
+}
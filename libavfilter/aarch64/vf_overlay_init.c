@@ -0,0 +1,73 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/aarch64/cpu.h"
+#include "libavutil/pixdesc.h"
+#include "libavfilter/vf_overlay.h"
+
+#define OVERLAY_ROW_FUNC(name)                                                  \
+int ff_overlay_row_##name##_neon(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, \
+                                 int w, ptrdiff_t alinesize)
+
+OVERLAY_ROW_FUNC(44);
+OVERLAY_ROW_FUNC(22);
+OVERLAY_ROW_FUNC(20);
+OVERLAY_ROW_FUNC(20_nv);
+OVERLAY_ROW_FUNC(y44_pm);
+OVERLAY_ROW_FUNC(c44_pm);
+OVERLAY_ROW_FUNC(c22_pm);
+OVERLAY_ROW_FUNC(c20_pm);
+OVERLAY_ROW_FUNC(c20_nv_pm);
+
+av_cold void ff_overlay_init_aarch64(OverlayContext *s, int format, int pix_format,
+                                     int alpha_format, int main_has_alpha)
+{
+    int cpu_flags = av_get_cpu_flags();
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_format);
+    const int nv = desc && desc->comp[1].step > 1;
+
+    if (!have_neon(cpu_flags) || main_has_alpha)
+        return;
+
+    switch (format) {
+    case OVERLAY_FORMAT_YUV420:
+        s->blend_row[0] = alpha_format ? ff_overlay_row_y44_pm_neon : ff_overlay_row_44_neon;
+        if (nv)
+            s->blend_row[1] = alpha_format ? ff_overlay_row_c20_nv_pm_neon : ff_overlay_row_20_nv_neon;
+        else
+            s->blend_row[1] = alpha_format ? ff_overlay_row_c20_pm_neon : ff_overlay_row_20_neon;
+        s->blend_row[2] = s->blend_row[1];
+        break;
+    case OVERLAY_FORMAT_YUV422:
+        s->blend_row[0] = alpha_format ? ff_overlay_row_y44_pm_neon : ff_overlay_row_44_neon;
+        s->blend_row[1] =
+        s->blend_row[2] = alpha_format ? ff_overlay_row_c22_pm_neon : ff_overlay_row_22_neon;
+        break;
+    case OVERLAY_FORMAT_YUV444:
+        s->blend_row[0] = alpha_format ? ff_overlay_row_y44_pm_neon : ff_overlay_row_44_neon;
+        s->blend_row[1] =
+        s->blend_row[2] = alpha_format ? ff_overlay_row_c44_pm_neon : ff_overlay_row_44_neon;
+        break;
+    case OVERLAY_FORMAT_GBRP:
+        s->blend_row[0] =
+        s->blend_row[1] =
+        s->blend_row[2] = alpha_format ? ff_overlay_row_y44_pm_neon : ff_overlay_row_44_neon;
+        break;
+    }
+}
@@ -355,4 +355,5 @@ const AVFilter ff_af_amerge = {
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &amerge_class,
     .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags_internal = FF_FILTER_FLAG_UNCACHEABLE_FORMATS,
 };
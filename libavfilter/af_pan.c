@@ -434,4 +434,5 @@ const AVFilter ff_af_pan = {
     FILTER_INPUTS(pan_inputs),
     FILTER_OUTPUTS(pan_outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags_internal = FF_FILTER_FLAG_UNCACHEABLE_FORMATS,
 };
@@ -32,6 +32,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/thread.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -190,7 +191,15 @@ void avfilter_link_free(AVFilterLink **link)
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    /* With the graph scheduler, filters sharing an input can be activated
+       concurrently and request frames from it at the same time. */
+    if (filter->graph && filter->graph->internal->sched) {
+        ff_mutex_lock(&filter->internal->ready_lock);
+        filter->ready = FFMAX(filter->ready, priority);
+        ff_mutex_unlock(&filter->internal->ready_lock);
+    } else {
+        filter->ready = FFMAX(filter->ready, priority);
+    }
 }
 
 /**
@@ -522,11 +531,13 @@ void ff_update_link_current_pts(AVFilterLink *link, int64_t pts)
 {
     if (pts == AV_NOPTS_VALUE)
         return;
+    /* TODO use duration */
+    if (link->graph && !link->dst->nb_outputs) {
+        ff_avfilter_graph_update_heap(link->graph, link, pts);
+        return;
+    }
     link->current_pts = pts;
     link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
-    /* TODO use duration */
-    if (link->graph && link->age_index >= 0)
-        ff_avfilter_graph_update_heap(link->graph, link);
 }
 
 int avfilter_process_command(AVFilterContext *filter, const char *cmd, const char *arg, char *res, int res_len, int flags)
@@ -542,7 +553,12 @@ int avfilter_process_command(AVFilterContext *filter, const char *cmd, const cha
         if (res == local_res)
             av_log(filter, AV_LOG_INFO, "%s", res);
         return 0;
-    }else if(!strcmp(cmd, "enable")) {
+    }
+
+    /* the output for the next frame may differ from the previous one */
+    av_frame_free(&filter->internal->last_output);
+
+    if(!strcmp(cmd, "enable")) {
         return set_enable_expr(filter, arg);
     }else if(filter->filter->process_command) {
         return filter->filter->process_command(filter, cmd, arg, res, res_len, flags);
@@ -674,7 +690,14 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
     ret->internal = av_mallocz(sizeof(*ret->internal));
     if (!ret->internal)
         goto err;
+    if (ff_mutex_init(&ret->internal->ready_lock, NULL)) {
+        av_freep(&ret->internal);
+        goto err;
+    }
     ret->internal->execute = default_execute;
+    ret->internal->keep_duplicates = !!(filter->flags_internal &
+                                        (FF_FILTER_FLAG_KEEP_DUPLICATES |
+                                         FF_FILTER_FLAG_REPEAT_DUPLICATES));
 
     ret->nb_inputs  = filter->nb_inputs;
     if (ret->nb_inputs ) {
@@ -708,6 +731,8 @@ err:
     av_freep(&ret->output_pads);
     ret->nb_outputs = 0;
     av_freep(&ret->priv);
+    if (ret->internal)
+        ff_mutex_destroy(&ret->internal->ready_lock);
     av_freep(&ret->internal);
     av_free(ret);
     return NULL;
@@ -776,6 +801,8 @@ void avfilter_free(AVFilterContext *filter)
     av_expr_free(filter->enable);
     filter->enable = NULL;
     av_freep(&filter->var_values);
+    av_frame_free(&filter->internal->last_output);
+    ff_mutex_destroy(&filter->internal->ready_lock);
     av_freep(&filter->internal);
     av_free(filter);
 }
@@ -965,16 +992,118 @@ static int default_filter_frame(AVFilterLink *link, AVFrame *frame)
     return ff_filter_frame(link->dst->outputs[0], frame);
 }
 
+/**
+ * Only filters whose output depends on nothing but the input picture may
+ * pass on the tag of duplicated frames.
+ */
+static int keeps_duplicates(const AVFilterContext *ctx)
+{
+    return ctx->internal->keep_duplicates && !ctx->enable_str;
+}
+
+void ff_filter_set_keep_duplicates(AVFilterContext *ctx, int keep)
+{
+    ctx->internal->keep_duplicates = keep &&
+        (ctx->filter->flags_internal & (FF_FILTER_FLAG_KEEP_DUPLICATES |
+                                        FF_FILTER_FLAG_REPEAT_DUPLICATES));
+    if (!ctx->internal->keep_duplicates)
+        av_frame_free(&ctx->internal->last_output);
+}
+
+/**
+ * Send a new reference to the output for the previous frame instead of
+ * filtering a duplicate of it.
+ */
+static int repeat_last_output(AVFilterLink *link, AVFrame *frame)
+{
+    AVFilterContext *dstctx = link->dst;
+    AVFilterLink *outlink = dstctx->outputs[0];
+    AVFrame *out = av_frame_clone(dstctx->internal->last_output);
+    int ret;
+
+    if (!out) {
+        av_frame_free(&frame);
+        return AVERROR(ENOMEM);
+    }
+
+    /* keep only the side data the duplicate still carries, e.g. fps removes
+     * closed captions after the first copy */
+    for (int i = out->nb_side_data - 1; i >= 0; i--) {
+        enum AVFrameSideDataType type;
+
+        if (i >= out->nb_side_data)
+            continue;
+        type = out->side_data[i]->type;
+        if (!av_frame_get_side_data(frame, type))
+            av_frame_remove_side_data(out, type);
+    }
+    if (!av_frame_get_side_data(out, AV_FRAME_DATA_DUPLICATE) &&
+        !av_frame_new_side_data(out, AV_FRAME_DATA_DUPLICATE, 0)) {
+        av_frame_free(&out);
+        av_frame_free(&frame);
+        return AVERROR(ENOMEM);
+    }
+
+    /* the timing and packet properties the filter copied from its input */
+    out->pts = frame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+               av_rescale_q(frame->pts, link->time_base, outlink->time_base);
+    out->duration              = av_rescale_q(frame->duration, link->time_base, outlink->time_base);
+    out->pkt_dts               = frame->pkt_dts;
+    out->pkt_pos               = frame->pkt_pos;
+    out->pkt_size              = frame->pkt_size;
+    out->best_effort_timestamp = frame->best_effort_timestamp;
+    out->key_frame             = frame->key_frame;
+    out->pict_type             = frame->pict_type;
+    out->opaque                = frame->opaque;
+    out->reordered_opaque      = frame->reordered_opaque;
+    av_frame_free(&frame);
+
+    ret = ff_filter_frame(outlink, out);
+    link->frame_count_out++;
+    return ret;
+}
+
+/**
+ * Keep a reference to the frame sent by a filter for the previous input
+ * frame, it is still queued on the output link.
+ */
+static int keep_last_output(AVFilterContext *ctx, size_t queued_before)
+{
+    FFFrameQueue *fifo = &ctx->outputs[0]->fifo;
+    size_t queued = ff_framequeue_queued_frames(fifo);
+
+    av_frame_free(&ctx->internal->last_output);
+    if (queued != queued_before + 1)
+        return 0;
+    ctx->internal->last_output = av_frame_clone(ff_framequeue_peek(fifo, queued - 1));
+    return ctx->internal->last_output ? 0 : AVERROR(ENOMEM);
+}
+
 static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
 {
     int (*filter_frame)(AVFilterLink *, AVFrame *);
     AVFilterContext *dstctx = link->dst;
     AVFilterPad *dst = link->dstpad;
+    size_t queued = 0;
+    int keep = 0;
     int ret;
 
     if (!(filter_frame = dst->filter_frame))
         filter_frame = default_filter_frame;
 
+    if ((dstctx->filter->flags_internal & FF_FILTER_FLAG_REPEAT_DUPLICATES) &&
+        keeps_duplicates(dstctx)) {
+        if (av_frame_get_side_data(frame, AV_FRAME_DATA_DUPLICATE)) {
+            dstctx->internal->duplicates_seen = 1;
+            if (dstctx->internal->last_output)
+                return repeat_last_output(link, frame);
+        }
+        /* holding a reference prevents the following filters from writing
+         * to the frame, so only do it once duplicates are coming */
+        keep   = dstctx->internal->duplicates_seen;
+        queued = ff_framequeue_queued_frames(&dstctx->outputs[0]->fifo);
+    }
+
     if (dst->flags & AVFILTERPAD_FLAG_NEEDS_WRITABLE) {
         ret = ff_inlink_make_frame_writable(link, &frame);
         if (ret < 0)
@@ -989,6 +1118,8 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
         filter_frame = default_filter_frame;
     ret = filter_frame(link, frame);
     link->frame_count_out++;
+    if (keep && ret >= 0)
+        ret = keep_last_output(dstctx, queued);
     return ret;
 
 fail:
@@ -1406,6 +1537,11 @@ int ff_inlink_consume_frame(AVFilterLink *link, AVFrame **rframe)
 
     frame = ff_framequeue_take(&link->fifo);
     consume_update(link, frame);
+    if (!keeps_duplicates(link->dst))
+        av_frame_remove_side_data(frame, AV_FRAME_DATA_DUPLICATE);
+    if (!(link->dst->filter->flags & AVFILTER_FLAG_METADATA_ONLY) &&
+        !(link->dst->filter->flags_internal & FF_FILTER_FLAG_KEEP_ACTIVE_RECTS))
+        av_frame_remove_side_data(frame, AV_FRAME_DATA_ACTIVE_RECTS);
     *rframe = frame;
     return 1;
 }
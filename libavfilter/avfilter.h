@@ -935,6 +935,27 @@ typedef struct AVFilterGraph {
     int sink_links_count;
 
     unsigned disable_auto_convert;
+
+    /**
+     * Maximum number of threads used to activate independent filters of this
+     * graph concurrently, e.g. the branches following a split filter. Zero or
+     * one (the default) means that filters are activated one at a time from
+     * the thread calling into the graph.
+     *
+     * May be set by the caller before avfilter_graph_config(). When enabled,
+     * the AVFilterGraph.execute callback may be called from several threads
+     * at once.
+     */
+    int graph_threads;
+
+    /**
+     * If nonzero, the outcome of the format negotiation of this graph is
+     * stored in a process-wide cache, and reused by any later graph with the
+     * same filters, options and links, skipping the negotiation entirely.
+     *
+     * May be set by the caller before avfilter_graph_config().
+     */
+    int cache_formats;
 } AVFilterGraph;
 
 /**
@@ -31,6 +31,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/hwcontext.h"
+#include "libavutil/thread.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -38,6 +39,7 @@
 #include "avfilter.h"
 #include "buffersink.h"
 #include "formats.h"
+#include "formatscache.h"
 #include "internal.h"
 #include "thread.h"
 
@@ -56,6 +58,10 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|V },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|A },
+    { "graph_threads", "Maximum number of threads activating independent filters concurrently",
+        OFFSET(graph_threads), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, F|V|A },
+    { "cache_formats", "Reuse the format negotiation of identical graphs",
+        OFFSET(cache_formats), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, F|V|A },
     { NULL },
 };
 
@@ -78,6 +84,21 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     graph->nb_threads  = 1;
     return 0;
 }
+
+int ff_graph_sched_init(AVFilterGraph *graph)
+{
+    graph->graph_threads = 1;
+    return 0;
+}
+
+int ff_graph_sched_run_once(AVFilterGraph *graph)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_graph_sched_free(AVFilterGraph *graph)
+{
+}
 #endif
 
 AVFilterGraph *avfilter_graph_alloc(void)
@@ -91,6 +112,11 @@ AVFilterGraph *avfilter_graph_alloc(void)
         av_freep(&ret);
         return NULL;
     }
+    if (ff_mutex_init(&ret->internal->sink_links_lock, NULL)) {
+        av_freep(&ret->internal);
+        av_freep(&ret);
+        return NULL;
+    }
 
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
@@ -125,9 +151,11 @@ void avfilter_graph_free(AVFilterGraph **graph)
     while ((*graph)->nb_filters)
         avfilter_free((*graph)->filters[0]);
 
+    ff_graph_sched_free(*graph);
     ff_graph_thread_free(*graph);
 
     av_freep(&(*graph)->sink_links);
+    ff_mutex_destroy(&(*graph)->internal->sink_links_lock);
 
     av_opt_free(*graph);
 
@@ -394,6 +422,126 @@ static int formats_declared(AVFilterContext *f)
     return 1;
 }
 
+enum HWFormats {
+    HW_FORMATS_NONE,
+    HW_FORMATS_ALL,
+    HW_FORMATS_MIXED,
+};
+
+static enum HWFormats hw_formats(const AVFilterFormats *formats)
+{
+    unsigned nb_hw = 0;
+
+    for (unsigned i = 0; i < formats->nb_formats; i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(formats->formats[i]);
+        nb_hw += desc && desc->flags & AV_PIX_FMT_FLAG_HWACCEL;
+    }
+    return !nb_hw ? HW_FORMATS_NONE :
+           nb_hw == formats->nb_formats ? HW_FORMATS_ALL : HW_FORMATS_MIXED;
+}
+
+static int has_format(const AVFilterFormats *formats, int format)
+{
+    for (unsigned i = 0; i < formats->nb_formats; i++)
+        if (formats->formats[i] == format)
+            return 1;
+    return 0;
+}
+
+/**
+ * Pick the filter converting between the formats of both ends of link.
+ * Software formats are converted by the conversion filter of the media type,
+ * frames are moved between hardware and software by hwdownload and hwupload.
+ * Software frames going to a DRM_PRIME filter with a DRM device are uploaded
+ * by scale_rga instead, when it is available. A software conversion filter is
+ * never inserted next to hardware-only formats, which it cannot handle.
+ */
+static const char *conversion_filter_name(AVFilterLink *link,
+                                          const AVFilterNegotiation *neg,
+                                          void *log_ctx)
+{
+    enum HWFormats src, dst;
+
+    if (link->type != AVMEDIA_TYPE_VIDEO ||
+        !link->incfg.formats || !link->outcfg.formats)
+        return neg->conversion_filter;
+
+    src = hw_formats(link->incfg.formats);
+    dst = hw_formats(link->outcfg.formats);
+
+    if (src == HW_FORMATS_ALL && dst == HW_FORMATS_NONE)
+        return "hwdownload";
+    if (src == HW_FORMATS_NONE && dst == HW_FORMATS_ALL) {
+        const AVHWDeviceContext *dev;
+
+        if (!link->dst->hw_device_ctx) {
+            av_log(log_ctx, AV_LOG_ERROR,
+                   "The filter '%s' only accepts hardware frames, but has no "
+                   "hardware device to upload the software frames of the "
+                   "filter '%s' to. Insert a hwupload filter with a device.\n",
+                   link->dst->name, link->src->name);
+            return NULL;
+        }
+        dev = (AVHWDeviceContext*)link->dst->hw_device_ctx->data;
+        if (dev->type == AV_HWDEVICE_TYPE_DRM &&
+            has_format(link->outcfg.formats, AV_PIX_FMT_DRM_PRIME) &&
+            avfilter_get_by_name("scale_rga"))
+            return "scale_rga";
+        return "hwupload";
+    }
+    if (src == HW_FORMATS_ALL && dst == HW_FORMATS_ALL) {
+        av_log(log_ctx, AV_LOG_ERROR,
+               "The filters '%s' and '%s' do not share a hardware format, and "
+               "hardware frames are not converted automatically. Insert a "
+               "hwmap filter or a hardware scaling filter between them.\n",
+               link->src->name, link->dst->name);
+        return NULL;
+    }
+    return neg->conversion_filter;
+}
+
+int ff_filter_graph_insert_converter(AVFilterGraph *graph, AVFilterLink *link,
+                                     const AVFilter *filter, const char *name,
+                                     AVFilterContext **pconvert)
+{
+    const AVFilterNegotiation *neg = ff_filter_get_negotiation(link);
+    const char *opts = NULL;
+    AVFilterContext *convert;
+    int ret;
+
+    if (!strcmp(filter->name, neg->conversion_filter))
+        opts = FF_FIELD_AT(char *, neg->conversion_opts_offset, *graph);
+
+    convert = avfilter_graph_alloc_filter(graph, filter, name);
+    if (!convert)
+        return AVERROR(ENOMEM);
+    convert->internal->auto_inserted = 1;
+
+    /* hwupload uploads to the device of the filter it feeds; scale_rga
+     * opens its own DRM device */
+    if (!strcmp(filter->name, "hwupload") && link->dst->hw_device_ctx) {
+        convert->hw_device_ctx = av_buffer_ref(link->dst->hw_device_ctx);
+        if (!convert->hw_device_ctx) {
+            avfilter_free(convert);
+            return AVERROR(ENOMEM);
+        }
+    }
+
+    if ((ret = avfilter_init_str(convert, opts)) < 0) {
+        avfilter_free(convert);
+        return ret;
+    }
+    if ((ret = avfilter_insert_filter(link, convert, 0, 0)) < 0)
+        return ret;
+
+    av_log(graph, AV_LOG_VERBOSE, "Inserted '%s' between the filters '%s' "
+           "and '%s'\n", convert->name, link->src->name,
+           convert->outputs[0]->dst->name);
+
+    *pconvert = convert;
+    return 0;
+}
+
 /**
  * Perform one round of query_formats() and merging formats lists on the
  * filter graph.
@@ -474,7 +622,7 @@ static int query_formats(AVFilterGraph *graph, void *log_ctx)
                 const AVFilter *filter;
                 AVFilterLink *inlink, *outlink;
                 char inst_name[30];
-                const char *opts;
+                const char *name;
 
                 if (graph->disable_auto_convert) {
                     av_log(log_ctx, AV_LOG_ERROR,
@@ -485,20 +633,20 @@ static int query_formats(AVFilterGraph *graph, void *log_ctx)
                 }
 
                 /* couldn't merge format lists. auto-insert conversion filter */
-                if (!(filter = avfilter_get_by_name(neg->conversion_filter))) {
+                if (!(name = conversion_filter_name(link, neg, log_ctx)))
+                    return AVERROR(EINVAL);
+                if (!(filter = avfilter_get_by_name(name))) {
                     av_log(log_ctx, AV_LOG_ERROR,
                            "'%s' filter not present, cannot convert formats.\n",
-                           neg->conversion_filter);
+                           name);
                     return AVERROR(EINVAL);
                 }
                 snprintf(inst_name, sizeof(inst_name), "auto_%s_%d",
-                         neg->conversion_filter, converter_count++);
-                opts = FF_FIELD_AT(char *, neg->conversion_opts_offset, *graph);
-                ret = avfilter_graph_create_filter(&convert, filter, inst_name, opts, NULL, graph);
+                         name, converter_count++);
+                ret = ff_filter_graph_insert_converter(graph, link, filter,
+                                                       inst_name, &convert);
                 if (ret < 0)
                     return ret;
-                if ((ret = avfilter_insert_filter(link, convert, 0, 0)) < 0)
-                    return ret;
 
                 if ((ret = filter_query_formats(convert)) < 0)
                     return ret;
@@ -1101,7 +1249,7 @@ static int pick_formats(AVFilterGraph *graph)
 /**
  * Configure the formats of all the links in the graph.
  */
-static int graph_config_formats(AVFilterGraph *graph, void *log_ctx)
+static int graph_negotiate_formats(AVFilterGraph *graph, void *log_ctx)
 {
     int ret;
 
@@ -1129,6 +1277,36 @@ static int graph_config_formats(AVFilterGraph *graph, void *log_ctx)
     return 0;
 }
 
+static int graph_config_formats(AVFilterGraph *graph, void *log_ctx)
+{
+    unsigned nb_filters = graph->nb_filters;
+    AVBPrint key;
+    int ret, cacheable;
+
+    if (!graph->cache_formats)
+        return graph_negotiate_formats(graph, log_ctx);
+
+    av_bprint_init(&key, 0, AV_BPRINT_SIZE_UNLIMITED);
+    cacheable = ff_formats_cache_key(graph, &key);
+    if (cacheable < 0) {
+        ret = cacheable;
+        goto end;
+    }
+    if (cacheable) {
+        ret = ff_formats_cache_replay(graph, key.str);
+        if (ret)
+            goto end;
+    }
+
+    ret = graph_negotiate_formats(graph, log_ctx);
+    if (ret >= 0 && cacheable)
+        ret = ff_formats_cache_store(graph, key.str, nb_filters);
+
+end:
+    av_bprint_finalize(&key, NULL);
+    return FFMIN(ret, 0);
+}
+
 static int graph_config_pointers(AVFilterGraph *graph, void *log_ctx)
 {
     unsigned i, j;
@@ -1184,6 +1362,8 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
+    if ((ret = ff_graph_sched_init(graphctx)) < 0)
+        return ret;
 
     return 0;
 }
@@ -1292,10 +1472,21 @@ static void heap_bubble_down(AVFilterGraph *graph,
     link->age_index = index;
 }
 
-void ff_avfilter_graph_update_heap(AVFilterGraph *graph, AVFilterLink *link)
+void ff_avfilter_graph_update_heap(AVFilterGraph *graph, AVFilterLink *link,
+                                   int64_t pts)
 {
-    heap_bubble_up  (graph, link, link->age_index);
-    heap_bubble_down(graph, link, link->age_index);
+    /* the heap compares the current pts of all the sink links, so they are
+     * only written with the lock held while a batch of filters is running */
+    if (graph->internal->sched)
+        ff_mutex_lock(&graph->internal->sink_links_lock);
+    link->current_pts    = pts;
+    link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
+    if (link->age_index >= 0) {
+        heap_bubble_up  (graph, link, link->age_index);
+        heap_bubble_down(graph, link, link->age_index);
+    }
+    if (graph->internal->sched)
+        ff_mutex_unlock(&graph->internal->sink_links_lock);
 }
 
 int avfilter_graph_request_oldest(AVFilterGraph *graph)
@@ -1348,6 +1539,9 @@ int ff_filter_graph_run_once(AVFilterGraph *graph)
     AVFilterContext *filter;
     unsigned i;
 
+    if (graph->internal->sched)
+        return ff_graph_sched_run_once(graph);
+
     av_assert0(graph->nb_filters);
     filter = graph->filters[0];
     for (i = 1; i < graph->nb_filters; i++)
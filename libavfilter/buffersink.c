@@ -413,6 +413,7 @@ const AVFilter ff_vsink_buffer = {
     .priv_class    = &buffersink_class,
     .init          = common_init,
     .activate      = activate,
+    .flags_internal = FF_FILTER_FLAG_KEEP_DUPLICATES | FF_FILTER_FLAG_KEEP_ACTIVE_RECTS,
     FILTER_INPUTS(avfilter_vsink_buffer_inputs),
     .outputs       = NULL,
     FILTER_QUERY_FUNC(vsink_query_formats),
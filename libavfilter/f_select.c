@@ -213,7 +213,8 @@ static int config_input(AVFilterLink *inlink)
                  (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
                  desc->nb_components >= 3;
 
-    select->bitdepth = desc->comp[0].depth;
+    /* MSB-aligned samples (P010) span the whole 16-bit range */
+    select->bitdepth = desc->comp[0].depth + desc->comp[0].shift;
     select->nb_planes = is_yuv ? 1 : av_pix_fmt_count_planes(inlink->format);
 
     for (int plane = 0; plane < select->nb_planes; plane++) {
@@ -498,6 +499,7 @@ static int query_formats(AVFilterContext *ctx)
             AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUVJ420P,
             AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUVJ422P,
             AV_PIX_FMT_YUV420P10,
+            AV_PIX_FMT_NV12, AV_PIX_FMT_NV21, AV_PIX_FMT_P010,
             AV_PIX_FMT_NONE
         };
         return ff_set_common_formats_from_list(ctx, pix_fmts);
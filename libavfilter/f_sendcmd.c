@@ -606,6 +606,7 @@ const AVFilter ff_vf_sendcmd = {
     .uninit      = uninit,
     .priv_size   = sizeof(SendCmdContext),
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_GRAPH_EXCLUSIVE,
     FILTER_INPUTS(sendcmd_inputs),
     FILTER_OUTPUTS(sendcmd_outputs),
     .priv_class  = &sendcmd_class,
@@ -638,6 +639,7 @@ const AVFilter ff_af_asendcmd = {
     .uninit      = uninit,
     .priv_size   = sizeof(SendCmdContext),
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_GRAPH_EXCLUSIVE,
     FILTER_INPUTS(asendcmd_inputs),
     FILTER_OUTPUTS(asendcmd_outputs),
 };
@@ -72,6 +72,8 @@ static const AVOption filt_name##_options[] = { \
     {   "REGIONS_OF_INTEREST",        "", 0,             AV_OPT_TYPE_CONST,  {.i64 = AV_FRAME_DATA_REGIONS_OF_INTEREST        }, 0, 0, FLAGS, "type" }, \
     {   "DETECTION_BOUNDING_BOXES",   "", 0,             AV_OPT_TYPE_CONST,  {.i64 = AV_FRAME_DATA_DETECTION_BBOXES           }, 0, 0, FLAGS, "type" }, \
     {   "SEI_UNREGISTERED",           "", 0,             AV_OPT_TYPE_CONST,  {.i64 = AV_FRAME_DATA_SEI_UNREGISTERED           }, 0, 0, FLAGS, "type" }, \
+    {   "ACTIVE_RECTS",               "", 0,             AV_OPT_TYPE_CONST,  {.i64 = AV_FRAME_DATA_ACTIVE_RECTS               }, 0, 0, FLAGS, "type" }, \
+    {   "DUPLICATE",                  "", 0,             AV_OPT_TYPE_CONST,  {.i64 = AV_FRAME_DATA_DUPLICATE                  }, 0, 0, FLAGS, "type" }, \
     { NULL } \
 }
 
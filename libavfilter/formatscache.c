@@ -0,0 +1,320 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Process-level cache of format negotiation outcomes
+ */
+
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/thread.h"
+
+#include "avfilter.h"
+#include "formats.h"
+#include "formatscache.h"
+#include "internal.h"
+
+#define MAX_CACHED_GRAPHS 32
+
+typedef struct CachedConverter {
+    char *filter;
+    char *name;
+    /* original link the converter was inserted on */
+    unsigned dst;
+    unsigned dstpad;
+} CachedConverter;
+
+typedef struct CachedLink {
+    int format;
+    int sample_rate;
+    AVChannelLayout ch_layout;
+} CachedLink;
+
+typedef struct CachedGraph {
+    char *key;
+    uint64_t last_use;
+
+    CachedConverter *converters;
+    unsigned nb_converters;
+
+    /* formats of the input links of all filters, in graph order */
+    CachedLink *links;
+    unsigned nb_links;
+} CachedGraph;
+
+static AVMutex cache_mutex = AV_MUTEX_INITIALIZER;
+static CachedGraph *cache[MAX_CACHED_GRAPHS];
+static uint64_t cache_uses;
+
+static void cached_graph_free(CachedGraph **pentry)
+{
+    CachedGraph *entry = *pentry;
+
+    if (!entry)
+        return;
+    for (unsigned i = 0; i < entry->nb_converters; i++) {
+        av_freep(&entry->converters[i].filter);
+        av_freep(&entry->converters[i].name);
+    }
+    for (unsigned i = 0; i < entry->nb_links; i++)
+        av_channel_layout_uninit(&entry->links[i].ch_layout);
+    av_freep(&entry->converters);
+    av_freep(&entry->links);
+    av_freep(&entry->key);
+    av_freep(pentry);
+}
+
+static int filter_index(const AVFilterGraph *graph, const AVFilterContext *filter,
+                        unsigned nb_filters)
+{
+    for (unsigned i = 0; i < nb_filters; i++)
+        if (graph->filters[i] == filter)
+            return i;
+    return -1;
+}
+
+static unsigned count_links(const AVFilterGraph *graph)
+{
+    unsigned nb_links = 0;
+
+    for (unsigned i = 0; i < graph->nb_filters; i++)
+        nb_links += graph->filters[i]->nb_inputs;
+    return nb_links;
+}
+
+/**
+ * Append the options of obj and of its children, e.g. the SwrContext of
+ * aresample whose output parameters are set on the filter.
+ */
+static int serialize_options(AVBPrint *key, void *obj)
+{
+    void *child = NULL;
+    char *opts;
+    int ret = av_opt_serialize(obj, 0, AV_OPT_SERIALIZE_SKIP_DEFAULTS,
+                               &opts, '=', ':');
+    if (ret < 0)
+        return ret == AVERROR(ENOMEM) ? ret : 0;
+    av_bprintf(key, " %zu:%s", strlen(opts), opts);
+    av_free(opts);
+
+    while ((child = av_opt_child_next(obj, child)))
+        if ((ret = serialize_options(key, child)) <= 0)
+            return ret;
+    return 1;
+}
+
+int ff_formats_cache_key(AVFilterGraph *graph, AVBPrint *key)
+{
+    const char *sws_opts = graph->scale_sws_opts     ? graph->scale_sws_opts     : "";
+    const char *swr_opts = graph->aresample_swr_opts ? graph->aresample_swr_opts : "";
+
+    /* strings are prefixed with their length, so that option values cannot
+       be mistaken for the structure of the graph */
+    av_bprintf(key, "%u %zu:%s %zu:%s\n", graph->disable_auto_convert,
+               strlen(sws_opts), sws_opts, strlen(swr_opts), swr_opts);
+
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        /* the formats of hardware filters depend on the device */
+        if (f->filter->flags_internal & FF_FILTER_FLAG_UNCACHEABLE_FORMATS ||
+            f->hw_device_ctx)
+            return 0;
+
+        av_bprintf(key, "%s %u", f->filter->name, f->nb_outputs);
+        for (unsigned j = 0; j < f->nb_inputs; j++) {
+            AVFilterLink *link = f->inputs[j];
+            int src = filter_index(graph, link->src, graph->nb_filters);
+
+            av_bprintf(key, " %d.%td", src, link->srcpad - link->src->output_pads);
+        }
+        if (f->filter->priv_class) {
+            int ret = serialize_options(key, f->priv);
+            if (ret <= 0)
+                return ret;
+        }
+        av_bprint_chars(key, '\n', 1);
+    }
+
+    return av_bprint_is_complete(key) ? 1 : AVERROR(ENOMEM);
+}
+
+static CachedGraph *cache_find(const char *key)
+{
+    for (int i = 0; i < MAX_CACHED_GRAPHS; i++)
+        if (cache[i] && !strcmp(cache[i]->key, key))
+            return cache[i];
+    return NULL;
+}
+
+static int replay(AVFilterGraph *graph, const CachedGraph *entry)
+{
+    unsigned n = 0;
+    int ret;
+
+    for (unsigned i = 0; i < entry->nb_converters; i++) {
+        const CachedConverter *c = &entry->converters[i];
+        AVFilterLink *link = graph->filters[c->dst]->inputs[c->dstpad];
+        const AVFilter *filter = avfilter_get_by_name(c->filter);
+        AVFilterContext *convert;
+
+        if (!filter)
+            return AVERROR_BUG;
+        ret = ff_filter_graph_insert_converter(graph, link, filter, c->name, &convert);
+        if (ret < 0)
+            return ret;
+    }
+
+    if (count_links(graph) != entry->nb_links)
+        return AVERROR_BUG;
+
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        for (unsigned j = 0; j < f->nb_inputs; j++) {
+            const CachedLink *cl = &entry->links[n++];
+            AVFilterLink *link = f->inputs[j];
+
+            link->format = cl->format;
+            if (link->type != AVMEDIA_TYPE_AUDIO)
+                continue;
+            link->sample_rate = cl->sample_rate;
+            ret = av_channel_layout_copy(&link->ch_layout, &cl->ch_layout);
+            if (ret < 0)
+                return ret;
+#if FF_API_OLD_CHANNEL_LAYOUT
+FF_DISABLE_DEPRECATION_WARNINGS
+            link->channel_layout = link->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ?
+                                   link->ch_layout.u.mask : 0;
+FF_ENABLE_DEPRECATION_WARNINGS
+#endif
+        }
+    }
+
+    return 1;
+}
+
+int ff_formats_cache_replay(AVFilterGraph *graph, const char *key)
+{
+    CachedGraph *entry;
+    int ret = 0;
+
+    ff_mutex_lock(&cache_mutex);
+    entry = cache_find(key);
+    if (entry) {
+        entry->last_use = ++cache_uses;
+        ret = replay(graph, entry);
+        av_log(graph, AV_LOG_DEBUG, "Replayed cached format negotiation, "
+               "%u conversion filters\n", entry->nb_converters);
+    }
+    ff_mutex_unlock(&cache_mutex);
+
+    return ret;
+}
+
+static int record(AVFilterGraph *graph, const char *key, unsigned nb_filters,
+                  CachedGraph **pentry)
+{
+    CachedGraph *entry = av_mallocz(sizeof(*entry));
+    int ret = AVERROR(ENOMEM);
+
+    if (!entry)
+        return AVERROR(ENOMEM);
+
+    entry->key        = av_strdup(key);
+    entry->converters = av_calloc(graph->nb_filters - nb_filters, sizeof(*entry->converters));
+    entry->links      = av_calloc(count_links(graph), sizeof(*entry->links));
+    if (!entry->key || !entry->converters || !entry->links)
+        goto fail;
+
+    for (unsigned i = nb_filters; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        AVFilterLink *link = f->outputs[0];
+        CachedConverter *c = &entry->converters[entry->nb_converters++];
+        int dst;
+
+        /* Converters are replayed in order, each one right before the
+           filter it feeds, so that chains of converters are rebuilt as long
+           as no converter was inserted before an earlier one. */
+        if (filter_index(graph, f->inputs[0]->src, graph->nb_filters) > (int)i) {
+            ret = 0;
+            goto fail;
+        }
+        while ((dst = filter_index(graph, link->dst, nb_filters)) < 0)
+            link = link->dst->outputs[0];
+
+        c->dst    = dst;
+        c->dstpad = link->dstpad - link->dst->input_pads;
+        c->filter = av_strdup(f->filter->name);
+        c->name   = av_strdup(f->name);
+        if (!c->filter || !c->name)
+            goto fail;
+    }
+
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        for (unsigned j = 0; j < f->nb_inputs; j++) {
+            CachedLink *cl = &entry->links[entry->nb_links++];
+            AVFilterLink *link = f->inputs[j];
+
+            cl->format      = link->format;
+            cl->sample_rate = link->sample_rate;
+            if (av_channel_layout_copy(&cl->ch_layout, &link->ch_layout) < 0)
+                goto fail;
+        }
+    }
+
+    *pentry = entry;
+    return 1;
+fail:
+    cached_graph_free(&entry);
+    return ret;
+}
+
+int ff_formats_cache_store(AVFilterGraph *graph, const char *key,
+                           unsigned nb_filters)
+{
+    CachedGraph *entry;
+    int slot = 0, ret;
+
+    if ((ret = record(graph, key, nb_filters, &entry)) <= 0)
+        return ret;
+
+    ff_mutex_lock(&cache_mutex);
+    if (cache_find(key)) {
+        /* stored concurrently by another graph */
+        cached_graph_free(&entry);
+    } else {
+        /* take a free slot, or evict the least recently used entry */
+        for (int i = 1; i < MAX_CACHED_GRAPHS && cache[slot]; i++)
+            if (!cache[i] || cache[i]->last_use < cache[slot]->last_use)
+                slot = i;
+        cached_graph_free(&cache[slot]);
+        entry->last_use = ++cache_uses;
+        cache[slot] = entry;
+    }
+    ff_mutex_unlock(&cache_mutex);
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_FORMATSCACHE_H
+#define AVFILTER_FORMATSCACHE_H
+
+#include "libavutil/bprint.h"
+#include "avfilter.h"
+
+/**
+ * Describe everything the format negotiation of a graph depends on: its
+ * topology, the options of all its filters and the options used for the
+ * automatically inserted conversion filters.
+ *
+ * @return 1 if the key was written, 0 if the graph cannot be cached,
+ *         a negative error code on failure
+ */
+int ff_formats_cache_key(AVFilterGraph *graph, AVBPrint *key);
+
+/**
+ * Apply the negotiation outcome stored for key: insert the same conversion
+ * filters and set the formats of all links.
+ *
+ * @return 1 if the outcome was replayed, 0 if key is not in the cache,
+ *         a negative error code on failure
+ */
+int ff_formats_cache_replay(AVFilterGraph *graph, const char *key);
+
+/**
+ * Store the outcome of the format negotiation of graph under key.
+ *
+ * @param nb_filters number of filters in graph before the negotiation,
+ *                   the following ones being the conversion filters
+ */
+int ff_formats_cache_store(AVFilterGraph *graph, const char *key,
+                           unsigned nb_filters);
+
+#endif /* AVFILTER_FORMATSCACHE_H */
@@ -18,6 +18,18 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
+#define _DEFAULT_SOURCE
+#define _SVID_SOURCE // needed for MAP_ANONYMOUS
+#define _DARWIN_C_SOURCE // needed for MAP_ANON
+#if HAVE_MMAP
+#include <sys/mman.h>
+#if defined(MAP_ANON) && !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
 #include "framepool.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
@@ -48,6 +60,81 @@ struct FFFramePool {
 
 };
 
+#if HAVE_MMAP && defined(MAP_ANONYMOUS)
+#define HUGE_PAGE_SIZE (2 << 20)
+
+static void huge_buffer_free(void *opaque, uint8_t *data)
+{
+    munmap(data, (size_t)(uintptr_t)opaque);
+}
+
+/**
+ * Map a buffer of at least FF_FRAME_POOL_HUGE_SIZE bytes, preferably from
+ * the reserved huge pages, otherwise from regular pages eligible for
+ * transparent huge pages. The mapping is rounded up to whole huge pages,
+ * which wastes less than the buffer size, and the fallback mapping is
+ * aligned on a huge page boundary, since the kernel only backs aligned
+ * huge pages lying entirely inside it. Anonymous mappings are always
+ * zeroed.
+ */
+static AVBufferRef *huge_buffer_alloc(size_t size)
+{
+    AVBufferRef *buf;
+    size_t len = FFALIGN(size, HUGE_PAGE_SIZE);
+    uint8_t *data = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    data = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (data == MAP_FAILED) {
+        uint8_t *map = mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        size_t head;
+
+        if (map == MAP_FAILED)
+            return NULL;
+        /* the mapping is page aligned, so are the trimmed ranges */
+        data = (uint8_t *)FFALIGN((uintptr_t)map, HUGE_PAGE_SIZE);
+        head = data - map;
+        if (head)
+            munmap(map, head);
+        munmap(data + len, HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+        madvise(data, len, MADV_HUGEPAGE);
+#endif
+    }
+
+    buf = av_buffer_create(data, size, huge_buffer_free, (void *)(uintptr_t)len, 0);
+    if (!buf)
+        munmap(data, len);
+    return buf;
+}
+#else
+static AVBufferRef *huge_buffer_alloc(size_t size)
+{
+    return NULL;
+}
+#endif
+
+AVBufferRef *ff_frame_pool_buffer_alloc(size_t size)
+{
+    AVBufferRef *buf = NULL;
+
+    if (size >= FF_FRAME_POOL_HUGE_SIZE)
+        buf = huge_buffer_alloc(size);
+    return buf ? buf : av_buffer_alloc(size);
+}
+
+AVBufferRef *ff_frame_pool_buffer_allocz(size_t size)
+{
+    AVBufferRef *buf = NULL;
+
+    if (size >= FF_FRAME_POOL_HUGE_SIZE)
+        buf = huge_buffer_alloc(size);
+    return buf ? buf : av_buffer_allocz(size);
+}
+
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
                                       int width,
                                       int height,
@@ -76,6 +76,22 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
  */
 void ff_frame_pool_uninit(FFFramePool **pool);
 
+/**
+ * Allocators for ff_frame_pool_video_init(). Buffers of at least
+ * FF_FRAME_POOL_HUGE_SIZE bytes are mapped directly and backed by huge
+ * pages where the system supports them, which spares hundreds of page
+ * faults per plane when a pool for 1080p or larger frames is (re)built.
+ * The threshold is below the 2 MiB huge page size, so that the 8-bit 1080p
+ * luma planes, which are slightly smaller, qualify.
+ *
+ * ff_frame_pool_buffer_alloc() does not initialize the contents of smaller
+ * buffers and is meant for pools whose frames are always entirely
+ * overwritten. ff_frame_pool_buffer_allocz() returns zeroed buffers.
+ */
+#define FF_FRAME_POOL_HUGE_SIZE (1 << 20)
+AVBufferRef *ff_frame_pool_buffer_alloc(size_t size);
+AVBufferRef *ff_frame_pool_buffer_allocz(size_t size);
+
 /**
  * Get the video frame pool configuration.
  *
@@ -0,0 +1,109 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Frame statistics functions
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "framestats.h"
+
+/* Four partial histograms are used, so that runs of equal values do not
+ * serialize on the same counter. */
+#define HIST_FUNC(name, type, step, shift)                                    \
+static av_always_inline void name(uint32_t *hist, const uint8_t *src8,        \
+                                  ptrdiff_t stride, ptrdiff_t width,          \
+                                  ptrdiff_t height, int sh)                   \
+{                                                                             \
+    uint32_t sub[4][256] = { { 0 } };                                         \
+    const type *src = (const type *)src8;                                     \
+    ptrdiff_t x, y;                                                           \
+                                                                              \
+    stride /= sizeof(type);                                                   \
+    for (y = 0; y < height; y++) {                                            \
+        for (x = 0; x < width - 3; x += 4) {                                  \
+            sub[0][(src[(x    ) * step] >> shift) & 0xff]++;                  \
+            sub[1][(src[(x + 1) * step] >> shift) & 0xff]++;                  \
+            sub[2][(src[(x + 2) * step] >> shift) & 0xff]++;                  \
+            sub[3][(src[(x + 3) * step] >> shift) & 0xff]++;                  \
+        }                                                                     \
+        for (; x < width; x++)                                                \
+            sub[0][(src[x * step] >> shift) & 0xff]++;                        \
+        src += stride;                                                        \
+    }                                                                         \
+                                                                              \
+    for (x = 0; x < 256; x++)                                                 \
+        hist[x] += sub[0][x] + sub[1][x] + sub[2][x] + sub[3][x];             \
+}
+
+HIST_FUNC(hist8_step1,  uint8_t,  1, 0)
+HIST_FUNC(hist8_step2,  uint8_t,  2, 0)
+HIST_FUNC(hist8_stepn,  uint8_t, sh, 0)
+HIST_FUNC(hist16_step1, uint16_t, 1, sh)
+HIST_FUNC(hist16_step2, uint16_t, 2, sh)
+
+static void hist8_c(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                    ptrdiff_t width, ptrdiff_t height)
+{
+    hist8_step1(hist, src, stride, width, height, 0);
+}
+
+static void hist8_uv_c(uint32_t *hist_u, uint32_t *hist_v,
+                       const uint8_t *src, ptrdiff_t stride,
+                       ptrdiff_t width, ptrdiff_t height)
+{
+    hist8_step2(hist_u, src,     stride, width, height, 0);
+    hist8_step2(hist_v, src + 1, stride, width, height, 0);
+}
+
+static void hist16_c(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                     ptrdiff_t width, ptrdiff_t height, int shift)
+{
+    hist16_step1(hist, src, stride, width, height, shift);
+}
+
+static void hist16_uv_c(uint32_t *hist_u, uint32_t *hist_v,
+                        const uint8_t *src, ptrdiff_t stride,
+                        ptrdiff_t width, ptrdiff_t height, int shift)
+{
+    hist16_step2(hist_u, src,     stride, width, height, shift);
+    hist16_step2(hist_v, src + 2, stride, width, height, shift);
+}
+
+static void hist8_rgb_c(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                        ptrdiff_t width, ptrdiff_t height, int step)
+{
+    hist8_stepn(hist,       src,     stride, width, height, step);
+    hist8_stepn(hist + 256, src + 1, stride, width, height, step);
+    hist8_stepn(hist + 512, src + 2, stride, width, height, step);
+}
+
+av_cold void ff_framestats_init(FrameStatsDSPContext *dsp)
+{
+    dsp->hist8     = hist8_c;
+    dsp->hist8_uv  = hist8_uv_c;
+    dsp->hist16    = hist16_c;
+    dsp->hist16_uv = hist16_uv_c;
+    dsp->hist8_rgb = hist8_rgb_c;
+
+#if ARCH_AARCH64
+    ff_framestats_init_aarch64(dsp);
+#endif
+}
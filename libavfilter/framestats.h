@@ -0,0 +1,57 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Frame statistics functions
+ */
+
+#ifndef AVFILTER_FRAMESTATS_H
+#define AVFILTER_FRAMESTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Histogram functions. They add the number of occurrences of each value in
+ * a width x height area to 256-entry histograms. The 16-bit versions count
+ * (sample >> shift) & 0xff, e.g. shift 8 gives the 8 most significant bits
+ * of P010 samples. The _uv versions take interleaved sample pairs (NV12
+ * chroma), width being the number of pairs, and fill one histogram for each
+ * component. hist8_rgb takes packed pixels of step bytes, and fills three
+ * consecutive histograms with the first three bytes of each pixel.
+ */
+typedef struct FrameStatsDSPContext {
+    void (*hist8)(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                  ptrdiff_t width, ptrdiff_t height);
+    void (*hist8_uv)(uint32_t *hist_u, uint32_t *hist_v,
+                     const uint8_t *src, ptrdiff_t stride,
+                     ptrdiff_t width, ptrdiff_t height);
+    void (*hist16)(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                   ptrdiff_t width, ptrdiff_t height, int shift);
+    void (*hist16_uv)(uint32_t *hist_u, uint32_t *hist_v,
+                      const uint8_t *src, ptrdiff_t stride,
+                      ptrdiff_t width, ptrdiff_t height, int shift);
+    void (*hist8_rgb)(uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                      ptrdiff_t width, ptrdiff_t height, int step);
+} FrameStatsDSPContext;
+
+void ff_framestats_init(FrameStatsDSPContext *dsp);
+void ff_framestats_init_aarch64(FrameStatsDSPContext *dsp);
+
+#endif /* AVFILTER_FRAMESTATS_H */
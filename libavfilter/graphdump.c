@@ -152,6 +152,25 @@ static void avfilter_graph_dump_to_buf(AVBPrint *buf, AVFilterGraph *graph)
         av_bprintf(buf, "+\n");
         av_bprintf(buf, "\n");
     }
+
+    /* make conversions nobody asked for easy to spot */
+    for (i = 0, x = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+        AVFilterLink *in, *out;
+
+        if (!filter->internal->auto_inserted)
+            continue;
+        if (!x++)
+            av_bprintf(buf, "Automatically inserted conversion filters:\n");
+        in  = filter->inputs[0];
+        out = filter->outputs[0];
+        av_bprintf(buf, "  %s (%s): %s:%s ", filter->name, filter->filter->name,
+                   in->src->name, in->srcpad->name);
+        print_link_prop(buf, in);
+        av_bprintf(buf, " -> ");
+        print_link_prop(buf, out);
+        av_bprintf(buf, " %s:%s\n", out->dst->name, out->dstpad->name);
+    }
 }
 
 char *avfilter_graph_dump(AVFilterGraph *graph, const char *options)
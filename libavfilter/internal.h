@@ -25,6 +25,7 @@
  */
 
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "framequeue.h"
@@ -39,9 +40,10 @@ typedef struct AVFilterCommand {
 } AVFilterCommand;
 
 /**
- * Update the position of a link in the age heap.
+ * Set the current pts of a sink link and update its position in the age heap.
  */
-void ff_avfilter_graph_update_heap(AVFilterGraph *graph, AVFilterLink *link);
+void ff_avfilter_graph_update_heap(AVFilterGraph *graph, AVFilterLink *link,
+                                   int64_t pts);
 
 /**
  * A filter pad used for either input or output.
@@ -133,10 +135,31 @@ struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+    /**
+     * Scheduler activating independent filters concurrently, only set when
+     * AVFilterGraph.graph_threads is larger than 1.
+     */
+    void *sched;
+    AVMutex sink_links_lock; ///< protects sink_links when sched is set
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+    /**
+     * Protects AVFilterContext.ready against concurrent updates from
+     * neighbouring filters when the graph scheduler is used.
+     */
+    AVMutex ready_lock;
+    unsigned sched_stamp; ///< last scheduler batch this filter conflicted with
+    int auto_inserted;    ///< inserted by the format negotiation to convert formats
+
+    /**
+     * AV_FRAME_DATA_DUPLICATE stays valid through the filter, see
+     * FF_FILTER_FLAG_KEEP_DUPLICATES.
+     */
+    int keep_duplicates;
+    int duplicates_seen;  ///< a duplicate was received, last_output is kept
+    AVFrame *last_output; ///< output for the previous input frame
 };
 
 static av_always_inline int ff_filter_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -369,6 +392,65 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters of the graph than its neighbours, and
+ * must not be activated concurrently with any other filter.
+ */
+#define FF_FILTER_FLAG_GRAPH_EXCLUSIVE (1 << 1)
+
+/**
+ * The filter writes every pixel of the video frames it allocates on its
+ * outputs, so that new frame pool buffers do not need to be zeroed.
+ */
+#define FF_FILTER_FLAG_FULL_OVERWRITE (1 << 2)
+
+/**
+ * The formats supported by the filter depend on more than its options and
+ * its position in the graph, so that the outcome of the format negotiation
+ * of a graph containing it must not be reused for another graph.
+ */
+#define FF_FILTER_FLAG_UNCACHEABLE_FORMATS (1 << 3)
+
+/**
+ * The pictures the filter outputs depend only on the corresponding input
+ * pictures, neither on their timestamps nor on previous frames, so that
+ * AV_FRAME_DATA_DUPLICATE stays valid through it. Other filters drop this
+ * side data from their input frames.
+ */
+#define FF_FILTER_FLAG_KEEP_DUPLICATES (1 << 4)
+
+/**
+ * Like FF_FILTER_FLAG_KEEP_DUPLICATES, and the filter has a single input
+ * and a single output and sends exactly one frame for each input frame
+ * from its filter_frame() callback, which does nothing else. Duplicates
+ * are then not passed to it once they are coming: a new reference to its
+ * previous output is sent instead.
+ */
+#define FF_FILTER_FLAG_REPEAT_DUPLICATES (1 << 5)
+
+/**
+ * The filter moves pixels or changes their alpha only along with the frame
+ * dimensions, so that AV_FRAME_DATA_ACTIVE_RECTS stays valid through it, or
+ * it reads that side data itself. Other filters that are not
+ * AVFILTER_FLAG_METADATA_ONLY drop this side data from their input frames.
+ */
+#define FF_FILTER_FLAG_KEEP_ACTIVE_RECTS (1 << 6)
+
+/**
+ * Set whether a filter with FF_FILTER_FLAG_KEEP_DUPLICATES or
+ * FF_FILTER_FLAG_REPEAT_DUPLICATES actually keeps duplicates valid, e.g.
+ * its options may make its output depend on the frame timestamps.
+ */
+void ff_filter_set_keep_duplicates(AVFilterContext *ctx, int keep);
+
+/**
+ * Create a conversion filter named name and insert it on link, the way the
+ * format negotiation does.
+ */
+int ff_filter_graph_insert_converter(AVFilterGraph *graph, AVFilterLink *link,
+                                     const AVFilter *filter, const char *name,
+                                     AVFilterContext **convert);
+
 /**
  * Run one round of processing on a filter graph.
  */
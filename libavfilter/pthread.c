@@ -23,10 +23,12 @@
 
 #include <stddef.h>
 
+#include "libavutil/avassert.h"
 #include "libavutil/error.h"
 #include "libavutil/macros.h"
 #include "libavutil/mem.h"
 #include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
 
 #include "avfilter.h"
 #include "internal.h"
@@ -35,6 +37,7 @@
 typedef struct ThreadContext {
     AVFilterGraph *graph;
     AVSliceThread *thread;
+    AVMutex execute_lock;
     avfilter_action_func *func;
 
     /* per-execute parameters */
@@ -54,29 +57,43 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    ff_mutex_destroy(&c->execute_lock);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
                           void *arg, int *ret, int nb_jobs)
 {
     ThreadContext *c = ctx->graph->internal->thread;
+    /* filters activated concurrently by the graph scheduler share the
+       slice threads */
+    int serialize = !!ctx->graph->internal->sched;
 
     if (nb_jobs <= 0)
         return 0;
+    if (serialize)
+        ff_mutex_lock(&c->execute_lock);
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+    if (serialize)
+        ff_mutex_unlock(&c->execute_lock);
     return 0;
 }
 
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
+    int ret = ff_mutex_init(&c->execute_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
     nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
-    if (nb_threads <= 1)
+    if (nb_threads <= 1) {
         avpriv_slicethread_free(&c->thread);
+        ff_mutex_destroy(&c->execute_lock);
+    }
     return FFMAX(nb_threads, 1);
 }
 
@@ -113,3 +130,142 @@ void ff_graph_thread_free(AVFilterGraph *graph)
         slice_thread_uninit(graph->internal->thread);
     av_freep(&graph->internal->thread);
 }
+
+typedef struct SchedContext {
+    AVSliceThread *thread;
+
+    /* filters activated by the current batch and their return values */
+    AVFilterContext **batch;
+    int *rets;
+    unsigned max_batch;
+
+    unsigned stamp;
+} SchedContext;
+
+static void sched_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    SchedContext *s = priv;
+    s->rets[jobnr] = ff_filter_activate(s->batch[jobnr]);
+}
+
+static void sched_stamp(AVFilterContext *filter, unsigned stamp)
+{
+    filter->internal->sched_stamp = stamp;
+}
+
+/**
+ * Mark all filters whose state an activation of filter may touch: besides
+ * its own links, a filter sets the ready status of its neighbours and
+ * unblocks the outputs of the filters it sends frames to. Filters sharing
+ * only an input filter stay independent, concurrent updates of its ready
+ * status are serialized by ff_filter_set_ready().
+ */
+static void sched_mark_conflicts(AVFilterContext *filter, unsigned stamp)
+{
+    sched_stamp(filter, stamp);
+    for (unsigned i = 0; i < filter->nb_inputs; i++) {
+        AVFilterContext *src = filter->inputs[i]->src;
+
+        sched_stamp(src, stamp);
+        for (unsigned j = 0; j < src->nb_inputs; j++)
+            sched_stamp(src->inputs[j]->src, stamp);
+    }
+    for (unsigned i = 0; i < filter->nb_outputs; i++) {
+        AVFilterContext *dst = filter->outputs[i]->dst;
+
+        sched_stamp(dst, stamp);
+        for (unsigned j = 0; j < dst->nb_inputs; j++)
+            sched_stamp(dst->inputs[j]->src, stamp);
+        for (unsigned j = 0; j < dst->nb_outputs; j++)
+            sched_stamp(dst->outputs[j]->dst, stamp);
+    }
+}
+
+int ff_graph_sched_run_once(AVFilterGraph *graph)
+{
+    SchedContext *s = graph->internal->sched;
+    AVFilterContext *filter;
+    unsigned nb_batch = 0;
+
+    av_assert0(graph->nb_filters);
+    filter = graph->filters[0];
+    for (unsigned i = 1; i < graph->nb_filters; i++)
+        if (graph->filters[i]->ready > filter->ready)
+            filter = graph->filters[i];
+    if (!filter->ready)
+        return AVERROR(EAGAIN);
+    if (filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_EXCLUSIVE)
+        return ff_filter_activate(filter);
+
+    if (!++s->stamp) {
+        for (unsigned i = 0; i < graph->nb_filters; i++)
+            sched_stamp(graph->filters[i], 0);
+        s->stamp = 1;
+    }
+
+    s->batch[nb_batch++] = filter;
+    sched_mark_conflicts(filter, s->stamp);
+    for (unsigned i = 0; i < graph->nb_filters && nb_batch < s->max_batch; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        if (!f->ready || f->internal->sched_stamp == s->stamp ||
+            f->filter->flags_internal & FF_FILTER_FLAG_GRAPH_EXCLUSIVE)
+            continue;
+        s->batch[nb_batch++] = f;
+        sched_mark_conflicts(f, s->stamp);
+    }
+
+    if (nb_batch == 1)
+        return ff_filter_activate(filter);
+
+    avpriv_slicethread_execute(s->thread, nb_batch, 0);
+    for (unsigned i = 0; i < nb_batch; i++)
+        if (s->rets[i] < 0)
+            return s->rets[i];
+    return 0;
+}
+
+int ff_graph_sched_init(AVFilterGraph *graph)
+{
+    SchedContext *s;
+    int ret;
+
+    if (graph->graph_threads <= 1 || graph->internal->sched)
+        return 0;
+
+    s = av_mallocz(sizeof(*s));
+    if (!s)
+        return AVERROR(ENOMEM);
+    graph->internal->sched = s;
+
+    s->max_batch = graph->nb_filters;
+    s->batch     = av_calloc(s->max_batch, sizeof(*s->batch));
+    s->rets      = av_calloc(s->max_batch, sizeof(*s->rets));
+    if (!s->batch || !s->rets) {
+        ff_graph_sched_free(graph);
+        return AVERROR(ENOMEM);
+    }
+
+    ret = avpriv_slicethread_create(&s->thread, s, sched_worker, NULL,
+                                    graph->graph_threads);
+    if (ret <= 1) {
+        ff_graph_sched_free(graph);
+        graph->graph_threads = 1;
+        return FFMIN(ret, 0);
+    }
+    graph->graph_threads = ret;
+
+    return 0;
+}
+
+void ff_graph_sched_free(AVFilterGraph *graph)
+{
+    SchedContext *s = graph->internal->sched;
+
+    if (!s)
+        return;
+    avpriv_slicethread_free(&s->thread);
+    av_freep(&s->batch);
+    av_freep(&s->rets);
+    av_freep(&graph->internal->sched);
+}
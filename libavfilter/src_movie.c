@@ -655,6 +655,7 @@ const AVFilter ff_avsrc_movie = {
     .inputs    = NULL,
     .outputs   = NULL,
     .flags     = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags_internal = FF_FILTER_FLAG_UNCACHEABLE_FORMATS,
     .process_command = process_command
 };
 
@@ -674,6 +675,7 @@ const AVFilter ff_avsrc_amovie = {
     .inputs     = NULL,
     .outputs    = NULL,
     .flags      = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags_internal = FF_FILTER_FLAG_UNCACHEABLE_FORMATS,
     .process_command = process_command,
 };
 
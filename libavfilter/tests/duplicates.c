@@ -0,0 +1,158 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/log.h"
+#include "libavutil/macros.h"
+#include "libavutil/pixdesc.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+
+#define MAX_FRAMES 32
+
+/* 25 to 30 fps, every sixth output frame is a duplicate */
+#define SOURCE "testsrc=s=64x48:r=25:d=0.4,fps=30:tag_duplicates=%d,"
+#define FLAGS  ":flags=bicubic+accurate_rnd+bitexact"
+
+static const char *const graphs[] = {
+    /* the duplicates are passed on, and not filtered again */
+    SOURCE "scale=32:24" FLAGS ",hflip,transpose,showinfo,buffersink",
+    /* negate does not declare that it passes the tag on */
+    SOURCE "scale=32:24" FLAGS ",negate,hflip,buffersink",
+    /* a filter with a timeline drops the tag */
+    SOURCE "hflip=enable='between(t,0.1,0.25)',scale=32:24" FLAGS ",buffersink",
+    /* so does scale when the output size depends on the frame number */
+    SOURCE "scale=w='32+2*mod(n,2)':h=24:eval=frame" FLAGS ",hflip,buffersink",
+};
+
+typedef struct Output {
+    int nb_frames;
+    int64_t pts[MAX_FRAMES];
+    unsigned long crc[MAX_FRAMES];
+    int duplicate[MAX_FRAMES];
+    int repeat[MAX_FRAMES];
+} Output;
+
+static unsigned long frame_crc(const AVFrame *frame)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    unsigned long crc = av_adler32_update(0, NULL, 0);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(frame->data) && frame->data[i]; i++) {
+        int h = i == 1 || i == 2 ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h)
+                                 : frame->height;
+        int w = av_image_get_linesize(frame->format, frame->width, i);
+
+        for (int y = 0; y < h; y++)
+            crc = av_adler32_update(crc, frame->data[i] + y * frame->linesize[i], w);
+    }
+    return crc;
+}
+
+static int run(const char *desc, Output *out)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFrame *frame = av_frame_alloc(), *prev = av_frame_alloc();
+    AVFilterContext *sink = NULL;
+    int ret;
+
+    memset(out, 0, sizeof(*out));
+    if (!graph || !frame || !prev) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    graph->nb_threads = 1;
+    if ((ret = avfilter_graph_parse_ptr(graph, desc, NULL, NULL, NULL)) < 0 ||
+        (ret = avfilter_graph_config(graph, NULL)) < 0)
+        goto end;
+    for (unsigned i = 0; i < graph->nb_filters; i++)
+        if (!strcmp(graph->filters[i]->filter->name, "buffersink"))
+            sink = graph->filters[i];
+
+    while ((ret = av_buffersink_get_frame(sink, frame)) >= 0) {
+        int n = out->nb_frames++;
+
+        if (n >= MAX_FRAMES) {
+            ret = AVERROR(ERANGE);
+            goto end;
+        }
+        out->pts[n]       = frame->pts;
+        out->crc[n]       = frame_crc(frame);
+        out->duplicate[n] = !!av_frame_get_side_data(frame, AV_FRAME_DATA_DUPLICATE);
+        /* the previous output is still referenced, a new picture cannot
+           reuse its buffer */
+        out->repeat[n]    = n && frame->buf[0]->buffer == prev->buf[0]->buffer;
+        av_frame_unref(prev);
+        av_frame_move_ref(prev, frame);
+    }
+    if (ret == AVERROR_EOF)
+        ret = 0;
+
+end:
+    av_frame_free(&frame);
+    av_frame_free(&prev);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    av_log_set_level(AV_LOG_QUIET);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(graphs); i++) {
+        Output tagged, untagged;
+        char desc[256];
+        int same;
+
+        snprintf(desc, sizeof(desc), graphs[i], 1);
+        printf("%s\n", desc);
+        if (run(desc, &tagged) < 0) {
+            printf("failed\n");
+            ret = 1;
+            continue;
+        }
+        for (int n = 0; n < tagged.nb_frames; n++)
+            printf("pts %2"PRId64" crc 0x%08lx%s%s\n", tagged.pts[n], tagged.crc[n],
+                   tagged.duplicate[n] ? " duplicate" : "",
+                   tagged.repeat[n]    ? " repeated"  : "");
+
+        snprintf(desc, sizeof(desc), graphs[i], 0);
+        if (run(desc, &untagged) < 0) {
+            printf("failed\n");
+            ret = 1;
+            continue;
+        }
+        same = tagged.nb_frames == untagged.nb_frames;
+        for (int n = 0; same && n < tagged.nb_frames; n++)
+            same = tagged.pts[n] == untagged.pts[n] && tagged.crc[n] == untagged.crc[n];
+        printf("tag_duplicates=0: %s\n\n", same ? "same" : "differs");
+        if (!same)
+            ret = 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/log.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/avfilter.h"
+
+static const char *const graphs[] = {
+    /* no conversion */
+    "testsrc2=s=32x24:d=1,split[a][b];[a]hflip[c];[b][c]hstack,nullsink",
+    /* scale inserted between incompatible formats */
+    "testsrc=s=32x24:d=1,format=rgb24,format=yuv420p,nullsink",
+    /* scale inserted on one branch only */
+    "testsrc=s=32x24:d=1,format=gray,split[a][b];"
+    "[a]format=yuv444p,nullsink;[b]scale=16:12,nullsink",
+    /* aresample inserted for the sample format and rate */
+    "sine=d=1:r=44100,aformat=sample_fmts=s16:sample_rates=8000,anullsink",
+    /* the output format of aresample is an option of its resampler, the
+       graphs must not share a cache entry */
+    "sine=d=1,aresample=osf=s16,anullsink",
+    "sine=d=1,aresample=osf=flt,anullsink",
+};
+
+static int nb_replayed;
+
+static void log_callback(void *ptr, int level, const char *fmt, va_list vl)
+{
+    if (level == AV_LOG_DEBUG && strstr(fmt, "Replayed cached format negotiation"))
+        nb_replayed++;
+}
+
+static char *configure(const char *desc, int cache_formats)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    char *dump = NULL;
+
+    if (!graph)
+        return NULL;
+    graph->nb_threads    = 1;
+    graph->cache_formats = cache_formats;
+    if (avfilter_graph_parse_ptr(graph, desc, NULL, NULL, NULL) >= 0 &&
+        avfilter_graph_config(graph, NULL) >= 0)
+        dump = avfilter_graph_dump(graph, NULL);
+    avfilter_graph_free(&graph);
+    return dump;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    av_log_set_level(AV_LOG_DEBUG);
+    av_log_set_callback(log_callback);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(graphs); i++) {
+        char *uncached, *miss, *hit;
+        int replayed;
+
+        uncached = configure(graphs[i], 0);
+        miss     = configure(graphs[i], 1);
+        replayed = nb_replayed;
+        hit      = configure(graphs[i], 1);
+        replayed = nb_replayed - replayed;
+
+        printf("%s\n", graphs[i]);
+        if (!uncached || !miss || !hit) {
+            printf("configuration failed\n");
+            ret = 1;
+        } else {
+            printf("replayed: %d\n", replayed);
+            printf("miss: %s\n", strcmp(uncached, miss) ? "differs" : "same");
+            printf("hit: %s\n",  strcmp(uncached, hit)  ? "differs" : "same");
+            printf("%s\n", hit);
+            if (replayed != 1 || strcmp(uncached, miss) || strcmp(uncached, hit))
+                ret = 1;
+        }
+        av_free(uncached);
+        av_free(miss);
+        av_free(hit);
+    }
+
+    return ret;
+}
@@ -0,0 +1,107 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "libavutil/error.h"
+#include "libavutil/log.h"
+#include "libavutil/macros.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/formats.h"
+#include "libavfilter/internal.h"
+
+#define DEFINE_FORMATS(fmt, ...)                                              \
+static int query_##fmt(AVFilterContext *ctx)                                  \
+{                                                                             \
+    static const int fmts[] = { __VA_ARGS__, AV_PIX_FMT_NONE };               \
+    return ff_set_common_formats_from_list(ctx, fmts);                        \
+}
+
+DEFINE_FORMATS(yuv,   AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12)
+DEFINE_FORMATS(vaapi, AV_PIX_FMT_VAAPI)
+DEFINE_FORMATS(cuda,  AV_PIX_FMT_CUDA)
+DEFINE_FORMATS(drm,   AV_PIX_FMT_DRM_PRIME)
+
+static const AVFilterPad pad[] = {
+    {
+        .name = "default",
+        .type = AVMEDIA_TYPE_VIDEO,
+    },
+};
+
+#define DEFINE_SOURCE(fmt)                                                    \
+static const AVFilter src_##fmt = {                                           \
+    .name   = "src_" #fmt,                                                    \
+    FILTER_OUTPUTS(pad),                                                      \
+    FILTER_QUERY_FUNC(query_##fmt),                                           \
+};
+
+#define DEFINE_SINK(fmt)                                                      \
+static const AVFilter sink_##fmt = {                                          \
+    .name    = "sink_" #fmt,                                                  \
+    FILTER_INPUTS(pad),                                                       \
+    FILTER_QUERY_FUNC(query_##fmt),                                           \
+};
+
+DEFINE_SOURCE(yuv)
+DEFINE_SOURCE(vaapi)
+DEFINE_SINK(cuda)
+DEFINE_SINK(drm)
+
+static void log_callback(void *ptr, int level, const char *fmt, va_list vl)
+{
+    if (level <= AV_LOG_ERROR)
+        vprintf(fmt, vl);
+}
+
+static void test(const AVFilter *src, const AVFilter *sink)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterContext *in, *out;
+    int ret;
+
+    printf("%s -> %s\n", src->name, sink->name);
+    if (!graph ||
+        !(in  = avfilter_graph_alloc_filter(graph, src,  "in")) ||
+        !(out = avfilter_graph_alloc_filter(graph, sink, "out")) ||
+        avfilter_init_str(in,  NULL) < 0 ||
+        avfilter_init_str(out, NULL) < 0 ||
+        avfilter_link(in, 0, out, 0) < 0) {
+        printf("setup failed\n");
+    } else {
+        ret = avfilter_graph_config(graph, NULL);
+        printf("ret: %s\n", ret == AVERROR(EINVAL) ? "EINVAL" : av_err2str(ret));
+    }
+    avfilter_graph_free(&graph);
+}
+
+int main(void)
+{
+    av_log_set_callback(log_callback);
+
+    /* hardware to hardware without a common format */
+    test(&src_vaapi, &sink_cuda);
+    test(&src_vaapi, &sink_drm);
+    /* software to hardware without a device to upload to */
+    test(&src_yuv, &sink_cuda);
+    test(&src_yuv, &sink_drm);
+
+    return 0;
+}
@@ -25,4 +25,21 @@ int ff_graph_thread_init(AVFilterGraph *graph);
 
 void ff_graph_thread_free(AVFilterGraph *graph);
 
+/**
+ * Set up concurrent activation of filters according to
+ * AVFilterGraph.graph_threads. Must be called once the graph is configured.
+ */
+int ff_graph_sched_init(AVFilterGraph *graph);
+
+/**
+ * Activate the most urgent filter of the graph along with all other ready
+ * filters that share no state with it or with each other.
+ *
+ * @return AVERROR(EAGAIN) if no filter is ready, the first error returned
+ *         by one of the filters, or 0
+ */
+int ff_graph_sched_run_once(AVFilterGraph *graph);
+
+void ff_graph_sched_free(AVFilterGraph *graph);
+
 #endif /* AVFILTER_THREAD_H */
@@ -172,6 +172,7 @@ const AVFilter ff_vf_format = {
     .priv_class    = &format_class,
 
     .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_KEEP_DUPLICATES,
 
     FILTER_INPUTS(avfilter_vf_format_inputs),
     FILTER_OUTPUTS(avfilter_vf_format_outputs),
@@ -208,6 +209,7 @@ const AVFilter ff_vf_noformat = {
     .priv_size     = sizeof(FormatContext),
 
     .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_KEEP_DUPLICATES,
 
     FILTER_INPUTS(avfilter_vf_noformat_inputs),
     FILTER_OUTPUTS(avfilter_vf_noformat_outputs),
@@ -74,6 +74,7 @@ typedef struct FPSContext {
     char *framerate;        ///< expression that defines the target framerate
     int rounding;           ///< AVRounding method for timestamps
     int eof_action;         ///< action performed for last frame in FIFO
+    int tag_duplicates;     ///< attach AV_FRAME_DATA_DUPLICATE to duplicated frames
 
     /* Set during outlink configuration */
     int64_t  in_pts_off;    ///< input frame pts offset for start_time handling
@@ -111,6 +112,7 @@ static const AVOption fps_options[] = {
     { "eof_action", "action performed for last frame", OFFSET(eof_action), AV_OPT_TYPE_INT, { .i64 = EOF_ACTION_ROUND }, 0, EOF_ACTION_NB-1, V|F, "eof_action" },
         { "round", "round similar to other frames",  0, AV_OPT_TYPE_CONST, { .i64 = EOF_ACTION_ROUND }, 0, 0, V|F, "eof_action" },
         { "pass",  "pass through last frame",        0, AV_OPT_TYPE_CONST, { .i64 = EOF_ACTION_PASS  }, 0, 0, V|F, "eof_action" },
+    { "tag_duplicates", "tag duplicated frames with side data", OFFSET(tag_duplicates), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, V|F },
     { NULL }
 };
 
@@ -292,6 +294,12 @@ static int write_frame(AVFilterContext *ctx, FPSContext *s, AVFilterLink *outlin
         av_frame_remove_side_data(s->frames[0], AV_FRAME_DATA_A53_CC);
         frame->pts = s->next_pts++;
 
+        if (s->tag_duplicates && s->cur_frame_out > 0 &&
+            !av_frame_new_side_data(frame, AV_FRAME_DATA_DUPLICATE, 0)) {
+            av_frame_free(&frame);
+            return AVERROR(ENOMEM);
+        }
+
         av_log(ctx, AV_LOG_DEBUG, "Writing frame with pts %"PRId64" to pts %"PRId64"\n",
                s->frames[0]->pts, frame->pts);
         s->cur_frame_out++;
@@ -167,4 +167,5 @@ const AVFilter ff_vf_hflip = {
     FILTER_OUTPUTS(avfilter_vf_hflip_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .flags         = AVFILTER_FLAG_SLICE_THREADS | AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags_internal = FF_FILTER_FLAG_FULL_OVERWRITE | FF_FILTER_FLAG_REPEAT_DUPLICATES,
 };
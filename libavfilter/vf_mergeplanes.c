@@ -316,4 +316,5 @@ const AVFilter ff_vf_mergeplanes = {
     FILTER_OUTPUTS(mergeplanes_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags_internal = FF_FILTER_FLAG_UNCACHEABLE_FORMATS,
 };
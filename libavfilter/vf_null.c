@@ -44,6 +44,7 @@ const AVFilter ff_vf_null = {
     .name        = "null",
     .description = NULL_IF_CONFIG_SMALL("Pass the source unchanged to the output."),
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_KEEP_DUPLICATES,
     FILTER_INPUTS(avfilter_vf_null_inputs),
     FILTER_OUTPUTS(avfilter_vf_null_outputs),
 };
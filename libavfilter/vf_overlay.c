@@ -26,13 +26,16 @@
  */
 
 #include "avfilter.h"
+#include "filters.h"
 #include "formats.h"
 #include "libavutil/common.h"
 #include "libavutil/eval.h"
 #include "libavutil/avstring.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/timestamp.h"
 #include "internal.h"
@@ -40,9 +43,11 @@
 #include "framesync.h"
 #include "video.h"
 #include "vf_overlay.h"
+#include "vf_overlay_init.h"
 
 typedef struct ThreadData {
     AVFrame *dst, *src;
+    int x, y;
 } ThreadData;
 
 static const char *const var_names[] = {
@@ -83,6 +88,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     OverlayContext *s = ctx->priv;
 
     ff_framesync_uninit(&s->fs);
+    av_freep(&s->tile_map);
+    s->tile_map_size = 0;
     av_expr_free(s->x_pexpr); s->x_pexpr = NULL;
     av_expr_free(s->y_pexpr); s->y_pexpr = NULL;
 }
@@ -332,16 +339,34 @@ static int config_output(AVFilterLink *outlink)
     return ff_framesync_configure(&s->fs);
 }
 
-// divide by 255 and round to nearest
-// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
-#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
-
 // calculate the unpremultiplied alpha, applying the general equation:
 // alpha = alpha_overlay / ( (alpha_main + alpha_overlay) - (alpha_main * alpha_overlay) )
 // (((x) << 16) - ((x) << 9) + (x)) is a faster version of: 255 * 255 * x
 // ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
 #define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
 
+/**
+ * Find the next span of the tiles of a row of the occupancy map which may
+ * modify the main picture.
+ *
+ * @param shift log2 of the tile width in samples of the blended plane
+ * @param start first sample to consider, moved to the start of the span
+ * @return the end of the span, not beyond end; not above *start if there
+ *         is no span left
+ */
+static av_always_inline int next_active_span(const uint8_t *tiles, int shift,
+                                             int *start, int end)
+{
+    int t, t1;
+
+    for (t = *start >> shift; (t << shift) < end && !tiles[t]; t++)
+        ;
+    *start = FFMAX(*start, t << shift);
+    for (t1 = t; (t1 << shift) < end && tiles[t1]; t1++)
+        ;
+    return FFMIN(t1 << shift, end);
+}
+
 /**
  * Blend image in src to destination buffer dst at position (x, y).
  */
@@ -381,52 +406,59 @@ static av_always_inline void blend_slice_packed_rgb(AVFilterContext *ctx,
     dp = dst->data[0] + (y + slice_start) * dst->linesize[0];
 
     for (i = slice_start; i < slice_end; i++) {
+        const uint8_t *tiles = s->tile_map + (i >> OVERLAY_TILE_H_LOG2) * s->tile_cols;
+        int jend;
+
         j = FFMAX(-x, 0);
-        S = sp + j     * sstep;
-        d = dp + (x+j) * dstep;
+        jmax = FFMIN(-x + dst_w, src_w);
 
-        for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
-            alpha = S[sa];
+        while ((jend = next_active_span(tiles, OVERLAY_TILE_W_LOG2, &j, jmax)) > j) {
+            S = sp + j     * sstep;
+            d = dp + (x+j) * dstep;
 
-            // if the main channel has an alpha channel, alpha has to be calculated
-            // to create an un-premultiplied (straight) alpha value
-            if (main_has_alpha && alpha != 0 && alpha != 255) {
-                uint8_t alpha_d = d[da];
-                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-            }
+            for (; j < jend; j++) {
+                alpha = S[sa];
+
+                // if the main channel has an alpha channel, alpha has to be calculated
+                // to create an un-premultiplied (straight) alpha value
+                if (main_has_alpha && alpha != 0 && alpha != 255) {
+                    uint8_t alpha_d = d[da];
+                    alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+                }
 
-            switch (alpha) {
-            case 0:
-                break;
-            case 255:
-                d[dr] = S[sr];
-                d[dg] = S[sg];
-                d[db] = S[sb];
-                break;
-            default:
-                // main_value = main_value * (1 - alpha) + overlay_value * alpha
-                // since alpha is in the range 0-255, the result must divided by 255
-                d[dr] = is_straight ? FAST_DIV255(d[dr] * (255 - alpha) + S[sr] * alpha) :
-                        FFMIN(FAST_DIV255(d[dr] * (255 - alpha)) + S[sr], 255);
-                d[dg] = is_straight ? FAST_DIV255(d[dg] * (255 - alpha) + S[sg] * alpha) :
-                        FFMIN(FAST_DIV255(d[dg] * (255 - alpha)) + S[sg], 255);
-                d[db] = is_straight ? FAST_DIV255(d[db] * (255 - alpha) + S[sb] * alpha) :
-                        FFMIN(FAST_DIV255(d[db] * (255 - alpha)) + S[sb], 255);
-            }
-            if (main_has_alpha) {
                 switch (alpha) {
                 case 0:
                     break;
                 case 255:
-                    d[da] = S[sa];
+                    d[dr] = S[sr];
+                    d[dg] = S[sg];
+                    d[db] = S[sb];
                     break;
                 default:
-                    // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
-                    d[da] += FAST_DIV255((255 - d[da]) * S[sa]);
+                    // main_value = main_value * (1 - alpha) + overlay_value * alpha
+                    // since alpha is in the range 0-255, the result must divided by 255
+                    d[dr] = is_straight ? FAST_DIV255(d[dr] * (255 - alpha) + S[sr] * alpha) :
+                            FFMIN(FAST_DIV255(d[dr] * (255 - alpha)) + S[sr], 255);
+                    d[dg] = is_straight ? FAST_DIV255(d[dg] * (255 - alpha) + S[sg] * alpha) :
+                            FFMIN(FAST_DIV255(d[dg] * (255 - alpha)) + S[sg], 255);
+                    d[db] = is_straight ? FAST_DIV255(d[db] * (255 - alpha) + S[sb] * alpha) :
+                            FFMIN(FAST_DIV255(d[db] * (255 - alpha)) + S[sb], 255);
+                }
+                if (main_has_alpha) {
+                    switch (alpha) {
+                    case 0:
+                        break;
+                    case 255:
+                        d[da] = S[sa];
+                        break;
+                    default:
+                        // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
+                        d[da] += FAST_DIV255((255 - d[da]) * S[sa]);
+                    }
                 }
+                d += dstep;
+                S += sstep;
             }
-            d += dstep;
-            S += sstep;
         }
         dp += dst->linesize[0];
         sp += src->linesize[0];
@@ -457,7 +489,7 @@ static av_always_inline void blend_plane_##depth##_##nbits##bits(AVFilterContext
     int yp = y>>vsub;                                                                                      \
     int xp = x>>hsub;                                                                                      \
     uint##depth##_t *s, *sp, *d, *dp, *dap, *a, *da, *ap;                                                  \
-    int jmax, j, k, kmax;                                                                                  \
+    int jmax, j, k, kmax, kend;                                                                            \
     int slice_start, slice_end;                                                                            \
     const uint##depth##_t max = (1 << nbits) - 1;                                                          \
     const uint##depth##_t mid = (1 << (nbits -1)) ;                                                        \
@@ -478,79 +510,87 @@ static av_always_inline void blend_plane_##depth##_##nbits##bits(AVFilterContext
     dap = (uint##depth##_t *)(dst->data[3] + ((yp + slice_start) << vsub) * dst->linesize[3]);             \
                                                                                                            \
     for (j = slice_start; j < slice_end; j++) {                                                            \
+        const uint8_t *tiles = octx->tile_map +                                                            \
+                               ((j << vsub) >> OVERLAY_TILE_H_LOG2) * octx->tile_cols;                     \
+                                                                                                           \
         k = FFMAX(-xp, 0);                                                                                 \
-        d = dp + (xp+k) * dst_step;                                                                        \
-        s = sp + k;                                                                                        \
-        a = ap + (k<<hsub);                                                                                \
-        da = dap + ((xp+k) << hsub);                                                                       \
         kmax = FFMIN(-xp + dst_wp, src_wp);                                                                \
                                                                                                            \
-        if (nbits == 8 && ((vsub && j+1 < src_hp) || !vsub) && octx->blend_row[i]) {                       \
-            int c = octx->blend_row[i]((uint8_t*)d, (uint8_t*)da, (uint8_t*)s,                             \
-                    (uint8_t*)a, kmax - k, src->linesize[3]);                                              \
+        while ((kend = next_active_span(tiles, OVERLAY_TILE_W_LOG2 - hsub, &k, kmax)) > k) {               \
+            d = dp + (xp+k) * dst_step;                                                                    \
+            s = sp + k;                                                                                    \
+            a = ap + (k<<hsub);                                                                            \
+            da = dap + ((xp+k) << hsub);                                                                   \
                                                                                                            \
-            s += c;                                                                                        \
-            d += dst_step * c;                                                                             \
-            da += (1 << hsub) * c;                                                                         \
-            a += (1 << hsub) * c;                                                                          \
-            k += c;                                                                                        \
-        }                                                                                                  \
-        for (; k < kmax; k++) {                                                                            \
-            int alpha_v, alpha_h, alpha;                                                                   \
+            if (nbits == 8 && ((vsub && j+1 < src_hp) || !vsub) && octx->blend_row[i]) {                   \
+                int c = octx->blend_row[i]((uint8_t*)d, (uint8_t*)da, (uint8_t*)s,                         \
+                        (uint8_t*)a, kend - k, src->linesize[3]);                                          \
+                                                                                                           \
+                s += c;                                                                                    \
+                d += dst_step * c;                                                                         \
+                da += (1 << hsub) * c;                                                                     \
+                a += (1 << hsub) * c;                                                                      \
+                k += c;                                                                                    \
+            }                                                                                              \
+            for (; k < kend; k++) {                                                                        \
+                int alpha_v, alpha_h, alpha;                                                               \
                                                                                                            \
-            /* average alpha for color components, improve quality */                                      \
-            if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {                                            \
-                alpha = (a[0] + a[src->linesize[3]] +                                                      \
-                         a[1] + a[src->linesize[3]+1]) >> 2;                                               \
-            } else if (hsub || vsub) {                                                                     \
-                alpha_h = hsub && k+1 < src_wp ?                                                           \
-                    (a[0] + a[1]) >> 1 : a[0];                                                             \
-                alpha_v = vsub && j+1 < src_hp ?                                                           \
-                    (a[0] + a[src->linesize[3]]) >> 1 : a[0];                                              \
-                alpha = (alpha_v + alpha_h) >> 1;                                                          \
-            } else                                                                                         \
-                alpha = a[0];                                                                              \
-            /* if the main channel has an alpha channel, alpha has to be calculated */                     \
-            /* to create an un-premultiplied (straight) alpha value */                                     \
-            if (main_has_alpha && alpha != 0 && alpha != max) {                                            \
                 /* average alpha for color components, improve quality */                                  \
-                uint8_t alpha_d;                                                                           \
                 if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {                                        \
-                    alpha_d = (da[0] + da[dst->linesize[3]] +                                              \
-                               da[1] + da[dst->linesize[3]+1]) >> 2;                                       \
+                    alpha = (a[0] + a[src->linesize[3]] +                                                  \
+                             a[1] + a[src->linesize[3]+1]) >> 2;                                           \
                 } else if (hsub || vsub) {                                                                 \
                     alpha_h = hsub && k+1 < src_wp ?                                                       \
-                        (da[0] + da[1]) >> 1 : da[0];                                                      \
+                        (a[0] + a[1]) >> 1 : a[0];                                                         \
                     alpha_v = vsub && j+1 < src_hp ?                                                       \
-                        (da[0] + da[dst->linesize[3]]) >> 1 : da[0];                                       \
-                    alpha_d = (alpha_v + alpha_h) >> 1;                                                    \
+                        (a[0] + a[src->linesize[3]]) >> 1 : a[0];                                          \
+                    alpha = (alpha_v + alpha_h) >> 1;                                                      \
                 } else                                                                                     \
-                    alpha_d = da[0];                                                                       \
-                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);                                               \
-            }                                                                                              \
-            if (straight) {                                                                                \
-                if (nbits > 8)                                                                             \
-                   *d = (*d * (max - alpha) + *s * alpha) / max;                                           \
-                else                                                                                       \
-                    *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);                                     \
-            } else {                                                                                       \
-                if (nbits > 8) {                                                                           \
-                    if (i && yuv)                                                                          \
-                        *d = av_clip((*d * (max - alpha) + *s * alpha) / max + *s - mid, -mid, mid) + mid; \
+                    alpha = a[0];                                                                          \
+                /* if the main channel has an alpha channel, alpha has to be calculated */                 \
+                /* to create an un-premultiplied (straight) alpha value */                                 \
+                if (main_has_alpha && alpha != 0 && alpha != max) {                                        \
+                    /* average alpha for color components, improve quality */                              \
+                    uint8_t alpha_d;                                                                       \
+                    if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {                                    \
+                        alpha_d = (da[0] + da[dst->linesize[3]] +                                          \
+                                   da[1] + da[dst->linesize[3]+1]) >> 2;                                   \
+                    } else if (hsub || vsub) {                                                             \
+                        alpha_h = hsub && k+1 < src_wp ?                                                   \
+                            (da[0] + da[1]) >> 1 : da[0];                                                  \
+                        alpha_v = vsub && j+1 < src_hp ?                                                   \
+                            (da[0] + da[dst->linesize[3]]) >> 1 : da[0];                                   \
+                        alpha_d = (alpha_v + alpha_h) >> 1;                                                \
+                    } else                                                                                 \
+                        alpha_d = da[0];                                                                   \
+                    alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);                                           \
+                }                                                                                          \
+                if (straight) {                                                                            \
+                    if (nbits > 8)                                                                         \
+                       *d = (*d * (max - alpha) + *s * alpha) / max;                                       \
                     else                                                                                   \
-                        *d = av_clip_uintp2((*d * (max - alpha) + *s * alpha) / max + *s - (16<<(nbits-8)),\
-                                                                                                    nbits);\
+                        *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);                                 \
                 } else {                                                                                   \
-                    if (i && yuv)                                                                          \
-                        *d = av_clip(FAST_DIV255((*d - mid) * (max - alpha)) + *s - mid, -mid, mid) + mid; \
-                    else                                                                                   \
-                        *d = av_clip_uint8(FAST_DIV255(*d * (255 - alpha)) + *s - 16);                     \
+                    if (nbits > 8) {                                                                       \
+                        if (i && yuv)                                                                      \
+                            *d = av_clip((*d * (max - alpha) + *s * alpha) / max + *s - mid,               \
+                                         -mid, mid - 1) + mid;                                             \
+                        else                                                                               \
+                            *d = av_clip_uintp2((*d * (max - alpha) + *s * alpha) / max +                  \
+                                                *s - (16<<(nbits-8)), nbits);                              \
+                    } else {                                                                               \
+                        if (i && yuv)                                                                      \
+                            *d = av_clip(FAST_DIV255((*d - mid) * (max - alpha)) + *s - mid,               \
+                                         -mid, mid - 1) + mid;                                             \
+                        else                                                                               \
+                            *d = av_clip_uint8(FAST_DIV255(*d * (255 - alpha)) + *s - 16);                 \
+                    }                                                                                      \
                 }                                                                                          \
+                s++;                                                                                       \
+                d += dst_step;                                                                             \
+                da += 1 << hsub;                                                                           \
+                a += 1 << hsub;                                                                            \
             }                                                                                              \
-            s++;                                                                                           \
-            d += dst_step;                                                                                 \
-            da += 1 << hsub;                                                                               \
-            a += 1 << hsub;                                                                                \
         }                                                                                                  \
         dp += dst->linesize[dst_plane] / bytes;                                                            \
         sp += src->linesize[i] / bytes;                                                                    \
@@ -562,7 +602,8 @@ DEFINE_BLEND_PLANE(8, 8)
 DEFINE_BLEND_PLANE(16, 10)
 
 #define DEFINE_ALPHA_COMPOSITE(depth, nbits)                                                               \
-static inline void alpha_composite_##depth##_##nbits##bits(const AVFrame *src, const AVFrame *dst,         \
+static inline void alpha_composite_##depth##_##nbits##bits(const OverlayContext *octx,                     \
+                                   const AVFrame *src, const AVFrame *dst,                                 \
                                    int src_w, int src_h,                                                   \
                                    int dst_w, int dst_h,                                                   \
                                    int x, int y,                                                           \
@@ -570,7 +611,7 @@ static inline void alpha_composite_##depth##_##nbits##bits(const AVFrame *src, c
 {                                                                                                          \
     uint##depth##_t alpha;          /* the amount of overlay to blend on to main */                        \
     uint##depth##_t *s, *sa, *d, *da;                                                                      \
-    int i, imax, j, jmax;                                                                                  \
+    int i, imax, j, jmax, jend;                                                                            \
     int slice_start, slice_end;                                                                            \
     const uint##depth##_t max = (1 << nbits) - 1;                                                          \
     int bytes = depth / 8;                                                                                 \
@@ -585,27 +626,33 @@ static inline void alpha_composite_##depth##_##nbits##bits(const AVFrame *src, c
     da = (uint##depth##_t *)(dst->data[3] + (y + slice_start) * dst->linesize[3]);                         \
                                                                                                            \
     for (i = slice_start; i < slice_end; i++) {                                                            \
+        const uint8_t *tiles = octx->tile_map + (i >> OVERLAY_TILE_H_LOG2) * octx->tile_cols;              \
+                                                                                                           \
         j = FFMAX(-x, 0);                                                                                  \
-        s = sa + j;                                                                                        \
-        d = da + x+j;                                                                                      \
+        jmax = FFMIN(-x + dst_w, src_w);                                                                   \
                                                                                                            \
-        for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {                                             \
-            alpha = *s;                                                                                    \
-            if (alpha != 0 && alpha != max) {                                                              \
-                uint8_t alpha_d = *d;                                                                      \
-                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);                                               \
-            }                                                                                              \
-            if (alpha == max)                                                                              \
-                *d = *s;                                                                                   \
-            else if (alpha > 0) {                                                                          \
-                /* apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha */                \
-                if (nbits > 8)                                                                             \
-                    *d += (max - *d) * *s / max;                                                           \
-                else                                                                                       \
-                    *d += FAST_DIV255((max - *d) * *s);                                                    \
+        while ((jend = next_active_span(tiles, OVERLAY_TILE_W_LOG2, &j, jmax)) > j) {                      \
+            s = sa + j;                                                                                    \
+            d = da + x+j;                                                                                  \
+                                                                                                           \
+            for (; j < jend; j++) {                                                                        \
+                alpha = *s;                                                                                \
+                if (alpha != 0 && alpha != max) {                                                          \
+                    uint8_t alpha_d = *d;                                                                  \
+                    alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);                                           \
+                }                                                                                          \
+                if (alpha == max)                                                                          \
+                    *d = *s;                                                                               \
+                else if (alpha > 0) {                                                                      \
+                    /* apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha */            \
+                    if (nbits > 8)                                                                         \
+                        *d += (max - *d) * *s / max;                                                       \
+                    else                                                                                   \
+                        *d += FAST_DIV255((max - *d) * *s);                                                \
+                }                                                                                          \
+                d += 1;                                                                                    \
+                s += 1;                                                                                    \
             }                                                                                              \
-            d += 1;                                                                                        \
-            s += 1;                                                                                        \
         }                                                                                                  \
         da += dst->linesize[3] / bytes;                                                                    \
         sa += src->linesize[3] / bytes;                                                                    \
@@ -640,7 +687,7 @@ static av_always_inline void blend_slice_yuv_##depth##_##nbits##bits(AVFilterCon
                 s->main_desc->comp[2].step, is_straight, 1, jobnr, nb_jobs);                               \
                                                                                                            \
     if (main_has_alpha)                                                                                    \
-        alpha_composite_##depth##_##nbits##bits(src, dst, src_w, src_h, dst_w, dst_h, x, y,                \
+        alpha_composite_##depth##_##nbits##bits(s, src, dst, src_w, src_h, dst_w, dst_h, x, y,             \
                                                 jobnr, nb_jobs);                                           \
 }
 DEFINE_BLEND_SLICE_YUV(8, 8)
@@ -672,198 +719,174 @@ static av_always_inline void blend_slice_planar_rgb(AVFilterContext *ctx,
                 jobnr, nb_jobs);
 
     if (main_has_alpha)
-        alpha_composite_8_8bits(src, dst, src_w, src_h, dst_w, dst_h, x, y, jobnr, nb_jobs);
+        alpha_composite_8_8bits(s, src, dst, src_w, src_h, dst_w, dst_h, x, y, jobnr, nb_jobs);
 }
 
 static int blend_slice_yuv420(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva420(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv420p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 1, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 1, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva420p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 1, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 1, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv422p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 0, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 0, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva422p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 0, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_16_10bits(ctx, td->dst, td->src, 1, 0, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv422(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva422(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv444(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva444(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_gbrp(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_gbrap(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv420_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 0, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva420_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 1, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 1, 1, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv422_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 0, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva422_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 1, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 1, 0, 1, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuv444_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 0, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_yuva444_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 1, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_yuv_8_8bits(ctx, td->dst, td->src, 0, 0, 1, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_gbrp_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 0, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_gbrap_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 1, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 1, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_rgb(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_packed_rgb(ctx, td->dst, td->src, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_packed_rgb(ctx, td->dst, td->src, 0, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_rgba(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_packed_rgb(ctx, td->dst, td->src, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    blend_slice_packed_rgb(ctx, td->dst, td->src, 1, td->x, td->y, 1, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_rgb_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_packed_rgb(ctx, td->dst, td->src, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_packed_rgb(ctx, td->dst, td->src, 0, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
 static int blend_slice_rgba_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    OverlayContext *s = ctx->priv;
     ThreadData *td = arg;
-    blend_slice_packed_rgb(ctx, td->dst, td->src, 1, s->x, s->y, 0, jobnr, nb_jobs);
+    blend_slice_packed_rgb(ctx, td->dst, td->src, 1, td->x, td->y, 0, jobnr, nb_jobs);
     return 0;
 }
 
@@ -984,23 +1007,242 @@ static int config_input_main(AVFilterLink *inlink)
     }
 
 end:
-#if ARCH_X86
-    ff_overlay_init_x86(s, s->format, inlink->format,
-                        s->alpha_format, s->main_has_alpha);
-#endif
+    overlay_init_blend_row(s, s->format, inlink->format,
+                           s->alpha_format, s->main_has_alpha);
 
     return 0;
 }
 
+/* Margin kept around active rectangles, large enough to cover the chroma
+ * filtering of a format conversion between the overlay source and here. */
+#define ACTIVE_RECT_PADDING 8
+
+/**
+ * Collect the areas of the overlay frame listed in its active rectangles
+ * side data, padded, aligned to the chroma grid and merged until none of
+ * them overlap, so that blending only those gives the same output as
+ * blending the whole frame.
+ *
+ * @return the number of areas, or -1 if the whole frame must be blended
+ */
+static int get_active_rects(const OverlayContext *s, const AVFrame *second,
+                            AVFrameActiveRect *rects)
+{
+    const AVFrameSideData *sd = av_frame_get_side_data(second, AV_FRAME_DATA_ACTIVE_RECTS);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(second->format);
+    const AVFrameActiveRects *ar;
+    int halign, valign, nb_rects = 0, merged, i, j;
+
+    if (!sd || sd->size < sizeof(*ar))
+        return -1;
+    ar = (const AVFrameActiveRects *)sd->data;
+    if (ar->width != second->width || ar->height != second->height ||
+        ar->nb_rects < 0 || ar->nb_rects > AV_FRAME_MAX_ACTIVE_RECTS)
+        return -1;
+
+    halign = 1 << FFMAX(s->hsub, desc->log2_chroma_w);
+    valign = 1 << FFMAX(s->vsub, desc->log2_chroma_h);
+    for (i = 0; i < ar->nb_rects; i++) {
+        const AVFrameActiveRect *r = &ar->rects[i];
+        int x0, y0, x1, y1;
+
+        if (r->x < 0 || r->y < 0 || r->w < 0 || r->h < 0 ||
+            r->w > second->width - r->x || r->h > second->height - r->y)
+            return -1;
+        if (!r->w || !r->h)
+            continue;
+
+        x0 = FFMAX(r->x - ACTIVE_RECT_PADDING, 0) & ~(halign - 1);
+        y0 = FFMAX(r->y - ACTIVE_RECT_PADDING, 0) & ~(valign - 1);
+        x1 = FFMIN(FFALIGN(r->x + r->w + ACTIVE_RECT_PADDING, halign), second->width);
+        y1 = FFMIN(FFALIGN(r->y + r->h + ACTIVE_RECT_PADDING, valign), second->height);
+        rects[nb_rects++] = (AVFrameActiveRect){ x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    /* blending is not idempotent, so no pixel may be covered twice */
+    do {
+        merged = 0;
+        for (i = 0; i < nb_rects; i++) {
+            for (j = i + 1; j < nb_rects; j++) {
+                AVFrameActiveRect *a = &rects[i];
+                const AVFrameActiveRect *b = &rects[j];
+                int x1, y1;
+
+                if (a->x >= b->x + b->w || b->x >= a->x + a->w ||
+                    a->y >= b->y + b->h || b->y >= a->y + a->h)
+                    continue;
+                x1   = FFMAX(a->x + a->w, b->x + b->w);
+                y1   = FFMAX(a->y + a->h, b->y + b->h);
+                a->x = FFMIN(a->x, b->x);
+                a->y = FFMIN(a->y, b->y);
+                a->w = x1 - a->x;
+                a->h = y1 - a->y;
+                rects[j--] = rects[--nb_rects];
+                merged = 1;
+            }
+        }
+    } while (merged);
+
+    return nb_rects;
+}
+
+/**
+ * Check whether the samples of a component in the given area of the overlay
+ * are all equal to value.
+ */
+static int comp_is_uniform(const AVFrame *src, const AVPixFmtDescriptor *desc, int c,
+                           int x0, int y0, int x1, int y1, int value)
+{
+    const AVComponentDescriptor *comp = &desc->comp[c];
+    const int hsub = c == 1 || c == 2 ? desc->log2_chroma_w : 0;
+    const int vsub = c == 1 || c == 2 ? desc->log2_chroma_h : 0;
+    const uint64_t pattern = value * 0x0101010101010101ULL;
+
+    x0 >>= hsub;
+    y0 >>= vsub;
+    x1 = AV_CEIL_RSHIFT(x1, hsub);
+    y1 = AV_CEIL_RSHIFT(y1, vsub);
+
+    for (int y = y0; y < y1; y++) {
+        const uint8_t *p = src->data[comp->plane] + y * src->linesize[comp->plane] + comp->offset;
+        uint64_t acc = 0;
+        int x = x0;
+
+        if (comp->depth > 8) {
+            for (; x < x1; x++)
+                acc |= AV_RN16(p + x * comp->step) ^ value;
+        } else {
+            if (comp->step == 1)
+                for (; x + 8 <= x1; x += 8)
+                    acc |= AV_RN64(p + x) ^ pattern;
+            for (; x < x1; x++)
+                acc |= p[x * comp->step] ^ value;
+        }
+        if (acc)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Check whether blending an area of the overlay may change the main picture,
+ * that is whether it has pixels which are not fully transparent or, with
+ * premultiplied alpha, whose color is not the one left untouched by blending.
+ */
+static int tile_is_active(const OverlayContext *s, const AVFrame *src,
+                          const AVPixFmtDescriptor *desc,
+                          int x0, int y0, int x1, int y1)
+{
+    if (!(desc->flags & AV_PIX_FMT_FLAG_ALPHA))
+        return 1;
+
+    for (int c = 0; c < desc->nb_components; c++) {
+        int value;
+
+        if (c == 3)
+            value = 0;
+        /* the blending of more than 8 bits always uses straight alpha */
+        else if (!s->alpha_format || desc->comp[c].depth > 8)
+            continue;
+        else if (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR))
+            value = 0;
+        else if (c && !(desc->flags & AV_PIX_FMT_FLAG_RGB))
+            value = 128;
+        else
+            value = 16;
+
+        if (!comp_is_uniform(src, desc, c, x0, y0, x1, y1, value))
+            return 1;
+    }
+    return 0;
+}
+
+static int build_tile_map(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *src = td->src;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src->format);
+    const int tile_rows   = AV_CEIL_RSHIFT(src->height, OVERLAY_TILE_H_LOG2);
+    const int slice_start = (tile_rows *  jobnr     ) / nb_jobs;
+    const int slice_end   = (tile_rows * (jobnr + 1)) / nb_jobs;
+
+    for (int ty = slice_start; ty < slice_end; ty++) {
+        const int y0 = ty << OVERLAY_TILE_H_LOG2;
+        const int y1 = FFMIN(y0 + (1 << OVERLAY_TILE_H_LOG2), src->height);
+
+        for (int tx = 0; tx < s->tile_cols; tx++) {
+            const int x0 = tx << OVERLAY_TILE_W_LOG2;
+            const int x1 = FFMIN(x0 + (1 << OVERLAY_TILE_W_LOG2), src->width);
+
+            s->tile_map[ty * s->tile_cols + tx] = tile_is_active(s, src, desc, x0, y0, x1, y1);
+        }
+    }
+    return 0;
+}
+
+static int blend_frame(AVFilterContext *ctx, AVFrame *dst, AVFrame *src, int x, int y)
+{
+    OverlayContext *s = ctx->priv;
+    const int nb_threads = ff_filter_get_nb_threads(ctx);
+    int tile_rows;
+    ThreadData td;
+
+    if (x >= dst->width  || x + src->width  < 0 ||
+        y >= dst->height || y + src->height < 0)
+        return 0;
+
+    td.dst = dst;
+    td.src = src;
+    td.x   = x;
+    td.y   = y;
+
+    /* find the fully transparent areas, which are skipped when blending */
+    s->tile_cols = AV_CEIL_RSHIFT(src->width,  OVERLAY_TILE_W_LOG2);
+    tile_rows    = AV_CEIL_RSHIFT(src->height, OVERLAY_TILE_H_LOG2);
+    av_fast_malloc(&s->tile_map, &s->tile_map_size, s->tile_cols * tile_rows);
+    if (!s->tile_map)
+        return AVERROR(ENOMEM);
+    ff_filter_execute(ctx, build_tile_map, &td, NULL, FFMIN(tile_rows, nb_threads));
+
+    ff_filter_execute(ctx, s->blend_slice, &td, NULL, FFMIN(FFMAX(1, FFMIN3(y + src->height, FFMIN(src->height, dst->height), dst->height - y)),
+                                                            nb_threads));
+    return 0;
+}
+
+static int blend_rect(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src,
+                       const AVFrameActiveRect *r)
+{
+    OverlayContext *s = ctx->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src->format);
+    AVFrame view = { 0 };
+    int i;
+
+    view.format = src->format;
+    view.width  = r->w;
+    view.height = r->h;
+    for (i = 0; i < 4 && src->data[i]; i++) {
+        int hsub = i == 1 || i == 2 ? desc->log2_chroma_w : 0;
+        int vsub = i == 1 || i == 2 ? desc->log2_chroma_h : 0;
+
+        view.data[i]     = src->data[i] + (r->y >> vsub) * src->linesize[i] +
+                           (r->x >> hsub) * s->overlay_pix_step[i];
+        view.linesize[i] = src->linesize[i];
+    }
+
+    return blend_frame(ctx, dst, &view, s->x + r->x, s->y + r->y);
+}
+
 static int do_blend(FFFrameSync *fs)
 {
     AVFilterContext *ctx = fs->parent;
     AVFrame *mainpic, *second;
     OverlayContext *s = ctx->priv;
     AVFilterLink *inlink = ctx->inputs[0];
-    int ret;
+    AVFrameActiveRect rects[AV_FRAME_MAX_ACTIVE_RECTS];
+    int nb_rects, i, ret;
 
-    ret = ff_framesync_dualinput_get_writable(fs, &mainpic, &second);
+    ret = ff_framesync_dualinput_get(fs, &mainpic, &second);
     if (ret < 0)
         return ret;
     if (!second)
@@ -1026,15 +1268,29 @@ static int do_blend(FFFrameSync *fs)
                s->var_values[VAR_Y], s->y);
     }
 
-    if (s->x < mainpic->width  && s->x + second->width  >= 0 &&
-        s->y < mainpic->height && s->y + second->height >= 0) {
-        ThreadData td;
+    /* nothing visible in the overlay, pass the main frame through untouched;
+     * the expressions are evaluated before, so that they see every frame */
+    nb_rects = get_active_rects(s, second, rects);
+    if (!nb_rects)
+        return ff_filter_frame(ctx->outputs[0], mainpic);
 
-        td.dst = mainpic;
-        td.src = second;
-        ff_filter_execute(ctx, s->blend_slice, &td, NULL, FFMIN(FFMAX(1, FFMIN3(s->y + second->height, FFMIN(second->height, mainpic->height), mainpic->height - s->y)),
-                                                                ff_filter_get_nb_threads(ctx)));
+    ret = ff_inlink_make_frame_writable(inlink, &mainpic);
+    if (ret < 0) {
+        av_frame_free(&mainpic);
+        return ret;
+    }
+
+    /* the main frame may have been an overlay itself, its areas are stale */
+    av_frame_remove_side_data(mainpic, AV_FRAME_DATA_ACTIVE_RECTS);
+    if (nb_rects < 0)
+        ret = blend_frame(ctx, mainpic, second, s->x, s->y);
+    for (i = 0; i < nb_rects && ret >= 0; i++)
+        ret = blend_rect(ctx, mainpic, second, &rects[i]);
+    if (ret < 0) {
+        av_frame_free(&mainpic);
+        return ret;
     }
+
     return ff_filter_frame(ctx->outputs[0], mainpic);
 }
 
@@ -1122,4 +1378,5 @@ const AVFilter ff_vf_overlay = {
     FILTER_QUERY_FUNC(query_formats),
     .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
                      AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal = FF_FILTER_FLAG_KEEP_ACTIVE_RECTS,
 };
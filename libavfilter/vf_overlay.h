@@ -77,11 +77,29 @@ typedef struct OverlayContext {
 
     AVExpr *x_pexpr, *y_pexpr;
 
+    /**
+     * Blend the start of a row of one plane, return the number of pixels
+     * done. The alpha of 2 source rows is read when vertically subsampled.
+     */
     int (*blend_row[4])(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, int w,
                         ptrdiff_t alinesize);
     int (*blend_slice)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
+
+    /**
+     * One byte per tile of OVERLAY_TILE_W x OVERLAY_TILE_H overlay pixels,
+     * nonzero if blending the tile may modify the main picture.
+     */
+    uint8_t *tile_map;
+    unsigned int tile_map_size;
+    int tile_cols;
 } OverlayContext;
 
+/* log2 of the tile size of the occupancy map, in overlay luma pixels */
+#define OVERLAY_TILE_W_LOG2 6
+#define OVERLAY_TILE_H_LOG2 4
+
+void ff_overlay_init_aarch64(OverlayContext *s, int format, int pix_format,
+                             int alpha_format, int main_has_alpha);
 void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
                          int alpha_format, int main_has_alpha);
 
@@ -0,0 +1,150 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_OVERLAY_INIT_H
+#define AVFILTER_OVERLAY_INIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/pixdesc.h"
+#include "vf_overlay.h"
+
+// divide by 255 and round to nearest
+// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
+#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
+
+enum OverlayRowMode {
+    ROW_STRAIGHT,
+    ROW_PREMULTIPLIED_LUMA,     ///< also used for the planes of gbrp
+    ROW_PREMULTIPLIED_CHROMA,
+};
+
+/**
+ * Blend a row of 8-bit samples, as the generic code of vf_overlay.c does
+ * for a main picture without alpha. With horizontally subsampled alpha the
+ * last sample is left to the caller, as its alpha may lack a column.
+ */
+static av_always_inline int overlay_row_c(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                          int w, ptrdiff_t alinesize,
+                                          int hsub, int vsub, int dst_step,
+                                          enum OverlayRowMode mode)
+{
+    if (hsub)
+        w = FFMAX(w - 1, 0);
+
+    for (int x = 0; x < w; x++) {
+        int alpha;
+
+        if (hsub && vsub)
+            alpha = (a[2 * x] + a[2 * x + 1] +
+                     a[alinesize + 2 * x] + a[alinesize + 2 * x + 1]) >> 2;
+        else if (hsub)
+            alpha = (((a[2 * x] + a[2 * x + 1]) >> 1) + a[2 * x]) >> 1;
+        else
+            alpha = a[x];
+
+        switch (mode) {
+        case ROW_STRAIGHT:
+            d[x * dst_step] = FAST_DIV255(d[x * dst_step] * (255 - alpha) + s[x] * alpha);
+            break;
+        case ROW_PREMULTIPLIED_LUMA:
+            d[x * dst_step] = av_clip_uint8(FAST_DIV255(d[x * dst_step] * (255 - alpha)) + s[x] - 16);
+            break;
+        case ROW_PREMULTIPLIED_CHROMA:
+            d[x * dst_step] = av_clip(FAST_DIV255((d[x * dst_step] - 128) * (255 - alpha)) + s[x] - 128,
+                                      -128, 127) + 128;
+            break;
+        }
+    }
+    return w;
+}
+
+#define DEFINE_OVERLAY_ROW(name, hsub, vsub, dst_step, mode)                        \
+static int overlay_row_##name##_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, \
+                                  int w, ptrdiff_t alinesize)                       \
+{                                                                                   \
+    return overlay_row_c(d, s, a, w, alinesize, hsub, vsub, dst_step, mode);        \
+}
+
+DEFINE_OVERLAY_ROW(44,        0, 0, 1, ROW_STRAIGHT)
+DEFINE_OVERLAY_ROW(22,        1, 0, 1, ROW_STRAIGHT)
+DEFINE_OVERLAY_ROW(20,        1, 1, 1, ROW_STRAIGHT)
+DEFINE_OVERLAY_ROW(20_nv,     1, 1, 2, ROW_STRAIGHT)
+DEFINE_OVERLAY_ROW(y44_pm,    0, 0, 1, ROW_PREMULTIPLIED_LUMA)
+DEFINE_OVERLAY_ROW(c44_pm,    0, 0, 1, ROW_PREMULTIPLIED_CHROMA)
+DEFINE_OVERLAY_ROW(c22_pm,    1, 0, 1, ROW_PREMULTIPLIED_CHROMA)
+DEFINE_OVERLAY_ROW(c20_pm,    1, 1, 1, ROW_PREMULTIPLIED_CHROMA)
+DEFINE_OVERLAY_ROW(c20_nv_pm, 1, 1, 2, ROW_PREMULTIPLIED_CHROMA)
+
+/**
+ * Set the row blending functions of the 8-bit planar formats.
+ *
+ * @param pix_format the format of the main input
+ */
+static av_unused av_cold void overlay_init_blend_row(OverlayContext *s, int format,
+                                                    int pix_format, int alpha_format,
+                                                    int main_has_alpha)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_format);
+    /* interleaved chroma of nv12 and nv21 */
+    const int nv = desc && desc->comp[1].step > 1;
+
+    memset(s->blend_row, 0, sizeof(s->blend_row));
+
+    /* an alpha plane in the main picture requires per pixel divisions */
+    if (!main_has_alpha) {
+        switch (format) {
+        case OVERLAY_FORMAT_YUV420:
+            s->blend_row[0] = alpha_format ? overlay_row_y44_pm_c : overlay_row_44_c;
+            if (nv)
+                s->blend_row[1] = alpha_format ? overlay_row_c20_nv_pm_c : overlay_row_20_nv_c;
+            else
+                s->blend_row[1] = alpha_format ? overlay_row_c20_pm_c : overlay_row_20_c;
+            s->blend_row[2] = s->blend_row[1];
+            break;
+        case OVERLAY_FORMAT_YUV422:
+            s->blend_row[0] = alpha_format ? overlay_row_y44_pm_c : overlay_row_44_c;
+            s->blend_row[1] =
+            s->blend_row[2] = alpha_format ? overlay_row_c22_pm_c : overlay_row_22_c;
+            break;
+        case OVERLAY_FORMAT_YUV444:
+            s->blend_row[0] = alpha_format ? overlay_row_y44_pm_c : overlay_row_44_c;
+            s->blend_row[1] =
+            s->blend_row[2] = alpha_format ? overlay_row_c44_pm_c : overlay_row_44_c;
+            break;
+        case OVERLAY_FORMAT_GBRP:
+            s->blend_row[0] =
+            s->blend_row[1] =
+            s->blend_row[2] = alpha_format ? overlay_row_y44_pm_c : overlay_row_44_c;
+            break;
+        }
+    }
+
+#if ARCH_AARCH64
+    ff_overlay_init_aarch64(s, format, pix_format, alpha_format, main_has_alpha);
+#elif ARCH_X86
+    ff_overlay_init_x86(s, format, pix_format, alpha_format, main_has_alpha);
+#endif
+}
+
+#endif /* AVFILTER_OVERLAY_INIT_H */
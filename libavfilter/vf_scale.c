@@ -212,6 +212,11 @@ static int check_exprs(AVFilterContext *ctx)
         return AVERROR(EINVAL);
     }
 
+    /* the output size of a duplicated frame may differ */
+    ff_filter_set_keep_duplicates(ctx, !(vars_w[VAR_N]   || vars_h[VAR_N] ||
+                                         vars_w[VAR_T]   || vars_h[VAR_T] ||
+                                         vars_w[VAR_POS] || vars_h[VAR_POS]));
+
     return 0;
 }
 
@@ -1009,6 +1014,8 @@ const AVFilter ff_vf_scale = {
     .uninit          = uninit,
     .priv_size       = sizeof(ScaleContext),
     .priv_class      = &scale_class,
+    .flags_internal  = FF_FILTER_FLAG_FULL_OVERWRITE | FF_FILTER_FLAG_REPEAT_DUPLICATES |
+                       FF_FILTER_FLAG_KEEP_ACTIVE_RECTS,
     FILTER_INPUTS(avfilter_vf_scale_inputs),
     FILTER_OUTPUTS(avfilter_vf_scale_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -1050,6 +1057,7 @@ const AVFilter ff_vf_scale2ref = {
     .uninit          = uninit,
     .priv_size       = sizeof(ScaleContext),
     .priv_class      = &scale_class,
+    .flags_internal  = FF_FILTER_FLAG_FULL_OVERWRITE,
     FILTER_INPUTS(avfilter_vf_scale2ref_inputs),
     FILTER_OUTPUTS(avfilter_vf_scale2ref_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -69,6 +69,7 @@ static const enum AVPixelFormat pix_fmts[] = {
         AV_PIX_FMT_YUV420P9, AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV420P12,
         AV_PIX_FMT_YUV422P9, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV422P12,
         AV_PIX_FMT_YUV444P9, AV_PIX_FMT_YUV444P10, AV_PIX_FMT_YUV444P12,
+        AV_PIX_FMT_NV12, AV_PIX_FMT_NV21, AV_PIX_FMT_P010,
         AV_PIX_FMT_NONE
 };
 
@@ -81,7 +82,8 @@ static int config_input(AVFilterLink *inlink)
         (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
         desc->nb_components >= 3;
 
-    s->bitdepth = desc->comp[0].depth;
+    /* MSB-aligned samples (P010) span the whole 16-bit range */
+    s->bitdepth = desc->comp[0].depth + desc->comp[0].shift;
     s->nb_planes = is_yuv ? 1 : av_pix_fmt_count_planes(inlink->format);
 
     for (int plane = 0; plane < 4; plane++) {
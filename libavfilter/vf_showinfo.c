@@ -158,6 +158,22 @@ static void dump_roi(AVFilterContext *ctx, const AVFrameSideData *sd)
     }
 }
 
+static void dump_active_rects(AVFilterContext *ctx, const AVFrameSideData *sd)
+{
+    const AVFrameActiveRects *ar = (const AVFrameActiveRects *)sd->data;
+
+    if (sd->size < sizeof(*ar) || ar->nb_rects < 0 ||
+        ar->nb_rects > AV_FRAME_MAX_ACTIVE_RECTS) {
+        av_log(ctx, AV_LOG_ERROR, "invalid data\n");
+        return;
+    }
+
+    av_log(ctx, AV_LOG_INFO, "active rectangles for %dx%d:", ar->width, ar->height);
+    for (int i = 0; i < ar->nb_rects; i++)
+        av_log(ctx, AV_LOG_INFO, " %dx%d+%d+%d", ar->rects[i].w, ar->rects[i].h,
+               ar->rects[i].x, ar->rects[i].y);
+}
+
 static void dump_detection_bbox(AVFilterContext *ctx, const AVFrameSideData *sd)
 {
     int nb_bboxes;
@@ -774,6 +790,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
         case AV_FRAME_DATA_REGIONS_OF_INTEREST:
             dump_roi(ctx, sd);
             break;
+        case AV_FRAME_DATA_ACTIVE_RECTS:
+            dump_active_rects(ctx, sd);
+            break;
+        case AV_FRAME_DATA_DUPLICATE:
+            av_log(ctx, AV_LOG_INFO, "duplicate of the previous frame");
+            break;
         case AV_FRAME_DATA_DETECTION_BBOXES:
             dump_detection_bbox(ctx, sd);
             break;
@@ -869,4 +891,5 @@ const AVFilter ff_vf_showinfo = {
     .priv_size   = sizeof(ShowInfoContext),
     .priv_class  = &showinfo_class,
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_KEEP_DUPLICATES,
 };
@@ -30,13 +30,14 @@
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "framestats.h"
 #include "internal.h"
 
 #define HIST_SIZE (3*256)
 
 struct thumb_frame {
     AVFrame *buf;               ///< cached frame
-    int histogram[HIST_SIZE];   ///< RGB color distribution histogram of the frame
+    uint32_t histogram[HIST_SIZE]; ///< RGB color distribution histogram of the frame
 };
 
 typedef struct ThumbContext {
@@ -45,9 +46,15 @@ typedef struct ThumbContext {
     int n_frames;               ///< number of frames for analysis
     struct thumb_frame *frames; ///< the n_frames frames
     AVRational tb;              ///< copy of the input timebase to ease access
+    int keyframes;              ///< only analyze key frames
 
     int planewidth[4];
     int planeheight[4];
+    int semiplanar;             ///< chroma samples are interleaved in one plane
+    int swap_uv;                ///< V comes first in the chroma plane
+    int hist16;                 ///< 16-bit samples
+    int shift;                  ///< shift of the 8 most significant bits of 16-bit samples
+    FrameStatsDSPContext dsp;
 } ThumbContext;
 
 #define OFFSET(x) offsetof(ThumbContext, x)
@@ -55,6 +62,7 @@ typedef struct ThumbContext {
 
 static const AVOption thumbnail_options[] = {
     { "n", "set the frames batch size", OFFSET(n_frames), AV_OPT_TYPE_INT, {.i64=100}, 2, INT_MAX, FLAGS },
+    { "keyframes", "only analyze key frames", OFFSET(keyframes), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
     { NULL }
 };
 
@@ -80,7 +88,7 @@ static av_cold int init(AVFilterContext *ctx)
  * @param median average color distribution histogram
  * @return       sum of squared errors
  */
-static double frame_sum_square_err(const int *hist, const double *median)
+static double frame_sum_square_err(const uint32_t *hist, const double *median)
 {
     int i;
     double err, sum_sq_err = 0;
@@ -134,13 +142,17 @@ static AVFrame *get_best_frame(AVFilterContext *ctx)
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
-    int i, j;
     AVFilterContext *ctx  = inlink->dst;
     ThumbContext *s   = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
-    int *hist = s->frames[s->n].histogram;
+    uint32_t *hist = s->frames[s->n].histogram;
     const uint8_t *p = frame->data[0];
 
+    if (s->keyframes && !frame->key_frame) {
+        av_frame_free(&frame);
+        return 0;
+    }
+
     // keep a reference of each frame
     s->frames[s->n].buf = frame;
 
@@ -148,50 +160,42 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
     switch (inlink->format) {
     case AV_PIX_FMT_RGB24:
     case AV_PIX_FMT_BGR24:
-        for (j = 0; j < inlink->h; j++) {
-            for (i = 0; i < inlink->w; i++) {
-                hist[0*256 + p[i*3    ]]++;
-                hist[1*256 + p[i*3 + 1]]++;
-                hist[2*256 + p[i*3 + 2]]++;
-            }
-            p += frame->linesize[0];
-        }
+        s->dsp.hist8_rgb(hist, p, frame->linesize[0], inlink->w, inlink->h, 3);
         break;
     case AV_PIX_FMT_RGB0:
     case AV_PIX_FMT_BGR0:
     case AV_PIX_FMT_RGBA:
     case AV_PIX_FMT_BGRA:
-        for (j = 0; j < inlink->h; j++) {
-            for (i = 0; i < inlink->w; i++) {
-                hist[0*256 + p[i*4    ]]++;
-                hist[1*256 + p[i*4 + 1]]++;
-                hist[2*256 + p[i*4 + 2]]++;
-            }
-            p += frame->linesize[0];
-        }
+        s->dsp.hist8_rgb(hist, p, frame->linesize[0], inlink->w, inlink->h, 4);
         break;
     case AV_PIX_FMT_0RGB:
     case AV_PIX_FMT_0BGR:
     case AV_PIX_FMT_ARGB:
     case AV_PIX_FMT_ABGR:
-        for (j = 0; j < inlink->h; j++) {
-            for (i = 0; i < inlink->w; i++) {
-                hist[0*256 + p[i*4 + 1]]++;
-                hist[1*256 + p[i*4 + 2]]++;
-                hist[2*256 + p[i*4 + 3]]++;
-            }
-            p += frame->linesize[0];
-        }
+        s->dsp.hist8_rgb(hist, p + 1, frame->linesize[0], inlink->w, inlink->h, 4);
         break;
     default:
-        for (int plane = 0; plane < 3; plane++) {
-            const uint8_t *p = frame->data[plane];
-            for (j = 0; j < s->planeheight[plane]; j++) {
-                for (i = 0; i < s->planewidth[plane]; i++)
-                    hist[256*plane + p[i]]++;
-                p += frame->linesize[plane];
+        if (s->semiplanar) {
+            uint32_t *hist_u = hist + 256, *hist_v = hist + 2*256;
+
+            if (s->swap_uv)
+                FFSWAP(uint32_t *, hist_u, hist_v);
+            if (s->hist16) {
+                s->dsp.hist16(hist, frame->data[0], frame->linesize[0],
+                              s->planewidth[0], s->planeheight[0], s->shift);
+                s->dsp.hist16_uv(hist_u, hist_v, frame->data[1], frame->linesize[1],
+                                 s->planewidth[1], s->planeheight[1], s->shift);
+            } else {
+                s->dsp.hist8(hist, frame->data[0], frame->linesize[0],
+                             s->planewidth[0], s->planeheight[0]);
+                s->dsp.hist8_uv(hist_u, hist_v, frame->data[1], frame->linesize[1],
+                                s->planewidth[1], s->planeheight[1]);
             }
+            break;
         }
+        for (int plane = 0; plane < 3; plane++)
+            s->dsp.hist8(hist + 256*plane, frame->data[plane], frame->linesize[plane],
+                         s->planewidth[plane], s->planeheight[plane]);
         break;
     }
 
@@ -241,6 +245,13 @@ static int config_props(AVFilterLink *inlink)
     s->planeheight[1] = s->planeheight[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
     s->planeheight[0] = s->planeheight[3] = inlink->h;
 
+    s->semiplanar = desc->nb_components >= 3 &&
+                    desc->comp[1].plane == desc->comp[2].plane;
+    s->swap_uv    = desc->comp[1].offset > desc->comp[2].offset;
+    s->hist16     = desc->comp[0].depth > 8;
+    s->shift      = desc->comp[0].shift + desc->comp[0].depth - 8;
+    ff_framestats_init(&s->dsp);
+
     return 0;
 }
 
@@ -258,6 +269,8 @@ static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_YUVJ411P,
     AV_PIX_FMT_YUVA420P, AV_PIX_FMT_YUVA422P, AV_PIX_FMT_YUVA444P,
     AV_PIX_FMT_GBRP, AV_PIX_FMT_GBRAP,
+    AV_PIX_FMT_NV12, AV_PIX_FMT_NV21,
+    AV_PIX_FMT_P010, AV_PIX_FMT_P016,
     AV_PIX_FMT_NONE
 };
 
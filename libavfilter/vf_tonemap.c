@@ -31,6 +31,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 
@@ -39,6 +40,7 @@
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_tonemap_init.h"
 
 enum TonemapAlgorithm {
     TONEMAP_NONE,
@@ -58,8 +60,21 @@ typedef struct TonemapContext {
     double param;
     double desat;
     double peak;
+    enum AVPixelFormat format;
 
     const AVLumaCoefficients *coeffs;
+
+    TonemapDSPContext dsp;
+    int16_t *lut;
+    uint16_t *tmp;
+    int tmp_stride;
+
+    /* input properties the LUT was built for */
+    enum AVColorSpace lut_csp;
+    enum AVColorTransferCharacteristic lut_trc;
+    enum AVColorPrimaries lut_prim;
+    enum AVColorRange lut_range;
+    double lut_peak;
 } TonemapContext;
 
 static av_cold int init(AVFilterContext *ctx)
@@ -84,9 +99,52 @@ static av_cold int init(AVFilterContext *ctx)
     if (isnan(s->param))
         s->param = 1.0f;
 
+    if (s->format != AV_PIX_FMT_NONE &&
+        s->format != AV_PIX_FMT_YUV420P && s->format != AV_PIX_FMT_NV12) {
+        av_log(ctx, AV_LOG_ERROR, "Unsupported output format '%s'\n",
+               av_get_pix_fmt_name(s->format));
+        return AVERROR(EINVAL);
+    }
+
+    if (s->format != AV_PIX_FMT_NONE)
+        ff_tonemap_init(&s->dsp);
+
     return 0;
 }
 
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    TonemapContext *s = ctx->priv;
+
+    av_freep(&s->lut);
+    av_freep(&s->tmp);
+}
+
+static int query_formats(AVFilterContext *ctx)
+{
+    static const enum AVPixelFormat float_fmts[] = {
+        AV_PIX_FMT_GBRPF32, AV_PIX_FMT_GBRAPF32, AV_PIX_FMT_NONE,
+    };
+    static const enum AVPixelFormat yuv_in_fmts[] = {
+        AV_PIX_FMT_YUV420P10, AV_PIX_FMT_P010, AV_PIX_FMT_NONE,
+    };
+    TonemapContext *s = ctx->priv;
+    AVFilterFormats *formats = NULL;
+    int ret;
+
+    if (s->format == AV_PIX_FMT_NONE)
+        return ff_set_common_formats_from_list(ctx, float_fmts);
+
+    ret = ff_formats_ref(ff_make_format_list(yuv_in_fmts),
+                         &ctx->inputs[0]->outcfg.formats);
+    if (ret < 0)
+        return ret;
+
+    if ((ret = ff_add_format(&formats, s->format)) < 0)
+        return ret;
+    return ff_formats_ref(formats, &ctx->outputs[0]->incfg.formats);
+}
+
 static float hable(float in)
 {
     float a = 0.15f, b = 0.50f, c = 0.10f, d = 0.20f, e = 0.02f, f = 0.30f;
@@ -107,36 +165,24 @@ static float mobius(float in, float j, double peak)
 }
 
 #define MIX(x,y,a) (x) * (1 - (a)) + (y) * (a)
-static void tonemap(TonemapContext *s, AVFrame *out, const AVFrame *in,
-                    const AVPixFmtDescriptor *desc, int x, int y, double peak)
+static void tonemap_rgb(TonemapContext *s, float *r, float *g, float *b, double peak)
 {
-    int map[3] = { desc->comp[0].plane, desc->comp[1].plane, desc->comp[2].plane };
-    const float *r_in = (const float *)(in->data[map[0]] + x * desc->comp[map[0]].step + y * in->linesize[map[0]]);
-    const float *g_in = (const float *)(in->data[map[1]] + x * desc->comp[map[1]].step + y * in->linesize[map[1]]);
-    const float *b_in = (const float *)(in->data[map[2]] + x * desc->comp[map[2]].step + y * in->linesize[map[2]]);
-    float *r_out = (float *)(out->data[map[0]] + x * desc->comp[map[0]].step + y * out->linesize[map[0]]);
-    float *g_out = (float *)(out->data[map[1]] + x * desc->comp[map[1]].step + y * out->linesize[map[1]]);
-    float *b_out = (float *)(out->data[map[2]] + x * desc->comp[map[2]].step + y * out->linesize[map[2]]);
+    const float r_in = *r, g_in = *g, b_in = *b;
     float sig, sig_orig;
 
-    /* load values */
-    *r_out = *r_in;
-    *g_out = *g_in;
-    *b_out = *b_in;
-
     /* desaturate to prevent unnatural colors */
     if (s->desat > 0) {
-        float luma = av_q2d(s->coeffs->cr) * *r_in + av_q2d(s->coeffs->cg) * *g_in + av_q2d(s->coeffs->cb) * *b_in;
+        float luma = av_q2d(s->coeffs->cr) * r_in + av_q2d(s->coeffs->cg) * g_in + av_q2d(s->coeffs->cb) * b_in;
         float overbright = FFMAX(luma - s->desat, 1e-6) / FFMAX(luma, 1e-6);
-        *r_out = MIX(*r_in, luma, overbright);
-        *g_out = MIX(*g_in, luma, overbright);
-        *b_out = MIX(*b_in, luma, overbright);
+        *r = MIX(r_in, luma, overbright);
+        *g = MIX(g_in, luma, overbright);
+        *b = MIX(b_in, luma, overbright);
     }
 
     /* pick the brightest component, reducing the value range as necessary
      * to keep the entire signal in range and preventing discoloration due to
      * out-of-bounds clipping */
-    sig = FFMAX(FFMAX3(*r_out, *g_out, *b_out), 1e-6);
+    sig = FFMAX(FFMAX3(*r, *g, *b), 1e-6);
     sig_orig = sig;
 
     switch(s->tonemap) {
@@ -167,9 +213,28 @@ static void tonemap(TonemapContext *s, AVFrame *out, const AVFrame *in,
 
     /* apply the computed scale factor to the color,
      * linearly to prevent discoloration */
-    *r_out *= sig / sig_orig;
-    *g_out *= sig / sig_orig;
-    *b_out *= sig / sig_orig;
+    *r *= sig / sig_orig;
+    *g *= sig / sig_orig;
+    *b *= sig / sig_orig;
+}
+
+static void tonemap(TonemapContext *s, AVFrame *out, const AVFrame *in,
+                    const AVPixFmtDescriptor *desc, int x, int y, double peak)
+{
+    int map[3] = { desc->comp[0].plane, desc->comp[1].plane, desc->comp[2].plane };
+    const float *r_in = (const float *)(in->data[map[0]] + x * desc->comp[map[0]].step + y * in->linesize[map[0]]);
+    const float *g_in = (const float *)(in->data[map[1]] + x * desc->comp[map[1]].step + y * in->linesize[map[1]]);
+    const float *b_in = (const float *)(in->data[map[2]] + x * desc->comp[map[2]].step + y * in->linesize[map[2]]);
+    float *r_out = (float *)(out->data[map[0]] + x * desc->comp[map[0]].step + y * out->linesize[map[0]]);
+    float *g_out = (float *)(out->data[map[1]] + x * desc->comp[map[1]].step + y * out->linesize[map[1]]);
+    float *b_out = (float *)(out->data[map[2]] + x * desc->comp[map[2]].step + y * out->linesize[map[2]]);
+
+    /* load values */
+    *r_out = *r_in;
+    *g_out = *g_in;
+    *b_out = *b_in;
+
+    tonemap_rgb(s, r_out, g_out, b_out, peak);
 }
 
 typedef struct ThreadData {
@@ -196,6 +261,330 @@ static int tonemap_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs
     return 0;
 }
 
+#define ST2084_MAX_LUMINANCE 10000.0
+#define ST2084_M1 0.1593017578125
+#define ST2084_M2 78.84375
+#define ST2084_C1 0.8359375
+#define ST2084_C2 18.8515625
+#define ST2084_C3 18.6875
+
+#define HLG_A 0.17883277
+#define HLG_B 0.28466892
+#define HLG_C 0.55991073
+
+static double eotf_st2084(double x)
+{
+    double p = pow(x, 1.0 / ST2084_M2);
+    double a = FFMAX(p - ST2084_C1, 0.0);
+    double b = FFMAX(ST2084_C2 - ST2084_C3 * p, 1e-6);
+    double c = pow(a / b, 1.0 / ST2084_M1);
+    return x > 0.0 ? c * ST2084_MAX_LUMINANCE / REFERENCE_WHITE : 0.0;
+}
+
+static double inverse_oetf_hlg(double x)
+{
+    return x < 0.5 ? 4.0 * x * x : exp((x - HLG_C) / HLG_A) + HLG_B;
+}
+
+/* scene light to display light, scaled so that 12.0 maps to the peak */
+static void ootf_hlg(double rgb[3], const AVLumaCoefficients *coeffs, double peak)
+{
+    double luma  = av_q2d(coeffs->cr) * rgb[0] + av_q2d(coeffs->cg) * rgb[1] +
+                   av_q2d(coeffs->cb) * rgb[2];
+    double gamma = FFMAX(1.2 + 0.42 * log10(peak * REFERENCE_WHITE / 1000.0), 1.0);
+    double factor = peak * pow(FFMAX(luma, 0.0), gamma - 1.0) / pow(12.0, gamma);
+
+    for (int i = 0; i < 3; i++)
+        rgb[i] *= factor;
+}
+
+static int get_rgb2rgb_matrix(enum AVColorPrimaries in, enum AVColorPrimaries out,
+                              double rgb2rgb[3][3])
+{
+    double rgb2xyz[3][3], xyz2rgb[3][3];
+    const AVColorPrimariesDesc *in_primaries  = av_csp_primaries_desc_from_id(in);
+    const AVColorPrimariesDesc *out_primaries = av_csp_primaries_desc_from_id(out);
+
+    if (!in_primaries || !out_primaries)
+        return AVERROR(EINVAL);
+
+    ff_fill_rgb2xyz_table(&out_primaries->prim, &out_primaries->wp, rgb2xyz);
+    ff_matrix_invert_3x3(rgb2xyz, xyz2rgb);
+    ff_fill_rgb2xyz_table(&in_primaries->prim, &in_primaries->wp, rgb2xyz);
+    ff_matrix_mul_3x3(rgb2rgb, rgb2xyz, xyz2rgb);
+
+    return 0;
+}
+
+/*
+ * Fold YUV to RGB, linearization, gamut conversion to BT.709, the tone
+ * curve, BT.1886 re-gamma and RGB to limited range BT.709 YUV into a 3D LUT
+ * sampled on the 10-bit input grid. Missing input tags fall back to what
+ * HDR10 sources use.
+ */
+static int build_yuv_lut(AVFilterContext *ctx, const AVFrame *in, double peak)
+{
+    TonemapContext *s = ctx->priv;
+    enum AVColorSpace csp = in->colorspace;
+    enum AVColorTransferCharacteristic trc = in->color_trc;
+    enum AVColorPrimaries prim = in->color_primaries;
+    const AVLumaCoefficients *in_coeffs, *out_coeffs;
+    double yuv2rgb[3][3], rgb2yuv[3][3], rgb2rgb[3][3];
+    double y_off, y_scale, uv_scale;
+    int ret;
+
+    if (s->lut && s->lut_csp == csp && s->lut_trc == trc && s->lut_prim == prim &&
+        s->lut_range == in->color_range && s->lut_peak == peak)
+        return 0;
+
+    if (csp == AVCOL_SPC_UNSPECIFIED) {
+        av_log(ctx, AV_LOG_WARNING, "Untagged color space, assuming bt2020nc\n");
+        csp = AVCOL_SPC_BT2020_NCL;
+    }
+    if (trc == AVCOL_TRC_UNSPECIFIED) {
+        av_log(ctx, AV_LOG_WARNING, "Untagged transfer, assuming smpte2084\n");
+        trc = AVCOL_TRC_SMPTE2084;
+    }
+    if (prim == AVCOL_PRI_UNSPECIFIED) {
+        av_log(ctx, AV_LOG_WARNING, "Untagged primaries, assuming bt2020\n");
+        prim = AVCOL_PRI_BT2020;
+    }
+
+    if (trc != AVCOL_TRC_SMPTE2084 && trc != AVCOL_TRC_ARIB_STD_B67) {
+        av_log(ctx, AV_LOG_ERROR, "Unsupported transfer '%s'\n",
+               av_color_transfer_name(trc));
+        return AVERROR(EINVAL);
+    }
+
+    in_coeffs  = av_csp_luma_coeffs_from_avcsp(csp);
+    out_coeffs = av_csp_luma_coeffs_from_avcsp(AVCOL_SPC_BT709);
+    if (!in_coeffs) {
+        av_log(ctx, AV_LOG_ERROR, "Unsupported color space '%s'\n",
+               av_color_space_name(csp));
+        return AVERROR(EINVAL);
+    }
+    ret = get_rgb2rgb_matrix(prim, AVCOL_PRI_BT709, rgb2rgb);
+    if (ret < 0) {
+        av_log(ctx, AV_LOG_ERROR, "Unsupported primaries '%s'\n",
+               av_color_primaries_name(prim));
+        return ret;
+    }
+    ff_fill_rgb2yuv_table(in_coeffs, rgb2yuv);
+    ff_matrix_invert_3x3(rgb2yuv, yuv2rgb);
+    ff_fill_rgb2yuv_table(out_coeffs, rgb2yuv);
+
+    if (in->color_range == AVCOL_RANGE_JPEG) {
+        y_off    = 0;
+        y_scale  = 1.0 / 1023;
+        uv_scale = 1.0 / 1023;
+    } else {
+        y_off    = 64;
+        y_scale  = 1.0 / 876;
+        uv_scale = 1.0 / 896;
+    }
+
+    if (!s->lut) {
+        s->lut = av_malloc_array(TONEMAP_LUT_SIZE * TONEMAP_LUT_SIZE * TONEMAP_LUT_SIZE,
+                                 4 * sizeof(*s->lut));
+        if (!s->lut)
+            return AVERROR(ENOMEM);
+    }
+
+    /* the tone curve and desaturation work on the output primaries */
+    s->coeffs = out_coeffs;
+
+    for (int i = 0; i < TONEMAP_LUT_SIZE; i++) {
+        for (int j = 0; j < TONEMAP_LUT_SIZE; j++) {
+            for (int k = 0; k < TONEMAP_LUT_SIZE; k++) {
+                const int step = 1 << (10 - TONEMAP_LUT_BITS);
+                int16_t *dst = s->lut + ((i * TONEMAP_LUT_SIZE + j) * TONEMAP_LUT_SIZE + k) * 4;
+                double yuv[3] = {
+                    (i * step - y_off) * y_scale,
+                    (j * step - 512)   * uv_scale,
+                    (k * step - 512)   * uv_scale,
+                };
+                double rgb[3], lin[3], out[3];
+                float r, g, b;
+
+                ff_matrix_mul_3x3_vec(rgb, yuv, yuv2rgb);
+                for (int c = 0; c < 3; c++) {
+                    rgb[c] = av_clipd(rgb[c], 0.0, 1.0);
+                    rgb[c] = trc == AVCOL_TRC_SMPTE2084 ? eotf_st2084(rgb[c])
+                                                        : inverse_oetf_hlg(rgb[c]);
+                }
+                if (trc == AVCOL_TRC_ARIB_STD_B67)
+                    ootf_hlg(rgb, in_coeffs, peak);
+                ff_matrix_mul_3x3_vec(lin, rgb, rgb2rgb);
+
+                r = FFMAX(lin[0], 0.0);
+                g = FFMAX(lin[1], 0.0);
+                b = FFMAX(lin[2], 0.0);
+                tonemap_rgb(s, &r, &g, &b, peak);
+
+                rgb[0] = pow(av_clipf(r, 0.0f, 1.0f), 1.0 / 2.4);
+                rgb[1] = pow(av_clipf(g, 0.0f, 1.0f), 1.0 / 2.4);
+                rgb[2] = pow(av_clipf(b, 0.0f, 1.0f), 1.0 / 2.4);
+                ff_matrix_mul_3x3_vec(out, rgb, rgb2yuv);
+
+                dst[0] = lrint((16.0  + 219.0 * out[0]) * (1 << TONEMAP_LUT_OUT_BITS));
+                dst[1] = lrint((128.0 + 224.0 * out[1]) * (1 << TONEMAP_LUT_OUT_BITS));
+                dst[2] = lrint((128.0 + 224.0 * out[2]) * (1 << TONEMAP_LUT_OUT_BITS));
+                dst[3] = 0;
+            }
+        }
+    }
+
+    s->lut_csp   = in->colorspace;
+    s->lut_trc   = in->color_trc;
+    s->lut_prim  = in->color_primaries;
+    s->lut_range = in->color_range;
+    s->lut_peak  = peak;
+
+    return 0;
+}
+
+static int tonemap_yuv_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    TonemapContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *in = td->in;
+    AVFrame *out = td->out;
+    const int cw = AV_CEIL_RSHIFT(in->width, 1);
+    const int ch = AV_CEIL_RSHIFT(in->height, 1);
+    const int slice_start = (ch * jobnr) / nb_jobs;
+    const int slice_end = (ch * (jobnr+1)) / nb_jobs;
+    const int packed_in = in->format == AV_PIX_FMT_P010 && !(in->width & 1);
+    const int packed_out = out->format == AV_PIX_FMT_NV12;
+    uint16_t *tmp_y  = s->tmp + jobnr * s->tmp_stride;
+    uint16_t *tmp_uv = tmp_y + 4 * cw;
+    uint8_t *tmp_out = (uint8_t *)(tmp_uv + 2 * cw);
+
+    for (int y = slice_start; y < slice_end; y++) {
+        const int last = 2 * y + 1 >= in->height;
+        const uint16_t *srcy  = (const uint16_t *)(in->data[0] + 2 * y * in->linesize[0]);
+        const uint16_t *srcuv = (const uint16_t *)(in->data[1] + y * in->linesize[1]);
+        ptrdiff_t srcy_stride = last ? 0 : in->linesize[0];
+        ptrdiff_t dsty_stride = last ? 0 : out->linesize[0];
+        uint8_t *dsty  = out->data[0] + 2 * y * out->linesize[0];
+        uint8_t *dstuv = packed_out ? out->data[1] + y * out->linesize[1] : tmp_out;
+
+        if (!packed_in) {
+            /* repack to MSB-aligned lines, padding odd widths */
+            const uint16_t *srcy1 = (const uint16_t *)((const uint8_t *)srcy + srcy_stride);
+
+            if (in->format == AV_PIX_FMT_P010) {
+                memcpy(tmp_y,          srcy,  in->width * sizeof(*tmp_y));
+                memcpy(tmp_y + 2 * cw, srcy1, in->width * sizeof(*tmp_y));
+                memcpy(tmp_uv,         srcuv, 2 * cw * sizeof(*tmp_uv));
+            } else {
+                const uint16_t *srcu = srcuv;
+                const uint16_t *srcv = (const uint16_t *)(in->data[2] + y * in->linesize[2]);
+
+                for (int x = 0; x < in->width; x++) {
+                    tmp_y[x]          = srcy[x]  << 6;
+                    tmp_y[2 * cw + x] = srcy1[x] << 6;
+                }
+                for (int x = 0; x < cw; x++) {
+                    tmp_uv[2 * x]     = srcu[x] << 6;
+                    tmp_uv[2 * x + 1] = srcv[x] << 6;
+                }
+            }
+            if (in->width & 1) {
+                tmp_y[in->width]          = tmp_y[in->width - 1];
+                tmp_y[2 * cw + in->width] = tmp_y[2 * cw + in->width - 1];
+            }
+            srcy        = tmp_y;
+            srcuv       = tmp_uv;
+            srcy_stride = 2 * cw * sizeof(*tmp_y);
+        }
+
+        s->dsp.yuv420(dsty, dsty_stride, dstuv, srcy, srcy_stride, srcuv, s->lut, cw);
+
+        if (!packed_out) {
+            uint8_t *dstu = out->data[1] + y * out->linesize[1];
+            uint8_t *dstv = out->data[2] + y * out->linesize[2];
+
+            for (int x = 0; x < cw; x++) {
+                dstu[x] = tmp_out[2 * x];
+                dstv[x] = tmp_out[2 * x + 1];
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    TonemapContext *s = ctx->priv;
+    const int cw = AV_CEIL_RSHIFT(ctx->inputs[0]->w, 1);
+
+    if (s->format == AV_PIX_FMT_NONE)
+        return 0;
+
+    /* per-thread scratch: two luma lines, one chroma line and one 8-bit chroma line */
+    s->tmp_stride = FFALIGN(4 * cw + 2 * cw + cw, 32);
+    av_freep(&s->tmp);
+    s->tmp = av_malloc_array(ff_filter_get_nb_threads(ctx), s->tmp_stride * sizeof(*s->tmp));
+    if (!s->tmp)
+        return AVERROR(ENOMEM);
+
+    return 0;
+}
+
+static int filter_frame_yuv(AVFilterLink *link, AVFrame *in)
+{
+    AVFilterContext *ctx = link->dst;
+    TonemapContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    ThreadData td;
+    AVFrame *out;
+    double peak = s->peak;
+    int ret;
+
+    /* read peak from side data if not passed in */
+    if (!peak) {
+        peak = ff_determine_signal_peak(in);
+        av_log(s, AV_LOG_DEBUG, "Computed signal peak: %f\n", peak);
+    }
+
+    ret = build_yuv_lut(ctx, in, peak);
+    if (ret < 0) {
+        av_frame_free(&in);
+        return ret;
+    }
+
+    out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+    if (!out) {
+        av_frame_free(&in);
+        return AVERROR(ENOMEM);
+    }
+
+    ret = av_frame_copy_props(out, in);
+    if (ret < 0) {
+        av_frame_free(&in);
+        av_frame_free(&out);
+        return ret;
+    }
+
+    out->color_primaries = AVCOL_PRI_BT709;
+    out->color_trc       = AVCOL_TRC_BT709;
+    out->colorspace      = AVCOL_SPC_BT709;
+    out->color_range     = AVCOL_RANGE_MPEG;
+    av_frame_remove_side_data(out, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA);
+    av_frame_remove_side_data(out, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL);
+
+    td.out = out;
+    td.in = in;
+    ff_filter_execute(ctx, tonemap_yuv_slice, &td, NULL,
+                      FFMIN(AV_CEIL_RSHIFT(in->height, 1), ff_filter_get_nb_threads(ctx)));
+
+    av_frame_free(&in);
+
+    return ff_filter_frame(outlink, out);
+}
+
 static int filter_frame(AVFilterLink *link, AVFrame *in)
 {
     AVFilterContext *ctx = link->dst;
@@ -208,6 +597,9 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
     int ret, x, y;
     double peak = s->peak;
 
+    if (s->format != AV_PIX_FMT_NONE)
+        return filter_frame_yuv(link, in);
+
     if (!desc || !odesc) {
         av_frame_free(&in);
         return AVERROR_BUG;
@@ -294,6 +686,7 @@ static const AVOption tonemap_options[] = {
     { "param",        "tonemap parameter", OFFSET(param), AV_OPT_TYPE_DOUBLE, {.dbl = NAN}, DBL_MIN, DBL_MAX, FLAGS },
     { "desat",        "desaturation strength", OFFSET(desat), AV_OPT_TYPE_DOUBLE, {.dbl = 2}, 0, DBL_MAX, FLAGS },
     { "peak",         "signal peak override", OFFSET(peak), AV_OPT_TYPE_DOUBLE, {.dbl = 0}, 0, DBL_MAX, FLAGS },
+    { "format",       "output pixel format for direct YUV tonemapping", OFFSET(format), AV_OPT_TYPE_PIXEL_FMT, {.i64 = AV_PIX_FMT_NONE}, AV_PIX_FMT_NONE, INT_MAX, FLAGS },
     { NULL }
 };
 
@@ -311,6 +704,7 @@ static const AVFilterPad tonemap_outputs[] = {
     {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_output,
     },
 };
 
@@ -318,10 +712,12 @@ const AVFilter ff_vf_tonemap = {
     .name            = "tonemap",
     .description     = NULL_IF_CONFIG_SMALL("Conversion to/from different dynamic ranges."),
     .init            = init,
+    .uninit          = uninit,
     .priv_size       = sizeof(TonemapContext),
     .priv_class      = &tonemap_class,
     FILTER_INPUTS(tonemap_inputs),
     FILTER_OUTPUTS(tonemap_outputs),
-    FILTER_PIXFMTS(AV_PIX_FMT_GBRPF32, AV_PIX_FMT_GBRAPF32),
+    FILTER_QUERY_FUNC(query_formats),
     .flags           = AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal  = FF_FILTER_FLAG_FULL_OVERWRITE,
 };
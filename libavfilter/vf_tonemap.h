@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_TONEMAP_H
+#define AVFILTER_TONEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The YUV tonemap LUT is indexed by the TONEMAP_LUT_BITS most significant
+ * bits of the MSB-aligned 16-bit input Y, U and V; the following
+ * TONEMAP_LUT_FRAC_BITS bits are used to interpolate between grid points.
+ * Each entry holds the output Y, U and V in 8.6 fixed point, padded to
+ * 4 elements.
+ */
+#define TONEMAP_LUT_BITS        5
+#define TONEMAP_LUT_FRAC_BITS   5
+#define TONEMAP_LUT_SIZE        ((1 << TONEMAP_LUT_BITS) + 1)
+#define TONEMAP_LUT_OUT_BITS    6
+
+typedef struct TonemapDSPContext {
+    /**
+     * Map two lines of 4:2:0 MSB-aligned 16-bit YUV with interleaved chroma
+     * to 8-bit YUV with interleaved chroma.
+     *
+     * @param dsty       first output luma line
+     * @param dsty_stride distance in bytes to the second output luma line
+     * @param dstuv      output chroma line, w pairs of U and V
+     * @param srcy       first input luma line, 2 * w samples
+     * @param srcy_stride distance in bytes to the second input luma line
+     * @param srcuv      input chroma line, w pairs of U and V
+     * @param lut        TONEMAP_LUT_SIZE^3 entries of 4 int16_t
+     * @param w          number of chroma samples, must be > 0
+     */
+    void (*yuv420)(uint8_t *dsty, ptrdiff_t dsty_stride, uint8_t *dstuv,
+                   const uint16_t *srcy, ptrdiff_t srcy_stride,
+                   const uint16_t *srcuv, const int16_t *lut, int w);
+} TonemapDSPContext;
+
+void ff_tonemap_init_aarch64(TonemapDSPContext *dsp);
+void ff_tonemap_init_x86(TonemapDSPContext *dsp);
+
+#endif /* AVFILTER_TONEMAP_H */
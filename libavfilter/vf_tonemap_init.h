@@ -0,0 +1,104 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_TONEMAP_INIT_H
+#define AVFILTER_TONEMAP_INIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "vf_tonemap.h"
+
+#define LUT_STEP_V  4
+#define LUT_STEP_U  (LUT_STEP_V * TONEMAP_LUT_SIZE)
+#define LUT_STEP_Y  (LUT_STEP_U * TONEMAP_LUT_SIZE)
+
+#define LERP(a, b, f) ((a) + ((((b) - (a)) * (f)) >> TONEMAP_LUT_FRAC_BITS))
+
+/**
+ * Trilinear interpolation of one pixel. U and V are shared by the 4 pixels
+ * of a chroma sample, so their offset and fractions are computed once by
+ * the caller.
+ */
+static av_always_inline void tonemap_pixel(int out[3], const int16_t *lut,
+                                           int y, int fu, int fv)
+{
+    const int shift = 16 - TONEMAP_LUT_BITS - TONEMAP_LUT_FRAC_BITS;
+    const int mask  = (1 << TONEMAP_LUT_FRAC_BITS) - 1;
+    const int16_t *p = lut + (y >> (16 - TONEMAP_LUT_BITS)) * LUT_STEP_Y;
+    const int fy = (y >> shift) & mask;
+
+    for (int i = 0; i < 3; i++) {
+        const int c00 = LERP(p[i],                           p[i + LUT_STEP_V],                           fv);
+        const int c01 = LERP(p[i + LUT_STEP_U],              p[i + LUT_STEP_U + LUT_STEP_V],              fv);
+        const int c10 = LERP(p[i + LUT_STEP_Y],              p[i + LUT_STEP_Y + LUT_STEP_V],              fv);
+        const int c11 = LERP(p[i + LUT_STEP_Y + LUT_STEP_U], p[i + LUT_STEP_Y + LUT_STEP_U + LUT_STEP_V], fv);
+        const int c0  = LERP(c00, c01, fu);
+        const int c1  = LERP(c10, c11, fu);
+        out[i] = LERP(c0, c1, fy);
+    }
+}
+
+static void tonemap_yuv420_c(uint8_t *dsty, ptrdiff_t dsty_stride, uint8_t *dstuv,
+                             const uint16_t *srcy, ptrdiff_t srcy_stride,
+                             const uint16_t *srcuv, const int16_t *lut, int w)
+{
+    const int shift = 16 - TONEMAP_LUT_BITS - TONEMAP_LUT_FRAC_BITS;
+    const int mask  = (1 << TONEMAP_LUT_FRAC_BITS) - 1;
+    const int round = 1 << (TONEMAP_LUT_OUT_BITS - 1);
+    const uint16_t *srcy1 = (const uint16_t *)((const uint8_t *)srcy + srcy_stride);
+    uint8_t *dsty1 = dsty + dsty_stride;
+
+    for (int x = 0; x < w; x++) {
+        const int u = srcuv[2 * x], v = srcuv[2 * x + 1];
+        const int16_t *p = lut + (u >> (16 - TONEMAP_LUT_BITS)) * LUT_STEP_U +
+                                 (v >> (16 - TONEMAP_LUT_BITS)) * LUT_STEP_V;
+        const int fu = (u >> shift) & mask, fv = (v >> shift) & mask;
+        int c[4][3];
+
+        tonemap_pixel(c[0], p, srcy [2 * x    ], fu, fv);
+        tonemap_pixel(c[1], p, srcy [2 * x + 1], fu, fv);
+        tonemap_pixel(c[2], p, srcy1[2 * x    ], fu, fv);
+        tonemap_pixel(c[3], p, srcy1[2 * x + 1], fu, fv);
+
+        dsty [2 * x    ] = av_clip_uint8((c[0][0] + round) >> TONEMAP_LUT_OUT_BITS);
+        dsty [2 * x + 1] = av_clip_uint8((c[1][0] + round) >> TONEMAP_LUT_OUT_BITS);
+        dsty1[2 * x    ] = av_clip_uint8((c[2][0] + round) >> TONEMAP_LUT_OUT_BITS);
+        dsty1[2 * x + 1] = av_clip_uint8((c[3][0] + round) >> TONEMAP_LUT_OUT_BITS);
+        dstuv[2 * x    ] = av_clip_uint8((c[0][1] + c[1][1] + c[2][1] + c[3][1] + 4 * round)
+                                         >> (TONEMAP_LUT_OUT_BITS + 2));
+        dstuv[2 * x + 1] = av_clip_uint8((c[0][2] + c[1][2] + c[2][2] + c[3][2] + 4 * round)
+                                         >> (TONEMAP_LUT_OUT_BITS + 2));
+    }
+}
+
+static av_unused av_cold void ff_tonemap_init(TonemapDSPContext *dsp)
+{
+    dsp->yuv420 = tonemap_yuv420_c;
+
+#if ARCH_AARCH64
+    ff_tonemap_init_aarch64(dsp);
+#elif ARCH_X86
+    ff_tonemap_init_x86(dsp);
+#endif
+}
+
+#endif /* AVFILTER_TONEMAP_INIT_H */
@@ -45,6 +45,10 @@ AVFrame *ff_default_get_video_buffer2(AVFilterLink *link, int w, int h, int alig
     int pool_height = 0;
     int pool_align = 0;
     enum AVPixelFormat pool_format = AV_PIX_FMT_NONE;
+    /* skip zeroing new buffers when the filter fills every frame anyway */
+    AVBufferRef *(*alloc)(size_t size) =
+        link->src->filter->flags_internal & FF_FILTER_FLAG_FULL_OVERWRITE ?
+        ff_frame_pool_buffer_alloc : ff_frame_pool_buffer_allocz;
 
     if (link->hw_frames_ctx &&
         ((AVHWFramesContext*)link->hw_frames_ctx->data)->format == link->format) {
@@ -62,7 +66,7 @@ AVFrame *ff_default_get_video_buffer2(AVFilterLink *link, int w, int h, int alig
     }
 
     if (!link->frame_pool) {
-        link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
+        link->frame_pool = ff_frame_pool_video_init(alloc, w, h,
                                                     link->format, align);
         if (!link->frame_pool)
             return NULL;
@@ -77,7 +81,7 @@ AVFrame *ff_default_get_video_buffer2(AVFilterLink *link, int w, int h, int alig
             pool_format != link->format || pool_align != align) {
 
             ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
+            link->frame_pool = ff_frame_pool_video_init(alloc, w, h,
                                                         link->format, align);
             if (!link->frame_pool)
                 return NULL;
@@ -449,4 +449,5 @@ const AVFilter ff_vsrc_life = {
     .inputs        = NULL,
     FILTER_OUTPUTS(life_outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags_internal = FF_FILTER_FLAG_UNCACHEABLE_FORMATS,
 };
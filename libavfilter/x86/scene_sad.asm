@@ -71,4 +71,40 @@ SAD_FRAMES
 INIT_YMM avx2
 SAD_FRAMES
 
+; The absolute differences of 16-bit samples are widened to 64 bits before
+; being accumulated.
+cglobal scene_sad16, 6, 7, 6, src1, stride1, src2, stride2, width, end, x
+    add     src1q, widthq
+    add     src2q, widthq
+    neg    widthq
+    pxor       m1, m1
+    pxor       m5, m5
+
+.nextrow:
+    mov        xq, widthq
+
+    .loop:
+        movu            m0, [src1q + xq]
+        movu            m2, [src2q + xq]
+        psubusw         m3, m0, m2
+        psubusw         m2, m0
+        por             m3, m2
+        punpcklwd       m0, m3, m5
+        punpckhwd       m3, m5
+        paddd           m0, m3
+        punpckldq       m2, m0, m5
+        punpckhdq       m0, m5
+        paddq           m1, m2
+        paddq           m1, m0
+        add             xq, mmsize
+    jl .loop
+    add     src1q, stride1q
+    add     src2q, stride2q
+    sub      endd, 1
+    jg .nextrow
+
+    mov         r0q, r6mp
+    movu      [r0q], m1      ; sum
+    RET
+
 %endif
@@ -36,10 +36,29 @@ static void FUNC_NAME(SCENE_SAD_PARAMS) {                                     \
     *sum += sad[0];                                                           \
 }
 
+/* the asm function takes the width in bytes */
+#define SCENE_SAD16_FUNC(FUNC_NAME, ASM_FUNC_NAME, MMSIZE)                    \
+void ASM_FUNC_NAME(SCENE_SAD_PARAMS);                                         \
+                                                                              \
+static void FUNC_NAME(SCENE_SAD_PARAMS) {                                     \
+    uint64_t sad[MMSIZE / 8] = {0};                                           \
+    ptrdiff_t awidth = width & ~(MMSIZE / 2 - 1);                             \
+    *sum = 0;                                                                 \
+    if (awidth)                                                               \
+        ASM_FUNC_NAME(src1, stride1, src2, stride2, awidth * 2, height, sad); \
+    for (int i = 0; i < MMSIZE / 8; i++)                                      \
+        *sum += sad[i];                                                       \
+    ff_scene_sad16_c(src1 + awidth * 2, stride1,                              \
+                     src2 + awidth * 2, stride2,                              \
+                     width - awidth, height, sad);                            \
+    *sum += sad[0];                                                           \
+}
+
 #if HAVE_X86ASM
 SCENE_SAD_FUNC(scene_sad_sse2, ff_scene_sad_sse2, 16)
 #if HAVE_AVX2_EXTERNAL
 SCENE_SAD_FUNC(scene_sad_avx2, ff_scene_sad_avx2, 32)
+SCENE_SAD16_FUNC(scene_sad16_avx2, ff_scene_sad16_avx2, 32)
 #endif
 #endif
 
@@ -55,6 +74,10 @@ ff_scene_sad_fn ff_scene_sad_get_fn_x86(int depth)
         if (EXTERNAL_SSE2(cpu_flags))
             return scene_sad_sse2;
     }
+#if HAVE_AVX2_EXTERNAL
+    if (depth == 16 && EXTERNAL_AVX2_FAST(cpu_flags))
+        return scene_sad16_avx2;
+#endif
 #endif
     return NULL;
 }
@@ -0,0 +1,145 @@
+;*****************************************************************************
+;* x86-optimized functions for tonemap filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_32:  times 8 dd 32
+pd_128: times 4 dd 128
+
+; LUT steps in bytes along V, U and Y, for 33 grid points of 4 int16_t
+%define STEP_V 8
+%define STEP_U (STEP_V * 33)
+%define STEP_Y (STEP_U * 33)
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; load one LUT vertex of two pixels, pixel a in the low lane
+%macro LOAD_VERTEX 2 ; dst, offset
+    movq              xm%1, [ptraq + %2]
+    movhps            xm%1, [ptrbq + %2]
+    pmovsxwd           m%1, xm%1
+%endmacro
+
+%macro LERP 3 ; a, b, fraction
+    psubd              m%2, m%1
+    pmulld             m%2, %3
+    psrad              m%2, 5
+    paddd              m%1, m%2
+%endmacro
+
+; interpolate the Y, U and V outputs of two horizontally adjacent pixels
+; m14 = U fraction, m15 = V fraction, uvoffq = LUT offset of the chroma sample
+%macro TONEMAP_PAIR 3 ; dst, src a, src b
+    movzx              yad, word %2
+    movzx              ybd, word %3
+    mov              ptrad, yad
+    mov              ptrbd, ybd
+    shr              ptrad, 11
+    shr              ptrbd, 11
+    imul             ptrad, ptrad, STEP_Y
+    imul             ptrbd, ptrbd, STEP_Y
+    add              ptraq, uvoffq
+    add              ptrbq, uvoffq
+    shr                yad, 6
+    shr                ybd, 6
+    and                yad, 31
+    and                ybd, 31
+    movd              xm13, yad
+    movd              xm12, ybd
+    vpbroadcastd      xm13, xm13
+    vpbroadcastd      xm12, xm12
+    vinserti128        m13, m13, xm12, 1
+    LOAD_VERTEX          0, 0
+    LOAD_VERTEX          1, STEP_V
+    LOAD_VERTEX          2, STEP_U
+    LOAD_VERTEX          3, STEP_U + STEP_V
+    LOAD_VERTEX          4, STEP_Y
+    LOAD_VERTEX          5, STEP_Y + STEP_V
+    LOAD_VERTEX          6, STEP_Y + STEP_U
+    LOAD_VERTEX          7, STEP_Y + STEP_U + STEP_V
+    LERP                 0, 1, m15
+    LERP                 2, 3, m15
+    LERP                 4, 5, m15
+    LERP                 6, 7, m15
+    LERP                 0, 2, m14
+    LERP                 4, 6, m14
+    LERP                 0, 4, m13
+    mova                %1, m0
+%endmacro
+
+INIT_YMM avx2
+cglobal tonemap_yuv420, 8, 13, 16, dsty, dstride, dstuv, srcy, sstride, srcuv, lut, w, uvoff, ptra, ptrb, ya, yb
+.loop:
+    movzx            uvoffd, word [srcuvq]
+    movzx             ptrbd, word [srcuvq + 2]
+    mov                yad, uvoffd
+    mov                ybd, ptrbd
+    shr                yad, 6
+    shr                ybd, 6
+    and                yad, 31
+    and                ybd, 31
+    movd              xm14, yad
+    movd              xm15, ybd
+    vpbroadcastd       m14, xm14
+    vpbroadcastd       m15, xm15
+    shr             uvoffd, 11
+    shr              ptrbd, 11
+    imul            uvoffd, uvoffd, STEP_U
+    add             uvoffq, lutq
+    lea             uvoffq, [uvoffq + ptrbq * 8]
+
+    TONEMAP_PAIR        m8, [srcyq], [srcyq + 2]
+    TONEMAP_PAIR        m9, [srcyq + sstrideq], [srcyq + sstrideq + 2]
+
+    ; chroma is the average of the 4 pixels
+    paddd              m10, m8, m9
+    vextracti128      xm11, m10, 1
+    paddd             xm10, xm11
+    paddd             xm10, [pd_128]
+    psrad             xm10, 8
+    packssdw          xm10, xm10
+    packuswb          xm10, xm10
+    psrldq            xm10, 1
+    pextrw         [dstuvq], xm10, 0
+
+    paddd               m8, [pd_32]
+    paddd               m9, [pd_32]
+    psrad               m8, 6
+    psrad               m9, 6
+    packssdw            m8, m9
+    packuswb            m8, m8
+    vextracti128       xm9, m8, 1
+    punpcklbw          xm8, xm9
+    pextrw          [dstyq], xm8, 0
+    pextrw [dstyq + dstrideq], xm8, 4
+
+    add              srcuvq, 4
+    add               srcyq, 4
+    add              dstuvq, 2
+    add               dstyq, 2
+    dec                  wd
+    jg .loop
+    RET
+
+%endif
@@ -44,6 +44,7 @@
 #include "avio_internal.h"
 #include "id3v2.h"
 
+#include "hls_prefetch.h"
 #include "hls_sample_encryption.h"
 
 #define INITIAL_BUFFER_SIZE 32768
@@ -105,6 +106,8 @@ struct playlist {
     int input_read_done;
     AVIOContext *input_next;
     int input_next_requested;
+    int input_pipelined;
+    int input_prefetched;
     AVFormatContext *parent;
     int index;
     AVFormatContext *ctx;
@@ -224,7 +227,13 @@ typedef struct HLSContext {
     int max_reload;
     int http_persistent;
     int http_multiple;
+    int http_pipelining;
     int http_seekable;
+    int prefetch_segments;
+    int prefetch_threads;
+    int64_t prefetch_buffer_size;
+    int64_t prefetch_buffered;
+    HLSPrefetchContext *prefetch;
     AVIOContext *playlist_pb;
     HLSCryptoContext  crypto_ctx;
 } HLSContext;
@@ -1063,7 +1072,12 @@ static int read_from_url(struct playlist *pls, struct segment *seg,
     if (seg->size >= 0)
         buf_size = FFMIN(buf_size, seg->size - pls->cur_seg_offset);
 
-    ret = avio_read(pls->input, buf, buf_size);
+    if (pls->input_prefetched) {
+        HLSContext *c = pls->parent->priv_data;
+        ret = ff_hls_prefetch_read(c->prefetch, pls->index, pls->cur_seq_no, buf, buf_size);
+    } else {
+        ret = avio_read(pls->input, buf, buf_size);
+    }
     if (ret > 0)
         pls->cur_seg_offset += ret;
 
@@ -1464,6 +1478,39 @@ static int playlist_needed(struct playlist *pls)
     return 0;
 }
 
+/* queue the current and the following segments for background download */
+static void prefetch_segments(HLSContext *c, struct playlist *pls)
+{
+    int64_t seq_no;
+
+    ff_hls_prefetch_release(c->prefetch, pls->index, pls->cur_seq_no - 1);
+
+    for (seq_no = pls->cur_seq_no; seq_no < pls->cur_seq_no + c->prefetch_segments; seq_no++) {
+        int64_t n = seq_no - pls->start_seq_no;
+        AVDictionary *opts = NULL;
+        struct segment *seg;
+        int ret;
+
+        if (n < 0 || n >= pls->n_segments)
+            break;
+        seg = pls->segments[n];
+        /* keys are loaded by the demuxer thread, so encrypted
+         * segments are opened normally */
+        if (seg->key_type != KEY_NONE || !av_strstart(seg->url, "http", NULL))
+            break;
+
+        av_dict_copy(&opts, c->avio_opts, 0);
+        if (seg->size >= 0) {
+            av_dict_set_int(&opts, "offset", seg->url_offset, 0);
+            av_dict_set_int(&opts, "end_offset", seg->url_offset + seg->size, 0);
+        }
+        ret = ff_hls_prefetch_add(c->prefetch, pls->index, seq_no, seg->url, seg->size, opts);
+        av_dict_free(&opts);
+        if (ret < 0)
+            break;
+    }
+}
+
 static int read_data(void *opaque, uint8_t *buf, int buf_size)
 {
     struct playlist *v = opaque;
@@ -1477,7 +1524,7 @@ restart:
     if (!v->needed)
         return AVERROR_EOF;
 
-    if (!v->input || (c->http_persistent && v->input_read_done)) {
+    if ((!v->input && !v->input_prefetched) || (c->http_persistent && v->input_read_done)) {
         int64_t reload_interval;
 
         /* Check that the playlist is still needed before opening a new
@@ -1485,6 +1532,8 @@ restart:
         v->needed = playlist_needed(v);
 
         if (!v->needed) {
+            if (c->prefetch)
+                ff_hls_prefetch_cancel(c->prefetch, v->index);
             av_log(v->parent, AV_LOG_INFO, "No longer receiving playlist %d ('%s')\n",
                    v->index, v->url);
             return AVERROR_EOF;
@@ -1548,7 +1597,16 @@ reload:
         if (ret)
             return ret;
 
-        if (c->http_multiple == 1 && v->input_next_requested) {
+        if (c->prefetch)
+            prefetch_segments(c, v);
+
+        if (c->prefetch && ff_hls_prefetch_contains(c->prefetch, v->index, v->cur_seq_no)) {
+            ff_format_io_close(v->parent, &v->input);
+            v->input_read_done  = 0;
+            v->input_prefetched = 1;
+            v->cur_seg_offset   = 0;
+            ret = 0;
+        } else if (c->http_multiple == 1 && v->input_next_requested) {
             FFSWAP(AVIOContext *, v->input, v->input_next);
             v->cur_seg_offset = 0;
             v->input_next_requested = 0;
@@ -1566,9 +1624,10 @@ reload:
             goto reload;
         }
         just_opened = 1;
+        v->input_pipelined = 0;
     }
 
-    if (c->http_multiple == -1) {
+    if (c->http_multiple == -1 && v->input) {
         uint8_t *http_version_opt = NULL;
         int r = av_opt_get(v->input, "http_version", AV_OPT_SEARCH_CHILDREN, &http_version_opt);
         if (r >= 0) {
@@ -1578,7 +1637,7 @@ reload:
     }
 
     seg = next_segment(v);
-    if (c->http_multiple == 1 && !v->input_next_requested &&
+    if (c->http_multiple == 1 && !v->input_next_requested && !c->prefetch &&
         seg && seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL)) {
         ret = open_input(c, v, seg, &v->input_next);
         if (ret < 0) {
@@ -1592,6 +1651,24 @@ reload:
         }
     }
 
+#if CONFIG_HTTP_PROTOCOL
+    if (c->http_pipelining && c->http_persistent && c->http_multiple != 1 &&
+        v->input && !v->input_pipelined && seg && seg->key_type == KEY_NONE &&
+        seg->init_section == current_segment(v)->init_section &&
+        av_strstart(seg->url, "http", NULL)) {
+        URLContext *uc = ffio_geturlcontext(v->input);
+        v->input_pipelined = 1;
+        if (uc) {
+            ret = ff_http_pipeline_request(uc, seg->url,
+                                           seg->size >= 0 ? seg->url_offset : 0,
+                                           seg->size >= 0 ? seg->url_offset + seg->size : 0);
+            if (ret < 0)
+                av_log(v->parent, AV_LOG_DEBUG, "Could not pipeline request for segment %"PRId64" of playlist %d\n",
+                       v->cur_seq_no + 1, v->index);
+        }
+    }
+#endif
+
     if (v->init_sec_buf_read_offset < v->init_sec_data_len) {
         /* Push init section out first before first actual segment */
         int copy_size = FFMIN(v->init_sec_data_len - v->init_sec_buf_read_offset, buf_size);
@@ -1611,7 +1688,10 @@ reload:
 
         return ret;
     }
-    if (c->http_persistent &&
+    if (v->input_prefetched) {
+        ff_hls_prefetch_release(c->prefetch, v->index, v->cur_seq_no);
+        v->input_prefetched = 0;
+    } else if (c->http_persistent &&
         seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL)) {
         v->input_read_done = 1;
     } else {
@@ -1904,6 +1984,7 @@ static int hls_close(AVFormatContext *s)
 {
     HLSContext *c = s->priv_data;
 
+    ff_hls_prefetch_free(&c->prefetch);
     free_playlist_list(c);
     free_variant_list(c);
     free_rendition_list(c);
@@ -1938,6 +2019,17 @@ static int hls_read_header(AVFormatContext *s)
        the range header */
     av_dict_set_int(&c->avio_opts, "seekable", c->http_seekable, 0);
 
+    if (c->prefetch_segments > 0) {
+        AVDictionaryEntry *rw_timeout = av_dict_get(c->avio_opts, "rw_timeout", NULL, 0);
+
+        ret = ff_hls_prefetch_init(&c->prefetch, s, c->prefetch_threads,
+                                   c->prefetch_buffer_size,
+                                   rw_timeout ? strtoll(rw_timeout->value, NULL, 10) : 0);
+        if (ret < 0)
+            av_log(s, AV_LOG_WARNING, "Segment prefetching unavailable: %s\n",
+                   av_err2str(ret));
+    }
+
     if ((ret = parse_playlist(c, s->url, NULL, s->pb)) < 0)
         return ret;
 
@@ -2223,6 +2315,9 @@ static int recheck_discard_flags(AVFormatContext *s, int first)
             }
             av_log(s, AV_LOG_INFO, "Now receiving playlist %d, segment %"PRId64"\n", i, pls->cur_seq_no);
         } else if (first && !cur_needed && pls->needed) {
+            if (c->prefetch)
+                ff_hls_prefetch_cancel(c->prefetch, i);
+            pls->input_prefetched = 0;
             ff_format_io_close(pls->parent, &pls->input);
             pls->input_read_done = 0;
             ff_format_io_close(pls->parent, &pls->input_next);
@@ -2285,6 +2380,9 @@ static int hls_read_packet(AVFormatContext *s, AVPacket *pkt)
     recheck_discard_flags(s, c->first_packet);
     c->first_packet = 0;
 
+    if (c->prefetch)
+        c->prefetch_buffered = ff_hls_prefetch_buffered(c->prefetch);
+
     for (i = 0; i < c->n_playlists; i++) {
         struct playlist *pls = c->playlists[i];
         /* Make sure we've got one buffered packet from each open playlist
@@ -2475,10 +2573,14 @@ static int hls_read_seek(AVFormatContext *s, int stream_index,
     seek_pls->cur_seq_no = seq_no;
     seek_pls->seek_stream_index = stream_subdemuxer_index;
 
+    if (c->prefetch)
+        ff_hls_prefetch_cancel(c->prefetch, -1);
+
     for (i = 0; i < c->n_playlists; i++) {
         /* Reset reading */
         struct playlist *pls = c->playlists[i];
         AVIOContext *const pb = &pls->pb.pub;
+        pls->input_prefetched = 0;
         ff_format_io_close(pls->parent, &pls->input);
         pls->input_read_done = 0;
         ff_format_io_close(pls->parent, &pls->input_next);
@@ -2544,8 +2646,18 @@ static const AVOption hls_options[] = {
         OFFSET(http_persistent), AV_OPT_TYPE_BOOL, {.i64 = 1}, 0, 1, FLAGS },
     {"http_multiple", "Use multiple HTTP connections for fetching segments",
         OFFSET(http_multiple), AV_OPT_TYPE_BOOL, {.i64 = -1}, -1, 1, FLAGS},
+    {"http_pipelining", "Request the next segment on the persistent connection before the current one is read",
+        OFFSET(http_pipelining), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, FLAGS},
     {"http_seekable", "Use HTTP partial requests, 0 = disable, 1 = enable, -1 = auto",
         OFFSET(http_seekable), AV_OPT_TYPE_BOOL, { .i64 = -1}, -1, 1, FLAGS},
+    {"prefetch_segments", "Number of upcoming segments to download in the background, 0 to disable",
+        OFFSET(prefetch_segments), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 16, FLAGS},
+    {"prefetch_threads", "Number of threads downloading prefetched segments",
+        OFFSET(prefetch_threads), AV_OPT_TYPE_INT, {.i64 = 2}, 1, 16, FLAGS},
+    {"prefetch_buffer_size", "Do not start prefetching more segments while this many bytes are buffered",
+        OFFSET(prefetch_buffer_size), AV_OPT_TYPE_INT64, {.i64 = 32 * 1024 * 1024}, 0, INT64_MAX, FLAGS},
+    {"prefetch_buffered", "Number of bytes currently held by the segment prefetch buffer",
+        OFFSET(prefetch_buffered), AV_OPT_TYPE_INT64, {.i64 = 0}, 0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY},
     {"seg_format_options", "Set options for segment demuxer",
         OFFSET(seg_format_opts), AV_OPT_TYPE_DICT, {.str = NULL}, 0, 0, FLAGS},
     {NULL}
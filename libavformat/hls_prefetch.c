@@ -0,0 +1,507 @@
+/*
+ * Apple HTTP Live Streaming segment prefetching
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "libavutil/error.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+
+#include "avio_internal.h"
+#include "hls_prefetch.h"
+#include "url.h"
+
+#if HAVE_THREADS
+
+#define READ_SIZE (64 * 1024)
+
+enum SegmentState {
+    SEGMENT_QUEUED,
+    SEGMENT_LOADING,
+    SEGMENT_DONE,
+};
+
+typedef struct PrefetchSegment {
+    int playlist;
+    int64_t seq_no;
+    char *url;
+    int64_t size;
+    AVDictionary *opts;
+
+    enum SegmentState state;
+    int error;              ///< result of the download once done
+    int wanted;             ///< the demuxer is waiting for this segment
+    atomic_int abort;       ///< dropped while loading, the worker frees it
+
+    uint8_t *data;
+    unsigned int data_size;
+    unsigned int alloc_size;
+    unsigned int read_pos;
+
+    struct PrefetchSegment *next;
+} PrefetchSegment;
+
+typedef struct PrefetchWorker {
+    HLSPrefetchContext *pc;
+    PrefetchSegment *seg;
+    uint8_t *buf;
+    pthread_t thread;
+    int thread_started;
+} PrefetchWorker;
+
+struct HLSPrefetchContext {
+    AVFormatContext *s;
+
+    PrefetchWorker *workers;
+    int nb_workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /* queued segments, in queue order */
+    PrefetchSegment *segments;
+    int64_t buffered;
+    int64_t max_buffered;
+    int64_t rw_timeout;
+    atomic_int quit;
+};
+
+static void segment_free(PrefetchSegment **pseg)
+{
+    PrefetchSegment *seg = *pseg;
+
+    av_freep(&seg->url);
+    av_dict_free(&seg->opts);
+    av_freep(&seg->data);
+    av_freep(pseg);
+}
+
+/* unlink *pseg from the queue, must be called with the lock held */
+static void segment_drop(HLSPrefetchContext *pc, PrefetchSegment **pseg)
+{
+    PrefetchSegment *seg = *pseg;
+
+    *pseg = seg->next;
+    pc->buffered -= seg->data_size;
+    if (seg->state == SEGMENT_LOADING)
+        atomic_store(&seg->abort, 1);
+    else
+        segment_free(&seg);
+}
+
+static PrefetchSegment *find_segment(HLSPrefetchContext *pc, int playlist, int64_t seq_no)
+{
+    PrefetchSegment *seg;
+
+    for (seg = pc->segments; seg; seg = seg->next)
+        if (seg->playlist == playlist && seg->seq_no == seq_no)
+            return seg;
+    return NULL;
+}
+
+/* segments the demuxer waits for go first, others only within the budget */
+static PrefetchSegment *next_queued_segment(HLSPrefetchContext *pc)
+{
+    PrefetchSegment *seg, *first = NULL;
+
+    for (seg = pc->segments; seg; seg = seg->next) {
+        if (seg->state != SEGMENT_QUEUED)
+            continue;
+        if (seg->wanted)
+            return seg;
+        if (!first)
+            first = seg;
+    }
+    return first && pc->buffered < pc->max_buffered ? first : NULL;
+}
+
+static int worker_interrupt_cb(void *opaque)
+{
+    PrefetchWorker *w = opaque;
+    HLSPrefetchContext *pc = w->pc;
+
+    return atomic_load(&pc->quit) || atomic_load(&w->seg->abort) ||
+           ff_check_interrupt(&pc->s->interrupt_callback);
+}
+
+static int load_segment(PrefetchWorker *w, PrefetchSegment *seg)
+{
+    HLSPrefetchContext *pc = w->pc;
+    AVFormatContext *s = pc->s;
+    const AVIOInterruptCB int_cb = { worker_interrupt_cb, w };
+    AVDictionary *opts = NULL;
+    AVIOContext *pb = NULL;
+    int64_t remaining = seg->size;
+    int ret;
+
+    av_dict_copy(&opts, seg->opts, 0);
+    ret = ffio_open_whitelist(&pb, seg->url, AVIO_FLAG_READ, &int_cb, &opts,
+                              s->protocol_whitelist, s->protocol_blacklist);
+    av_dict_free(&opts);
+    if (ret < 0)
+        return ret;
+
+    while (remaining) {
+        int len = remaining > 0 ? FFMIN(remaining, READ_SIZE) : READ_SIZE;
+        uint8_t *data;
+
+        ret = avio_read(pb, w->buf, len);
+        if (ret <= 0)
+            break;
+        len = ret;
+
+        pthread_mutex_lock(&pc->lock);
+        if (atomic_load(&seg->abort)) {
+            ret = AVERROR_EXIT;
+        } else if (seg->data_size > UINT_MAX - len ||
+                   !(data = av_fast_realloc(seg->data, &seg->alloc_size,
+                                            seg->data_size + len))) {
+            ret = AVERROR(ENOMEM);
+        } else {
+            seg->data = data;
+            memcpy(seg->data + seg->data_size, w->buf, len);
+            seg->data_size += len;
+            pc->buffered   += len;
+            pthread_cond_broadcast(&pc->cond);
+        }
+        pthread_mutex_unlock(&pc->lock);
+        if (ret < 0)
+            break;
+
+        if (remaining > 0)
+            remaining -= len;
+    }
+    avio_closep(&pb);
+
+    return ret == AVERROR_EOF ? 0 : FFMIN(ret, 0);
+}
+
+static void *prefetch_worker(void *arg)
+{
+    PrefetchWorker *w = arg;
+    HLSPrefetchContext *pc = w->pc;
+
+    pthread_mutex_lock(&pc->lock);
+    while (!atomic_load(&pc->quit)) {
+        PrefetchSegment *seg = next_queued_segment(pc);
+        int ret;
+
+        if (!seg) {
+            pthread_cond_wait(&pc->cond, &pc->lock);
+            continue;
+        }
+        seg->state = SEGMENT_LOADING;
+        w->seg     = seg;
+        pthread_mutex_unlock(&pc->lock);
+
+        ret = load_segment(w, seg);
+
+        pthread_mutex_lock(&pc->lock);
+        w->seg = NULL;
+        if (atomic_load(&seg->abort)) {
+            segment_free(&seg);
+        } else {
+            if (ret < 0 && ret != AVERROR_EXIT)
+                av_log(pc->s, AV_LOG_WARNING, "Failed to prefetch segment '%s': %s\n",
+                       seg->url, av_err2str(ret));
+            seg->state = SEGMENT_DONE;
+            seg->error = ret;
+        }
+        pthread_cond_broadcast(&pc->cond);
+    }
+    pthread_mutex_unlock(&pc->lock);
+
+    return NULL;
+}
+
+int ff_hls_prefetch_init(HLSPrefetchContext **ppc, AVFormatContext *s,
+                         int nb_threads, int64_t max_buffered, int64_t rw_timeout)
+{
+    HLSPrefetchContext *pc;
+    int i, ret;
+
+    pc = av_mallocz(sizeof(*pc));
+    if (!pc)
+        return AVERROR(ENOMEM);
+    pc->s            = s;
+    pc->max_buffered = max_buffered;
+    pc->rw_timeout   = rw_timeout;
+    atomic_init(&pc->quit, 0);
+
+    if ((ret = pthread_mutex_init(&pc->lock, NULL))) {
+        av_free(pc);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pc->cond, NULL))) {
+        pthread_mutex_destroy(&pc->lock);
+        av_free(pc);
+        return AVERROR(ret);
+    }
+    *ppc = pc;
+
+    pc->workers = av_calloc(nb_threads, sizeof(*pc->workers));
+    if (!pc->workers) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    pc->nb_workers = nb_threads;
+
+    for (i = 0; i < nb_threads; i++) {
+        PrefetchWorker *w = &pc->workers[i];
+
+        w->pc  = pc;
+        w->buf = av_malloc(READ_SIZE);
+        if (!w->buf) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        if ((ret = pthread_create(&w->thread, NULL, prefetch_worker, w))) {
+            ret = AVERROR(ret);
+            goto fail;
+        }
+        w->thread_started = 1;
+    }
+
+    return 0;
+fail:
+    ff_hls_prefetch_free(ppc);
+    return ret;
+}
+
+void ff_hls_prefetch_free(HLSPrefetchContext **ppc)
+{
+    HLSPrefetchContext *pc = *ppc;
+    int i;
+
+    if (!pc)
+        return;
+
+    pthread_mutex_lock(&pc->lock);
+    atomic_store(&pc->quit, 1);
+    pthread_cond_broadcast(&pc->cond);
+    pthread_mutex_unlock(&pc->lock);
+
+    for (i = 0; i < pc->nb_workers; i++) {
+        PrefetchWorker *w = &pc->workers[i];
+        if (w->thread_started)
+            pthread_join(w->thread, NULL);
+        av_freep(&w->buf);
+    }
+    av_freep(&pc->workers);
+
+    while (pc->segments) {
+        PrefetchSegment *seg = pc->segments;
+        pc->segments = seg->next;
+        segment_free(&seg);
+    }
+
+    pthread_cond_destroy(&pc->cond);
+    pthread_mutex_destroy(&pc->lock);
+    av_freep(ppc);
+}
+
+int ff_hls_prefetch_add(HLSPrefetchContext *pc, int playlist, int64_t seq_no,
+                        const char *url, int64_t size, const AVDictionary *opts)
+{
+    PrefetchSegment *seg, **p;
+    int ret = 0;
+
+    pthread_mutex_lock(&pc->lock);
+    if (find_segment(pc, playlist, seq_no))
+        goto end;
+
+    seg = av_mallocz(sizeof(*seg));
+    if (!seg) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    seg->playlist = playlist;
+    seg->seq_no   = seq_no;
+    seg->size     = size;
+    seg->url      = av_strdup(url);
+    atomic_init(&seg->abort, 0);
+    if (!seg->url || (ret = av_dict_copy(&seg->opts, opts, 0)) < 0) {
+        segment_free(&seg);
+        ret = ret < 0 ? ret : AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (p = &pc->segments; *p; p = &(*p)->next)
+        ;
+    *p = seg;
+    pthread_cond_broadcast(&pc->cond);
+end:
+    pthread_mutex_unlock(&pc->lock);
+    return ret;
+}
+
+int ff_hls_prefetch_contains(HLSPrefetchContext *pc, int playlist, int64_t seq_no)
+{
+    int ret;
+
+    pthread_mutex_lock(&pc->lock);
+    ret = !!find_segment(pc, playlist, seq_no);
+    pthread_mutex_unlock(&pc->lock);
+    return ret;
+}
+
+int ff_hls_prefetch_read(HLSPrefetchContext *pc, int playlist, int64_t seq_no,
+                         uint8_t *buf, int buf_size)
+{
+    PrefetchSegment *seg;
+    int64_t wait_start = av_gettime_relative();
+    int ret;
+
+    pthread_mutex_lock(&pc->lock);
+    seg = find_segment(pc, playlist, seq_no);
+    if (!seg) {
+        ret = AVERROR(ENOENT);
+        goto end;
+    }
+    if (!seg->wanted) {
+        seg->wanted = 1;
+        pthread_cond_broadcast(&pc->cond);
+    }
+    while (seg->read_pos == seg->data_size && seg->state != SEGMENT_DONE) {
+        /* wake up regularly to honour the interrupt callback and rw_timeout,
+         * as a blocking read of the segment would */
+        int64_t t = av_gettime() + 100000;
+        struct timespec tv = { .tv_sec  =  t / 1000000,
+                               .tv_nsec = (t % 1000000) * 1000 };
+
+        if (ff_check_interrupt(&pc->s->interrupt_callback)) {
+            ret = AVERROR_EXIT;
+            goto end;
+        }
+        if (pc->rw_timeout > 0 && av_gettime_relative() - wait_start > pc->rw_timeout) {
+            ret = AVERROR(ETIMEDOUT);
+            goto end;
+        }
+        ret = pthread_cond_timedwait(&pc->cond, &pc->lock, &tv);
+        if (ret && ret != ETIMEDOUT) {
+            ret = AVERROR(ret);
+            goto end;
+        }
+        /* the segment may have been dropped by a cancel meanwhile */
+        if (!(seg = find_segment(pc, playlist, seq_no))) {
+            ret = AVERROR(ENOENT);
+            goto end;
+        }
+    }
+
+    if (seg->read_pos < seg->data_size) {
+        ret = FFMIN(buf_size, seg->data_size - seg->read_pos);
+        memcpy(buf, seg->data + seg->read_pos, ret);
+        seg->read_pos += ret;
+    } else {
+        ret = seg->error < 0 ? seg->error : AVERROR_EOF;
+    }
+end:
+    pthread_mutex_unlock(&pc->lock);
+    return ret;
+}
+
+void ff_hls_prefetch_release(HLSPrefetchContext *pc, int playlist, int64_t seq_no)
+{
+    PrefetchSegment **p;
+
+    pthread_mutex_lock(&pc->lock);
+    for (p = &pc->segments; *p; ) {
+        if ((*p)->playlist == playlist && (*p)->seq_no <= seq_no)
+            segment_drop(pc, p);
+        else
+            p = &(*p)->next;
+    }
+    pthread_cond_broadcast(&pc->cond);
+    pthread_mutex_unlock(&pc->lock);
+}
+
+void ff_hls_prefetch_cancel(HLSPrefetchContext *pc, int playlist)
+{
+    PrefetchSegment **p;
+
+    pthread_mutex_lock(&pc->lock);
+    for (p = &pc->segments; *p; ) {
+        if (playlist < 0 || (*p)->playlist == playlist)
+            segment_drop(pc, p);
+        else
+            p = &(*p)->next;
+    }
+    pthread_cond_broadcast(&pc->cond);
+    pthread_mutex_unlock(&pc->lock);
+}
+
+int64_t ff_hls_prefetch_buffered(HLSPrefetchContext *pc)
+{
+    int64_t ret;
+
+    pthread_mutex_lock(&pc->lock);
+    ret = pc->buffered;
+    pthread_mutex_unlock(&pc->lock);
+    return ret;
+}
+
+#else /* HAVE_THREADS */
+
+int ff_hls_prefetch_init(HLSPrefetchContext **pc, AVFormatContext *s,
+                         int nb_threads, int64_t max_buffered, int64_t rw_timeout)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_hls_prefetch_free(HLSPrefetchContext **pc)
+{
+}
+
+int ff_hls_prefetch_add(HLSPrefetchContext *pc, int playlist, int64_t seq_no,
+                        const char *url, int64_t size, const AVDictionary *opts)
+{
+    return AVERROR(ENOSYS);
+}
+
+int ff_hls_prefetch_contains(HLSPrefetchContext *pc, int playlist, int64_t seq_no)
+{
+    return 0;
+}
+
+int ff_hls_prefetch_read(HLSPrefetchContext *pc, int playlist, int64_t seq_no,
+                         uint8_t *buf, int buf_size)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_hls_prefetch_release(HLSPrefetchContext *pc, int playlist, int64_t seq_no)
+{
+}
+
+void ff_hls_prefetch_cancel(HLSPrefetchContext *pc, int playlist)
+{
+}
+
+int64_t ff_hls_prefetch_buffered(HLSPrefetchContext *pc)
+{
+    return 0;
+}
+
+#endif /* HAVE_THREADS */
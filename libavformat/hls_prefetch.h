@@ -0,0 +1,105 @@
+/*
+ * Apple HTTP Live Streaming segment prefetching
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Background download of upcoming HLS media segments into memory.
+ *
+ * Segments are identified by the index of their playlist and their media
+ * sequence number. A pool of worker threads downloads queued segments in
+ * queue order, as long as the total amount of buffered data stays below a
+ * limit. The demuxer reads a segment while it is still being downloaded.
+ */
+
+#ifndef AVFORMAT_HLS_PREFETCH_H
+#define AVFORMAT_HLS_PREFETCH_H
+
+#include <stdint.h>
+
+#include "libavutil/dict.h"
+#include "avformat.h"
+
+typedef struct HLSPrefetchContext HLSPrefetchContext;
+
+/**
+ * Start the prefetch worker threads.
+ *
+ * @param s            demuxer context, used for logging, interrupt callback
+ *                     and protocol white/blacklists
+ * @param nb_threads   number of worker threads
+ * @param max_buffered do not start new downloads while more than this many
+ *                     bytes are buffered
+ * @param rw_timeout   maximum time in microseconds ff_hls_prefetch_read()
+ *                     waits for data, 0 for no limit
+ * @return 0 on success, AVERROR(ENOSYS) if built without threads
+ */
+int ff_hls_prefetch_init(HLSPrefetchContext **pc, AVFormatContext *s,
+                         int nb_threads, int64_t max_buffered, int64_t rw_timeout);
+
+/**
+ * Stop the worker threads and free all buffered segments.
+ */
+void ff_hls_prefetch_free(HLSPrefetchContext **pc);
+
+/**
+ * Queue a segment for download, unless it is queued already.
+ *
+ * @param opts options for opening the url, copied
+ * @param size maximum number of bytes to read, -1 for everything
+ */
+int ff_hls_prefetch_add(HLSPrefetchContext *pc, int playlist, int64_t seq_no,
+                        const char *url, int64_t size, const AVDictionary *opts);
+
+/**
+ * @return 1 if the segment is queued, downloading or downloaded
+ */
+int ff_hls_prefetch_contains(HLSPrefetchContext *pc, int playlist, int64_t seq_no);
+
+/**
+ * Read the next bytes of a queued segment, waiting for them to be
+ * downloaded if necessary. The wait ends early with AVERROR_EXIT when the
+ * interrupt callback of the demuxer triggers and with AVERROR(ETIMEDOUT)
+ * after rw_timeout.
+ *
+ * @return number of bytes read, AVERROR_EOF at the end of the segment,
+ * another negative error code if the download failed or the segment is
+ * not queued
+ */
+int ff_hls_prefetch_read(HLSPrefetchContext *pc, int playlist, int64_t seq_no,
+                         uint8_t *buf, int buf_size);
+
+/**
+ * Drop all segments of a playlist up to and including seq_no,
+ * aborting their download if it is in progress.
+ */
+void ff_hls_prefetch_release(HLSPrefetchContext *pc, int playlist, int64_t seq_no);
+
+/**
+ * Drop all segments of a playlist, or of all playlists if playlist is
+ * negative, e.g. on seeking.
+ */
+void ff_hls_prefetch_cancel(HLSPrefetchContext *pc, int playlist);
+
+/**
+ * @return number of bytes currently held in the prefetch buffer
+ */
+int64_t ff_hls_prefetch_buffered(HLSPrefetchContext *pc);
+
+#endif /* AVFORMAT_HLS_PREFETCH_H */
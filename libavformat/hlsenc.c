@@ -40,8 +40,10 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/opt.h"
 #include "libavutil/log.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/time_internal.h"
+#include "libavutil/tree.h"
 
 #include "avformat.h"
 #include "avio_internal.h"
@@ -89,8 +91,18 @@ typedef struct HLSSegment {
 
     struct HLSSegment *next;
     double discont_program_date_time;
+    int64_t sequence;
 } HLSSegment;
 
+/* Partial segment of a low-latency playlist */
+typedef struct HLSPart {
+    char *path;         /* output path of the part file */
+    char *uri;          /* name of the part in the playlist */
+    double duration;    /* in seconds */
+    int independent;    /* starts with a keyframe */
+    int64_t sequence;   /* media sequence number of the parent segment */
+} HLSPart;
+
 typedef enum HLSFlags {
     // Generate a single media file and use byte ranges in the playlist.
     HLS_SINGLE_FILE = (1 << 0),
@@ -108,6 +120,7 @@ typedef enum HLSFlags {
     HLS_PERIODIC_REKEY = (1 << 12),
     HLS_INDEPENDENT_SEGMENTS = (1 << 13),
     HLS_I_FRAMES_ONLY = (1 << 14),
+    HLS_INCREMENTAL_PLAYLIST = (1 << 15),
 } HLSFlags;
 
 typedef enum {
@@ -152,6 +165,22 @@ typedef struct VariantStream {
     HLSSegment *segments;
     HLSSegment *last_segment;
     HLSSegment *old_segments;
+    struct AVTreeNode *segment_index; // segments and old_segments by filename
+
+    AVIOContext *pl_out;         // playlist kept open in incremental mode
+    HLSSegment *pl_last;         // last segment written to pl_out
+    int64_t pl_target_pos;       // offset of the target duration slot
+    int pl_target_duration;
+    double pl_prog_date_time;
+    int pl_incremental_failed;   // fall back to rewriting the playlist
+
+    HLSPart *parts;
+    int nb_parts;
+    unsigned int parts_size;
+    int part_index;        // index of the next part in the current segment
+    int part_independent;  // the next part starts with a keyframe
+    int64_t part_start_pts;
+    int64_t part_start_pos; // start of the next part in the segment dynbuf
 
     char *basename_tmp;
     char *basename;
@@ -185,6 +214,8 @@ typedef struct VariantStream {
     const char *varname;  /* variant name */
 } VariantStream;
 
+typedef struct HLSWriter HLSWriter;
+
 typedef struct ClosedCaptionsStream {
     const char *ccgroup;    /* closed caption group name */
     const char *instreamid; /* closed captions INSTREAM-ID */
@@ -255,6 +286,10 @@ typedef struct HLSContext {
     char *headers;
     int has_default_key; /* has DEFAULT field of var_stream_map */
     int has_video_m3u8; /* has video stream m3u8 list */
+    int async_io;
+    HLSWriter *writer; /* background writer, set when async_io is active */
+    int64_t part_time;      ///< partial segment duration, low-latency mode if set
+    int can_block_reload;
 } HLSContext;
 
 static int strftime_expand(const char *fmt, char **dest)
@@ -583,6 +618,484 @@ static int hls_delete_file(HLSContext *hls, AVFormatContext *avf,
     return 0;
 }
 
+#if HAVE_THREADS
+/* Upper bound on queued writer jobs; the muxer blocks once it is reached. */
+#define WRITER_MAX_JOBS 64
+
+enum HLSWriteJobType {
+    JOB_WRITE,  ///< write buf (prefixed with styp if requested) to url
+    JOB_RENAME, ///< rename url to new_url
+    JOB_DELETE, ///< delete an old segment at url
+};
+
+typedef struct HLSWriteJob {
+    enum HLSWriteJobType type;
+    char *url;
+    char *new_url;
+    AVDictionary *options;
+    int styp;
+    uint8_t *buf;
+    int size;
+    AVFormatContext *avf;
+    const char *proto;
+    struct HLSWriteJob *next;
+} HLSWriteJob;
+
+struct HLSWriter {
+    AVFormatContext *s;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t job_cond;
+    pthread_cond_t space_cond;
+    HLSWriteJob *first, *last;
+    int nb_jobs;
+    int stop;
+    int error;
+};
+
+static void writer_job_free(HLSWriteJob **pjob)
+{
+    HLSWriteJob *job = *pjob;
+
+    if (!job)
+        return;
+    av_freep(&job->url);
+    av_freep(&job->new_url);
+    av_dict_free(&job->options);
+    av_freep(&job->buf);
+    av_freep(pjob);
+}
+
+static int writer_exec_write(AVFormatContext *s, HLSWriteJob *job)
+{
+    HLSContext *hls = s->priv_data;
+    AVIOContext *pb = NULL;
+    AVDictionary *options = NULL;
+    int ret, retried = 0;
+
+    for (;;) {
+        av_dict_copy(&options, job->options, 0);
+        ret = s->io_open(s, &pb, job->url, AVIO_FLAG_WRITE, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
+                   "Failed to open file '%s'\n", job->url);
+            return ret;
+        }
+        if (job->styp)
+            write_styp(pb);
+        avio_write(pb, job->buf, job->size);
+        avio_flush(pb);
+        ret = pb->error;
+        if (ret >= 0)
+            ret = ff_format_io_close(s, &pb);
+        else
+            ff_format_io_close(s, &pb);
+        if (ret >= 0 || retried++)
+            return ret;
+        av_log(s, AV_LOG_WARNING, "upload of '%s' failed,"
+               " will retry with a new http session.\n", job->url);
+    }
+}
+
+static void *writer_thread(void *arg)
+{
+    HLSWriter *w = arg;
+    AVFormatContext *s = w->s;
+    HLSContext *hls = s->priv_data;
+
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        HLSWriteJob *job;
+        int ret = 0;
+
+        while (!w->first && !w->stop)
+            pthread_cond_wait(&w->job_cond, &w->lock);
+        if (!w->first)
+            break;
+        job = w->first;
+        w->first = job->next;
+        if (!w->first)
+            w->last = NULL;
+        pthread_mutex_unlock(&w->lock);
+
+        switch (job->type) {
+        case JOB_WRITE:
+            ret = writer_exec_write(s, job);
+            break;
+        case JOB_RENAME:
+            ret = ff_rename(job->url, job->new_url, s);
+            break;
+        case JOB_DELETE:
+            ret = hls_delete_file(hls, job->avf, job->url, job->proto);
+            break;
+        }
+        if (hls->ignore_io_errors && ret < 0)
+            ret = 0;
+        writer_job_free(&job);
+
+        pthread_mutex_lock(&w->lock);
+        if (ret < 0 && !w->error)
+            w->error = ret;
+        w->nb_jobs--;
+        pthread_cond_broadcast(&w->space_cond);
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return NULL;
+}
+
+static int writer_start(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+    HLSWriter *w;
+    int ret;
+
+    w = av_mallocz(sizeof(*w));
+    if (!w)
+        return AVERROR(ENOMEM);
+    w->s = s;
+
+    if ((ret = pthread_mutex_init(&w->lock, NULL)))
+        goto fail_free;
+    if ((ret = pthread_cond_init(&w->job_cond, NULL)))
+        goto fail_mutex;
+    if ((ret = pthread_cond_init(&w->space_cond, NULL)))
+        goto fail_job_cond;
+    if ((ret = pthread_create(&w->thread, NULL, writer_thread, w)))
+        goto fail_space_cond;
+
+    hls->writer = w;
+    return 0;
+
+fail_space_cond:
+    pthread_cond_destroy(&w->space_cond);
+fail_job_cond:
+    pthread_cond_destroy(&w->job_cond);
+fail_mutex:
+    pthread_mutex_destroy(&w->lock);
+fail_free:
+    av_free(w);
+    return AVERROR(ret);
+}
+
+/**
+ * Wait for all queued jobs to complete and stop the writer thread.
+ * Returns the first error a job ran into, if any.
+ */
+static int writer_stop(HLSContext *hls)
+{
+    HLSWriter *w = hls->writer;
+    int ret;
+
+    if (!w)
+        return 0;
+
+    pthread_mutex_lock(&w->lock);
+    w->stop = 1;
+    pthread_cond_broadcast(&w->job_cond);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+
+    ret = w->error;
+    pthread_cond_destroy(&w->space_cond);
+    pthread_cond_destroy(&w->job_cond);
+    pthread_mutex_destroy(&w->lock);
+    av_freep(&hls->writer);
+
+    return ret;
+}
+
+/* Takes ownership of job, also on failure. */
+static int writer_submit(HLSWriter *w, HLSWriteJob *job)
+{
+    int ret;
+
+    pthread_mutex_lock(&w->lock);
+    while (w->nb_jobs >= WRITER_MAX_JOBS && !w->error)
+        pthread_cond_wait(&w->space_cond, &w->lock);
+    ret = w->error;
+    if (ret >= 0) {
+        if (w->last)
+            w->last->next = job;
+        else
+            w->first = job;
+        w->last = job;
+        w->nb_jobs++;
+        pthread_cond_signal(&w->job_cond);
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    if (ret < 0)
+        writer_job_free(&job);
+    return ret;
+}
+
+static HLSWriteJob *writer_job_alloc(enum HLSWriteJobType type,
+                                     const char *url, const char *new_url)
+{
+    HLSWriteJob *job = av_mallocz(sizeof(*job));
+
+    if (!job)
+        return NULL;
+    job->type = type;
+    job->url  = av_strdup(url);
+    if (new_url)
+        job->new_url = av_strdup(new_url);
+    if (!job->url || (new_url && !job->new_url))
+        writer_job_free(&job);
+    return job;
+}
+
+/**
+ * Queue writing buf to url. Ownership of buf is passed to the writer,
+ * the contents are not copied.
+ */
+static int writer_queue_write(HLSContext *hls, const char *url,
+                              AVDictionary **options, int styp,
+                              uint8_t *buf, int size)
+{
+    HLSWriteJob *job = writer_job_alloc(JOB_WRITE, url, NULL);
+
+    if (!job) {
+        av_free(buf);
+        return AVERROR(ENOMEM);
+    }
+    job->options = *options;
+    *options     = NULL;
+    job->styp    = styp;
+    job->buf     = buf;
+    job->size    = size;
+    return writer_submit(hls->writer, job);
+}
+#else
+static int writer_stop(HLSContext *hls)
+{
+    return 0;
+}
+#endif /* HAVE_THREADS */
+
+static int hls_queue_delete(HLSContext *hls, AVFormatContext *avf,
+                            const char *path, const char *proto)
+{
+#if HAVE_THREADS
+    if (hls->writer) {
+        HLSWriteJob *job = writer_job_alloc(JOB_DELETE, path, NULL);
+        if (!job)
+            return AVERROR(ENOMEM);
+        job->avf   = avf;
+        job->proto = proto;
+        return writer_submit(hls->writer, job);
+    }
+#endif
+    return hls_delete_file(hls, avf, path, proto);
+}
+
+static int hls_rename(HLSContext *hls, const char *url_src,
+                      const char *url_dst, void *logctx)
+{
+#if HAVE_THREADS
+    if (hls->writer) {
+        HLSWriteJob *job = writer_job_alloc(JOB_RENAME, url_src, url_dst);
+        if (!job)
+            return AVERROR(ENOMEM);
+        return writer_submit(hls->writer, job);
+    }
+#endif
+    return ff_rename(url_src, url_dst, logctx);
+}
+
+/* Playlists are rendered into a dynamic buffer when the writer is active. */
+static int playlist_open(AVFormatContext *s, AVIOContext **pb,
+                         const char *filename, AVDictionary **options)
+{
+    HLSContext *hls = s->priv_data;
+
+    if (hls->writer)
+        return avio_open_dyn_buf(pb);
+    return hlsenc_io_open(s, pb, filename, options);
+}
+
+/**
+ * Close a playlist opened with playlist_open() and, if final_filename
+ * is set, rename it from filename to final_filename afterwards.
+ */
+static int playlist_close(AVFormatContext *s, AVIOContext **pb,
+                          char *filename, const char *final_filename)
+{
+    HLSContext *hls = s->priv_data;
+    int ret;
+
+    if (!*pb)
+        return 0;
+#if HAVE_THREADS
+    if (hls->writer) {
+        AVDictionary *options = NULL;
+        uint8_t *buf;
+        int size;
+
+        size = avio_close_dyn_buf(*pb, &buf);
+        *pb = NULL;
+        set_http_options(s, &options, hls);
+        ret = writer_queue_write(hls, filename, &options, 0, buf, size);
+        av_dict_free(&options);
+        if (ret < 0)
+            return ret;
+        return final_filename ? hls_rename(hls, filename, final_filename, s) : 0;
+    }
+#endif
+    ret = hlsenc_io_close(s, pb, filename);
+    if (ret >= 0 && final_filename)
+        ff_rename(filename, final_filename, s);
+    return ret;
+}
+
+/**
+ * Hand the buffered segment data of vs over to the writer, which writes
+ * it to filename. The dynamic buffer is not copied but detached and
+ * replaced with a new one.
+ */
+static int queue_dynbuf(AVFormatContext *s, VariantStream *vs,
+                        const char *filename, AVDictionary **options)
+{
+#if HAVE_THREADS
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *ctx = vs->avf;
+    uint8_t *buf;
+    int size, ret;
+
+    if (!ctx->pb)
+        return AVERROR(EINVAL);
+
+    av_write_frame(ctx, NULL);
+    size = avio_close_dyn_buf(ctx->pb, &buf);
+    ctx->pb = NULL;
+    if ((ret = avio_open_dyn_buf(&ctx->pb)) < 0) {
+        av_free(buf);
+        return ret;
+    }
+
+    return writer_queue_write(hls, filename, options,
+                              hls->segment_type == SEGMENT_TYPE_FMP4, buf, size);
+#else
+    return AVERROR(ENOSYS);
+#endif
+}
+
+static void free_part(HLSPart *part)
+{
+    av_freep(&part->path);
+    av_freep(&part->uri);
+}
+
+/**
+ * Build the output path and the playlist URI of part index of the current
+ * segment, e.g. out5.part2.m4s for the segment out5.m4s.
+ */
+static int part_filename(HLSContext *hls, VariantStream *vs, int index,
+                         char **path, char **uri)
+{
+    const char *url = vs->avf->url;
+    size_t len = strlen(url);
+    const char *dot;
+    char *base;
+
+    if ((hls->flags & HLS_TEMP_FILE) && len > 4 && !strcmp(url + len - 4, ".tmp"))
+        len -= 4;
+    base = av_strndup(url, len);
+    if (!base)
+        return AVERROR(ENOMEM);
+
+    dot = strrchr(av_basename(base), '.');
+    if (dot)
+        *path = av_asprintf("%.*s.part%d%s", (int)(dot - base), base, index, dot);
+    else
+        *path = av_asprintf("%s.part%d", base, index);
+    av_free(base);
+    if (!*path)
+        return AVERROR(ENOMEM);
+
+    *uri = av_strdup(hls->use_localtime_mkdir ? *path : av_basename(*path));
+    if (!*uri) {
+        av_freep(path);
+        return AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
+/* Drop the parts of all but the last three complete segments. */
+static int prune_parts(HLSContext *hls, VariantStream *vs)
+{
+    int i, ret = 0;
+
+    for (i = 0; i < vs->nb_parts && vs->parts[i].sequence < vs->sequence - 3; i++) {
+        HLSPart *part = &vs->parts[i];
+        if (hls->flags & HLS_DELETE_SEGMENTS) {
+            int err = hls_queue_delete(hls, vs->avf, part->path,
+                                       avio_find_protocol_name(part->path));
+            if (err < 0 && ret >= 0)
+                ret = err;
+        }
+        free_part(part);
+    }
+    vs->nb_parts -= i;
+    memmove(vs->parts, vs->parts + i, vs->nb_parts * sizeof(*vs->parts));
+
+    return ret;
+}
+
+static void write_parts(AVIOContext *out, HLSContext *hls, VariantStream *vs,
+                        int64_t sequence)
+{
+    for (int i = 0; i < vs->nb_parts; i++) {
+        const HLSPart *part = &vs->parts[i];
+        if (part->sequence == sequence)
+            ff_hls_write_part(out, part->duration, hls->baseurl,
+                              part->uri, part->independent);
+    }
+}
+
+/* Order segments by filename; segments sharing a name are ordered by address. */
+static int segment_cmp(const void *a, const void *b)
+{
+    const HLSSegment *sa = a, *sb = b;
+    int ret = av_strcasecmp(sa->filename, sb->filename);
+
+    if (ret)
+        return ret;
+    return ((uintptr_t)sa > (uintptr_t)sb) - ((uintptr_t)sa < (uintptr_t)sb);
+}
+
+static int segment_filename_cmp(const void *filename, const void *b)
+{
+    const HLSSegment *segment = b;
+    return av_strcasecmp(filename, segment->filename);
+}
+
+static int segment_index_add(VariantStream *vs, HLSSegment *en)
+{
+    struct AVTreeNode *node = av_tree_node_alloc();
+
+    if (!node)
+        return AVERROR(ENOMEM);
+    av_tree_insert(&vs->segment_index, en, segment_cmp, &node);
+    av_free(node);
+    return 0;
+}
+
+static void segment_index_remove(VariantStream *vs, HLSSegment *en)
+{
+    struct AVTreeNode *node = NULL;
+
+    av_tree_insert(&vs->segment_index, en, segment_cmp, &node);
+    av_free(node);
+}
+
+static HLSSegment *find_segment_by_filename(VariantStream *vs, const char *filename)
+{
+    return av_tree_find(vs->segment_index, (void *)filename, segment_filename_cmp, NULL);
+}
+
 static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls,
                                    VariantStream *vs)
 {
@@ -660,7 +1173,7 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls,
         }
 
         proto = avio_find_protocol_name(s->url);
-        if (ret = hls_delete_file(hls, vs->avf, path.str, proto))
+        if (ret = hls_queue_delete(hls, vs->avf, path.str, proto))
             goto fail;
 
         if ((segment->sub_filename[0] != '\0')) {
@@ -677,12 +1190,13 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls,
                 goto fail;
             }
 
-            if (ret = hls_delete_file(hls, vs->vtt_avf, path.str, proto))
+            if (ret = hls_queue_delete(hls, vs->vtt_avf, path.str, proto))
                 goto fail;
         }
         av_bprint_clear(&path);
         previous_segment = segment;
         segment = previous_segment->next;
+        segment_index_remove(vs, previous_segment);
         av_freep(&previous_segment);
     }
 
@@ -956,16 +1470,6 @@ static int hls_mux_init(AVFormatContext *s, VariantStream *vs)
     return 0;
 }
 
-static HLSSegment *find_segment_by_filename(HLSSegment *segment, const char *filename)
-{
-    while (segment) {
-        if (!av_strcasecmp(segment->filename,filename))
-            return segment;
-        segment = segment->next;
-    }
-    return (HLSSegment *) NULL;
-}
-
 static int sls_flags_filename_process(struct AVFormatContext *s, HLSContext *hls,
                                       VariantStream *vs, HLSSegment *en,
                                       double duration, int64_t pos, int64_t size)
@@ -1052,7 +1556,7 @@ static int sls_flag_check_duration_size(HLSContext *hls, VariantStream *vs)
 static void sls_flag_file_rename(HLSContext *hls, VariantStream *vs, char *old_filename) {
     if ((hls->flags & (HLS_SECOND_LEVEL_SEGMENT_SIZE | HLS_SECOND_LEVEL_SEGMENT_DURATION)) &&
         strlen(vs->current_segment_final_filename_fmt)) {
-        ff_rename(old_filename, vs->avf->url, hls);
+        hls_rename(hls, old_filename, vs->avf->url, hls);
     }
 }
 
@@ -1124,11 +1628,14 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls,
     if (hls->use_localtime_mkdir) {
         filename = vs->avf->url;
     }
-    if ((find_segment_by_filename(vs->segments, filename) || find_segment_by_filename(vs->old_segments, filename))
-        && !byterange_mode) {
+    if (find_segment_by_filename(vs, filename) && !byterange_mode) {
         av_log(hls, AV_LOG_WARNING, "Duplicated segment filename detected: %s\n", filename);
     }
     av_strlcpy(en->filename, filename, sizeof(en->filename));
+    if ((ret = segment_index_add(vs, en)) < 0) {
+        av_freep(&en);
+        return ret;
+    }
 
     if (vs->has_subtitle)
         av_strlcpy(en->sub_filename, av_basename(vs->vtt_avf->url), sizeof(en->sub_filename));
@@ -1138,6 +1645,7 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls,
     en->duration = duration;
     en->pos      = pos;
     en->size     = size;
+    en->sequence = vs->sequence;
     en->keyframe_pos      = vs->video_keyframe_pos;
     en->keyframe_size     = vs->video_keyframe_size;
     en->next     = NULL;
@@ -1176,8 +1684,10 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls,
             vs->old_segments = en;
             if ((ret = hls_delete_old_segments(s, hls, vs)) < 0)
                 return ret;
-        } else
+        } else {
+            segment_index_remove(vs, en);
             av_freep(&en);
+        }
     } else
         vs->nb_entries++;
 
@@ -1322,7 +1832,7 @@ static int hls_rename_temp_file(AVFormatContext *s, AVFormatContext *oc)
     if (!final_filename)
         return AVERROR(ENOMEM);
     final_filename[len-4] = '\0';
-    ret = ff_rename(oc->url, final_filename, s);
+    ret = hls_rename(s->priv_data, oc->url, final_filename, s);
     oc->url[len-4] = '\0';
     av_freep(&final_filename);
     return ret;
@@ -1398,7 +1908,7 @@ static int create_master_playlist(AVFormatContext *s,
 
     set_http_options(s, &options, hls);
     snprintf(temp_filename, sizeof(temp_filename), use_temp_file ? "%s.tmp" : "%s", hls->master_m3u8_url);
-    ret = hlsenc_io_open(s, &hls->m3u8_out, temp_filename, &options);
+    ret = playlist_open(s, &hls->m3u8_out, temp_filename, &options);
     av_dict_free(&options);
     if (ret < 0) {
         av_log(s, AV_LOG_ERROR, "Failed to open master play list file '%s'\n",
@@ -1523,9 +2033,139 @@ static int create_master_playlist(AVFormatContext *s,
 fail:
     if (ret >=0)
         hls->master_m3u8_created = 1;
-    hlsenc_io_close(s, &hls->m3u8_out, temp_filename);
-    if (use_temp_file)
-        ff_rename(temp_filename, hls->master_m3u8_url, s);
+    playlist_close(s, &hls->m3u8_out, temp_filename,
+                   use_temp_file ? hls->master_m3u8_url : NULL);
+
+    return ret;
+}
+
+/**
+ * Write the playlist header of a variant stream, along with the tags
+ * preceding its first segment.
+ *
+ * @param target_duration_pos see ff_hls_write_playlist_header()
+ */
+static void write_playlist_header(HLSContext *hls, VariantStream *vs,
+                                  AVIOContext *out, int target_duration,
+                                  int64_t sequence, int64_t *target_duration_pos)
+{
+    ff_hls_write_playlist_header(out, hls->version, hls->allowcache,
+                                 target_duration, sequence, hls->pl_type,
+                                 hls->flags & HLS_I_FRAMES_ONLY,
+                                 target_duration_pos);
+
+    vs->discontinuity_set = 0;
+    if ((hls->flags & HLS_DISCONT_START) && sequence == hls->start_sequence) {
+        avio_printf(out, "#EXT-X-DISCONTINUITY\n");
+        vs->discontinuity_set = 1;
+    }
+    if (vs->has_video && (hls->flags & HLS_INDEPENDENT_SEGMENTS))
+        avio_printf(out, "#EXT-X-INDEPENDENT-SEGMENTS\n");
+}
+
+static int use_incremental_playlist(HLSContext *hls, VariantStream *vs)
+{
+    return (hls->flags & HLS_INCREMENTAL_PLAYLIST) && !hls->max_nb_segments &&
+           !vs->vtt_m3u8_name && !hls->writer && !hls->part_time &&
+           !vs->pl_incremental_failed;
+}
+
+/**
+ * Append the segments added since the last call to the playlist instead of
+ * rewriting it. The playlist stays open, the header is written once and only
+ * the target duration is patched when it grows.
+ */
+static int hls_window_incremental(AVFormatContext *s, int last, VariantStream *vs)
+{
+    HLSContext *hls = s->priv_data;
+    int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
+    int64_t sequence = byterange_mode ? 0 : FFMAX(hls->start_sequence, vs->sequence - vs->nb_entries);
+    const char *key_uri = NULL, *iv_string = NULL;
+    int target_duration = vs->pl_target_duration;
+    HLSSegment *en;
+    int ret = 0;
+
+    if (!vs->pl_out) {
+        AVDictionary *options = NULL;
+
+        set_http_options(s, &options, hls);
+        ret = hlsenc_io_open(s, &vs->pl_out, vs->m3u8_name, &options);
+        av_dict_free(&options);
+        if (ret < 0)
+            return hls->ignore_io_errors ? 0 : ret;
+        if (!(vs->pl_out->seekable & AVIO_SEEKABLE_NORMAL)) {
+            av_log(s, AV_LOG_WARNING, "Playlist output is not seekable, "
+                   "rewriting the playlist instead of appending to it\n");
+            ff_format_io_close(s, &vs->pl_out);
+            vs->pl_incremental_failed = 1;
+            return AVERROR(EAGAIN);
+        }
+
+        for (en = vs->segments; en; en = en->next)
+            target_duration = FFMAX(target_duration, lrint(en->duration));
+
+        write_playlist_header(hls, vs, vs->pl_out, target_duration, sequence,
+                              &vs->pl_target_pos);
+
+        vs->pl_target_duration = target_duration;
+        vs->pl_prog_date_time  = vs->initial_prog_date_time;
+        en = vs->segments;
+    } else {
+        key_uri   = vs->pl_last->key_uri;
+        iv_string = vs->pl_last->iv_string;
+        en = vs->pl_last->next;
+    }
+
+    for (; en; en = en->next) {
+        if (lrint(en->duration) > vs->pl_target_duration) {
+            int64_t pos = avio_tell(vs->pl_out);
+            vs->pl_target_duration = lrint(en->duration);
+            avio_seek(vs->pl_out, vs->pl_target_pos, SEEK_SET);
+            ff_hls_write_target_duration(vs->pl_out, vs->pl_target_duration, 1);
+            avio_seek(vs->pl_out, pos, SEEK_SET);
+        }
+
+        if ((hls->encrypt || hls->key_info_file) && (!key_uri || strcmp(en->key_uri, key_uri) ||
+                                    av_strcasecmp(en->iv_string, iv_string))) {
+            avio_printf(vs->pl_out, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"", en->key_uri);
+            if (*en->iv_string)
+                avio_printf(vs->pl_out, ",IV=0x%s", en->iv_string);
+            avio_printf(vs->pl_out, "\n");
+            key_uri = en->key_uri;
+            iv_string = en->iv_string;
+        }
+
+        if ((hls->segment_type == SEGMENT_TYPE_FMP4) && (en == vs->segments)) {
+            ff_hls_write_init_file(vs->pl_out, (hls->flags & HLS_SINGLE_FILE) ? en->filename : vs->fmp4_init_filename,
+                                   hls->flags & HLS_SINGLE_FILE, vs->init_range_length, 0);
+        }
+
+        ret = ff_hls_write_file_entry(vs->pl_out, en->discont, byterange_mode,
+                                      en->duration, hls->flags & HLS_ROUND_DURATIONS,
+                                      en->size, en->pos, hls->baseurl,
+                                      en->filename,
+                                      en->discont_program_date_time ? &en->discont_program_date_time :
+                                      (hls->flags & HLS_PROGRAM_DATE_TIME) ? &vs->pl_prog_date_time : NULL,
+                                      en->keyframe_size, en->keyframe_pos, hls->flags & HLS_I_FRAMES_ONLY);
+        if (ret < 0)
+            av_log(s, AV_LOG_WARNING, "ff_hls_write_file_entry get error\n");
+        vs->pl_last = en;
+    }
+
+    if (last) {
+        if (!(hls->flags & HLS_OMIT_ENDLIST))
+            ff_hls_write_end_list(vs->pl_out);
+        ret = ff_format_io_close(s, &vs->pl_out);
+    } else {
+        avio_flush(vs->pl_out);
+        ret = vs->pl_out->error;
+    }
+    if (ret < 0 && hls->ignore_io_errors)
+        ret = 0;
+
+    if (ret >= 0 && hls->master_pl_name)
+        if (create_master_playlist(s, vs) < 0)
+            av_log(s, AV_LOG_WARNING, "Master playlist creation failed\n");
 
     return ret;
 }
@@ -1575,9 +2215,15 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
     if (!is_file_proto && (hls->flags & HLS_TEMP_FILE) && !warned_non_file++)
         av_log(s, AV_LOG_ERROR, "Cannot use rename on non file protocol, this may lead to races and temporary partial files\n");
 
+    if (use_incremental_playlist(hls, vs)) {
+        ret = hls_window_incremental(s, last, vs);
+        if (ret != AVERROR(EAGAIN))
+            return ret;
+    }
+
     set_http_options(s, &options, hls);
     snprintf(temp_filename, sizeof(temp_filename), use_temp_file ? "%s.tmp" : "%s", vs->m3u8_name);
-    if ((ret = hlsenc_io_open(s, byterange_mode ? &hls->m3u8_out : &vs->out, temp_filename, &options)) < 0) {
+    if ((ret = playlist_open(s, byterange_mode ? &hls->m3u8_out : &vs->out, temp_filename, &options)) < 0) {
         if (hls->ignore_io_errors)
             ret = 0;
         goto fail;
@@ -1587,18 +2233,14 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
         if (target_duration <= en->duration)
             target_duration = lrint(en->duration);
     }
+    if (hls->part_time > 0 && !target_duration)
+        target_duration = lrint(hls->time / (double)AV_TIME_BASE);
 
-    vs->discontinuity_set = 0;
-    ff_hls_write_playlist_header(byterange_mode ? hls->m3u8_out : vs->out, hls->version, hls->allowcache,
-                                 target_duration, sequence, hls->pl_type, hls->flags & HLS_I_FRAMES_ONLY);
-
-    if ((hls->flags & HLS_DISCONT_START) && sequence==hls->start_sequence && vs->discontinuity_set==0) {
-        avio_printf(byterange_mode ? hls->m3u8_out : vs->out, "#EXT-X-DISCONTINUITY\n");
-        vs->discontinuity_set = 1;
-    }
-    if (vs->has_video && (hls->flags & HLS_INDEPENDENT_SEGMENTS)) {
-        avio_printf(byterange_mode ? hls->m3u8_out : vs->out, "#EXT-X-INDEPENDENT-SEGMENTS\n");
-    }
+    write_playlist_header(hls, vs, byterange_mode ? hls->m3u8_out : vs->out,
+                          target_duration, sequence, NULL);
+    if (hls->part_time > 0 && !last)
+        ff_hls_write_part_info(vs->out, hls->part_time / (double)AV_TIME_BASE,
+                               hls->can_block_reload);
     for (en = vs->segments; en; en = en->next) {
         if ((hls->encrypt || hls->key_info_file) && (!key_uri || strcmp(en->key_uri, key_uri) ||
                                     av_strcasecmp(en->iv_string, iv_string))) {
@@ -1615,6 +2257,9 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
                                    hls->flags & HLS_SINGLE_FILE, vs->init_range_length, 0);
         }
 
+        if (hls->part_time > 0 && !last)
+            write_parts(vs->out, hls, vs, en->sequence);
+
         ret = ff_hls_write_file_entry(byterange_mode ? hls->m3u8_out : vs->out, en->discont, byterange_mode,
                                       en->duration, hls->flags & HLS_ROUND_DURATIONS,
                                       en->size, en->pos, hls->baseurl,
@@ -1628,18 +2273,33 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
         }
     }
 
+    if (hls->part_time > 0 && !last) {
+        if (!vs->segments && vs->nb_parts)
+            ff_hls_write_init_file(vs->out, vs->fmp4_init_filename, 0, vs->init_range_length, 0);
+        write_parts(vs->out, hls, vs, vs->sequence);
+        /* The name of the next segment is not known before it is started. */
+        if (vs->part_index > 0) {
+            char *path, *uri;
+            if ((ret = part_filename(hls, vs, vs->part_index, &path, &uri)) < 0)
+                goto fail;
+            ff_hls_write_preload_hint(vs->out, hls->baseurl, uri);
+            av_free(path);
+            av_free(uri);
+        }
+    }
+
     if (last && (hls->flags & HLS_OMIT_ENDLIST)==0)
         ff_hls_write_end_list(byterange_mode ? hls->m3u8_out : vs->out);
 
     if (vs->vtt_m3u8_name) {
         snprintf(temp_vtt_filename, sizeof(temp_vtt_filename), use_temp_file ? "%s.tmp" : "%s", vs->vtt_m3u8_name);
-        if ((ret = hlsenc_io_open(s, &hls->sub_m3u8_out, temp_vtt_filename, &options)) < 0) {
+        if ((ret = playlist_open(s, &hls->sub_m3u8_out, temp_vtt_filename, &options)) < 0) {
             if (hls->ignore_io_errors)
                 ret = 0;
             goto fail;
         }
         ff_hls_write_playlist_header(hls->sub_m3u8_out, hls->version, hls->allowcache,
-                                     target_duration, sequence, PLAYLIST_TYPE_NONE, 0);
+                                     target_duration, sequence, PLAYLIST_TYPE_NONE, 0, NULL);
         for (en = vs->segments; en; en = en->next) {
             ret = ff_hls_write_file_entry(hls->sub_m3u8_out, 0, byterange_mode,
                                           en->duration, 0, en->size, en->pos,
@@ -1656,16 +2316,14 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
 
 fail:
     av_dict_free(&options);
-    ret = hlsenc_io_close(s, byterange_mode ? &hls->m3u8_out : &vs->out, temp_filename);
+    ret = playlist_close(s, byterange_mode ? &hls->m3u8_out : &vs->out, temp_filename,
+                         use_temp_file ? vs->m3u8_name : NULL);
     if (ret < 0) {
         return ret;
     }
-    hlsenc_io_close(s, &hls->sub_m3u8_out, vs->vtt_m3u8_name);
-    if (use_temp_file) {
-        ff_rename(temp_filename, vs->m3u8_name, s);
-        if (vs->vtt_m3u8_name)
-            ff_rename(temp_vtt_filename, vs->vtt_m3u8_name, s);
-    }
+    if (vs->vtt_m3u8_name)
+        playlist_close(s, &hls->sub_m3u8_out, temp_vtt_filename,
+                       use_temp_file ? vs->vtt_m3u8_name : NULL);
     if (ret >= 0 && hls->master_pl_name)
         if (create_master_playlist(s, vs) < 0)
             av_log(s, AV_LOG_WARNING, "Master playlist creation failed\n");
@@ -2400,6 +3058,119 @@ static int64_t append_single_file(AVFormatContext *s, VariantStream *vs)
 
     return ret;
 }
+/* Move the fMP4 initialization section out of the segment buffer. */
+static int write_fmp4_init(AVFormatContext *s, VariantStream *vs)
+{
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = vs->avf;
+    int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
+    int range_length;
+
+    range_length = avio_close_dyn_buf(oc->pb, &vs->init_buffer);
+    if (range_length <= 0)
+        return AVERROR(EINVAL);
+    avio_write(vs->out, vs->init_buffer, range_length);
+    if (!hls->resend_init_file)
+        av_freep(&vs->init_buffer);
+    vs->init_range_length = range_length;
+    avio_open_dyn_buf(&oc->pb);
+    vs->packets_written = 0;
+    vs->start_pos = range_length;
+    if (!byterange_mode) {
+        hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
+    }
+
+    return 0;
+}
+
+static int write_part_data(AVFormatContext *s, const char *path,
+                           const uint8_t *data, int size)
+{
+    HLSContext *hls = s->priv_data;
+    AVDictionary *options = NULL;
+    AVIOContext *pb = NULL;
+    int ret;
+
+    set_http_options(s, &options, hls);
+#if HAVE_THREADS
+    if (hls->writer) {
+        /* The segment buffer keeps growing, so the part has to be copied. */
+        uint8_t *buf = av_memdup(data, size);
+        if (!buf) {
+            av_dict_free(&options);
+            return AVERROR(ENOMEM);
+        }
+        ret = writer_queue_write(hls, path, &options, 0, buf, size);
+        av_dict_free(&options);
+        return ret;
+    }
+#endif
+    ret = s->io_open(s, &pb, path, AVIO_FLAG_WRITE, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
+               "Failed to open file '%s'\n", path);
+        return ret;
+    }
+    avio_write(pb, data, size);
+    return ff_format_io_close(s, &pb);
+}
+
+/**
+ * Close the current part of the segment being written at pts: flush a
+ * fragment and write everything muxed since the previous part to a part
+ * file. next_independent tells whether the following part starts with a
+ * keyframe.
+ */
+static int hls_cut_part(AVFormatContext *s, VariantStream *vs, int64_t pts,
+                        AVRational time_base, int next_independent)
+{
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = vs->avf;
+    HLSPart *part;
+    uint8_t *buf;
+    int size, ret;
+
+    if (!vs->init_range_length) {
+        /* The first flush only writes the moov box. */
+        av_write_frame(oc, NULL);
+        if ((ret = write_fmp4_init(s, vs)) < 0)
+            return ret;
+    }
+    av_write_frame(oc, NULL);
+    size = avio_get_dyn_buf(oc->pb, &buf);
+    if (size <= vs->part_start_pos)
+        return 0;
+
+    part = av_fast_realloc(vs->parts, &vs->parts_size,
+                           (vs->nb_parts + 1) * sizeof(*vs->parts));
+    if (!part)
+        return AVERROR(ENOMEM);
+    vs->parts = part;
+    part = &vs->parts[vs->nb_parts];
+    memset(part, 0, sizeof(*part));
+
+    if ((ret = part_filename(hls, vs, vs->part_index, &part->path, &part->uri)) < 0)
+        return ret;
+    ret = write_part_data(s, part->path, buf + vs->part_start_pos,
+                          size - vs->part_start_pos);
+    if (ret < 0) {
+        free_part(part);
+        return hls->ignore_io_errors ? 0 : ret;
+    }
+    part->duration    = (double)(pts - vs->part_start_pts) * time_base.num / time_base.den;
+    part->independent = vs->part_independent;
+    part->sequence    = vs->sequence;
+    vs->nb_parts++;
+
+    vs->part_index++;
+    vs->part_start_pts   = pts;
+    vs->part_start_pos   = size;
+    vs->part_independent = next_independent;
+
+    return prune_parts(hls, vs);
+}
+
 static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
 {
     HLSContext *hls = s->priv_data;
@@ -2496,25 +3267,17 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         int64_t new_start_pos;
         int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
 
+        if (hls->part_time > 0 && (ret = hls_cut_part(s, vs, pkt->pts, st->time_base, 0)) < 0)
+            return ret;
+
         av_write_frame(oc, NULL); /* Flush any buffered data */
         new_start_pos = avio_tell(oc->pb);
         vs->size = new_start_pos - vs->start_pos;
         avio_flush(oc->pb);
         if (hls->segment_type == SEGMENT_TYPE_FMP4) {
             if (!vs->init_range_length) {
-                range_length = avio_close_dyn_buf(oc->pb, &vs->init_buffer);
-                if (range_length <= 0)
-                    return AVERROR(EINVAL);
-                avio_write(vs->out, vs->init_buffer, range_length);
-                if (!hls->resend_init_file)
-                    av_freep(&vs->init_buffer);
-                vs->init_range_length = range_length;
-                avio_open_dyn_buf(&oc->pb);
-                vs->packets_written = 0;
-                vs->start_pos = range_length;
-                if (!byterange_mode) {
-                    hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
-                }
+                if ((ret = write_fmp4_init(s, vs)) < 0)
+                    return ret;
             }
         }
         if (!byterange_mode) {
@@ -2560,31 +3323,39 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
 
                 set_http_options(s, &options, hls);
 
-                ret = hlsenc_io_open(s, &vs->out, filename, &options);
-                if (ret < 0) {
-                    av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
-                           "Failed to open file '%s'\n", filename);
+                if (hls->writer) {
+                    ret = queue_dynbuf(s, vs, filename, &options);
                     av_freep(&filename);
                     av_dict_free(&options);
-                    return hls->ignore_io_errors ? 0 : ret;
-                }
-                if (hls->segment_type == SEGMENT_TYPE_FMP4) {
-                    write_styp(vs->out);
-                }
-                ret = flush_dynbuf(vs, &range_length);
-                if (ret < 0) {
-                    av_freep(&filename);
-                    av_dict_free(&options);
-                    return ret;
-                }
-                ret = hlsenc_io_close(s, &vs->out, filename);
-                if (ret < 0) {
-                    av_log(s, AV_LOG_WARNING, "upload segment failed,"
-                           " will retry with a new http session.\n");
-                    ff_format_io_close(s, &vs->out);
+                    if (ret < 0)
+                        return ret;
+                } else {
                     ret = hlsenc_io_open(s, &vs->out, filename, &options);
-                    reflush_dynbuf(vs, &range_length);
+                    if (ret < 0) {
+                        av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
+                               "Failed to open file '%s'\n", filename);
+                        av_freep(&filename);
+                        av_dict_free(&options);
+                        return hls->ignore_io_errors ? 0 : ret;
+                    }
+                    if (hls->segment_type == SEGMENT_TYPE_FMP4) {
+                        write_styp(vs->out);
+                    }
+                    ret = flush_dynbuf(vs, &range_length);
+                    if (ret < 0) {
+                        av_freep(&filename);
+                        av_dict_free(&options);
+                        return ret;
+                    }
                     ret = hlsenc_io_close(s, &vs->out, filename);
+                    if (ret < 0) {
+                        av_log(s, AV_LOG_WARNING, "upload segment failed,"
+                               " will retry with a new http session.\n");
+                        ff_format_io_close(s, &vs->out);
+                        ret = hlsenc_io_open(s, &vs->out, filename, &options);
+                        reflush_dynbuf(vs, &range_length);
+                        ret = hlsenc_io_close(s, &vs->out, filename);
+                    }
                 }
                 av_dict_free(&options);
                 av_freep(&vs->temp_buffer);
@@ -2611,6 +3382,13 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             }
         }
 
+        if (hls->part_time > 0) {
+            vs->part_index       = 0;
+            vs->part_start_pos   = 0;
+            vs->part_start_pts   = pkt->pts;
+            vs->part_independent = !vs->has_video || (pkt->flags & AV_PKT_FLAG_KEY);
+        }
+
         // if we're building a VOD playlist, skip writing the manifest multiple times, and just wait until the end
         if (hls->pl_type != PLAYLIST_TYPE_VOD) {
             if ((ret = hls_window(s, 0, vs)) < 0) {
@@ -2662,6 +3440,23 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         }
     }
 
+    if (hls->part_time > 0 && is_ref_pkt && oc == vs->avf) {
+        int independent = !vs->has_video || (pkt->flags & AV_PKT_FLAG_KEY);
+        if (vs->part_start_pts == AV_NOPTS_VALUE) {
+            vs->part_start_pts   = pkt->pts;
+            vs->part_independent = independent;
+        } else if (vs->packets_written &&
+                   av_compare_ts(pkt->pts + pkt->duration - vs->part_start_pts, st->time_base,
+                                 hls->part_time, AV_TIME_BASE_Q) > 0) {
+            /* Parts must not be longer than the part target, so cut before
+             * the packet that would make it exceed it. */
+            if ((ret = hls_cut_part(s, vs, pkt->pts, st->time_base, independent)) < 0)
+                return ret;
+            if (hls->pl_type != PLAYLIST_TYPE_VOD && (ret = hls_window(s, 0, vs)) < 0)
+                return ret;
+        }
+    }
+
     vs->packets_written++;
     if (oc->pb) {
         ret = ff_write_chained(oc, stream_index, pkt, s, 0);
@@ -2684,6 +3479,8 @@ static void hls_deinit(AVFormatContext *s)
     int i = 0;
     VariantStream *vs = NULL;
 
+    writer_stop(hls);
+
     for (i = 0; i < hls->nb_varstreams; i++) {
         vs = &hls->var_streams[i];
 
@@ -2697,8 +3494,13 @@ static void hls_deinit(AVFormatContext *s)
         avformat_free_context(vs->avf);
         if (hls->resend_init_file)
             av_freep(&vs->init_buffer);
+        av_tree_destroy(vs->segment_index);
         hls_free_segments(vs->segments);
         hls_free_segments(vs->old_segments);
+        ff_format_io_close(s, &vs->pl_out);
+        for (int j = 0; j < vs->nb_parts; j++)
+            free_part(&vs->parts[j]);
+        av_freep(&vs->parts);
         av_freep(&vs->m3u8_name);
         av_freep(&vs->streams);
     }
@@ -2724,6 +3526,14 @@ static int hls_write_trailer(struct AVFormatContext *s)
     VariantStream *vs = NULL;
     AVDictionary *options = NULL;
     int range_length, byterange_mode;
+    int writer_ret;
+
+    /* Let the writer finish pending segments and playlists; the final
+     * segment and playlist are written synchronously. */
+    writer_ret = writer_stop(hls);
+    if (writer_ret < 0)
+        av_log(s, AV_LOG_ERROR, "Asynchronous write failed: %s\n",
+               av_err2str(writer_ret));
 
     for (i = 0; i < hls->nb_varstreams; i++) {
         char *filename = NULL;
@@ -2846,7 +3656,7 @@ failed:
         av_free(old_filename);
     }
 
-    return 0;
+    return writer_ret;
 }
 
 
@@ -2938,6 +3748,20 @@ static int hls_init(AVFormatContext *s)
 
     hls->recording_time = hls->init_time ? hls->init_time : hls->time;
 
+    if (hls->part_time > 0) {
+        if (hls->segment_type != SEGMENT_TYPE_FMP4 ||
+            (hls->flags & HLS_SINGLE_FILE) || hls->max_seg_size > 0 ||
+            hls->pl_type == PLAYLIST_TYPE_VOD) {
+            av_log(s, AV_LOG_ERROR, "hls_part_time requires fmp4 segments in separate "
+                   "files and a live or event playlist\n");
+            return AVERROR(EINVAL);
+        }
+        if (hls->part_time > hls->time) {
+            av_log(s, AV_LOG_ERROR, "hls_part_time must not exceed hls_time\n");
+            return AVERROR(EINVAL);
+        }
+    }
+
     if (hls->flags & HLS_SPLIT_BY_TIME && hls->flags & HLS_INDEPENDENT_SEGMENTS) {
         // Independent segments cannot be guaranteed when splitting by time
         hls->flags &= ~HLS_INDEPENDENT_SEGMENTS;
@@ -2956,6 +3780,7 @@ static int hls_init(AVFormatContext *s)
         vs->sequence  = hls->start_sequence;
         vs->start_pts = AV_NOPTS_VALUE;
         vs->end_pts   = AV_NOPTS_VALUE;
+        vs->part_start_pts = AV_NOPTS_VALUE;
         vs->current_segment_final_filename_fmt[0] = '\0';
         vs->initial_prog_date_time = initial_program_date_time;
 
@@ -3098,6 +3923,21 @@ static int hls_init(AVFormatContext *s)
         vs->number++;
     }
 
+    if (hls->async_io) {
+#if HAVE_THREADS
+        if (hls->http_persistent) {
+            av_log(s, AV_LOG_WARNING, "async_io is not supported together with "
+                   "http_persistent, writing synchronously\n");
+        } else if ((ret = writer_start(s)) < 0) {
+            av_log(s, AV_LOG_ERROR, "Failed to start the writer thread\n");
+            return ret;
+        }
+#else
+        av_log(s, AV_LOG_WARNING, "async_io requires thread support, "
+               "writing synchronously\n");
+#endif
+    }
+
     return ret;
 }
 
@@ -3145,6 +3985,7 @@ static const AVOption options[] = {
     {"periodic_rekey", "reload keyinfo file periodically for re-keying", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_PERIODIC_REKEY }, 0, UINT_MAX,   E, "flags"},
     {"independent_segments", "add EXT-X-INDEPENDENT-SEGMENTS, whenever applicable", 0, AV_OPT_TYPE_CONST, { .i64 = HLS_INDEPENDENT_SEGMENTS }, 0, UINT_MAX, E, "flags"},
     {"iframes_only", "add EXT-X-I-FRAMES-ONLY, whenever applicable", 0, AV_OPT_TYPE_CONST, { .i64 = HLS_I_FRAMES_ONLY }, 0, UINT_MAX, E, "flags"},
+    {"incremental_playlist", "append new segments to the playlist instead of rewriting it when the list size is unlimited", 0, AV_OPT_TYPE_CONST, { .i64 = HLS_INCREMENTAL_PLAYLIST }, 0, UINT_MAX, E, "flags"},
     {"strftime", "set filename expansion with strftime at segment creation", OFFSET(use_localtime), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, E },
     {"strftime_mkdir", "create last directory component in strftime-generated filename", OFFSET(use_localtime_mkdir), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, E },
     {"hls_playlist_type", "set the HLS playlist type", OFFSET(pl_type), AV_OPT_TYPE_INT, {.i64 = PLAYLIST_TYPE_NONE }, 0, PLAYLIST_TYPE_NB-1, E, "pl_type" },
@@ -3165,6 +4006,9 @@ static const AVOption options[] = {
     {"timeout", "set timeout for socket I/O operations", OFFSET(timeout), AV_OPT_TYPE_DURATION, { .i64 = -1 }, -1, INT_MAX, .flags = E },
     {"ignore_io_errors", "Ignore IO errors for stable long-duration runs with network output", OFFSET(ignore_io_errors), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
     {"headers", "set custom HTTP headers, can override built in default headers", OFFSET(headers), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
+    {"async_io", "write segments and playlists from a background thread", OFFSET(async_io), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
+    {"hls_part_time", "set partial segment length for low-latency HLS", OFFSET(part_time), AV_OPT_TYPE_DURATION, { .i64 = 0 }, 0, INT64_MAX, E },
+    {"hls_can_block_reload", "advertise blocking playlist reload support in low-latency mode", OFFSET(can_block_reload), AV_OPT_TYPE_BOOL, { .i64 = 1 }, 0, 1, E },
     { NULL },
 };
 
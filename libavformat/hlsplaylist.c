@@ -22,6 +22,7 @@
 
 #include "config.h"
 #include <stdint.h>
+#include <string.h>
 
 #include "libavutil/time_internal.h"
 
@@ -95,9 +96,28 @@ void ff_hls_write_stream_info(AVStream *st, AVIOContext *out, int bandwidth,
     avio_printf(out, "\n%s\n\n", filename);
 }
 
+void ff_hls_write_target_duration(AVIOContext *out, int target_duration,
+                                  int padded)
+{
+    char buf[HLS_TARGET_DURATION_SLOT];
+    int len;
+
+    if (!padded) {
+        avio_printf(out, "#EXT-X-TARGETDURATION:%d\n", target_duration);
+        return;
+    }
+
+    /* pad with a comment line */
+    len = snprintf(buf, sizeof(buf), "#EXT-X-TARGETDURATION:%d\n#", target_duration);
+    memset(buf + len, ' ', sizeof(buf) - len - 1);
+    buf[sizeof(buf) - 1] = '\n';
+    avio_write(out, buf, sizeof(buf));
+}
+
 void ff_hls_write_playlist_header(AVIOContext *out, int version, int allowcache,
                                   int target_duration, int64_t sequence,
-                                  uint32_t playlist_type, int iframe_mode)
+                                  uint32_t playlist_type, int iframe_mode,
+                                  int64_t *target_duration_pos)
 {
     if (!out)
         return;
@@ -105,7 +125,9 @@ void ff_hls_write_playlist_header(AVIOContext *out, int version, int allowcache,
     if (allowcache == 0 || allowcache == 1) {
         avio_printf(out, "#EXT-X-ALLOW-CACHE:%s\n", allowcache == 0 ? "NO" : "YES");
     }
-    avio_printf(out, "#EXT-X-TARGETDURATION:%d\n", target_duration);
+    if (target_duration_pos)
+        *target_duration_pos = avio_tell(out);
+    ff_hls_write_target_duration(out, target_duration, !!target_duration_pos);
     avio_printf(out, "#EXT-X-MEDIA-SEQUENCE:%"PRId64"\n", sequence);
     av_log(NULL, AV_LOG_VERBOSE, "EXT-X-MEDIA-SEQUENCE:%"PRId64"\n", sequence);
 
@@ -186,6 +208,37 @@ int ff_hls_write_file_entry(AVIOContext *out, int insert_discont,
     return 0;
 }
 
+void ff_hls_write_part_info(AVIOContext *out, double part_target,
+                            int can_block_reload)
+{
+    if (!out)
+        return;
+    avio_printf(out, "#EXT-X-SERVER-CONTROL:%sPART-HOLD-BACK=%.3f\n",
+                can_block_reload ? "CAN-BLOCK-RELOAD=YES," : "",
+                3 * part_target);
+    avio_printf(out, "#EXT-X-PART-INF:PART-TARGET=%.3f\n", part_target);
+}
+
+void ff_hls_write_part(AVIOContext *out, double duration,
+                       const char *baseurl, const char *filename,
+                       int independent)
+{
+    if (!out || !filename)
+        return;
+    avio_printf(out, "#EXT-X-PART:DURATION=%.5f,URI=\"%s%s\"%s\n", duration,
+                baseurl ? baseurl : "", filename,
+                independent ? ",INDEPENDENT=YES" : "");
+}
+
+void ff_hls_write_preload_hint(AVIOContext *out, const char *baseurl,
+                               const char *filename)
+{
+    if (!out || !filename)
+        return;
+    avio_printf(out, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s%s\"\n",
+                baseurl ? baseurl : "", filename);
+}
+
 void ff_hls_write_end_list(AVIOContext *out)
 {
     if (!out)
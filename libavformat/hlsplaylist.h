@@ -46,9 +46,27 @@ void ff_hls_write_stream_info(AVStream *st, AVIOContext *out, int bandwidth,
                               const char *filename, const char *agroup,
                               const char *codecs, const char *ccgroup,
                               const char *sgroup);
+/**
+ * Size of a padded EXT-X-TARGETDURATION tag, see
+ * ff_hls_write_target_duration().
+ */
+#define HLS_TARGET_DURATION_SLOT 48
+
+/**
+ * Write the EXT-X-TARGETDURATION tag. If padded is set, the tag is followed
+ * by a comment line filling HLS_TARGET_DURATION_SLOT bytes, so that it can
+ * be overwritten in place by a tag with a longer duration.
+ */
+void ff_hls_write_target_duration(AVIOContext *out, int target_duration,
+                                  int padded);
+/**
+ * @param target_duration_pos if not NULL, the target duration tag is padded
+ *                            and its position in out is stored there
+ */
 void ff_hls_write_playlist_header(AVIOContext *out, int version, int allowcache,
                                   int target_duration, int64_t sequence,
-                                  uint32_t playlist_type, int iframe_mode);
+                                  uint32_t playlist_type, int iframe_mode,
+                                  int64_t *target_duration_pos);
 void ff_hls_write_init_file(AVIOContext *out, const char *filename,
                             int byterange_mode, int64_t size, int64_t pos);
 int ff_hls_write_file_entry(AVIOContext *out, int insert_discont,
@@ -59,6 +77,18 @@ int ff_hls_write_file_entry(AVIOContext *out, int insert_discont,
                             const char *filename, double *prog_date_time,
                             int64_t video_keyframe_size, int64_t video_keyframe_pos,
                             int iframe_mode);
+/**
+ * Write the low-latency playlist tags EXT-X-SERVER-CONTROL and
+ * EXT-X-PART-INF for partial segments of part_target seconds.
+ */
+void ff_hls_write_part_info(AVIOContext *out, double part_target,
+                            int can_block_reload);
+void ff_hls_write_part(AVIOContext *out, double duration,
+                       const char *baseurl /* Ignored if NULL */,
+                       const char *filename, int independent);
+void ff_hls_write_preload_hint(AVIOContext *out,
+                               const char *baseurl /* Ignored if NULL */,
+                               const char *filename);
 void ff_hls_write_end_list (AVIOContext *out);
 
 #endif /* AVFORMAT_HLSPLAYLIST_H_ */
@@ -33,6 +33,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/time.h"
 #include "libavutil/parseutils.h"
+#include "libavutil/thread.h"
 
 #include "avformat.h"
 #include "http.h"
@@ -55,6 +56,7 @@
 #define HTTP_SINGLE   1
 #define HTTP_MUTLI    2
 #define MAX_EXPIRY    19
+#define MAX_POOLED_CONNECTIONS 16
 #define WHITESPACES " \n\t\r"
 typedef enum {
     LOWER_PROTO,
@@ -63,6 +65,31 @@ typedef enum {
     FINISH
 }HandshakeState;
 
+typedef enum {
+    PIPELINE_NONE,
+    PIPELINE_SEND,      ///< only send the request, the reply is read later
+    PIPELINE_RECV,      ///< the request was already sent, only read the reply
+} PipelineState;
+
+/**
+ * A lower level (tcp/tls) connection that may be shared between HTTP
+ * contexts. The connection is opened with an interrupt callback pointing
+ * to this struct, so that whoever owns the connection at the moment gets
+ * its own interrupt callback called, even for nested protocols.
+ */
+typedef struct HTTPPoolConn {
+    URLContext *hd;             ///< only set while the connection is idle
+    char *key;                  ///< url of the lower protocol, e.g. tls://host:443,
+                                ///< followed by its security related options
+    AVIOInterruptCB owner_cb;
+    int64_t idle_since;
+    struct HTTPPoolConn *next;
+} HTTPPoolConn;
+
+static AVMutex pool_mutex = AV_MUTEX_INITIALIZER;
+static HTTPPoolConn *pool_idle;
+static int pool_nb_idle;
+
 typedef struct HTTPContext {
     const AVClass *class;
     URLContext *hd;
@@ -136,6 +163,14 @@ typedef struct HTTPContext {
     char *new_location;
     AVDictionary *redirect_cache;
     uint64_t filesize_from_content_range;
+    /* Position right after the body of the current reply, if known. */
+    uint64_t body_end;
+    int connection_pool;
+    int pool_idle_timeout;
+    HTTPPoolConn *pool_conn;
+    PipelineState pipeline_state;
+    char *pipelined_uri;
+    uint64_t pipelined_off, pipelined_end_off;
 } HTTPContext;
 
 #define OFFSET(x) offsetof(HTTPContext, x)
@@ -178,6 +213,8 @@ static const AVOption options[] = {
     { "resource", "The resource requested by a client", OFFSET(resource), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
     { "reply_code", "The http status code to return to a client", OFFSET(reply_code), AV_OPT_TYPE_INT, { .i64 = 200}, INT_MIN, 599, E},
     { "short_seek_size", "Threshold to favor readahead over seek.", OFFSET(short_seek_size), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, D },
+    { "connection_pool", "share idle persistent connections between HTTP contexts", OFFSET(connection_pool), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, D },
+    { "pool_idle_timeout", "max time in seconds a pooled connection may stay idle", OFFSET(pool_idle_timeout), AV_OPT_TYPE_INT, { .i64 = 30 }, 0, INT_MAX, D },
     { NULL }
 };
 
@@ -186,6 +223,7 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
                         const char *proxyauth);
 static int http_read_header(URLContext *h);
 static int http_shutdown(URLContext *h, int flags);
+static int http_drain_body(URLContext *h);
 
 void ff_http_init_auth_state(URLContext *dest, const URLContext *src)
 {
@@ -197,6 +235,186 @@ void ff_http_init_auth_state(URLContext *dest, const URLContext *src)
            sizeof(HTTPAuthState));
 }
 
+static int pool_interrupt_cb(void *opaque)
+{
+    HTTPPoolConn *conn = opaque;
+    return ff_check_interrupt(&conn->owner_cb);
+}
+
+static void pool_conn_free(HTTPPoolConn **pconn)
+{
+    HTTPPoolConn *conn = *pconn;
+
+    if (!conn)
+        return;
+    ffurl_closep(&conn->hd);
+    av_freep(&conn->key);
+    av_freep(pconn);
+}
+
+static void pool_conn_free_list(HTTPPoolConn *list)
+{
+    while (list) {
+        HTTPPoolConn *next = list->next;
+        pool_conn_free(&list);
+        list = next;
+    }
+}
+
+/* Options of the lower protocol changing how the peer is authenticated or
+ * reached. They are not part of the url, but a connection must only be
+ * shared between contexts using the same values. */
+static const char *const pool_key_options[] = {
+    "ca_file", "cafile", "tls_verify", "verifyhost", "cert_file", "key_file",
+    "http_proxy",
+};
+
+static char *pool_key(const char *url, const AVDictionary *options)
+{
+    AVBPrint key;
+    char *str;
+
+    av_bprint_init(&key, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprintf(&key, "%s", url);
+    for (int i = 0; i < FF_ARRAY_ELEMS(pool_key_options); i++) {
+        const AVDictionaryEntry *e = av_dict_get(options, pool_key_options[i], NULL, 0);
+        if (e)
+            av_bprintf(&key, "|%s=%s", e->key, e->value);
+    }
+    if (av_bprint_finalize(&key, &str) < 0)
+        return NULL;
+    return str;
+}
+
+/* close the lower connection along with its pool entry, if any */
+static void http_close_hd(HTTPContext *s)
+{
+    ffurl_closep(&s->hd);
+    pool_conn_free(&s->pool_conn);
+}
+
+static int http_open_hd(URLContext *h, const char *url, const char *key,
+                        AVDictionary **options)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPPoolConn *conn;
+    AVIOInterruptCB int_cb;
+    int ret;
+
+    if (!s->connection_pool)
+        return ffurl_open_whitelist(&s->hd, url, AVIO_FLAG_READ_WRITE,
+                                    &h->interrupt_callback, options,
+                                    h->protocol_whitelist, h->protocol_blacklist, h);
+
+    conn = av_mallocz(sizeof(*conn));
+    if (!conn)
+        return AVERROR(ENOMEM);
+    conn->key = av_strdup(key);
+    if (!conn->key) {
+        av_free(conn);
+        return AVERROR(ENOMEM);
+    }
+    conn->owner_cb = h->interrupt_callback;
+    int_cb.callback = pool_interrupt_cb;
+    int_cb.opaque   = conn;
+    ret = ffurl_open_whitelist(&s->hd, url, AVIO_FLAG_READ_WRITE,
+                               &int_cb, options,
+                               h->protocol_whitelist, h->protocol_blacklist, h);
+    if (ret < 0) {
+        pool_conn_free(&conn);
+        return ret;
+    }
+    s->pool_conn = conn;
+    return 0;
+}
+
+/**
+ * Take an idle connection with the given key out of the pool.
+ * @return 1 if a connection was found, 0 otherwise
+ */
+static int pool_get(URLContext *h, const char *key)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPPoolConn *conn = NULL, *expired = NULL, **p;
+    int64_t now = av_gettime_relative();
+
+    ff_mutex_lock(&pool_mutex);
+    p = &pool_idle;
+    while (*p) {
+        HTTPPoolConn *cur = *p;
+        if (now - cur->idle_since > s->pool_idle_timeout * INT64_C(1000000)) {
+            *p = cur->next;
+            cur->next = expired;
+            expired = cur;
+            pool_nb_idle--;
+        } else if (!conn && !strcmp(cur->key, key)) {
+            *p = cur->next;
+            conn = cur;
+            pool_nb_idle--;
+        } else {
+            p = &cur->next;
+        }
+    }
+    ff_mutex_unlock(&pool_mutex);
+
+    pool_conn_free_list(expired);
+    if (!conn)
+        return 0;
+
+    av_log(h, AV_LOG_DEBUG, "Reusing pooled connection %s\n", key);
+    conn->next     = NULL;
+    conn->owner_cb = h->interrupt_callback;
+    s->hd          = conn->hd;
+    conn->hd       = NULL;
+    s->pool_conn   = conn;
+    return 1;
+}
+
+static int http_conn_reusable(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+
+    if (!s->hd || !s->pool_conn || s->willclose || s->pipelined_uri ||
+        s->listen || (h->flags & AVIO_FLAG_WRITE) || s->buf_ptr != s->buf_end)
+        return 0;
+    if (s->chunksize != UINT64_MAX)
+        return s->chunkend;
+    return s->body_end != UINT64_MAX && s->off == s->body_end;
+}
+
+/* put the connection into the pool if possible, close it otherwise */
+static void http_release_hd(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPPoolConn *conn = s->pool_conn, *evicted = NULL, **p;
+
+    if (!http_conn_reusable(h)) {
+        http_close_hd(s);
+        return;
+    }
+
+    conn->owner_cb   = (AVIOInterruptCB){ NULL, NULL };
+    conn->hd         = s->hd;
+    conn->idle_since = av_gettime_relative();
+    s->hd            = NULL;
+    s->pool_conn     = NULL;
+
+    ff_mutex_lock(&pool_mutex);
+    conn->next = pool_idle;
+    pool_idle  = conn;
+    if (++pool_nb_idle > MAX_POOLED_CONNECTIONS) {
+        /* evict the least recently used connection */
+        for (p = &pool_idle; (*p)->next; p = &(*p)->next)
+            ;
+        evicted = *p;
+        *p      = NULL;
+        pool_nb_idle--;
+    }
+    ff_mutex_unlock(&pool_mutex);
+
+    pool_conn_free_list(evicted);
+}
+
 static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 {
     const char *path, *proxy_path, *lower_proto = "tcp", *local_path;
@@ -205,8 +423,9 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
     char hostname[1024], hoststr[1024], proto[10];
     char auth[1024], proxyauth[1024] = "";
     char path1[MAX_URL_SIZE], sanitized_path[MAX_URL_SIZE + 1];
-    char buf[1024], urlbuf[MAX_URL_SIZE];
-    int port, use_proxy, err = 0;
+    char buf[1024], urlbuf[MAX_URL_SIZE], *key = NULL;
+    int port, use_proxy, err = 0, reused = 0;
+    uint64_t off;
     HTTPContext *s = h->priv_data;
 
     av_url_split(proto, sizeof(proto), auth, sizeof(auth),
@@ -263,15 +482,37 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
     ff_url_join(buf, sizeof(buf), lower_proto, NULL, hostname, port, NULL);
 
     if (!s->hd) {
-        err = ffurl_open_whitelist(&s->hd, buf, AVIO_FLAG_READ_WRITE,
-                                   &h->interrupt_callback, options,
-                                   h->protocol_whitelist, h->protocol_blacklist, h);
+        if (s->connection_pool) {
+            if (!(key = pool_key(buf, *options))) {
+                err = AVERROR(ENOMEM);
+                goto end;
+            }
+            reused = pool_get(h, key);
+        }
+        if (!reused)
+            err = http_open_hd(h, buf, key, options);
     }
 
 end:
     freeenv_utf8(env_http_proxy);
-    return err < 0 ? err : http_connect(
-        h, path, local_path, hoststr, auth, proxyauth);
+    if (err < 0)
+        goto fail;
+
+    off = s->off;
+    err = http_connect(h, path, local_path, hoststr, auth, proxyauth);
+    if (err < 0 && reused && err != AVERROR_EXIT) {
+        /* The server may have dropped the idle connection in the meantime,
+         * retry once on a fresh one. */
+        av_log(h, AV_LOG_DEBUG, "Pooled connection failed, reconnecting\n");
+        http_close_hd(s);
+        s->off = off;
+        if ((err = http_open_hd(h, buf, key, options)) < 0)
+            goto fail;
+        err = http_connect(h, path, local_path, hoststr, auth, proxyauth);
+    }
+fail:
+    av_free(key);
+    return err;
 }
 
 static int http_should_reconnect(HTTPContext *s, int err)
@@ -392,7 +633,7 @@ redo:
         /* restore the offset (http_connect resets it) */
         s->off = off;
 
-        ffurl_closep(&s->hd);
+        http_close_hd(s);
         goto redo;
     }
 
@@ -400,7 +641,7 @@ redo:
     if (s->http_code == 401) {
         if ((cur_auth_type == HTTP_AUTH_NONE || s->auth_state.stale) &&
             s->auth_state.auth_type != HTTP_AUTH_NONE && attempts < 4) {
-            ffurl_closep(&s->hd);
+            http_close_hd(s);
             goto redo;
         } else
             goto fail;
@@ -408,7 +649,7 @@ redo:
     if (s->http_code == 407) {
         if ((cur_proxy_auth_type == HTTP_AUTH_NONE || s->proxy_auth_state.stale) &&
             s->proxy_auth_state.auth_type != HTTP_AUTH_NONE && attempts < 4) {
-            ffurl_closep(&s->hd);
+            http_close_hd(s);
             goto redo;
         } else
             goto fail;
@@ -417,7 +658,7 @@ redo:
          s->http_code == 303 || s->http_code == 307 || s->http_code == 308) &&
         s->new_location) {
         /* url moved, get next */
-        ffurl_closep(&s->hd);
+        http_close_hd(s);
         if (redirects++ >= MAX_REDIRECTS)
             return AVERROR(EIO);
 
@@ -442,8 +683,7 @@ redo:
     return 0;
 
 fail:
-    if (s->hd)
-        ffurl_closep(&s->hd);
+    http_close_hd(s);
     if (ret < 0)
         return ret;
     return ff_http_averror(s->http_code, AVERROR(EIO));
@@ -457,7 +697,7 @@ int ff_http_do_new_request2(URLContext *h, const char *uri, AVDictionary **opts)
 {
     HTTPContext *s = h->priv_data;
     AVDictionary *options = NULL;
-    int ret;
+    int ret, pipelined = 0;
     char hostname1[1024], hostname2[1024], proto1[10], proto2[10];
     int port1, port2;
 
@@ -486,8 +726,13 @@ int ff_http_do_new_request2(URLContext *h, const char *uri, AVDictionary **opts)
             return ret;
     }
 
-    if (s->willclose)
+    if (s->pipelined_uri) {
+        /* Skip what is left of the current reply, the reply to the
+         * pipelined request follows it on the connection. */
+        pipelined = http_drain_body(h) >= 0;
+    } else if (s->willclose) {
         return AVERROR_EOF;
+    }
 
     s->end_chunked_post = 0;
     s->chunkend      = 0;
@@ -507,12 +752,85 @@ int ff_http_do_new_request2(URLContext *h, const char *uri, AVDictionary **opts)
     if ((ret = av_opt_set_dict(s, opts)) < 0)
         return ret;
 
+    if (s->pipelined_uri) {
+        if (pipelined && !strcmp(s->pipelined_uri, uri) &&
+            s->off == s->pipelined_off && s->end_off == s->pipelined_end_off) {
+            s->pipeline_state = PIPELINE_RECV;
+        } else {
+            av_log(h, AV_LOG_DEBUG, "Dropping pipelined request for %s\n", s->pipelined_uri);
+            http_close_hd(s);
+        }
+        av_freep(&s->pipelined_uri);
+    }
+
     av_log(s, AV_LOG_INFO, "Opening \'%s\' for %s\n", uri, h->flags & AVIO_FLAG_WRITE ? "writing" : "reading");
     ret = http_open_cnx(h, &options);
+    s->pipeline_state = PIPELINE_NONE;
     av_dict_free(&options);
     return ret;
 }
 
+int ff_http_pipeline_request(URLContext *h, const char *uri,
+                             int64_t off, int64_t end_off)
+{
+    HTTPContext *s = h->priv_data;
+    AVDictionary *options = NULL;
+    char hostname1[1024], hostname2[1024];
+    int port1, port2, ret;
+    uint64_t cur_off, cur_end_off;
+    char *cur_location, *pipelined_uri;
+
+    if (!h->prot ||
+        !(!strcmp(h->prot->name, "http") ||
+          !strcmp(h->prot->name, "https")))
+        return AVERROR(EINVAL);
+
+    /* The reply to the current request must be delimited for the
+     * next reply to be found on the connection. */
+    if (!s->hd || s->willclose || !s->multiple_requests || s->pipelined_uri ||
+        (h->flags & AVIO_FLAG_WRITE) ||
+        (s->chunksize == UINT64_MAX && s->body_end == UINT64_MAX))
+        return AVERROR(ENOSYS);
+
+    av_url_split(NULL, 0, NULL, 0, hostname1, sizeof(hostname1), &port1,
+                 NULL, 0, s->location);
+    av_url_split(NULL, 0, NULL, 0, hostname2, sizeof(hostname2), &port2,
+                 NULL, 0, uri);
+    if (port1 != port2 || strcmp(hostname1, hostname2))
+        return AVERROR(EINVAL);
+
+    pipelined_uri = av_strdup(uri);
+    if (!pipelined_uri)
+        return AVERROR(ENOMEM);
+
+    cur_location = s->location;
+    cur_off      = s->off;
+    cur_end_off  = s->end_off;
+
+    s->location       = pipelined_uri;
+    s->off            = off;
+    s->end_off        = end_off;
+    s->pipeline_state = PIPELINE_SEND;
+
+    ret = http_open_cnx_internal(h, &options);
+
+    s->pipeline_state = PIPELINE_NONE;
+    av_dict_free(&options);
+    s->location = cur_location;
+    s->off      = cur_off;
+    s->end_off  = cur_end_off;
+    if (ret < 0) {
+        av_free(pipelined_uri);
+        return ret;
+    }
+
+    s->pipelined_uri     = pipelined_uri;
+    s->pipelined_off     = off;
+    s->pipelined_end_off = end_off;
+    av_log(h, AV_LOG_DEBUG, "Pipelined request for %s\n", uri);
+    return 0;
+}
+
 int ff_http_averror(int status_code, int default_averror)
 {
     switch (status_code) {
@@ -1351,6 +1669,11 @@ static int http_read_header(URLContext *h)
         s->line_count++;
     }
 
+    // at this point filesize is the Content-Length, and off the start of the range
+    s->body_end = UINT64_MAX;
+    if (s->chunksize == UINT64_MAX && s->filesize != UINT64_MAX)
+        s->body_end = s->off + s->filesize;
+
     // filesize from Content-Range can always be used, even if using chunked Transfer-Encoding
     if (s->filesize_from_content_range != UINT64_MAX)
         s->filesize = s->filesize_from_content_range;
@@ -1408,7 +1731,8 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
     const char *method;
     int send_expect_100 = 0;
 
-    av_bprint_init_for_buffer(&request, s->buffer, sizeof(s->buffer));
+    /* s->buffer may still hold unread data when pipelining requests */
+    av_bprint_init(&request, 0, sizeof(s->buffer));
 
     /* send http header */
     post = h->flags & AVIO_FLAG_WRITE;
@@ -1425,6 +1749,13 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
     else
         method = post ? "POST" : "GET";
 
+    if (s->pipeline_state == PIPELINE_RECV) {
+        /* the request was sent by ff_http_pipeline_request() already,
+         * and the reply data may be in the input buffer */
+        s->pipeline_state = PIPELINE_NONE;
+        goto read_reply;
+    }
+
     authstr      = ff_http_auth_create_response(&s->auth_state, auth,
                                                 local_path, method);
     proxyauthstr = ff_http_auth_create_response(&s->proxy_auth_state, proxyauth,
@@ -1475,7 +1806,8 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
         av_bprintf(&request, "Expect: 100-continue\r\n");
 
     if (!has_header(s->headers, "\r\nConnection: "))
-        av_bprintf(&request, "Connection: %s\r\n", s->multiple_requests ? "keep-alive" : "close");
+        av_bprintf(&request, "Connection: %s\r\n",
+                   s->multiple_requests || s->connection_pool ? "keep-alive" : "close");
 
     if (!has_header(s->headers, "\r\nHost: "))
         av_bprintf(&request, "Host: %s\r\n", hoststr);
@@ -1519,9 +1851,15 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
         if ((err = ffurl_write(s->hd, s->post_data, s->post_datalen)) < 0)
             goto done;
 
+    if (s->pipeline_state == PIPELINE_SEND) {
+        err = 0;
+        goto done;
+    }
+
     /* init input buffer */
     s->buf_ptr          = s->buffer;
     s->buf_end          = s->buffer;
+read_reply:
     s->line_count       = 0;
     s->off              = 0;
     s->icy_data_read    = 0;
@@ -1551,6 +1889,7 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
 
     err = (off == s->off) ? 0 : -1;
 done:
+    av_bprint_finalize(&request, NULL);
     av_freep(&authstr);
     av_freep(&proxyauthstr);
     return err;
@@ -1580,14 +1919,14 @@ static int http_buf_read(URLContext *h, uint8_t *buf, int size)
                    "Chunked encoding data size: %"PRIu64"\n",
                     s->chunksize);
 
-            if (!s->chunksize && s->multiple_requests) {
+            if (!s->chunksize && (s->multiple_requests || s->connection_pool)) {
                 http_get_line(s, line, sizeof(line)); // read empty chunk
                 s->chunkend = 1;
                 return 0;
             }
             else if (!s->chunksize) {
                 av_log(h, AV_LOG_DEBUG, "Last chunk received, closing conn\n");
-                ffurl_closep(&s->hd);
+                http_close_hd(s);
                 return 0;
             }
             else if (s->chunksize == UINT64_MAX) {
@@ -1597,6 +1936,11 @@ static int http_buf_read(URLContext *h, uint8_t *buf, int size)
             }
         }
         size = FFMIN(size, s->chunksize);
+    } else if (s->pipelined_uri && s->body_end != UINT64_MAX) {
+        /* do not read into the reply to the pipelined request */
+        if (s->off >= s->body_end)
+            return AVERROR_EOF;
+        size = FFMIN(size, s->body_end - s->off);
     }
 
     /* read bytes from input buffer first */
@@ -1630,6 +1974,20 @@ static int http_buf_read(URLContext *h, uint8_t *buf, int size)
     return len;
 }
 
+static int http_drain_body(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    uint8_t buf[4096];
+    int ret;
+
+    if (!s->hd || (s->chunksize == UINT64_MAX && s->body_end == UINT64_MAX))
+        return AVERROR(EINVAL);
+
+    while ((ret = http_buf_read(h, buf, sizeof(buf))) > 0)
+        ;
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
 #if CONFIG_ZLIB
 #define DECOMPRESS_BUF_SIZE (256 * 1024)
 static int http_buf_read_compressed(URLContext *h, uint8_t *buf, int size)
@@ -1885,12 +2243,12 @@ static int http_close(URLContext *h)
         /* Close the write direction by sending the end of chunked encoding. */
         ret = http_shutdown(h, h->flags);
 
-    if (s->hd)
-        ffurl_closep(&s->hd);
+    http_release_hd(h);
     av_dict_free(&s->chained_options);
     av_dict_free(&s->cookie_dict);
     av_dict_free(&s->redirect_cache);
     av_freep(&s->new_location);
+    av_freep(&s->pipelined_uri);
     av_freep(&s->uri);
     return ret;
 }
@@ -1899,6 +2257,7 @@ static int64_t http_seek_internal(URLContext *h, int64_t off, int whence, int fo
 {
     HTTPContext *s = h->priv_data;
     URLContext *old_hd = s->hd;
+    HTTPPoolConn *old_conn = s->pool_conn;
     uint64_t old_off = s->off;
     uint8_t old_buf[BUFFER_SIZE];
     int old_buf_size, ret;
@@ -1946,7 +2305,8 @@ static int64_t http_seek_internal(URLContext *h, int64_t off, int whence, int fo
     /* we save the old context in case the seek fails */
     old_buf_size = s->buf_end - s->buf_ptr;
     memcpy(old_buf, s->buf_ptr, old_buf_size);
-    s->hd = NULL;
+    s->hd        = NULL;
+    s->pool_conn = NULL;
 
     /* if it fails, continue on old connection */
     if ((ret = http_open_cnx(h, &options)) < 0) {
@@ -1954,12 +2314,15 @@ static int64_t http_seek_internal(URLContext *h, int64_t off, int whence, int fo
         memcpy(s->buffer, old_buf, old_buf_size);
         s->buf_ptr = s->buffer;
         s->buf_end = s->buffer + old_buf_size;
-        s->hd      = old_hd;
-        s->off     = old_off;
+        s->hd        = old_hd;
+        s->pool_conn = old_conn;
+        s->off       = old_off;
         return ret;
     }
     av_dict_free(&options);
     ffurl_close(old_hd);
+    pool_conn_free(&old_conn);
+    av_freep(&s->pipelined_uri);
     return off;
 }
 
@@ -60,6 +60,23 @@ int ff_http_do_new_request(URLContext *h, const char *uri);
  */
 int ff_http_do_new_request2(URLContext *h, const char *uri, AVDictionary **options);
 
+/**
+ * Send the request for the next resource on the same connection before
+ * the reply to the current request has been read entirely (HTTP
+ * pipelining). The reply is picked up by the next call to
+ * ff_http_do_new_request2() with the same uri and byte range, any other
+ * request drops the connection.
+ *
+ * @param h pointer to the resource
+ * @param uri uri of the next request, must be on the same host
+ * @param off start offset of the next request
+ * @param end_off end offset of the next request, 0 for the whole resource
+ * @return a negative value if an error condition occurred (e.g. the current
+ * reply length is not known), 0 otherwise
+ */
+int ff_http_pipeline_request(URLContext *h, const char *uri,
+                             int64_t off, int64_t end_off);
+
 int ff_http_averror(int status_code, int default_averror);
 
 #endif /* AVFORMAT_HTTP_H */
@@ -3764,6 +3764,9 @@ static int matroska_parse_block(MatroskaDemuxContext *matroska, AVBufferRef *buf
         }
     }
 
+    if (st->discard >= AVDISCARD_NONKEY && !is_keyframe)
+        return res;
+
     res = matroska_parse_laces(matroska, &data, size, (flags & 0x06) >> 1,
                                &pb.pub, lace_size, &laces);
     if (res < 0) {
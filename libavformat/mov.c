@@ -8736,6 +8736,18 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
         sample->size = FFMIN(sample->size, (mov->next_root_atom - sample->pos));
     }
 
+    if (st->discard == AVDISCARD_NONKEY && !(sample->flags & AVINDEX_KEYFRAME)) {
+        FFStream *const sti = ffstream(st);
+
+        /* walk the index up to the next keyframe, without touching the
+         * samples in between */
+        while (sc->current_sample < sti->nb_index_entries &&
+               !(sti->index_entries[sc->current_sample].flags & AVINDEX_KEYFRAME))
+            mov_current_sample_inc(sc);
+        av_log(mov->fc, AV_LOG_DEBUG, "Nonkey frames from stream %d discarded due to AVDISCARD_NONKEY\n", sc->ffindex);
+        goto retry;
+    }
+
     if (st->discard != AVDISCARD_ALL) {
         int64_t ret64 = avio_seek(sc->pb, sample->pos, SEEK_SET);
         if (ret64 != sample->pos) {
@@ -8749,11 +8761,6 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
             return AVERROR_INVALIDDATA;
         }
 
-        if (st->discard == AVDISCARD_NONKEY && !(sample->flags & AVINDEX_KEYFRAME)) {
-            av_log(mov->fc, AV_LOG_DEBUG, "Nonkey frame from stream %d discarded due to AVDISCARD_NONKEY\n", sc->ffindex);
-            goto retry;
-        }
-
         if (st->codecpar->codec_id == AV_CODEC_ID_EIA_608 && sample->size > 8)
             ret = get_eia608_packet(sc->pb, pkt, sample->size);
         else
@@ -0,0 +1,180 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/thread.h"
+
+#include "libavformat/avformat.h"
+#include "libavformat/network.h"
+
+/* A keep-alive HTTP server on the loopback interface, counting the
+ * connections it accepts. */
+
+#define MAX_CLIENTS 8
+
+static const char reply[] = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: text/plain\r\n"
+                            "Content-Length: 5\r\n"
+                            "\r\n"
+                            "hello";
+
+static int listen_fd;
+static atomic_int nb_accepted;
+static atomic_int quit;
+
+typedef struct Client {
+    int fd;
+    int len;
+    char buf[4096];
+} Client;
+
+static void *server(void *arg)
+{
+    Client clients[MAX_CLIENTS];
+    struct pollfd p[MAX_CLIENTS + 1];
+    int idx[MAX_CLIENTS + 1];
+
+    for (int i = 0; i < MAX_CLIENTS; i++)
+        clients[i].fd = -1;
+
+    while (!atomic_load(&quit)) {
+        int n = 0;
+
+        p[n++] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0)
+                continue;
+            idx[n]   = i;
+            p[n++] = (struct pollfd){ .fd = clients[i].fd, .events = POLLIN };
+        }
+        if (poll(p, n, 50) <= 0)
+            continue;
+
+        if (p[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+            for (int i = 0; fd >= 0 && i < MAX_CLIENTS; i++) {
+                if (clients[i].fd < 0) {
+                    clients[i].fd  = fd;
+                    clients[i].len = 0;
+                    fd = -1;
+                    atomic_fetch_add(&nb_accepted, 1);
+                }
+            }
+            if (fd >= 0)
+                closesocket(fd);
+        }
+
+        for (int j = 1; j < n; j++) {
+            Client *c = &clients[idx[j]];
+            char *end;
+            int ret;
+
+            if (!p[j].revents)
+                continue;
+            ret = recv(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len, 0);
+            if (ret <= 0) {
+                closesocket(c->fd);
+                c->fd = -1;
+                continue;
+            }
+            c->len += ret;
+            c->buf[c->len] = 0;
+            while ((end = strstr(c->buf, "\r\n\r\n"))) {
+                end    += 4;
+                c->len -= end - c->buf;
+                memmove(c->buf, end, c->len + 1);
+                send(c->fd, reply, sizeof(reply) - 1, 0);
+            }
+        }
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++)
+        if (clients[i].fd >= 0)
+            closesocket(clients[i].fd);
+    return NULL;
+}
+
+static void fetch(int port, const char *path, const char *tls_verify)
+{
+    AVDictionary *opts = NULL;
+    AVIOContext *pb;
+    char url[64];
+    uint8_t buf[16];
+    int ret, size = 0;
+
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s", port, path);
+    av_dict_set(&opts, "connection_pool", "1", 0);
+    if (tls_verify)
+        av_dict_set(&opts, "tls_verify", tls_verify, 0);
+    ret = avio_open2(&pb, url, AVIO_FLAG_READ, NULL, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        printf("/%s: open failed\n", path);
+        return;
+    }
+    while ((ret = avio_read(pb, buf, sizeof(buf))) > 0)
+        size += ret;
+    avio_closep(&pb);
+
+    printf("/%s%s%s: %d bytes, %d connections accepted\n", path,
+           tls_verify ? " tls_verify=" : "", tls_verify ? tls_verify : "",
+           size, atomic_load(&nb_accepted));
+}
+
+int main(void)
+{
+    struct sockaddr_in addr = { 0 };
+    socklen_t addrlen = sizeof(addr);
+    pthread_t thread;
+    int port;
+
+    avformat_network_init();
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (listen_fd < 0 ||
+        bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, MAX_CLIENTS) < 0 ||
+        getsockname(listen_fd, (struct sockaddr *)&addr, &addrlen) < 0) {
+        printf("cannot listen on the loopback interface\n");
+        return 1;
+    }
+    port = ntohs(addr.sin_port);
+    if (pthread_create(&thread, NULL, server, NULL))
+        return 1;
+
+    /* the idle connection is reused */
+    fetch(port, "a", NULL);
+    fetch(port, "b", NULL);
+    /* it is not shared with a context using other security options */
+    fetch(port, "c", "1");
+    fetch(port, "d", "1");
+    fetch(port, "e", "0");
+    fetch(port, "f", NULL);
+
+    atomic_store(&quit, 1);
+    pthread_join(thread, NULL);
+    closesocket(listen_fd);
+    avformat_network_deinit();
+    return 0;
+}
@@ -831,6 +831,8 @@ const char *av_frame_side_data_name(enum AVFrameSideDataType type)
     case AV_FRAME_DATA_DETECTION_BBOXES:            return "Bounding boxes for object detection and classification";
     case AV_FRAME_DATA_DOVI_RPU_BUFFER:             return "Dolby Vision RPU Data";
     case AV_FRAME_DATA_DOVI_METADATA:               return "Dolby Vision Metadata";
+    case AV_FRAME_DATA_ACTIVE_RECTS:                return "Active rectangles";
+    case AV_FRAME_DATA_DUPLICATE:                   return "Duplicate frame";
     }
     return NULL;
 }
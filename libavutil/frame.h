@@ -209,6 +209,20 @@ enum AVFrameSideDataType {
      * volume transform - CUVA 005.1-2021.
      */
     AV_FRAME_DATA_DYNAMIC_HDR_VIVID,
+
+    /**
+     * Areas of a frame with an alpha channel outside of which every pixel is
+     * fully transparent. The payload is an AVFrameActiveRects.
+     */
+    AV_FRAME_DATA_ACTIVE_RECTS,
+
+    /**
+     * The frame repeats the previous frame of the stream: its picture is
+     * identical, only its timestamps differ. There is no payload, the side
+     * data is typically attached by frame rate conversion, so that later
+     * processing steps can reuse their results for the previous frame.
+     */
+    AV_FRAME_DATA_DUPLICATE,
 };
 
 enum AVActiveFormatDescription {
@@ -292,6 +306,48 @@ typedef struct AVRegionOfInterest {
     AVRational qoffset;
 } AVRegionOfInterest;
 
+/**
+ * Maximum number of rectangles in an AVFrameActiveRects.
+ */
+#define AV_FRAME_MAX_ACTIVE_RECTS 16
+
+/**
+ * A rectangle of an AVFrameActiveRects, in pixels.
+ */
+typedef struct AVFrameActiveRect {
+    int x, y;
+    int w, h;
+} AVFrameActiveRect;
+
+/**
+ * Structure describing the parts of a frame that may hold non-transparent
+ * pixels, stored as AV_FRAME_DATA_ACTIVE_RECTS side data. It is typically
+ * attached to mostly empty frames, like rendered subtitles, so that
+ * compositing can be restricted to the listed areas, or skipped entirely
+ * when nb_rects is 0.
+ *
+ * A filter that moves pixels within a frame without changing its dimensions
+ * must remove this side data.
+ *
+ * sizeof(AVFrameActiveRects) is a part of the public ABI.
+ */
+typedef struct AVFrameActiveRects {
+    /**
+     * Dimensions of the frame the rectangles refer to. The side data must
+     * be ignored if they differ from those of the frame it is attached to,
+     * e.g. because it was scaled.
+     */
+    int width, height;
+
+    /**
+     * Number of valid entries in rects. Every pixel outside of these
+     * rectangles has an alpha of zero.
+     */
+    int nb_rects;
+
+    AVFrameActiveRect rects[AV_FRAME_MAX_ACTIVE_RECTS];
+} AVFrameActiveRects;
+
 /**
  * This structure describes decoded (raw) audio or video data.
  *
@@ -466,12 +466,58 @@ av_cold static int auto_matrix(SwrContext *s)
     return ret;
 }
 
-av_cold int swri_rematrix_init(SwrContext *s){
+static void mix_n_1_float(float *out, const float **in, const float *coeffp, integer n, integer len){
     int i, j;
+
+    for(i=0; i<len; i++){
+        float v = in[0][i] * coeffp[0];
+        for(j=1; j<n; j++)
+            v += in[j][i] * coeffp[j];
+        out[i] = v;
+    }
+}
+
+static av_cold void init_mix_n_1(SwrContext *s){
+    int nb_in  = s->used_ch_count;
+    int nb_out = s->out.ch_count;
+    int i, j;
+
+    memset(s->mix_n_1_ch, 0, sizeof(s->mix_n_1_ch));
+    if (!s->mix_n_1_f)
+        return;
+
+    /* With SIMD, also downmix 5.1 and 7.1 to stereo this way, summing the
+     * channels in the order of mix6to2() and mix8to2() for identical output. */
+    if (   s->mix_n_1_simd
+        && (   s->mix_any_f == (mix_any_func_type*)mix6to2_float
+            || s->mix_any_f == (mix_any_func_type*)mix8to2_float)) {
+        for (i = 0; i < 2; i++) {
+            uint8_t *ch = s->mix_n_1_ch[i];
+            ch[++ch[0]] = FRONT_CENTER;
+            ch[++ch[0]] = LOW_FREQUENCY;
+            for (j = i; j < nb_in; j += 2)
+                if (j != FRONT_CENTER && j != LOW_FREQUENCY)
+                    ch[++ch[0]] = j;
+        }
+        s->mix_any_f = NULL;
+        return;
+    }
+
+    if (s->mix_any_f)
+        return;
+    for (i = 0; i < nb_out; i++)
+        if (s->matrix_ch[i][0] > 2)
+            memcpy(s->mix_n_1_ch[i], s->matrix_ch[i], sizeof(s->matrix_ch[i]));
+}
+
+av_cold int swri_rematrix_init(SwrContext *s){
+    int i, j, av_unused ret;
     int nb_in  = s->used_ch_count;
     int nb_out = s->out.ch_count;
 
     s->mix_any_f = NULL;
+    s->mix_n_1_f = NULL;
+    s->mix_n_1_simd = NULL;
 
     if (!s->rematrix_custom) {
         int r = auto_matrix(s);
@@ -518,6 +564,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_float;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
         s->native_one    = av_mallocz(sizeof(double));
@@ -566,8 +613,13 @@ av_cold int swri_rematrix_init(SwrContext *s){
     }
 
 #if ARCH_X86 && HAVE_X86ASM && HAVE_MMX
-    return swri_rematrix_init_x86(s);
+    if ((ret = swri_rematrix_init_x86(s)) < 0)
+        return ret;
+#elif ARCH_AARCH64
+    if ((ret = swri_rematrix_init_aarch64(s)) < 0)
+        return ret;
 #endif
+    init_mix_n_1(s);
 
     return 0;
 }
@@ -579,6 +631,32 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_simd_one);
 }
 
+static void mix_n_1(SwrContext *s, AudioData *out, AudioData *in, int out_i, int len, int len1){
+    const uint8_t *ins[SWR_CH_MAX];
+    float coeffs[SWR_CH_MAX];
+    int n   = s->mix_n_1_ch[out_i][0];
+    int off;
+    int j;
+
+    /* len1 is aligned for the other SIMD mixes, x86-32 has no mix_n_1_simd */
+    if(!s->mix_n_1_simd)
+        len1 = 0;
+    off = len1 * out->bps;
+
+    for(j=0; j<n; j++){
+        int in_i  = s->mix_n_1_ch[out_i][1+j];
+        ins[j]    = in->ch[in_i];
+        coeffs[j] = ((float*)s->native_matrix)[in->ch_count*out_i + in_i];
+    }
+    if(s->mix_n_1_simd && len1)
+        s->mix_n_1_simd(out->ch[out_i], (const void **)ins, coeffs, n, len1);
+    if(len != len1){
+        for(j=0; j<n; j++)
+            ins[j] += off;
+        s->mix_n_1_f(out->ch[out_i] + off, (const void **)ins, coeffs, n, len-len1);
+    }
+}
+
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
     int out_i, in_i, i, j;
     int len1 = 0;
@@ -589,7 +667,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
         return 0;
     }
 
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
+    if(s->mix_2_1_simd || s->mix_1_1_simd || s->mix_n_1_simd){
         len1= len&~15;
         off = len1 * out->bps;
     }
@@ -598,6 +676,10 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
     av_assert0(s-> in_ch_layout.order == AV_CHANNEL_ORDER_UNSPEC || in ->ch_count == s->in_ch_layout.nb_channels);
 
     for(out_i=0; out_i<out->ch_count; out_i++){
+        if(s->mix_n_1_ch[out_i][0]){
+            mix_n_1(s, out, in, out_i, len, len1);
+            continue;
+        }
         switch(s->matrix_ch[out_i][0]){
         case 0:
             if(mustcopy)
@@ -28,6 +28,7 @@
 #include <float.h>
 
 #define ALIGN 32
+#define REMATRIX_BLOCK 1024
 
 int swr_set_channel_mapping(struct SwrContext *s, const int *channel_map){
     if(!s || s->in_convert) // s needs to be allocated but not initialized
@@ -663,6 +664,33 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     return ret_sum;
 }
 
+/**
+ * Rematrix and resample in blocks, so that the resampler reads the output of
+ * the rematrixing while it is still in the cache.
+ *
+ * @return number of samples output per channel
+ */
+static int rematrix_resample(SwrContext *s, AudioData *out, int out_count,
+                             AudioData *in, int in_count){
+    int ret_sum = 0;
+    int i = 0;
+
+    do{
+        AudioData in_block = *in, out_block = *out, midbuf = s->midbuf;
+        int count = FFMIN(in_count - i, REMATRIX_BLOCK);
+        int ret;
+
+        buf_set(&in_block, in, i);
+        buf_set(&out_block, out, ret_sum);
+        swri_rematrix(s, &midbuf, &in_block, count, 0);
+        if ((ret = resample(s, &out_block, out_count - ret_sum, &midbuf, count)) < 0)
+            return ret;
+        ret_sum += ret;
+        i += count;
+    }while(i < in_count);
+    return ret_sum;
+}
+
 static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_count,
                                                       AudioData *in , int  in_count){
     AudioData *postin, *midbuf, *preout;
@@ -686,7 +714,7 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
             return ret;
     }else{
         av_assert0(s->midbuf.ch_count ==  s->out.ch_count);
-        if((ret=swri_realloc_audio(&s->midbuf,  in_count))<0)
+        if((ret=swri_realloc_audio(&s->midbuf,  s->resample ? FFMIN(in_count, REMATRIX_BLOCK) : in_count))<0)
             return ret;
     }
     if((ret=swri_realloc_audio(&s->preout, out_count))<0)
@@ -731,6 +759,9 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
                 return out_count;
         if(midbuf != preout)
             swri_rematrix(s, preout, midbuf, out_count, preout==out);
+    }else if(postin != midbuf && midbuf != preout){
+        if ((out_count = rematrix_resample(s, preout, out_count, postin, in_count)) < 0)
+            return out_count;
     }else{
         if(postin != midbuf)
             swri_rematrix(s, midbuf, postin, in_count, midbuf==out);
@@ -42,6 +42,12 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+/**
+ * Sum the input planes in[0..n-1] weighted with coeffp[0..n-1] into out,
+ * adding the products in that order.
+ */
+typedef void (mix_n_1_func_type)(void *out, const void **in, const void *coeffp, integer n, integer len);
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -188,6 +194,10 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_1_func_type *mix_n_1_f;
+    mix_n_1_func_type *mix_n_1_simd;
+    uint8_t mix_n_1_ch[SWR_CH_MAX][SWR_CH_MAX+1];   ///< Lists of input channels per output channel mixed with mix_n_1, in summation order
+
     /* TODO: callbacks for ASM optimizations */
 };
 
@@ -204,6 +214,7 @@ int swri_rematrix_init(SwrContext *s);
 void swri_rematrix_free(SwrContext *s);
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy);
 int swri_rematrix_init_x86(struct SwrContext *s);
+int swri_rematrix_init_aarch64(struct SwrContext *s);
 
 av_warn_unused_result
 int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt);
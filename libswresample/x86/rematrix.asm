@@ -222,12 +222,48 @@ mix_2_1_int16_u_int %+ SUFFIX:
 %endif
 %endmacro
 
+; sum of n >= 2 weighted input planes, the products are added in the order of
+; the inputs, as the C code does
+%macro MIXN_FLT 0
+cglobal mix_n_1_float, 5, 8, 5, out, in, coeffp, n, len, off, k, src
+    shl        lenq, 2
+    xor        offq, offq
+.next:
+    mov        srcq, [inq]
+    VBROADCASTSS m4, [coeffpq]
+    movu         m0, [srcq + offq         ]
+    movu         m1, [srcq + offq + mmsize]
+    mulps        m0, m0, m4
+    mulps        m1, m1, m4
+    mov          kd, 1
+.tap:
+    mov        srcq, [inq + gprsize*kq]
+    VBROADCASTSS m4, [coeffpq + 4*kq]
+    movu         m2, [srcq + offq         ]
+    movu         m3, [srcq + offq + mmsize]
+    mulps        m2, m2, m4
+    mulps        m3, m3, m4
+    addps        m0, m0, m2
+    addps        m1, m1, m3
+    inc          kq
+    cmp          kq, nq
+        jl .tap
+    movu  [outq + offq         ], m0
+    movu  [outq + offq + mmsize], m1
+    add        offq, mmsize*2
+    cmp        offq, lenq
+        jl .next
+    RET
+%endmacro
 
 INIT_XMM sse
 MIX2_FLT u
 MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
+%if ARCH_X86_64
+MIXN_FLT
+%endif
 
 INIT_XMM sse2
 MIX1_INT16 u
@@ -241,4 +277,7 @@ MIX2_FLT u
 MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
+%if ARCH_X86_64
+MIXN_FLT
+%endif
 %endif
@@ -30,6 +30,9 @@ D(float, sse)
 D(float, avx)
 D(int16, sse2)
 
+mix_n_1_func_type ff_mix_n_1_float_sse;
+mix_n_1_func_type ff_mix_n_1_float_avx;
+
 av_cold int swri_rematrix_init_x86(struct SwrContext *s){
 #if HAVE_X86ASM
     int mm_flags = av_get_cpu_flags();
@@ -73,6 +76,12 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
             s->mix_1_1_simd = ff_mix_1_1_a_float_avx;
             s->mix_2_1_simd = ff_mix_2_1_a_float_avx;
         }
+#if ARCH_X86_64
+        if(EXTERNAL_SSE(mm_flags))
+            s->mix_n_1_simd = ff_mix_n_1_float_sse;
+        if(EXTERNAL_AVX_FAST(mm_flags))
+            s->mix_n_1_simd = ff_mix_n_1_float_avx;
+#endif
         s->native_simd_matrix = av_calloc(num, sizeof(float));
         s->native_simd_one = av_mallocz(sizeof(float));
         if (!s->native_simd_matrix || !s->native_simd_one)
@@ -30,12 +30,15 @@
 void ff_interleave_bytes_neon(const uint8_t *src1, const uint8_t *src2,
                               uint8_t *dest, int width, int height,
                               int src1Stride, int src2Stride, int dstStride);
+void ff_palette8topacked32_neon(const uint8_t *src, uint8_t *dst,
+                                int num_pixels, const uint8_t *palette);
 
 av_cold void rgb2rgb_init_aarch64(void)
 {
     int cpu_flags = av_get_cpu_flags();
 
     if (have_neon(cpu_flags)) {
-        interleaveBytes = ff_interleave_bytes_neon;
+        interleaveBytes    = ff_interleave_bytes_neon;
+        palette8topacked32 = ff_palette8topacked32_neon;
     }
 }
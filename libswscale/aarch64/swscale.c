@@ -46,6 +46,84 @@ void ff_yuv2plane1_8_neon(
         int dstW,
         const uint8_t *dither,
         int offset);
+void ff_yuv2planeX_10LE_neon(const int16_t *filter, int filterSize,
+                             const int16_t **src, uint8_t *dest, int dstW,
+                             const uint8_t *dither, int offset);
+void ff_yuv2plane1_10LE_neon(const int16_t *src, uint8_t *dest, int dstW,
+                             const uint8_t *dither, int offset);
+
+#define YUV2NV_DECL(fmt, opt) \
+void ff_yuv2 ## fmt ## cX_ ## opt(enum AVPixelFormat format, const uint8_t *dither, \
+                                  const int16_t *filter, int filterSize, \
+                                  const int16_t **u, const int16_t **v, \
+                                  uint8_t *dst, int dstWidth)
+
+YUV2NV_DECL(nv12, neon);
+YUV2NV_DECL(nv21, neon);
+
+#define INPUT_Y_FUNC(fmt, opt) \
+void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
+                                const uint8_t *unused1, const uint8_t *unused2, \
+                                int w, uint32_t *coeffs)
+#define INPUT_UV_FUNC(fmt, opt) \
+void ff_ ## fmt ## ToUV_ ## opt(uint8_t *dstU, uint8_t *dstV, \
+                                const uint8_t *unused0, \
+                                const uint8_t *src1, \
+                                const uint8_t *src2, \
+                                int w, uint32_t *coeffs)
+#define INPUT_FUNC(fmt, opt) \
+    INPUT_Y_FUNC(fmt, opt); \
+    INPUT_UV_FUNC(fmt, opt)
+
+INPUT_UV_FUNC(nv12, neon);
+INPUT_UV_FUNC(nv21, neon);
+INPUT_FUNC(p010LE, neon);
+INPUT_FUNC(rgba, neon);
+INPUT_FUNC(bgra, neon);
+INPUT_UV_FUNC(rgba, half_neon);
+INPUT_UV_FUNC(bgra, half_neon);
+
+#define YUV2RGB_FULL_X(fmt, opt)                                              \
+void ff_yuv2 ## fmt ## _full_X_ ## opt(const int *coeffs,                     \
+                                      const int16_t *lumFilter,               \
+                                      const int16_t **lumSrc,                 \
+                                      int lumFilterSize,                      \
+                                      const int16_t *chrFilter,               \
+                                      const int16_t **chrUSrc,                \
+                                      const int16_t **chrVSrc,                \
+                                      int chrFilterSize,                      \
+                                      const int16_t **alpSrc, uint8_t *dest,  \
+                                      int dstW);                              \
+static void yuv2 ## fmt ## _full_X_ ## opt(SwsContext *c,                     \
+                                           const int16_t *lumFilter,          \
+                                           const int16_t **lumSrc,            \
+                                           int lumFilterSize,                 \
+                                           const int16_t *chrFilter,          \
+                                           const int16_t **chrUSrc,           \
+                                           const int16_t **chrVSrc,           \
+                                           int chrFilterSize,                 \
+                                           const int16_t **alpSrc,            \
+                                           uint8_t *dest, int dstW, int y)    \
+{                                                                             \
+    ff_yuv2 ## fmt ## _full_X_ ## opt(&c->yuv2rgb_y_offset, lumFilter,        \
+                                      lumSrc, lumFilterSize, chrFilter,       \
+                                      chrUSrc, chrVSrc, chrFilterSize,        \
+                                      alpSrc, dest, dstW);                    \
+}
+
+YUV2RGB_FULL_X(rgba, neon)
+YUV2RGB_FULL_X(argb, neon)
+YUV2RGB_FULL_X(bgra, neon)
+YUV2RGB_FULL_X(abgr, neon)
+YUV2RGB_FULL_X(rgbx, neon)
+YUV2RGB_FULL_X(xrgb, neon)
+YUV2RGB_FULL_X(bgrx, neon)
+YUV2RGB_FULL_X(xbgr, neon)
+
+void ff_lumRangeToJpeg_neon(int16_t *dst, int width);
+void ff_lumRangeFromJpeg_neon(int16_t *dst, int width);
+void ff_chrRangeToJpeg_neon(int16_t *dstU, int16_t *dstV, int width);
+void ff_chrRangeFromJpeg_neon(int16_t *dstU, int16_t *dstV, int width);
 
 #define ASSIGN_SCALE_FUNC2(hscalefn, filtersize, opt) do {              \
     if (c->srcBpc == 8 && c->dstBpc <= 14) {                            \
@@ -66,6 +144,10 @@ void ff_yuv2plane1_8_neon(
 #define ASSIGN_VSCALE_FUNC(vscalefn, opt)                               \
     switch (c->dstBpc) {                                                \
     case 8: vscalefn = ff_yuv2plane1_8_  ## opt;  break;                \
+    case 10: if (!HAVE_BIGENDIAN && !isBE(c->dstFormat) &&              \
+                 !isSemiPlanarYUV(c->dstFormat))                        \
+                 vscalefn = ff_yuv2plane1_10LE_ ## opt;                 \
+             break;                                                     \
     default: break;                                                     \
     }
 
@@ -79,6 +161,119 @@ av_cold void ff_sws_init_swscale_aarch64(SwsContext *c)
         ASSIGN_VSCALE_FUNC(c->yuv2plane1, neon);
         if (c->dstBpc == 8) {
             c->yuv2planeX = ff_yuv2planeX_8_neon;
+        } else if (!HAVE_BIGENDIAN && c->dstBpc == 10 &&
+                   !isBE(c->dstFormat) && !isSemiPlanarYUV(c->dstFormat)) {
+            c->yuv2planeX = ff_yuv2planeX_10LE_neon;
+        }
+
+        switch (c->dstFormat) {
+        case AV_PIX_FMT_NV12:
+        case AV_PIX_FMT_NV24:
+            c->yuv2nv12cX = ff_yuv2nv12cX_neon;
+            break;
+        case AV_PIX_FMT_NV21:
+        case AV_PIX_FMT_NV42:
+            c->yuv2nv12cX = ff_yuv2nv21cX_neon;
+            break;
+        default:
+            break;
+        }
+
+        if (c->flags & SWS_FULL_CHR_H_INT) {
+            int alpha = CONFIG_SWSCALE_ALPHA && c->needAlpha;
+
+            switch (c->dstFormat) {
+            case AV_PIX_FMT_RGBA:
+                c->yuv2packedX = alpha ? yuv2rgba_full_X_neon : yuv2rgbx_full_X_neon;
+                break;
+            case AV_PIX_FMT_ARGB:
+                c->yuv2packedX = alpha ? yuv2argb_full_X_neon : yuv2xrgb_full_X_neon;
+                break;
+            case AV_PIX_FMT_BGRA:
+                c->yuv2packedX = alpha ? yuv2bgra_full_X_neon : yuv2bgrx_full_X_neon;
+                break;
+            case AV_PIX_FMT_ABGR:
+                c->yuv2packedX = alpha ? yuv2abgr_full_X_neon : yuv2xbgr_full_X_neon;
+                break;
+            default:
+                break;
+            }
+        }
+
+        switch (c->srcFormat) {
+        case AV_PIX_FMT_NV12:
+            c->chrToYV12 = ff_nv12ToUV_neon;
+            break;
+        case AV_PIX_FMT_NV21:
+            c->chrToYV12 = ff_nv21ToUV_neon;
+            break;
+#if !HAVE_BIGENDIAN
+        /* the samples are read in native byte order */
+        case AV_PIX_FMT_P010LE:
+        case AV_PIX_FMT_P210LE:
+        case AV_PIX_FMT_P410LE:
+            c->lumToYV12 = ff_p010LEToY_neon;
+            c->chrToYV12 = ff_p010LEToUV_neon;
+            break;
+#endif
+        case AV_PIX_FMT_RGBA:
+            c->lumToYV12 = ff_rgbaToY_neon;
+            c->chrToYV12 = c->chrSrcHSubSample ? ff_rgbaToUV_half_neon
+                                               : ff_rgbaToUV_neon;
+            break;
+        case AV_PIX_FMT_BGRA:
+            c->lumToYV12 = ff_bgraToY_neon;
+            c->chrToYV12 = c->chrSrcHSubSample ? ff_bgraToUV_half_neon
+                                               : ff_bgraToUV_neon;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+av_cold void ff_sws_init_range_convert_aarch64(SwsContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (have_neon(cpu_flags) && c->lumConvertRange && c->dstBpc <= 14) {
+        if (c->srcRange) {
+            c->lumConvertRange = ff_lumRangeFromJpeg_neon;
+            c->chrConvertRange = ff_chrRangeFromJpeg_neon;
+        } else {
+            c->lumConvertRange = ff_lumRangeToJpeg_neon;
+            c->chrConvertRange = ff_chrRangeToJpeg_neon;
+        }
+    }
+}
+
+void ff_fused_plane_2to1_neon(uint8_t *dst, const uint8_t *src0,
+                              const uint8_t *src1, int dstW);
+void ff_fused_plane_3to2_neon(uint8_t *dst, const uint8_t *src0,
+                              const uint8_t *src1, int dstW);
+void ff_fused_uv_2to1_neon(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                           const uint8_t *src1, int dstW);
+void ff_fused_uv_3to2_neon(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                           const uint8_t *src1, int dstW);
+void ff_fused_rgb_2to1_neon(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                            const uint8_t *uv, const int32_t *coeffs, int dstW);
+void ff_fused_hscale_uv_neon(int16_t *dstU, int16_t *dstV, int dstW,
+                             const uint8_t *src, const int16_t *filter,
+                             const int32_t *filterPos, int filterSize);
+
+av_cold void ff_sws_init_fused_aarch64(SwsContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+    int half = c->srcW == 2 * c->dstW;
+
+    if (have_neon(cpu_flags)) {
+        if (c->fused_plane) {
+            c->fused_plane = half ? ff_fused_plane_2to1_neon : ff_fused_plane_3to2_neon;
+            c->fused_uv    = half ? ff_fused_uv_2to1_neon    : ff_fused_uv_3to2_neon;
         }
+        if (c->fused_rgb)
+            c->fused_rgb = ff_fused_rgb_2to1_neon;
+        if (c->fused_hscale_uv && !(c->hChrFilterSize % 4))
+            c->fused_hscale_uv = ff_fused_hscale_uv_neon;
     }
 }
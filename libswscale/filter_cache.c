@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Process-wide cache of scaler filter coefficients, shared between all
+ * contexts scaling between the same sizes with the same parameters.
+ */
+
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#include "swscale_internal.h"
+
+#define MAX_CACHED_FILTERS 64
+
+typedef struct CachedFilter {
+    SwsFilterKey key;
+    AVBufferRef *buf;
+    uint64_t last_use;
+} CachedFilter;
+
+static AVMutex cache_mutex = AV_MUTEX_INITIALIZER;
+static CachedFilter cache[MAX_CACHED_FILTERS];
+static uint64_t cache_uses;
+
+static void filter_free(void *opaque, uint8_t *data)
+{
+    SwsFilterData *f = (SwsFilterData *)data;
+
+    av_free(f->filter);
+    av_free(f->filterPos);
+    av_free(f);
+}
+
+AVBufferRef *ff_sws_filter_wrap(int16_t *filter, int32_t *filterPos, int filterSize)
+{
+    SwsFilterData *f = av_mallocz(sizeof(*f));
+    AVBufferRef *buf;
+
+    if (!f)
+        return NULL;
+    buf = av_buffer_create((uint8_t *)f, sizeof(*f), filter_free, NULL,
+                           AV_BUFFER_FLAG_READONLY);
+    if (!buf) {
+        av_free(f);
+        return NULL;
+    }
+    f->filter     = filter;
+    f->filterPos  = filterPos;
+    f->filterSize = filterSize;
+    return buf;
+}
+
+AVBufferRef *ff_sws_filter_cache_get(const SwsFilterKey *key)
+{
+    AVBufferRef *buf = NULL;
+
+    ff_mutex_lock(&cache_mutex);
+    for (int i = 0; i < MAX_CACHED_FILTERS; i++) {
+        if (cache[i].buf && !memcmp(&cache[i].key, key, sizeof(*key))) {
+            cache[i].last_use = ++cache_uses;
+            buf = av_buffer_ref(cache[i].buf);
+            break;
+        }
+    }
+    ff_mutex_unlock(&cache_mutex);
+
+    return buf;
+}
+
+void ff_sws_filter_cache_add(const SwsFilterKey *key, AVBufferRef *buf)
+{
+    int slot = 0;
+
+    ff_mutex_lock(&cache_mutex);
+    for (int i = 0; i < MAX_CACHED_FILTERS; i++) {
+        /* added concurrently by another context */
+        if (cache[i].buf && !memcmp(&cache[i].key, key, sizeof(*key)))
+            goto end;
+        if (cache[slot].buf && (!cache[i].buf || cache[i].last_use < cache[slot].last_use))
+            slot = i;
+    }
+
+    /* contexts using an evicted filter keep their own reference to it */
+    av_buffer_unref(&cache[slot].buf);
+    cache[slot].buf = av_buffer_ref(buf);
+    if (cache[slot].buf) {
+        /* copied bytewise, with the zeroed padding the lookups compare */
+        memcpy(&cache[slot].key, key, sizeof(*key));
+        cache[slot].last_use = ++cache_uses;
+    }
+end:
+    ff_mutex_unlock(&cache_mutex);
+}
@@ -27,6 +27,7 @@
 
 #include "libavutil/attributes.h"
 #include "libavutil/bswap.h"
+#include "libavutil/thread.h"
 #include "config.h"
 #include "rgb2rgb.h"
 #include "swscale.h"
@@ -57,6 +58,9 @@ void (*shuffle_bytes_1230)(const uint8_t *src, uint8_t *dst, int src_size);
 void (*shuffle_bytes_3012)(const uint8_t *src, uint8_t *dst, int src_size);
 void (*shuffle_bytes_3210)(const uint8_t *src, uint8_t *dst, int src_size);
 
+void (*palette8topacked32)(const uint8_t *src, uint8_t *dst, int num_pixels,
+                           const uint8_t *palette);
+
 
 void (*yv12toyuy2)(const uint8_t *ysrc, const uint8_t *usrc,
                    const uint8_t *vsrc, uint8_t *dst,
@@ -144,6 +148,13 @@ av_cold void ff_sws_rgb2rgb_init(void)
 #endif
 }
 
+int ff_sws_rgb2rgb_init_once(void)
+{
+    static AVOnce rgb2rgb_once = AV_ONCE_INIT;
+
+    return ff_thread_once(&rgb2rgb_once, ff_sws_rgb2rgb_init);
+}
+
 void rgb32to24(const uint8_t *src, uint8_t *dst, int src_size)
 {
     int i, num_pixels = src_size >> 2;
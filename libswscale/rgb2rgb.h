@@ -53,6 +53,9 @@ extern void (*shuffle_bytes_1230)(const uint8_t *src, uint8_t *dst, int src_size
 extern void (*shuffle_bytes_3012)(const uint8_t *src, uint8_t *dst, int src_size);
 extern void (*shuffle_bytes_3210)(const uint8_t *src, uint8_t *dst, int src_size);
 
+extern void (*palette8topacked32)(const uint8_t *src, uint8_t *dst, int num_pixels,
+                                  const uint8_t *palette);
+
 void rgb64tobgr48_nobswap(const uint8_t *src, uint8_t *dst, int src_size);
 void   rgb64tobgr48_bswap(const uint8_t *src, uint8_t *dst, int src_size);
 void rgb48tobgr48_nobswap(const uint8_t *src, uint8_t *dst, int src_size);
@@ -166,6 +169,12 @@ extern void (*yuyvtoyuv422)(uint8_t *ydst, uint8_t *udst, uint8_t *vdst, const u
 
 void ff_sws_rgb2rgb_init(void);
 
+/**
+ * Run ff_sws_rgb2rgb_init() exactly once.
+ * @return 0 on success, a negative value otherwise
+ */
+int ff_sws_rgb2rgb_init_once(void);
+
 void rgb2rgb_init_aarch64(void);
 void rgb2rgb_init_x86(void);
 
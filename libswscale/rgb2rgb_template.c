@@ -314,6 +314,15 @@ static inline void rgb16to32_c(const uint8_t *src, uint8_t *dst, int src_size)
     }
 }
 
+static void palette8topacked32_c(const uint8_t *src, uint8_t *dst,
+                                 int num_pixels, const uint8_t *palette)
+{
+    int i;
+
+    for (i = 0; i < num_pixels; i++)
+        ((uint32_t *) dst)[i] = ((const uint32_t *) palette)[src[i]];
+}
+
 static inline void shuffle_bytes_2103_c(const uint8_t *src, uint8_t *dst,
                                         int src_size)
 {
@@ -971,6 +980,7 @@ static av_cold void rgb2rgb_init_c(void)
     shuffle_bytes_1230 = shuffle_bytes_1230_c;
     shuffle_bytes_3012 = shuffle_bytes_3012_c;
     shuffle_bytes_3210 = shuffle_bytes_3210_c;
+    palette8topacked32 = palette8topacked32_c;
     rgb32tobgr16       = rgb32tobgr16_c;
     rgb32tobgr15       = rgb32tobgr15_c;
     yv12toyuy2         = yv12toyuy2_c;
@@ -552,6 +552,10 @@ av_cold void ff_sws_init_range_convert(SwsContext *c)
             }
         }
     }
+
+#if ARCH_AARCH64
+    ff_sws_init_range_convert_aarch64(c);
+#endif
 }
 
 static av_cold void sws_init_swscale(SwsContext *c)
@@ -1039,6 +1043,9 @@ static int scale_internal(SwsContext *c,
                                   dst2, dstStride2);
         if (scale_dst)
             dst2[0] += dstSliceY * dstStride2[0];
+    } else if (c->convert_fused && srcSliceY_internal == 0 && srcSliceH == c->srcH) {
+        ret = c->convert_fused(c, src2, srcStride2, dst2, dstStride2,
+                               dstSliceY, dstSliceH);
     } else {
         ret = swscale(c, src2, srcStride2, srcSliceY_internal, srcSliceH,
                       dst2, dstStride2, dstSliceY, dstSliceH);
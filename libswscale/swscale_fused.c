@@ -0,0 +1,455 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Fused scaling and conversion of NV12/NV21 for common fixed ratios
+ *
+ * These converters read every source line once and write the destination
+ * directly, instead of going through the input conversion, horizontal scaler
+ * and vertical scaler ring buffers of swscale().
+ *
+ * With SWS_FAST_BILINEAR, they implement a box filter for 2:1 and a centered
+ * bilinear filter for 3:2 downscaling, and their output differs from the
+ * generic path. With the other scalers, they apply the filters of the context
+ * and their output is the same as the generic path.
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/mem_internal.h"
+#include "libavutil/pixfmt.h"
+#include "swscale.h"
+#include "swscale_internal.h"
+
+static void plane_2to1_c(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                         int dstW)
+{
+    for (int i = 0; i < dstW; i++)
+        dst[i] = (src0[2 * i] + src0[2 * i + 1] +
+                  src1[2 * i] + src1[2 * i + 1] + 2) >> 2;
+}
+
+static void uv_2to1_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                      const uint8_t *src1, int dstW)
+{
+    for (int i = 0; i < dstW; i++) {
+        dstU[i] = (src0[4 * i    ] + src0[4 * i + 2] +
+                   src1[4 * i    ] + src1[4 * i + 2] + 2) >> 2;
+        dstV[i] = (src0[4 * i + 1] + src0[4 * i + 3] +
+                   src1[4 * i + 1] + src1[4 * i + 3] + 2) >> 2;
+    }
+}
+
+/* Every 3 source pixels s0 s1 s2 give 2 destination pixels, centered at 1/3
+ * and 2/3 of s1: (3 * s0 + s1) / 4 and (s1 + 3 * s2) / 4. src0 is the line
+ * weighted by 3 and src1 the one weighted by 1. dstW must be even. */
+static void plane_3to2_c(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                         int dstW)
+{
+    for (int i = 0; i < dstW; i += 2) {
+        const uint8_t *a = src0 + 3 * i / 2, *b = src1 + 3 * i / 2;
+
+        dst[i]     = (3 * (3 * a[0] + a[1]) + 3 * b[0] + b[1] + 8) >> 4;
+        dst[i + 1] = (3 * (a[1] + 3 * a[2]) + b[1] + 3 * b[2] + 8) >> 4;
+    }
+}
+
+static void uv_3to2_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                      const uint8_t *src1, int dstW)
+{
+    for (int i = 0; i < dstW; i += 2) {
+        const uint8_t *a = src0 + 3 * i, *b = src1 + 3 * i;
+
+        dstU[i]     = (3 * (3 * a[0] + a[2]) + 3 * b[0] + b[2] + 8) >> 4;
+        dstV[i]     = (3 * (3 * a[1] + a[3]) + 3 * b[1] + b[3] + 8) >> 4;
+        dstU[i + 1] = (3 * (a[2] + 3 * a[4]) + b[2] + 3 * b[4] + 8) >> 4;
+        dstV[i + 1] = (3 * (a[3] + 3 * a[5]) + b[3] + 3 * b[5] + 8) >> 4;
+    }
+}
+
+/* Same arithmetic as yuv2rgb_write_full(), on the sum of 2x2 luma samples,
+ * which is used with 2 more fractional bits. */
+static void rgb_2to1_c(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                       const uint8_t *uv, const int32_t *coeffs, int dstW)
+{
+    for (int i = 0; i < dstW; i++) {
+        int Y = (src0[2 * i] + src0[2 * i + 1] + src1[2 * i] + src1[2 * i + 1]) << 7;
+        int C0 = (uv[2 * i]     - 128) << 9;
+        int C1 = (uv[2 * i + 1] - 128) << 9;
+
+        Y -= coeffs[0];
+        Y *= coeffs[1];
+        Y += 1 << 21;
+        for (int j = 0; j < 3; j++) {
+            int v = (unsigned)Y + C0 * (unsigned)coeffs[2 + 2 * j] +
+                                  C1 * (unsigned)coeffs[3 + 2 * j];
+            dst[4 * i + j] = av_clip_uintp2(v, 30) >> 22;
+        }
+        dst[4 * i + 3] = 255;
+    }
+}
+
+/* lines of the source weighted by 3 and 1 for the destination line y */
+static av_always_inline void src_lines_3to2(int y, int *y0, int *y1)
+{
+    *y0 = 3 * (y >> 1) + 2 * (y & 1);
+    *y1 = 3 * (y >> 1) + 1;
+}
+
+/* The SIMD kernels process multiples of 16 pixels, the C ones take the rest. */
+#define SIMD_MASK 15
+
+static av_always_inline int fused_to_yuv420p(SwsContext *c, const uint8_t *const src[],
+                                             const int srcStride[], uint8_t *const dst[],
+                                             const int dstStride[], int dstSliceY,
+                                             int dstSliceH, int three_halves)
+{
+    void (*plane_c)(uint8_t *, const uint8_t *, const uint8_t *, int) =
+        three_halves ? plane_3to2_c : plane_2to1_c;
+    void (*uv_c)(uint8_t *, uint8_t *, const uint8_t *, const uint8_t *, int) =
+        three_halves ? uv_3to2_c : uv_2to1_c;
+    const int w  = c->dstW,  simd_w  = w  & ~SIMD_MASK;
+    const int cw = w >> 1,   simd_cw = cw & ~SIMD_MASK;
+    const int src_simd_w  = three_halves ? simd_w  * 3 / 2 : simd_w  * 2;
+    const int src_simd_cw = three_halves ? simd_cw * 3     : simd_cw * 4;
+    /* the first chroma sample of NV21 is V */
+    uint8_t *dstU = dst[c->srcFormat == AV_PIX_FMT_NV21 ? 2 : 1];
+    uint8_t *dstV = dst[c->srcFormat == AV_PIX_FMT_NV21 ? 1 : 2];
+    const int cy_start = dstSliceY >> 1;
+    const int cy_end   = AV_CEIL_RSHIFT(dstSliceY + dstSliceH, 1);
+    int y0, y1;
+
+    for (int y = dstSliceY; y < dstSliceY + dstSliceH; y++) {
+        uint8_t *d = dst[0] + (y - dstSliceY) * dstStride[0];
+        const uint8_t *s0, *s1;
+
+        if (three_halves)
+            src_lines_3to2(y, &y0, &y1);
+        else
+            y0 = 2 * y, y1 = 2 * y + 1;
+        s0 = src[0] + y0 * srcStride[0];
+        s1 = src[0] + y1 * srcStride[0];
+
+        if (simd_w)
+            c->fused_plane(d, s0, s1, simd_w);
+        if (simd_w < w)
+            plane_c(d + simd_w, s0 + src_simd_w, s1 + src_simd_w, w - simd_w);
+    }
+
+    for (int y = cy_start; y < cy_end; y++) {
+        uint8_t *du = dstU + (y - cy_start) * dstStride[1];
+        uint8_t *dv = dstV + (y - cy_start) * dstStride[2];
+        const uint8_t *s0, *s1;
+
+        if (three_halves)
+            src_lines_3to2(y, &y0, &y1);
+        else
+            y0 = 2 * y, y1 = 2 * y + 1;
+        s0 = src[1] + y0 * srcStride[1];
+        s1 = src[1] + y1 * srcStride[1];
+
+        if (simd_cw)
+            c->fused_uv(du, dv, s0, s1, simd_cw);
+        if (simd_cw < cw)
+            uv_c(du + simd_cw, dv + simd_cw, s0 + src_simd_cw, s1 + src_simd_cw,
+                 cw - simd_cw);
+    }
+
+    return dstSliceH;
+}
+
+static int fused_2to1_yuv420p(SwsContext *c, const uint8_t *const src[],
+                              const int srcStride[], uint8_t *const dst[],
+                              const int dstStride[], int dstSliceY, int dstSliceH)
+{
+    return fused_to_yuv420p(c, src, srcStride, dst, dstStride,
+                            dstSliceY, dstSliceH, 0);
+}
+
+static int fused_3to2_yuv420p(SwsContext *c, const uint8_t *const src[],
+                              const int srcStride[], uint8_t *const dst[],
+                              const int dstStride[], int dstSliceY, int dstSliceH)
+{
+    return fused_to_yuv420p(c, src, srcStride, dst, dstStride,
+                            dstSliceY, dstSliceH, 1);
+}
+
+static int fused_2to1_rgb(SwsContext *c, const uint8_t *const src[],
+                          const int srcStride[], uint8_t *const dst[],
+                          const int dstStride[], int dstSliceY, int dstSliceH)
+{
+    const int w = c->dstW, simd_w = w & ~SIMD_MASK;
+    const int swap_uv = c->srcFormat == AV_PIX_FMT_NV21;
+    const int swap_rb = c->dstFormat == AV_PIX_FMT_BGRA;
+    const int u = swap_uv, v = !swap_uv;
+    int32_t coeffs[8] = { c->yuv2rgb_y_offset, c->yuv2rgb_y_coeff };
+    int32_t *r = coeffs + (swap_rb ? 6 : 2), *g = coeffs + 4, *b = coeffs + (swap_rb ? 2 : 6);
+
+    r[v] = c->yuv2rgb_v2r_coeff;
+    g[u] = c->yuv2rgb_u2g_coeff;
+    g[v] = c->yuv2rgb_v2g_coeff;
+    b[u] = c->yuv2rgb_u2b_coeff;
+
+    for (int y = dstSliceY; y < dstSliceY + dstSliceH; y++) {
+        uint8_t *d = dst[0] + (y - dstSliceY) * dstStride[0];
+        const uint8_t *s0 = src[0] + 2 * y * srcStride[0];
+        const uint8_t *s1 = s0 + srcStride[0];
+        const uint8_t *uv = src[1] + y * srcStride[1];
+
+        if (simd_w)
+            c->fused_rgb(d, s0, s1, uv, coeffs, simd_w);
+        if (simd_w < w)
+            rgb_2to1_c(d + 4 * simd_w, s0 + 2 * simd_w, s1 + 2 * simd_w,
+                       uv + 2 * simd_w, coeffs, w - simd_w);
+    }
+
+    return dstSliceH;
+}
+
+static void hscale_uv_c(int16_t *dstU, int16_t *dstV, int dstW, const uint8_t *src,
+                        const int16_t *filter, const int32_t *filterPos,
+                        int filterSize)
+{
+    for (int i = 0; i < dstW; i++) {
+        const uint8_t *s = src + 2 * filterPos[i];
+        int valU = 0, valV = 0;
+
+        for (int j = 0; j < filterSize; j++) {
+            valU += s[2 * j]     * filter[filterSize * i + j];
+            valV += s[2 * j + 1] * filter[filterSize * i + j];
+        }
+        /* clipped like in hScale8To15_c() */
+        dstU[i] = FFMIN(valU >> 7, (1 << 15) - 1);
+        dstV[i] = FFMIN(valV >> 7, (1 << 15) - 1);
+    }
+}
+
+/* 8 bit sources are not dithered, see swscale() */
+DECLARE_ALIGNED(8, static const uint8_t, dither_64)[8] = {
+    64, 64, 64, 64, 64, 64, 64, 64,
+};
+
+/* The filtered converter keeps the horizontally scaled lines of each plane in
+ * a ring with a slot per tap of the vertical filter, the line n in the slot
+ * n % filterSize. The rings follow the tables of line pointers passed to the
+ * vertical scaler in fused_buf. */
+
+static int fused_line_size(const SwsContext *c)
+{
+    return FFALIGN(c->dstW * sizeof(int16_t) + 66, 16);
+}
+
+static int fused_tables_size(const SwsContext *c)
+{
+    return FFALIGN((c->vLumFilterSize + 2 * c->vChrFilterSize) * sizeof(int16_t *), 16);
+}
+
+static av_always_inline int16_t *ring_line(uint8_t *ring, int n, int size,
+                                           int line_size)
+{
+    return (int16_t *)(ring + n % size * line_size);
+}
+
+static int fused_filtered_yuv420p(SwsContext *c, const uint8_t *const src[],
+                                  const int srcStride[], uint8_t *const dst[],
+                                  const int dstStride[], int dstSliceY, int dstSliceH)
+{
+    const int lum_size  = c->vLumFilterSize, chr_size = c->vChrFilterSize;
+    const int line_size = fused_line_size(c);
+    const int end       = dstSliceY + dstSliceH;
+    const int cy_start  = dstSliceY >> 1;
+    const int cy_end    = AV_CEIL_RSHIFT(end, 1);
+    const int16_t **lum = (const int16_t **)c->fused_buf;
+    const int16_t **chrU = lum + lum_size, **chrV = chrU + chr_size;
+    uint8_t *lum_ring = c->fused_buf + fused_tables_size(c);
+    uint8_t *u_ring   = lum_ring + lum_size * line_size;
+    uint8_t *v_ring   = u_ring   + chr_size * line_size;
+    /* the first chroma sample of NV21 is V */
+    const int swap_uv = c->srcFormat == AV_PIX_FMT_NV21;
+    uint8_t *convU    = c->formatConvBuffer;
+    uint8_t *convV    = convU + FFALIGN(c->srcW * 2 + 78, 16);
+    yuv2planar1_fn plane1 = c->yuv2plane1, plane1_c = NULL;
+    yuv2planarX_fn planeX = c->yuv2planeX, planeX_c = NULL;
+    int next;
+
+    if (end > c->dstH - 2) {
+        yuv2interleavedX_fn nv12cX;
+        yuv2packed1_fn packed1;
+        yuv2packed2_fn packed2;
+        yuv2packedX_fn packedX;
+        yuv2anyX_fn anyX;
+
+        /* the SIMD functions may write past the end of the last lines */
+        ff_sws_init_output_funcs(c, &plane1_c, &planeX_c, &nv12cX,
+                                 &packed1, &packed2, &packedX, &anyX);
+    }
+
+    next = c->vLumFilterPos[dstSliceY];
+    for (int y = dstSliceY; y < end; y++) {
+        const int first = c->vLumFilterPos[y];
+        const int last  = FFMIN(first + lum_size, c->srcH) - 1;
+        uint8_t *d = dst[0] + (y - dstSliceY) * dstStride[0];
+
+        for (next = FFMAX(next, first); next <= last; next++) {
+            int16_t *line = ring_line(lum_ring, next, lum_size, line_size);
+
+            c->hyScale(c, line, c->dstW, src[0] + next * srcStride[0],
+                       c->hLumFilter, c->hLumFilterPos, c->hLumFilterSize);
+            if (c->lumConvertRange)
+                c->lumConvertRange(line, c->dstW);
+        }
+        /* the taps past the last line have no weight */
+        for (int j = 0; j < lum_size; j++)
+            lum[j] = ring_line(lum_ring, FFMIN(first + j, last), lum_size, line_size);
+
+        if (y >= c->dstH - 2) {
+            plane1 = plane1_c;
+            planeX = planeX_c;
+        }
+        if (lum_size == 1)
+            plane1(lum[0], d, c->dstW, dither_64, 0);
+        else
+            planeX(c->vLumFilter + y * lum_size, lum_size, lum, d, c->dstW,
+                   dither_64, 0);
+    }
+
+    plane1 = c->yuv2plane1;
+    planeX = c->yuv2planeX;
+    next   = c->vChrFilterPos[cy_start];
+    for (int y = cy_start; y < cy_end; y++) {
+        const int first = c->vChrFilterPos[y];
+        const int last  = FFMIN(first + chr_size, c->chrSrcH) - 1;
+        uint8_t *du = dst[1] + (y - cy_start) * dstStride[1];
+        uint8_t *dv = dst[2] + (y - cy_start) * dstStride[2];
+
+        for (next = FFMAX(next, first); next <= last; next++) {
+            const uint8_t *s = src[1] + next * srcStride[1];
+            int16_t *u = ring_line(u_ring, next, chr_size, line_size);
+            int16_t *v = ring_line(v_ring, next, chr_size, line_size);
+
+            if (c->fused_hscale_uv) {
+                c->fused_hscale_uv(swap_uv ? v : u, swap_uv ? u : v, c->chrDstW, s,
+                                   c->hChrFilter, c->hChrFilterPos, c->hChrFilterSize);
+            } else {
+                c->chrToYV12(convU, convV, NULL, s, NULL, c->chrSrcW, NULL);
+                c->hcScale(c, u, c->chrDstW, convU, c->hChrFilter,
+                           c->hChrFilterPos, c->hChrFilterSize);
+                c->hcScale(c, v, c->chrDstW, convV, c->hChrFilter,
+                           c->hChrFilterPos, c->hChrFilterSize);
+            }
+            if (c->chrConvertRange)
+                c->chrConvertRange(u, v, c->chrDstW);
+        }
+        for (int j = 0; j < chr_size; j++) {
+            chrU[j] = ring_line(u_ring, FFMIN(first + j, last), chr_size, line_size);
+            chrV[j] = ring_line(v_ring, FFMIN(first + j, last), chr_size, line_size);
+        }
+
+        if (2 * y >= c->dstH - 2) {
+            plane1 = plane1_c;
+            planeX = planeX_c;
+        }
+        if (chr_size == 1) {
+            plane1(chrU[0], du, c->chrDstW, dither_64, 0);
+            plane1(chrV[0], dv, c->chrDstW, dither_64, 3);
+        } else {
+            const int16_t *filter = c->vChrFilter + y * chr_size;
+
+            planeX(filter, chr_size, chrU, du, c->chrDstW, dither_64, 0);
+            planeX(filter, chr_size, chrV, dv, c->chrDstW, dither_64, 3);
+        }
+    }
+
+    return dstSliceH;
+}
+
+static av_cold void init_filtered(SwsContext *c)
+{
+    const int lines = c->vLumFilterSize + 2 * c->vChrFilterSize;
+
+    /* the MMX vertical scaler reads the lines and coefficients from tables
+     * which are only set up by swscale() */
+    if (c->use_mmx_vfilter)
+        return;
+
+    c->fused_buf = av_mallocz(fused_tables_size(c) + lines * fused_line_size(c));
+    if (!c->fused_buf)
+        return;
+    c->convert_fused   = fused_filtered_yuv420p;
+    c->fused_hscale_uv = hscale_uv_c;
+}
+
+av_cold void ff_sws_init_fused(SwsContext *c)
+{
+    const int srcW = c->srcW, srcH = c->srcH, dstW = c->dstW, dstH = c->dstH;
+    const int half  = srcW == 2 * dstW && srcH == 2 * dstH;
+    const int third = 2 * srcW == 3 * dstW && 2 * srcH == 3 * dstH;
+
+    c->convert_fused   = NULL;
+    c->fused_plane     = NULL;
+    c->fused_uv        = NULL;
+    c->fused_rgb       = NULL;
+    c->fused_hscale_uv = NULL;
+    av_freep(&c->fused_buf);
+
+    if (c->gamma_flag ||
+        (c->srcFormat != AV_PIX_FMT_NV12 && c->srcFormat != AV_PIX_FMT_NV21))
+        return;
+
+    if (!(c->flags & SWS_FAST_BILINEAR)) {
+        if (c->dstFormat == AV_PIX_FMT_YUV420P && (half || third))
+            init_filtered(c);
+    } else {
+        switch (c->dstFormat) {
+        case AV_PIX_FMT_YUV420P:
+            if (c->srcRange != c->dstRange)
+                return;
+            if (half && !(srcW % 4) && !(srcH % 4)) {
+                c->convert_fused = fused_2to1_yuv420p;
+                c->fused_plane   = plane_2to1_c;
+                c->fused_uv      = uv_2to1_c;
+            } else if (third && !(srcW % 6) && !(srcH % 6)) {
+                c->convert_fused = fused_3to2_yuv420p;
+                c->fused_plane   = plane_3to2_c;
+                c->fused_uv      = uv_3to2_c;
+            }
+            break;
+        case AV_PIX_FMT_RGBA:
+        case AV_PIX_FMT_BGRA:
+            if (half && !(srcW % 2) && !(srcH % 2)) {
+                c->convert_fused = fused_2to1_rgb;
+                c->fused_rgb     = rgb_2to1_c;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!c->convert_fused)
+        return;
+
+#if ARCH_AARCH64
+    ff_sws_init_fused_aarch64(c);
+#elif ARCH_X86
+    ff_sws_init_fused_x86(c);
+#endif
+}
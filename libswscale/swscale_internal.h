@@ -674,6 +674,52 @@ typedef struct SwsContext {
     unsigned int dst_slice_align;
     atomic_int   stride_unaligned_warned;
     atomic_int   data_unaligned_warned;
+
+    /**
+     * References to the SwsFilterData the h/v filters and positions are
+     * taken from when they are shared through the filter cache, NULL when
+     * they are owned by this context.
+     */
+    AVBufferRef *hLumFilterBuf;
+    AVBufferRef *hChrFilterBuf;
+    AVBufferRef *vLumFilterBuf;
+    AVBufferRef *vChrFilterBuf;
+
+    /**
+     * Scale and convert a whole source picture in a single pass, set by
+     * ff_sws_init_fused() for some formats and fixed ratios.
+     *
+     * @return the number of destination lines written
+     */
+    int (*convert_fused)(struct SwsContext *c, const uint8_t *const src[],
+                         const int srcStride[], uint8_t *const dst[],
+                         const int dstStride[], int dstSliceY, int dstSliceH);
+    /**
+     * Line kernels of convert_fused, the SIMD versions only handle widths
+     * that are multiples of 16.
+     */
+    void (*fused_plane)(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                        int dstW);
+    void (*fused_uv)(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                     const uint8_t *src1, int dstW);
+    /**
+     * coeffs holds the luma offset and factor, then the factors of both
+     * chroma samples for each of the 3 colors, in destination order.
+     */
+    void (*fused_rgb)(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                      const uint8_t *uv, const int32_t *coeffs, int dstW);
+    /**
+     * Horizontally scale a line of interleaved chroma into both planes, with
+     * the same output as chrToYV12() followed by hcScale(). NULL when the
+     * chroma is deinterleaved first.
+     */
+    void (*fused_hscale_uv)(int16_t *dstU, int16_t *dstV, int dstW,
+                            const uint8_t *src, const int16_t *filter,
+                            const int32_t *filterPos, int filterSize);
+    /**
+     * Rings of horizontally scaled lines of the filtered fused converters.
+     */
+    uint8_t *fused_buf;
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -954,6 +1000,13 @@ void ff_get_unscaled_swscale_aarch64(SwsContext *c);
 
 void ff_sws_init_scale(SwsContext *c);
 
+/**
+ * Set c->convert_fused if the conversion can be done by a fused converter.
+ */
+void ff_sws_init_fused(SwsContext *c);
+void ff_sws_init_fused_x86(SwsContext *c);
+void ff_sws_init_fused_aarch64(SwsContext *c);
+
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2planar1_fn *yuv2plane1,
@@ -967,6 +1020,7 @@ void ff_sws_init_swscale_ppc(SwsContext *c);
 void ff_sws_init_swscale_vsx(SwsContext *c);
 void ff_sws_init_swscale_x86(SwsContext *c);
 void ff_sws_init_swscale_aarch64(SwsContext *c);
+void ff_sws_init_range_convert_aarch64(SwsContext *c);
 void ff_sws_init_swscale_arm(SwsContext *c);
 
 void ff_hyscale_fast_c(SwsContext *c, int16_t *dst, int dstWidth,
@@ -1143,4 +1197,43 @@ void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
 
 //shuffle filter and filterPos for hyScale and hcScale filters in avx2
 int ff_shuffle_filter_coefficients(SwsContext *c, int* filterPos, int filterSize, int16_t *filter, int dstW);
+
+/**
+ * All the inputs of the computation of a scaler filter, used as key of the
+ * process-wide filter cache. Must be zeroed before being filled in, as keys
+ * are compared bytewise.
+ */
+typedef struct SwsFilterKey {
+    int xInc, srcW, dstW;
+    int filterAlign, one;
+    int flags, cpu_flags;
+    double param[2];
+    int srcPos, dstPos;
+    /* horizontal filters are reordered for the scaler of these depths */
+    int srcBpc, dstBpc;
+} SwsFilterKey;
+
+typedef struct SwsFilterData {
+    int16_t *filter;
+    int32_t *filterPos;
+    int filterSize;
+} SwsFilterData;
+
+/**
+ * Wrap filter and filterPos in a refcounted SwsFilterData, which takes
+ * ownership of them on success.
+ */
+AVBufferRef *ff_sws_filter_wrap(int16_t *filter, int32_t *filterPos, int filterSize);
+
+/**
+ * @return a new reference to the filter cached for key, NULL if there is none
+ */
+AVBufferRef *ff_sws_filter_cache_get(const SwsFilterKey *key);
+
+/**
+ * Make the filter in buf available to other contexts, evicting the least
+ * recently used filter if the cache is full. Failures are not fatal and are
+ * silently ignored.
+ */
+void ff_sws_filter_cache_add(const SwsFilterKey *key, AVBufferRef *buf);
 #endif /* SWSCALE_SWSCALE_INTERNAL_H */
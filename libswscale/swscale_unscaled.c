@@ -2235,10 +2235,14 @@ void ff_get_unscaled_swscale(SwsContext *c)
 void sws_convertPalette8ToPacked32(const uint8_t *src, uint8_t *dst,
                                    int num_pixels, const uint8_t *palette)
 {
-    int i;
+    if (ff_sws_rgb2rgb_init_once() < 0) {
+        int i;
 
-    for (i = 0; i < num_pixels; i++)
-        ((uint32_t *) dst)[i] = ((const uint32_t *) palette)[src[i]];
+        for (i = 0; i < num_pixels; i++)
+            ((uint32_t *) dst)[i] = ((const uint32_t *) palette)[src[i]];
+        return;
+    }
+    palette8topacked32(src, dst, num_pixels, palette);
 }
 
 /* Palette format: ABCD -> dst format: ABC */
@@ -0,0 +1,116 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/mem.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+static void fill_key(SwsFilterKey *key, int dstW)
+{
+    memset(key, 0, sizeof(*key));
+    key->xInc        = 1 << 16;
+    key->srcW        = 64;
+    key->dstW        = dstW;
+    key->filterAlign = 1;
+    key->one         = 1 << 14;
+    key->flags       = SWS_BICUBIC;
+    key->param[0]    = SWS_PARAM_DEFAULT;
+    key->param[1]    = SWS_PARAM_DEFAULT;
+}
+
+static AVBufferRef *new_filter(void)
+{
+    int16_t *filter    = av_mallocz(sizeof(*filter));
+    int32_t *filterPos = av_mallocz(sizeof(*filterPos));
+    AVBufferRef *buf   = filter && filterPos ? ff_sws_filter_wrap(filter, filterPos, 1) : NULL;
+
+    if (!buf) {
+        av_free(filter);
+        av_free(filterPos);
+    }
+    return buf;
+}
+
+static void test_lookup(void)
+{
+    AVBufferRef *buf = new_filter(), *hit, *miss;
+    SwsFilterKey key;
+
+    if (!buf)
+        return;
+    fill_key(&key, 32);
+    ff_sws_filter_cache_add(&key, buf);
+
+    /* a key built separately, with its own zeroed padding */
+    fill_key(&key, 32);
+    hit  = ff_sws_filter_cache_get(&key);
+    fill_key(&key, 48);
+    miss = ff_sws_filter_cache_get(&key);
+    printf("same key: %s\n", hit && hit->data == buf->data ? "hit" : "miss");
+    printf("other key: %s\n", miss ? "hit" : "miss");
+
+    av_buffer_unref(&hit);
+    av_buffer_unref(&miss);
+    av_buffer_unref(&buf);
+}
+
+static struct SwsContext *get_context(int dstW, int dstH, int flags)
+{
+    return sws_getContext(64, 48, AV_PIX_FMT_YUV420P, dstW, dstH,
+                          AV_PIX_FMT_YUV420P, flags, NULL, NULL, NULL);
+}
+
+static void test_contexts(void)
+{
+    struct SwsContext *a = get_context(32, 24, SWS_BICUBIC);
+    struct SwsContext *b = get_context(32, 24, SWS_BICUBIC);
+    struct SwsContext *c = get_context(32, 24, SWS_BILINEAR);
+
+    if (!a || !b || !c) {
+        printf("cannot create the contexts\n");
+    } else {
+        printf("same parameters: %s\n",
+               a->hLumFilter == b->hLumFilter && a->vLumFilter == b->vLumFilter &&
+               a->hChrFilter == b->hChrFilter && a->vChrFilter == b->vChrFilter ?
+               "shared" : "not shared");
+        printf("other flags: %s\n",
+               a->hLumFilter == c->hLumFilter || a->vLumFilter == c->vLumFilter ?
+               "shared" : "not shared");
+    }
+
+    /* the shared filters outlive the context they were computed for */
+    sws_freeContext(a);
+    a = get_context(32, 24, SWS_BICUBIC);
+    printf("after free: %s\n", a && b && a->hLumFilter == b->hLumFilter ?
+           "shared" : "not shared");
+
+    sws_freeContext(a);
+    sws_freeContext(b);
+    sws_freeContext(c);
+}
+
+int main(void)
+{
+    test_lookup();
+    test_contexts();
+    return 0;
+}
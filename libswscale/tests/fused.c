@@ -0,0 +1,192 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+/* The fused converters scale whole source pictures, into the whole
+ * destination or slices of it, the generic path is used when the source is
+ * passed in slices. Both must give the same output for the scalers which
+ * apply the filters of the context. */
+
+#define SRC_SLICE_H 16
+
+static const struct {
+    int srcW, srcH, dstW, dstH;
+} sizes[] = {
+    {  96,  64,  48,  32 },
+    {  96,  66,  64,  44 },
+    { 132,  70,  66,  35 },
+};
+
+/* The MMX vertical scaler of x86, which is not used with accurate_rnd, does
+ * not give the same output for all the slicings. */
+static const struct {
+    const char *name;
+    int flags;
+} scalers[] = {
+    { "bilinear+accurate_rnd", SWS_BILINEAR | SWS_ACCURATE_RND },
+    { "bicubic+accurate_rnd",  SWS_BICUBIC  | SWS_ACCURATE_RND },
+    { "lanczos+accurate_rnd",  SWS_LANCZOS  | SWS_ACCURATE_RND },
+    { "area+accurate_rnd",     SWS_AREA     | SWS_ACCURATE_RND },
+    { "bicubic+bitexact",      SWS_BICUBIC  | SWS_ACCURATE_RND | SWS_BITEXACT },
+};
+
+static AVFrame *alloc_frame(enum AVPixelFormat format, int w, int h)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+    frame->format = format;
+    frame->width  = w;
+    frame->height = h;
+    if (av_frame_get_buffer(frame, 0) < 0)
+        av_frame_free(&frame);
+    return frame;
+}
+
+static int same_picture(const AVFrame *a, const AVFrame *b)
+{
+    for (int p = 0; p < 3; p++) {
+        int w = p ? AV_CEIL_RSHIFT(a->width,  1) : a->width;
+        int h = p ? AV_CEIL_RSHIFT(a->height, 1) : a->height;
+
+        for (int y = 0; y < h; y++)
+            if (memcmp(a->data[p] + y * a->linesize[p],
+                       b->data[p] + y * b->linesize[p], w))
+                return 0;
+    }
+    return 1;
+}
+
+static int scale_sliced(struct SwsContext *sws, const AVFrame *src, AVFrame *dst)
+{
+    for (int y = 0; y < src->height; y += SRC_SLICE_H) {
+        const uint8_t *planes[4] = {
+            src->data[0] +  y       * src->linesize[0],
+            src->data[1] + (y >> 1) * src->linesize[1],
+        };
+        int h = FFMIN(SRC_SLICE_H, src->height - y);
+
+        if (sws_scale(sws, planes, src->linesize, y, h, dst->data, dst->linesize) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static struct SwsContext *get_context(enum AVPixelFormat src_fmt, int s, int flags,
+                                      int threads, int full_range)
+{
+    struct SwsContext *sws = sws_alloc_context();
+    const int *table = sws_getCoefficients(SWS_CS_DEFAULT);
+
+    if (!sws)
+        return NULL;
+    av_opt_set_int(sws, "srcw",       sizes[s].srcW,      0);
+    av_opt_set_int(sws, "srch",       sizes[s].srcH,      0);
+    av_opt_set_int(sws, "src_format", src_fmt,            0);
+    av_opt_set_int(sws, "dstw",       sizes[s].dstW,      0);
+    av_opt_set_int(sws, "dsth",       sizes[s].dstH,      0);
+    av_opt_set_int(sws, "dst_format", AV_PIX_FMT_YUV420P, 0);
+    av_opt_set_int(sws, "sws_flags",  flags,              0);
+    av_opt_set_int(sws, "threads",    threads,            0);
+    if (sws_init_context(sws, NULL, NULL) < 0 ||
+        (full_range &&
+         sws_setColorspaceDetails(sws, table, 1, table, 0, 0, 1 << 16, 1 << 16) < 0)) {
+        sws_freeContext(sws);
+        return NULL;
+    }
+    return sws;
+}
+
+static int test(AVLFG *lfg, enum AVPixelFormat src_fmt, int s, int f, int full_range)
+{
+    AVFrame *src = alloc_frame(src_fmt, sizes[s].srcW, sizes[s].srcH);
+    AVFrame *whole = NULL, *sliced = NULL, *generic = NULL;
+    struct SwsContext *sws = NULL, *threaded = NULL;
+    int ret = -1;
+
+    printf("%s %dx%d -> yuv420p %dx%d %s%s: ", av_get_pix_fmt_name(src_fmt),
+           sizes[s].srcW, sizes[s].srcH, sizes[s].dstW, sizes[s].dstH,
+           scalers[f].name, full_range ? " full range" : "");
+
+    if (!src)
+        goto end;
+    for (int p = 0; p < 2; p++) {
+        int h = p ? AV_CEIL_RSHIFT(src->height, 1) : src->height;
+
+        for (int i = 0; i < h * src->linesize[p]; i++)
+            src->data[p][i] = av_lfg_get(lfg);
+    }
+
+    whole    = alloc_frame(AV_PIX_FMT_YUV420P, sizes[s].dstW, sizes[s].dstH);
+    sliced   = alloc_frame(AV_PIX_FMT_YUV420P, sizes[s].dstW, sizes[s].dstH);
+    generic  = alloc_frame(AV_PIX_FMT_YUV420P, sizes[s].dstW, sizes[s].dstH);
+    sws      = get_context(src_fmt, s, scalers[f].flags, 1, full_range);
+    /* each thread scales a slice of the destination */
+    threaded = get_context(src_fmt, s, scalers[f].flags, 3, full_range);
+    if (!whole || !sliced || !generic || !sws || !threaded)
+        goto end;
+
+    if (sws_scale_frame(sws, whole, src) < 0 ||
+        sws_scale_frame(threaded, sliced, src) < 0 ||
+        scale_sliced(sws, src, generic) < 0)
+        goto end;
+
+    ret = same_picture(whole, generic) && same_picture(sliced, generic) ? 0 : 1;
+
+end:
+    printf("%s\n", ret < 0 ? "failed" : ret ? "differs" : "same");
+    av_frame_free(&src);
+    av_frame_free(&whole);
+    av_frame_free(&sliced);
+    av_frame_free(&generic);
+    sws_freeContext(sws);
+    sws_freeContext(threaded);
+    return ret;
+}
+
+int main(void)
+{
+    static const enum AVPixelFormat src_fmts[] = { AV_PIX_FMT_NV12, AV_PIX_FMT_NV21 };
+    AVLFG lfg;
+    int ret = 0;
+
+    av_lfg_init(&lfg, 0xC0FFEE);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(src_fmts); i++)
+        for (int s = 0; s < FF_ARRAY_ELEMS(sizes); s++)
+            for (int f = 0; f < FF_ARRAY_ELEMS(scalers); f++)
+                if (test(&lfg, src_fmts[i], s, f, 0))
+                    ret = 1;
+
+    /* the range is converted after the horizontal scaler */
+    for (int f = 0; f < 2; f++)
+        if (test(&lfg, AV_PIX_FMT_NV12, 0, f, 1))
+            ret = 1;
+
+    return ret;
+}
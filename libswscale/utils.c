@@ -765,6 +765,70 @@ done:
     return ret;
 }
 
+/**
+ * Get a filter from the filter cache, computing and caching it if needed.
+ * Horizontal filters are reordered for the hscale functions of c.
+ */
+static av_cold int get_filter(SwsContext *c, AVBufferRef **buf,
+                              int16_t **outFilter, int32_t **filterPos,
+                              int *outFilterSize, int xInc, int srcW,
+                              int dstW, int filterAlign, int one,
+                              int flags, int cpu_flags,
+                              SwsVector *srcFilter, SwsVector *dstFilter,
+                              double param[2], int srcPos, int dstPos,
+                              int horizontal)
+{
+    const SwsFilterData *data;
+    SwsFilterKey key;
+    int ret;
+
+    memset(&key, 0, sizeof(key));
+    key.xInc        = xInc;
+    key.srcW        = srcW;
+    key.dstW        = dstW;
+    key.filterAlign = filterAlign;
+    key.one         = one;
+    key.flags       = flags;
+    key.cpu_flags   = cpu_flags;
+    key.param[0]    = param[0];
+    key.param[1]    = param[1];
+    key.srcPos      = srcPos;
+    key.dstPos      = dstPos;
+    if (horizontal) {
+        key.srcBpc = c->srcBpc;
+        key.dstBpc = c->dstBpc;
+    }
+
+    /* user supplied filter vectors are not part of the key */
+    if (!srcFilter && !dstFilter)
+        *buf = ff_sws_filter_cache_get(&key);
+
+    if (!*buf) {
+        if ((ret = initFilter(outFilter, filterPos, outFilterSize, xInc, srcW,
+                              dstW, filterAlign, one, flags, cpu_flags,
+                              srcFilter, dstFilter, param, srcPos, dstPos)) < 0)
+            return ret;
+        if (horizontal &&
+            ff_shuffle_filter_coefficients(c, *filterPos, *outFilterSize,
+                                           *outFilter, dstW) < 0)
+            return AVERROR(ENOMEM);
+        if (srcFilter || dstFilter)
+            return 0;
+
+        /* on failure, the filter stays owned by the context */
+        *buf = ff_sws_filter_wrap(*outFilter, *filterPos, *outFilterSize);
+        if (!*buf)
+            return AVERROR(ENOMEM);
+        ff_sws_filter_cache_add(&key, *buf);
+    }
+
+    data           = (const SwsFilterData *)(*buf)->data;
+    *outFilter     = data->filter;
+    *filterPos     = data->filterPos;
+    *outFilterSize = data->filterSize;
+    return 0;
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -956,6 +1020,10 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     if (need_reinit && (c->srcBpc == 8 || !isYUV(c->srcFormat)))
         ff_sws_init_range_convert(c);
 
+    // the box filters of the fused converters do not convert the range
+    if (need_reinit && c->convert_fused)
+        ff_sws_init_fused(c);
+
     c->dstFormatBpp = av_get_bits_per_pixel(desc_dst);
     c->srcFormatBpp = av_get_bits_per_pixel(desc_src);
 
@@ -1311,7 +1379,6 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     int ret = 0;
     enum AVPixelFormat tmpFmt;
     static const float float_mult = 1.0f / 255.0f;
-    static AVOnce rgb2rgb_once = AV_ONCE_INIT;
 
     if (c->nb_threads != 1) {
         ret = context_init_threaded(c, srcFilter, dstFilter);
@@ -1323,7 +1390,7 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     cpu_flags = av_get_cpu_flags();
     flags     = c->flags;
     emms_c();
-    if (ff_thread_once(&rgb2rgb_once, ff_sws_rgb2rgb_init) != 0)
+    if (ff_sws_rgb2rgb_init_once() != 0)
         return AVERROR_UNKNOWN;
 
     unscaled = (srcW == dstW && srcH == dstH);
@@ -1825,28 +1892,26 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                                     PPC_ALTIVEC(cpu_flags) ? 8 :
                                     have_neon(cpu_flags)   ? 4 : 1;
 
-            if ((ret = initFilter(&c->hLumFilter, &c->hLumFilterPos,
+            if ((ret = get_filter(c, &c->hLumFilterBuf,
+                           &c->hLumFilter, &c->hLumFilterPos,
                            &c->hLumFilterSize, c->lumXInc,
                            srcW, dstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                            cpu_flags, srcFilter->lumH, dstFilter->lumH,
                            c->param,
                            get_local_pos(c, 0, 0, 0),
-                           get_local_pos(c, 0, 0, 0))) < 0)
+                           get_local_pos(c, 0, 0, 0), 1)) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hLumFilterPos, c->hLumFilterSize, c->hLumFilter, dstW) < 0)
-                goto nomem;
-            if ((ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
+            if ((ret = get_filter(c, &c->hChrFilterBuf,
+                           &c->hChrFilter, &c->hChrFilterPos,
                            &c->hChrFilterSize, c->chrXInc,
                            c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
                            cpu_flags, srcFilter->chrH, dstFilter->chrH,
                            c->param,
                            get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
-                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0))) < 0)
+                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0), 1)) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hChrFilterPos, c->hChrFilterSize, c->hChrFilter, c->chrDstW) < 0)
-                goto nomem;
         }
     } // initialize horizontal stuff
 
@@ -1856,22 +1921,24 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                                 PPC_ALTIVEC(cpu_flags) ? 8 :
                                 have_neon(cpu_flags)   ? 2 : 1;
 
-        if ((ret = initFilter(&c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
+        if ((ret = get_filter(c, &c->vLumFilterBuf,
+                       &c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
                        c->lumYInc, srcH, dstH, filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                        cpu_flags, srcFilter->lumV, dstFilter->lumV,
                        c->param,
                        get_local_pos(c, 0, 0, 1),
-                       get_local_pos(c, 0, 0, 1))) < 0)
+                       get_local_pos(c, 0, 0, 1), 0)) < 0)
             goto fail;
-        if ((ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
+        if ((ret = get_filter(c, &c->vChrFilterBuf,
+                       &c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
                        c->chrYInc, c->chrSrcH, c->chrDstH,
                        filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
                        cpu_flags, srcFilter->chrV, dstFilter->chrV,
                        c->param,
                        get_local_pos(c, c->chrSrcVSubSample, c->src_v_chr_pos, 1),
-                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1))) < 0)
+                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1), 0)) < 0)
 
             goto fail;
 
@@ -1988,6 +2055,11 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
 
     ff_sws_init_scale(c);
 
+    ff_sws_init_fused(c);
+    if (c->convert_fused && (flags & SWS_PRINT_INFO))
+        av_log(c, AV_LOG_INFO, "using fused %s -> %s converter\n",
+               av_get_pix_fmt_name(srcFormat), av_get_pix_fmt_name(dstFormat));
+
     return ff_init_filters(c);
 nomem:
     ret = AVERROR(ENOMEM);
@@ -2380,6 +2452,18 @@ void sws_freeFilter(SwsFilter *filter)
     av_free(filter);
 }
 
+static void free_filter(AVBufferRef **buf, int16_t **filter, int32_t **filterPos)
+{
+    if (*buf) {
+        av_buffer_unref(buf);
+        *filter    = NULL;
+        *filterPos = NULL;
+    } else {
+        av_freep(filter);
+        av_freep(filterPos);
+    }
+}
+
 void sws_freeContext(SwsContext *c)
 {
     int i;
@@ -2401,20 +2485,15 @@ void sws_freeContext(SwsContext *c)
 
     av_freep(&c->src_ranges.ranges);
 
-    av_freep(&c->vLumFilter);
-    av_freep(&c->vChrFilter);
-    av_freep(&c->hLumFilter);
-    av_freep(&c->hChrFilter);
+    free_filter(&c->vLumFilterBuf, &c->vLumFilter, &c->vLumFilterPos);
+    free_filter(&c->vChrFilterBuf, &c->vChrFilter, &c->vChrFilterPos);
+    free_filter(&c->hLumFilterBuf, &c->hLumFilter, &c->hLumFilterPos);
+    free_filter(&c->hChrFilterBuf, &c->hChrFilter, &c->hChrFilterPos);
 #if HAVE_ALTIVEC
     av_freep(&c->vYCoeffsBank);
     av_freep(&c->vCCoeffsBank);
 #endif
 
-    av_freep(&c->vLumFilterPos);
-    av_freep(&c->vChrFilterPos);
-    av_freep(&c->hLumFilterPos);
-    av_freep(&c->hChrFilterPos);
-
 #if HAVE_MMX_INLINE
 #if USE_MMAP
     if (c->lumMmxextFilterCode)
@@ -2436,6 +2515,7 @@ void sws_freeContext(SwsContext *c)
 
     av_freep(&c->yuvTable);
     av_freep(&c->formatConvBuffer);
+    av_freep(&c->fused_buf);
 
     sws_freeContext(c->cascaded_context[0]);
     sws_freeContext(c->cascaded_context[1]);
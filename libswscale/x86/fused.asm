@@ -0,0 +1,298 @@
+;******************************************************************************
+;* x86-optimized kernels of the fused NV12 scaling converters
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+fused_pb_1:          times 16 db 1
+fused_pb_3113:       times 4 db 3, 1, 1, 3
+fused_pb_uv_3113:    times 2 db 3, 1, 3, 1, 1, 3, 1, 3
+fused_pw_2:          times 8 dw 2
+fused_pw_8:          times 8 dw 8
+fused_pw_128:        times 8 dw 128
+fused_pw_255:        times 8 dw 255
+
+; pairs of source pixels of the destination pixels of 3:2 scaling, for bytes
+; 0-11 and for bytes 12-23 loaded from offset 8
+shuf_3to2_lo:        db 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11
+shuf_3to2_hi:        db 4, 5, 5, 6, 7, 8, 8, 9, 10, 11, 11, 12, 13, 14, 14, 15
+shuf_uv_3to2_lo:     db 0, 2, 1, 3, 2, 4, 3, 5, 6, 8, 7, 9, 8, 10, 9, 11
+shuf_uv_3to2_hi:     db 4, 6, 5, 7, 6, 8, 7, 9, 10, 12, 11, 13, 12, 14, 13, 15
+; u0 u1 v0 v1 u2 u3 v2 v3...
+shuf_uv_pairs:       db 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 12, 14, 13, 15
+; even bytes followed by odd bytes
+shuf_deinterleave:   db 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_fused_plane_2to1(uint8_t *dst, const uint8_t *src0,
+;                          const uint8_t *src1, int dstW)
+;-----------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal fused_plane_2to1, 4, 4, 5, dst, src0, src1, w
+    mova            m4, [fused_pb_1]
+    mova            m3, [fused_pw_2]
+    movsxdifnidn    wq, wd
+    add           dstq, wq
+    lea          src0q, [src0q + 2 * wq]
+    lea          src1q, [src1q + 2 * wq]
+    neg             wq
+.loop:
+    movu            m0, [src0q + 2 * wq]
+    movu            m1, [src0q + 2 * wq + mmsize]
+    movu            m2, [src1q + 2 * wq]
+    pmaddubsw       m0, m4                  ; sums of horizontal pairs
+    pmaddubsw       m1, m4
+    pmaddubsw       m2, m4
+    paddw           m0, m2
+    movu            m2, [src1q + 2 * wq + mmsize]
+    pmaddubsw       m2, m4
+    paddw           m1, m2
+    paddw           m0, m3
+    paddw           m1, m3
+    psrlw           m0, 2
+    psrlw           m1, 2
+    packuswb        m0, m1
+    movu   [dstq + wq], m0
+    add             wq, mmsize
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_fused_uv_2to1(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+;                       const uint8_t *src1, int dstW)
+;-----------------------------------------------------------------------------
+cglobal fused_uv_2to1, 5, 5, 7, dstU, dstV, src0, src1, w
+    mova            m4, [fused_pb_1]
+    mova            m3, [fused_pw_2]
+    mova            m5, [shuf_uv_pairs]
+    mova            m6, [shuf_deinterleave]
+    movsxdifnidn    wq, wd
+    add          dstUq, wq
+    add          dstVq, wq
+    lea          src0q, [src0q + 4 * wq]
+    lea          src1q, [src1q + 4 * wq]
+    neg             wq
+.loop:
+    movu            m0, [src0q + 4 * wq]
+    movu            m2, [src1q + 4 * wq]
+    pshufb          m0, m5
+    pshufb          m2, m5
+    pmaddubsw       m0, m4                  ; u01 v01 u23 v23...
+    pmaddubsw       m2, m4
+    paddw           m0, m2
+    movu            m1, [src0q + 4 * wq + mmsize]
+    movu            m2, [src1q + 4 * wq + mmsize]
+    pshufb          m1, m5
+    pshufb          m2, m5
+    pmaddubsw       m1, m4
+    pmaddubsw       m2, m4
+    paddw           m1, m2
+    paddw           m0, m3
+    paddw           m1, m3
+    psrlw           m0, 2
+    psrlw           m1, 2
+    packuswb        m0, m1
+    pshufb          m0, m6
+    movq  [dstUq + wq], m0
+    movhps [dstVq + wq], m0
+    add             wq, mmsize / 2
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_fused_plane_3to2(uint8_t *dst, const uint8_t *src0,
+;                          const uint8_t *src1, int dstW)
+;-----------------------------------------------------------------------------
+cglobal fused_plane_3to2, 4, 4, 8, dst, src0, src1, w
+    mova            m4, [fused_pw_8]
+    mova            m5, [fused_pb_3113]
+    mova            m6, [shuf_3to2_lo]
+    mova            m7, [shuf_3to2_hi]
+    movsxdifnidn    wq, wd
+    add           dstq, wq
+    neg             wq
+.loop:
+    movu            m0, [src0q]
+    movu            m1, [src0q + 8]
+    movu            m2, [src1q]
+    movu            m3, [src1q + 8]
+    pshufb          m0, m6
+    pshufb          m1, m7
+    pshufb          m2, m6
+    pshufb          m3, m7
+    pmaddubsw       m0, m5                  ; 3 * s0 + s1, s1 + 3 * s2...
+    pmaddubsw       m1, m5
+    pmaddubsw       m2, m5
+    pmaddubsw       m3, m5
+    paddw           m2, m4
+    paddw           m3, m4
+    paddw           m2, m0
+    paddw           m3, m1
+    paddw           m0, m0
+    paddw           m1, m1
+    paddw           m0, m2                  ; 3 * src0 + src1 + 8
+    paddw           m1, m3
+    psrlw           m0, 4
+    psrlw           m1, 4
+    packuswb        m0, m1
+    movu   [dstq + wq], m0
+    add          src0q, 24
+    add          src1q, 24
+    add             wq, mmsize
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_fused_uv_3to2(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+;                       const uint8_t *src1, int dstW)
+;-----------------------------------------------------------------------------
+cglobal fused_uv_3to2, 5, 5, 8, dstU, dstV, src0, src1, w
+    mova            m4, [fused_pw_8]
+    mova            m5, [fused_pb_uv_3113]
+    mova            m6, [shuf_uv_3to2_lo]
+    mova            m7, [shuf_uv_3to2_hi]
+    movsxdifnidn    wq, wd
+    add          dstUq, wq
+    add          dstVq, wq
+    neg             wq
+.loop:
+    movu            m0, [src0q]
+    movu            m1, [src0q + 8]
+    movu            m2, [src1q]
+    movu            m3, [src1q + 8]
+    pshufb          m0, m6
+    pshufb          m1, m7
+    pshufb          m2, m6
+    pshufb          m3, m7
+    pmaddubsw       m0, m5                  ; ua va ub vb...
+    pmaddubsw       m1, m5
+    pmaddubsw       m2, m5
+    pmaddubsw       m3, m5
+    paddw           m2, m4
+    paddw           m3, m4
+    paddw           m2, m0
+    paddw           m3, m1
+    paddw           m0, m0
+    paddw           m1, m1
+    paddw           m0, m2
+    paddw           m1, m3
+    psrlw           m0, 4
+    psrlw           m1, 4
+    packuswb        m0, m1
+    pshufb          m0, [shuf_deinterleave]
+    movq  [dstUq + wq], m0
+    movhps [dstVq + wq], m0
+    add          src0q, 24
+    add          src1q, 24
+    add             wq, mmsize / 2
+    jl .loop
+    RET
+
+%if ARCH_X86_64
+;-----------------------------------------------------------------------------
+; void ff_fused_rgb_2to1(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+;                        const uint8_t *uv, const int32_t *coeffs, int dstW)
+;-----------------------------------------------------------------------------
+
+; %1 = dst, %2-%3 = chroma of pixels 0-3 and 4-7, %4 = coefficients,
+; %5-%6 = luma of pixels 0-3 and 4-7, %7 = tmp
+%macro RGB_CHANNEL 7
+    mova            %1, %2
+    mova            %7, %3
+    pmaddwd         %1, %4
+    pmaddwd         %7, %4
+    pslld           %1, 9
+    pslld           %7, 9
+    paddd           %1, %5
+    paddd           %7, %6
+    psrad           %1, 22
+    psrad           %7, 22
+    packssdw        %1, %7
+%endmacro
+
+cglobal fused_rgb_2to1, 6, 7, 16, dst, src0, src1, uv, coeffs, w, tmp
+    movsxdifnidn    wq, wd
+    ; the luma offset is applied after the multiplication, together with
+    ; the rounding
+    mov           tmpd, [coeffsq]
+    imul          tmpd, [coeffsq + 4]
+    neg           tmpd
+    add           tmpd, 1 << 21
+    movd           m11, tmpd
+    pshufd         m11, m11, q0000
+    movd           m12, [coeffsq + 4]
+    pshuflw        m12, m12, q0000
+    punpcklqdq     m12, m12
+    ; the chroma factors fit in 16 bits
+    movu            m8, [coeffsq + 8]
+    movq           m10, [coeffsq + 24]
+    packssdw        m8, m10
+    pshufd          m9, m8, q1111
+    pshufd         m10, m8, q2222
+    pshufd          m8, m8, q0000
+    mova           m13, [fused_pb_1]
+    mova           m14, [fused_pw_128]
+    pxor           m15, m15
+    lea           dstq, [dstq + 4 * wq]
+    lea          src0q, [src0q + 2 * wq]
+    lea          src1q, [src1q + 2 * wq]
+    lea            uvq, [uvq + 2 * wq]
+    neg             wq
+.loop:
+    movu            m0, [src0q + 2 * wq]
+    movu            m1, [src1q + 2 * wq]
+    pmaddubsw       m0, m13
+    pmaddubsw       m1, m13
+    paddw           m0, m1                  ; sums of 2x2 luma samples
+    movu            m2, [uvq + 2 * wq]
+    mova            m3, m2
+    punpcklbw       m2, m15
+    punpckhbw       m3, m15
+    psubw           m2, m14
+    psubw           m3, m14
+    mova            m1, m0
+    punpcklwd       m0, m15
+    punpckhwd       m1, m15
+    pmaddwd         m0, m12
+    pmaddwd         m1, m12
+    pslld           m0, 7
+    pslld           m1, 7
+    paddd           m0, m11
+    paddd           m1, m11
+    RGB_CHANNEL     m4, m2, m3, m8,  m0, m1, m5
+    RGB_CHANNEL     m6, m2, m3, m9,  m0, m1, m5
+    RGB_CHANNEL     m7, m2, m3, m10, m0, m1, m5
+    packuswb        m4, m7                  ; c0 of 8 pixels, then c2
+    packuswb        m6, [fused_pw_255]      ; c1, then alpha
+    mova            m5, m4
+    punpcklbw       m4, m6
+    punpckhbw       m5, m6
+    mova            m7, m4
+    punpcklwd       m4, m5
+    punpckhwd       m7, m5
+    movu [dstq + 4 * wq], m4
+    movu [dstq + 4 * wq + mmsize], m7
+    add             wq, mmsize / 2
+    jl .loop
+    RET
+%endif
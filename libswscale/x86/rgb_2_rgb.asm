@@ -170,6 +170,49 @@ SHUFFLE_BYTES 3, 2, 1, 0
 %endif
 %endif
 
+;-----------------------------------------------------------------------------------------------
+; palette8topacked32(const uint8_t *src, uint8_t *dst, int num_pixels,
+;                    const uint8_t *palette)
+;-----------------------------------------------------------------------------------------------
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal palette8topacked32, 4, 6, 4, src, dst, w, pal, x, tmp
+    movsxdifnidn wq, wd
+    xor          xq, xq
+    test         wq, wq
+    jle .end
+
+    mov        tmpq, wq
+    and        tmpq, ~(mmsize / 4 - 1)
+    jz .loop_scalar
+
+    pcmpeqd       m2, m2
+.loop_simd:
+    pmovzxbd      m0, [srcq + xq]
+    mova          m1, m2
+    vpgatherdd    m3, [palq + m0 * 4], m1
+    movu [dstq + xq * 4], m3
+    add           xq, mmsize / 4
+    cmp           xq, tmpq
+    jl .loop_simd
+
+    cmp           xq, wq
+    jge .end
+
+.loop_scalar:
+    movzx       tmpd, byte [srcq + xq]
+    mov         tmpd, [palq + tmpq * 4]
+    mov [dstq + xq * 4], tmpd
+    inc           xq
+    cmp           xq, wq
+    jl .loop_scalar
+
+.end:
+    RET
+%endif
+%endif
+
 ;-----------------------------------------------------------------------------------------------
 ; uyvytoyuv422(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
 ;              const uint8_t *src, int width, int height,
@@ -808,3 +808,36 @@ switch(c->dstBpc){ \
 
 #endif
 }
+
+void ff_fused_plane_2to1_ssse3(uint8_t *dst, const uint8_t *src0,
+                               const uint8_t *src1, int dstW);
+void ff_fused_plane_3to2_ssse3(uint8_t *dst, const uint8_t *src0,
+                               const uint8_t *src1, int dstW);
+void ff_fused_uv_2to1_ssse3(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                            const uint8_t *src1, int dstW);
+void ff_fused_uv_3to2_ssse3(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0,
+                            const uint8_t *src1, int dstW);
+void ff_fused_rgb_2to1_ssse3(uint8_t *dst, const uint8_t *src0, const uint8_t *src1,
+                             const uint8_t *uv, const int32_t *coeffs, int dstW);
+
+av_cold void ff_sws_init_fused_x86(SwsContext *c)
+{
+#if HAVE_X86ASM
+    int cpu_flags = av_get_cpu_flags();
+    int half = c->srcW == 2 * c->dstW;
+
+    if (EXTERNAL_SSSE3(cpu_flags)) {
+        if (c->fused_plane) {
+            c->fused_plane = half ? ff_fused_plane_2to1_ssse3 : ff_fused_plane_3to2_ssse3;
+            c->fused_uv    = half ? ff_fused_uv_2to1_ssse3    : ff_fused_uv_3to2_ssse3;
+        }
+#if ARCH_X86_64
+        if (c->fused_rgb)
+            c->fused_rgb = ff_fused_rgb_2to1_ssse3;
+#endif
+    }
+    /* the chroma is faster deinterleaved then scaled by the SIMD hcScale() */
+    if (EXTERNAL_SSE2(cpu_flags))
+        c->fused_hscale_uv = NULL;
+#endif
+}
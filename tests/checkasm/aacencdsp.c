@@ -0,0 +1,105 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/mem_internal.h"
+
+#include "libavcodec/aacencdsp.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 1024
+
+static void randomize_coefs(float *buf, int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        buf[i] = ((float)rnd() / UINT_MAX - 0.5f) * 65536.0f;
+}
+
+static void test_abs_pow34(AACEncDSPContext *s)
+{
+    LOCAL_ALIGNED_32(float, in,   [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, out0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, out1, [BUF_SIZE]);
+    int size;
+
+    declare_func(void, float *out, const float *in, const int size);
+
+    if (check_func(s->abs_pow34, "abs_pow34")) {
+        randomize_coefs(in, BUF_SIZE);
+        for (size = 4; size <= 96; size += 4) {
+            /* bands start at any multiple of 4 coefficients */
+            int offset = (rnd() & 7) * 4;
+
+            call_ref(out0 + offset, in + offset, size);
+            call_new(out1 + offset, in + offset, size);
+            if (!float_near_ulp_array(out0 + offset, out1 + offset, 1, size))
+                fail();
+        }
+        bench_new(out1, in, BUF_SIZE);
+    }
+    report("abs_pow34");
+}
+
+static void test_quant_bands(AACEncDSPContext *s)
+{
+    static const int maxvals[] = { 1, 2, 4, 7, 12, 16, 8191 };
+    LOCAL_ALIGNED_32(float, in,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, scaled, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int,   out0,   [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int,   out1,   [BUF_SIZE]);
+    int size, is_signed;
+
+    declare_func(void, int *out, const float *in, const float *scaled,
+                 int size, int is_signed, int maxval, const float Q34,
+                 const float rounding);
+
+    randomize_coefs(in, BUF_SIZE);
+    s->abs_pow34(scaled, in, BUF_SIZE);
+
+    for (is_signed = 0; is_signed <= 1; is_signed++) {
+        if (check_func(s->quant_bands, "quant_bands_%s", is_signed ? "signed" : "unsigned")) {
+            for (size = 4; size <= 96; size += 4) {
+                int maxval = maxvals[rnd() % FF_ARRAY_ELEMS(maxvals)];
+                float Q34  = (float)rnd() / UINT_MAX * 0.05f;
+                int offset = (rnd() & 7) * 4;
+
+                call_ref(out0 + offset, in + offset, scaled + offset, size,
+                         is_signed, maxval, Q34, 0.4054f);
+                call_new(out1 + offset, in + offset, scaled + offset, size,
+                         is_signed, maxval, Q34, 0.4054f);
+                if (memcmp(out0 + offset, out1 + offset, size * sizeof(*out0)))
+                    fail();
+            }
+            bench_new(out1, in, scaled, BUF_SIZE, is_signed, 8191, 0.01f, 0.4054f);
+        }
+    }
+    report("quant_bands");
+}
+
+void checkasm_check_aacencdsp(void)
+{
+    AACEncDSPContext s;
+
+    ff_aacenc_dsp_init(&s);
+
+    test_abs_pow34(&s);
+    test_quant_bands(&s);
+}
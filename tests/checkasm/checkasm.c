@@ -78,6 +78,9 @@ static const struct {
         { "aacpsdsp", checkasm_check_aacpsdsp },
         { "sbrdsp",   checkasm_check_sbrdsp },
     #endif
+    #if CONFIG_AAC_ENCODER
+        { "aacencdsp", checkasm_check_aacencdsp },
+    #endif
     #if CONFIG_ALAC_DECODER
         { "alacdsp", checkasm_check_alacdsp },
     #endif
@@ -116,6 +119,7 @@ static const struct {
     #endif
     #if CONFIG_HEVC_DECODER
         { "hevc_add_res", checkasm_check_hevc_add_res },
+        { "hevc_deblock", checkasm_check_hevc_deblock },
         { "hevc_idct", checkasm_check_hevc_idct },
         { "hevc_pel", checkasm_check_hevc_pel },
         { "hevc_sao", checkasm_check_hevc_sao },
@@ -179,6 +183,9 @@ static const struct {
     #if CONFIG_EQ_FILTER
         { "vf_eq", checkasm_check_vf_eq },
     #endif
+    #if CONFIG_FRAMESTATS
+        { "vf_framestats", checkasm_check_vf_framestats },
+    #endif
     #if CONFIG_GBLUR_FILTER
         { "vf_gblur", checkasm_check_vf_gblur },
     #endif
@@ -188,15 +195,27 @@ static const struct {
     #if CONFIG_NLMEANS_FILTER
         { "vf_nlmeans", checkasm_check_nlmeans },
     #endif
+    #if CONFIG_OVERLAY_FILTER
+        { "vf_overlay", checkasm_check_vf_overlay },
+    #endif
+    #if CONFIG_SCENE_SAD
+        { "vf_scene_sad", checkasm_check_vf_scene_sad },
+    #endif
     #if CONFIG_THRESHOLD_FILTER
         { "vf_threshold", checkasm_check_vf_threshold },
     #endif
+    #if CONFIG_TONEMAP_FILTER
+        { "vf_tonemap", checkasm_check_vf_tonemap },
+    #endif
 #endif
 #if CONFIG_SWSCALE
     { "sw_gbrp", checkasm_check_sw_gbrp },
     { "sw_rgb", checkasm_check_sw_rgb },
     { "sw_scale", checkasm_check_sw_scale },
 #endif
+#if CONFIG_SWRESAMPLE
+    { "sw_rematrix", checkasm_check_sw_rematrix },
+#endif
 #if CONFIG_AVUTIL
         { "fixed_dsp", checkasm_check_fixed_dsp },
         { "float_dsp", checkasm_check_float_dsp },
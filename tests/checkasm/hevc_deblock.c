@@ -0,0 +1,155 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define BUF_STRIDE   (16 * 2)
+#define BUF_LINES    16
+#define BUF_SIZE     (BUF_STRIDE * BUF_LINES)
+#define BUF_OFFSET   (BUF_STRIDE * 8 + 8 * SIZEOF_PIXEL)
+
+static void put_pixel(uint8_t *buf, int bit_depth, int x, int y, int v)
+{
+    v = av_clip_uintp2(v, bit_depth);
+    if (bit_depth > 8)
+        AV_WN16A(buf + y * BUF_STRIDE + x * 2, v);
+    else
+        buf[y * BUF_STRIDE + x] = v;
+}
+
+/* Random background with 8 smooth lines crossing the edge at (8, 8), each
+ * with a small step and some noise, so that the strong, normal and no-filter
+ * decisions are all taken over a run of calls. */
+static void randomize_buffers(uint8_t *buf0, uint8_t *buf1, int bit_depth, int vertical)
+{
+    int i, j;
+
+    for (i = 0; i < BUF_SIZE; i += 4)
+        AV_WN32A(buf0 + i, rnd());
+    for (j = 0; j < BUF_LINES; j++)
+        for (i = 0; i < BUF_STRIDE / SIZEOF_PIXEL; i++)
+            put_pixel(buf0, bit_depth, i, j, rnd());
+
+    for (j = 0; j < 8; j++) {
+        static const int steps[]  = { 0, 1, 2, 4, 8, 16, 40 };
+        static const int noises[] = { 0, 1, 2, 4, 16 };
+        int base  = rnd() & ((1 << bit_depth) - 1);
+        int step  = steps[rnd() % FF_ARRAY_ELEMS(steps)]   << (bit_depth - 8);
+        int noise = noises[rnd() % FF_ARRAY_ELEMS(noises)] << (bit_depth - 8);
+
+        for (i = 0; i < 8; i++) {
+            int v = base + (i >= 4 ? step : 0);
+            if (noise)
+                v += (int)(rnd() % (2 * noise + 1)) - noise;
+            if (vertical)
+                put_pixel(buf0, bit_depth, 4 + i, 8 + j, v);
+            else
+                put_pixel(buf0, bit_depth, 8 + j, 4 + i, v);
+        }
+    }
+    memcpy(buf1, buf0, BUF_SIZE);
+}
+
+static void check_deblock_luma(HEVCDSPContext *h, int bit_depth)
+{
+    static const uint8_t no_pq[2] = { 0 };
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    int32_t tc[2];
+    int beta, i, vertical;
+
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int beta, const int32_t *tc,
+                 const uint8_t *no_p, const uint8_t *no_q);
+
+    for (vertical = 0; vertical <= 1; vertical++) {
+        if (check_func(vertical ? h->hevc_v_loop_filter_luma : h->hevc_h_loop_filter_luma,
+                       "hevc_%s_loop_filter_luma_%d", vertical ? "v" : "h", bit_depth)) {
+            for (i = 0; i < 32; i++) {
+                randomize_buffers(buf0, buf1, bit_depth, vertical);
+                beta  = rnd() % 65;
+                tc[0] = rnd() % 25;
+                tc[1] = rnd() % 25;
+                call_ref(buf0 + BUF_OFFSET, BUF_STRIDE, beta, tc, no_pq, no_pq);
+                call_new(buf1 + BUF_OFFSET, BUF_STRIDE, beta, tc, no_pq, no_pq);
+                if (memcmp(buf0, buf1, BUF_SIZE))
+                    fail();
+            }
+            tc[0] = tc[1] = 24;
+            bench_new(buf1 + BUF_OFFSET, BUF_STRIDE, 64, tc, no_pq, no_pq);
+        }
+    }
+}
+
+static void check_deblock_chroma(HEVCDSPContext *h, int bit_depth)
+{
+    static const uint8_t no_pq[2] = { 0 };
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    int32_t tc[2];
+    int i, vertical;
+
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, const int32_t *tc,
+                 const uint8_t *no_p, const uint8_t *no_q);
+
+    for (vertical = 0; vertical <= 1; vertical++) {
+        if (check_func(vertical ? h->hevc_v_loop_filter_chroma : h->hevc_h_loop_filter_chroma,
+                       "hevc_%s_loop_filter_chroma_%d", vertical ? "v" : "h", bit_depth)) {
+            for (i = 0; i < 32; i++) {
+                randomize_buffers(buf0, buf1, bit_depth, vertical);
+                tc[0] = rnd() % 25;
+                tc[1] = rnd() % 25;
+                call_ref(buf0 + BUF_OFFSET, BUF_STRIDE, tc, no_pq, no_pq);
+                call_new(buf1 + BUF_OFFSET, BUF_STRIDE, tc, no_pq, no_pq);
+                if (memcmp(buf0, buf1, BUF_SIZE))
+                    fail();
+            }
+            tc[0] = tc[1] = 24;
+            bench_new(buf1 + BUF_OFFSET, BUF_STRIDE, tc, no_pq, no_pq);
+        }
+    }
+}
+
+void checkasm_check_hevc_deblock(void)
+{
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_deblock_luma(&h, bit_depth);
+    }
+    report("luma");
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_deblock_chroma(&h, bit_depth);
+    }
+    report("chroma");
+}
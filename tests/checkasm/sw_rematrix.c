@@ -0,0 +1,150 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/mem_internal.h"
+
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define LEN 1024
+#define MAX_IN 8
+
+static void check_mix_n_1(mix_n_1_func_type *mix_n_1)
+{
+    LOCAL_ALIGNED_32(float, src, [MAX_IN * LEN]);
+    LOCAL_ALIGNED_32(float, dst_ref, [LEN]);
+    LOCAL_ALIGNED_32(float, dst_new, [LEN]);
+    const float *in[MAX_IN];
+    float coeffs[MAX_IN];
+    int n, i;
+
+    declare_func(void, void *out, const void **in, const void *coeffp,
+                 integer n, integer len);
+
+    for (i = 0; i < MAX_IN; i++) {
+        for (int j = 0; j < LEN; j++)
+            src[i * LEN + j] = (int)(rnd() & 0xffff) / 32768.0f - 1.0f;
+        coeffs[i] = (int)(rnd() & 0xffff) / 65536.0f;
+    }
+
+    for (n = 3; n <= MAX_IN; n++) {
+        if (!check_func(mix_n_1, "mix_n_1_float_%d", n))
+            continue;
+
+        /* sum the inputs in a shuffled order, as for downmixes */
+        for (i = 0; i < n; i++)
+            in[i] = src + (i + n / 2) % n * LEN;
+
+        memset(dst_ref, 0, LEN * sizeof(*dst_ref));
+        memset(dst_new, 0, LEN * sizeof(*dst_new));
+        call_ref(dst_ref, (const void **)in, coeffs, n, LEN);
+        call_new(dst_new, (const void **)in, coeffs, n, LEN);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, n * n * FLT_EPSILON, LEN))
+            fail();
+        bench_new(dst_new, (const void **)in, coeffs, n, LEN);
+    }
+}
+
+static void fill_audio_data(AudioData *a, float *buf, int ch_count)
+{
+    memset(a, 0, sizeof(*a));
+    for (int i = 0; i < ch_count; i++)
+        a->ch[i] = (uint8_t *)(buf + i * LEN);
+    a->ch_count = ch_count;
+    a->bps      = sizeof(float);
+    a->planar   = 1;
+    a->fmt      = AV_SAMPLE_FMT_FLTP;
+}
+
+/* The SIMD versions of the 1 and 2 input mixes make swri_rematrix() align
+ * the length, also when mix_n_1 has none, as on x86-32. */
+static void check_rematrix_no_simd_n_1(void)
+{
+    LOCAL_ALIGNED_32(float, src, [3 * LEN]);
+    LOCAL_ALIGNED_32(float, dst_ref, [LEN]);
+    LOCAL_ALIGNED_32(float, dst_new, [LEN]);
+    SwrContext *s_ref = NULL, *s_new = NULL;
+    AudioData in, out_ref, out_new;
+    int len = LEN - 1 - rnd() % 15;
+
+    declare_func(int, SwrContext *s, AudioData *out, AudioData *in,
+                 int len, int mustcopy);
+
+    for (int i = 0; i < 2; i++) {
+        SwrContext **s = i ? &s_new : &s_ref;
+        if (swr_alloc_set_opts2(s, &(AVChannelLayout)AV_CHANNEL_LAYOUT_MONO, AV_SAMPLE_FMT_FLTP, 48000,
+                                &(AVChannelLayout)AV_CHANNEL_LAYOUT_SURROUND, AV_SAMPLE_FMT_FLTP, 48000,
+                                0, NULL) < 0 || swr_init(*s) < 0) {
+            fprintf(stderr, "checkasm: failed to initialize the resampler\n");
+            fail();
+            goto end;
+        }
+    }
+    s_ref->mix_1_1_simd = NULL;
+    s_ref->mix_2_1_simd = NULL;
+    s_ref->mix_n_1_simd = NULL;
+    s_new->mix_n_1_simd = NULL;
+
+    if (check_func(s_new->mix_1_1_simd || s_new->mix_2_1_simd ? swri_rematrix : NULL,
+                   "rematrix_3_1_no_simd_n_1")) {
+        for (int i = 0; i < 3 * LEN; i++)
+            src[i] = (int)(rnd() & 0xffff) / 32768.0f - 1.0f;
+        for (int i = 0; i < LEN; i++)
+            dst_ref[i] = dst_new[i] = 2.0f;
+        fill_audio_data(&in, src, 3);
+        fill_audio_data(&out_ref, dst_ref, 1);
+        fill_audio_data(&out_new, dst_new, 1);
+
+        call_ref(s_ref, &out_ref, &in, len, 1);
+        call_new(s_new, &out_new, &in, len, 1);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, 3 * FLT_EPSILON, LEN))
+            fail();
+    }
+
+end:
+    swr_free(&s_ref);
+    swr_free(&s_new);
+}
+
+void checkasm_check_sw_rematrix(void)
+{
+    SwrContext *s = NULL;
+
+    if (swr_alloc_set_opts2(&s, &(AVChannelLayout)AV_CHANNEL_LAYOUT_STEREO, AV_SAMPLE_FMT_FLTP, 48000,
+                            &(AVChannelLayout)AV_CHANNEL_LAYOUT_7POINT1, AV_SAMPLE_FMT_FLTP, 48000,
+                            0, NULL) < 0 || swr_init(s) < 0) {
+        fprintf(stderr, "checkasm: failed to initialize the resampler\n");
+        swr_free(&s);
+        fail();
+        return;
+    }
+
+    check_mix_n_1(s->mix_n_1_simd ? s->mix_n_1_simd : s->mix_n_1_f);
+    report("mix_n_1");
+
+    check_rematrix_no_simd_n_1();
+    report("rematrix");
+
+    swr_free(&s);
+}
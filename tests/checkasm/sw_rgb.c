@@ -179,6 +179,47 @@ static void check_interleave_bytes(void)
     }
 }
 
+static void check_palette8topacked32(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, palette, [256 * 4]);
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_STRIDE + 1]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_buf, [4 * MAX_STRIDE + 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_buf, [4 * MAX_STRIDE + 4]);
+    // Bitmap subtitles rarely use more than a handful of colours; the
+    // limited index range exercises the table lookup paths, the full
+    // range the generic ones.
+    static const int index_mask[] = { 0x0f, 0x3f, 0xff };
+    uint8_t *dst0 = dst0_buf + 4;
+    uint8_t *dst1 = dst1_buf + 4;
+    int i, j, k;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src, uint8_t *dst,
+                      int num_pixels, const uint8_t *palette);
+
+    randomize_buffers(palette, 256 * 4);
+
+    if (check_func(palette8topacked32, "palette8topacked32")) {
+        for (k = 0; k < FF_ARRAY_ELEMS(index_mask); k++) {
+            for (i = 0; i <= 17; i++) {
+                int w = i < 17 ? i : 1 + (rnd() % MAX_STRIDE);
+
+                for (j = 0; j < MAX_STRIDE + 1; j++)
+                    src[j] = rnd() & index_mask[k];
+                memset(dst0_buf, 0, 4 * MAX_STRIDE + 4);
+                memset(dst1_buf, 0, 4 * MAX_STRIDE + 4);
+
+                call_ref(src + 1, dst0, w, palette);
+                call_new(src + 1, dst1, w, palette);
+                if (memcmp(dst0_buf, dst1_buf, 4 * MAX_STRIDE + 4))
+                    fail();
+            }
+        }
+        for (j = 0; j < MAX_STRIDE; j++)
+            src[j] = rnd() & 0x0f;
+        bench_new(src, dst1, MAX_STRIDE, palette);
+    }
+}
+
 void checkasm_check_sw_rgb(void)
 {
     ff_sws_rgb2rgb_init();
@@ -203,4 +244,7 @@ void checkasm_check_sw_rgb(void)
 
     check_interleave_bytes();
     report("interleave_bytes");
+
+    check_palette8topacked32();
+    report("palette8topacked32");
 }
@@ -347,6 +347,573 @@ static void check_hscale(void)
     sws_freeContext(ctx);
 }
 
+static void check_yuv2nv12cX(void)
+{
+    struct SwsContext *ctx;
+    int fsi, isi, fmti, i, j;
+#define LARGEST_FILTER 16
+    static const int filter_sizes[] = {1, 2, 3, 4, 8, 16};
+#define LARGEST_INPUT_SIZE 512
+    static const int input_sizes[] = {8, 24, 123, 128, 144, 256, 512};
+    static const enum AVPixelFormat formats[] = {AV_PIX_FMT_NV12, AV_PIX_FMT_NV21};
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, enum AVPixelFormat format,
+                      const uint8_t *dither, const int16_t *filter, int filterSize,
+                      const int16_t **u, const int16_t **v, uint8_t *dst, int dstWidth);
+
+    const int16_t *srcU[LARGEST_FILTER], *srcV[LARGEST_FILTER];
+    LOCAL_ALIGNED_16(int16_t, src_pixels, [2 * LARGEST_FILTER * LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, filter_coeff, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [LARGEST_INPUT_SIZE * 2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [LARGEST_INPUT_SIZE * 2]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+
+    randomize_buffers(dither, 8);
+    randomize_buffers((uint8_t*)src_pixels, 2 * LARGEST_FILTER * LARGEST_INPUT_SIZE * sizeof(int16_t));
+    for (i = 0; i < LARGEST_FILTER; i++) {
+        srcU[i] = &src_pixels[ i                   * LARGEST_INPUT_SIZE];
+        srcV[i] = &src_pixels[(i + LARGEST_FILTER) * LARGEST_INPUT_SIZE];
+    }
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (fmti = 0; fmti < FF_ARRAY_ELEMS(formats); fmti++) {
+        ctx->dstFormat = formats[fmti];
+        ctx->dstBpc    = 8;
+        ff_sws_init_scale(ctx);
+        for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+            // coefficients of a normalized filter, summing to 1 << 12
+            int sum = 0;
+            for (j = 0; j < filter_sizes[fsi] - 1; j++) {
+                filter_coeff[j] = (rnd() % 1024) - 256;
+                sum += filter_coeff[j];
+            }
+            filter_coeff[j] = 4096 - sum;
+            for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+                int dstW = input_sizes[isi];
+                if (check_func(ctx->yuv2nv12cX, "yuv2%s_%d_%d",
+                               av_get_pix_fmt_name(formats[fmti]), filter_sizes[fsi], dstW)) {
+                    memset(dst0, 0, LARGEST_INPUT_SIZE * 2);
+                    memset(dst1, 0, LARGEST_INPUT_SIZE * 2);
+
+                    call_ref(formats[fmti], dither, filter_coeff, filter_sizes[fsi],
+                             srcU, srcV, dst0, dstW);
+                    call_new(formats[fmti], dither, filter_coeff, filter_sizes[fsi],
+                             srcU, srcV, dst1, dstW);
+                    if (memcmp(dst0, dst1, dstW * 2)) {
+                        fail();
+                        printf("failed: yuv2%s_%d_%d\n", av_get_pix_fmt_name(formats[fmti]),
+                               filter_sizes[fsi], dstW);
+                        show_differences(dst0, dst1, dstW * 2);
+                    }
+                    if (dstW == LARGEST_INPUT_SIZE)
+                        bench_new(formats[fmti], dither, filter_coeff, filter_sizes[fsi],
+                                  srcU, srcV, dst1, dstW);
+                }
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
+static void check_yuv2rgb_full_X(void)
+{
+    struct SwsContext *ctx;
+    int alpha, fsi, isi, fmti, i, j;
+#define LARGEST_FILTER 16
+    static const int filter_sizes[] = {1, 2, 3, 4, 8, 16};
+#define LARGEST_INPUT_SIZE 512
+    static const int input_sizes[] = {8, 24, 123, 128, 144, 256, 512};
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_RGBA, AV_PIX_FMT_ARGB, AV_PIX_FMT_BGRA, AV_PIX_FMT_ABGR,
+    };
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, SwsContext *c, const int16_t *lumFilter,
+                      const int16_t **lumSrc, int lumFilterSize,
+                      const int16_t *chrFilter, const int16_t **chrUSrc,
+                      const int16_t **chrVSrc, int chrFilterSize,
+                      const int16_t **alpSrc, uint8_t *dest, int dstW, int y);
+
+    const int16_t *lum[LARGEST_FILTER], *chrU[LARGEST_FILTER];
+    const int16_t *chrV[LARGEST_FILTER], *alp[LARGEST_FILTER];
+    LOCAL_ALIGNED_16(int16_t, src_pixels, [4 * LARGEST_FILTER * LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, lum_filter, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_16(int16_t, chr_filter, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [LARGEST_INPUT_SIZE * 4]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [LARGEST_INPUT_SIZE * 4]);
+
+    // the horizontally scaled samples have 15 bits
+    randomize_buffers((uint8_t*)src_pixels, 4 * LARGEST_FILTER * LARGEST_INPUT_SIZE * sizeof(int16_t));
+    for (i = 0; i < 4 * LARGEST_FILTER * LARGEST_INPUT_SIZE; i++)
+        src_pixels[i] &= 0x7fff;
+    for (i = 0; i < LARGEST_FILTER; i++) {
+        lum[i]  = &src_pixels[ i                       * LARGEST_INPUT_SIZE];
+        chrU[i] = &src_pixels[(i +     LARGEST_FILTER) * LARGEST_INPUT_SIZE];
+        chrV[i] = &src_pixels[(i + 2 * LARGEST_FILTER) * LARGEST_INPUT_SIZE];
+        alp[i]  = &src_pixels[(i + 3 * LARGEST_FILTER) * LARGEST_INPUT_SIZE];
+    }
+
+    for (alpha = 0; alpha < 2; alpha++) {
+        for (fmti = 0; fmti < FF_ARRAY_ELEMS(formats); fmti++) {
+            const char *name = av_get_pix_fmt_name(formats[fmti]);
+
+            ctx = sws_getContext(LARGEST_INPUT_SIZE, 16,
+                                 alpha ? AV_PIX_FMT_YUVA420P : AV_PIX_FMT_YUV420P,
+                                 LARGEST_INPUT_SIZE, 8, formats[fmti],
+                                 SWS_BICUBIC | SWS_FULL_CHR_H_INT, NULL, NULL, NULL);
+            if (!ctx) {
+                fail();
+                continue;
+            }
+            for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+                // coefficients of normalized filters, summing to 1 << 12
+                int lum_sum = 0, chr_sum = 0;
+                for (j = 0; j < filter_sizes[fsi] - 1; j++) {
+                    lum_filter[j] = (rnd() % 1024) - 256;
+                    chr_filter[j] = (rnd() % 1024) - 256;
+                    lum_sum += lum_filter[j];
+                    chr_sum += chr_filter[j];
+                }
+                lum_filter[j] = 4096 - lum_sum;
+                chr_filter[j] = 4096 - chr_sum;
+                for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+                    int dstW = input_sizes[isi];
+                    if (check_func(ctx->yuv2packedX, "yuv2%s_full_X%s_%d_%d", name,
+                                   alpha ? "" : "_noalpha", filter_sizes[fsi], dstW)) {
+                        memset(dst0, 0, LARGEST_INPUT_SIZE * 4);
+                        memset(dst1, 0, LARGEST_INPUT_SIZE * 4);
+
+                        call_ref(ctx, lum_filter, lum, filter_sizes[fsi], chr_filter,
+                                 chrU, chrV, filter_sizes[fsi], alp, dst0, dstW, 0);
+                        call_new(ctx, lum_filter, lum, filter_sizes[fsi], chr_filter,
+                                 chrU, chrV, filter_sizes[fsi], alp, dst1, dstW, 0);
+                        if (memcmp(dst0, dst1, LARGEST_INPUT_SIZE * 4)) {
+                            fail();
+                            printf("failed: yuv2%s_full_X%s_%d_%d\n", name,
+                                   alpha ? "" : "_noalpha", filter_sizes[fsi], dstW);
+                            show_differences(dst0, dst1, LARGEST_INPUT_SIZE * 4);
+                        }
+                        if (dstW == LARGEST_INPUT_SIZE)
+                            bench_new(ctx, lum_filter, lum, filter_sizes[fsi], chr_filter,
+                                      chrU, chrV, filter_sizes[fsi], alp, dst1, dstW, 0);
+                    }
+                }
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
+static void check_yuv2yuv_10(void)
+{
+    struct SwsContext *ctx;
+    int fsi, isi, i, j;
+#define LARGEST_FILTER 16
+    static const int filter_sizes[] = {1, 2, 3, 4, 8, 16};
+#define LARGEST_INPUT_SIZE 512
+    static const int input_sizes[] = {8, 24, 123, 128, 144, 256, 512};
+
+    const int16_t *src[LARGEST_FILTER];
+    LOCAL_ALIGNED_16(int16_t, src_pixels, [LARGEST_FILTER * LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, filter_coeff, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_16(uint16_t, dst0, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(uint16_t, dst1, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+
+    randomize_buffers(dither, 8);
+    // the vertical scaler input is 15-bit for 10-bit output
+    for (i = 0; i < LARGEST_FILTER * LARGEST_INPUT_SIZE; i++)
+        src_pixels[i] = rnd() & 0x7fff;
+    for (i = 0; i < LARGEST_FILTER; i++)
+        src[i] = &src_pixels[i * LARGEST_INPUT_SIZE];
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+    ctx->dstFormat = AV_PIX_FMT_YUV420P10LE;
+    ctx->dstBpc    = 10;
+    ff_sws_init_scale(ctx);
+
+    for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+        int dstW = input_sizes[isi];
+        declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *src, uint8_t *dest,
+                          int dstW, const uint8_t *dither, int offset);
+
+        if (check_func(ctx->yuv2plane1, "yuv2yuv1_10_%d", dstW)) {
+            memset(dst0, 0, LARGEST_INPUT_SIZE * sizeof(dst0[0]));
+            memset(dst1, 0, LARGEST_INPUT_SIZE * sizeof(dst1[0]));
+
+            call_ref(src[0], (uint8_t*)dst0, dstW, dither, 0);
+            call_new(src[0], (uint8_t*)dst1, dstW, dither, 0);
+            if (memcmp(dst0, dst1, dstW * sizeof(dst0[0])))
+                fail();
+            if (dstW == LARGEST_INPUT_SIZE)
+                bench_new(src[0], (uint8_t*)dst1, dstW, dither, 0);
+        }
+    }
+
+    for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+        int sum = 0;
+        for (j = 0; j < filter_sizes[fsi] - 1; j++) {
+            filter_coeff[j] = (rnd() % 1024) - 256;
+            sum += filter_coeff[j];
+        }
+        filter_coeff[j] = 4096 - sum;
+        for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+            int dstW = input_sizes[isi];
+            declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *filter,
+                              int filterSize, const int16_t **src, uint8_t *dest,
+                              int dstW, const uint8_t *dither, int offset);
+
+            if (check_func(ctx->yuv2planeX, "yuv2yuvX_10_%d_%d", filter_sizes[fsi], dstW)) {
+                memset(dst0, 0, LARGEST_INPUT_SIZE * sizeof(dst0[0]));
+                memset(dst1, 0, LARGEST_INPUT_SIZE * sizeof(dst1[0]));
+
+                call_ref(filter_coeff, filter_sizes[fsi], src, (uint8_t*)dst0, dstW, dither, 0);
+                call_new(filter_coeff, filter_sizes[fsi], src, (uint8_t*)dst1, dstW, dither, 0);
+                if (memcmp(dst0, dst1, dstW * sizeof(dst0[0])))
+                    fail();
+                if (dstW == LARGEST_INPUT_SIZE)
+                    bench_new(filter_coeff, filter_sizes[fsi], src, (uint8_t*)dst1, dstW, dither, 0);
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
+static void check_input(void)
+{
+    struct SwsContext *ctx;
+    int fmti, isi, half;
+#define LARGEST_INPUT_SIZE 512
+    static const int input_sizes[] = {8, 24, 123, 128, 144, 256, 512};
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_NV12, AV_PIX_FMT_NV21, AV_PIX_FMT_P010LE,
+        AV_PIX_FMT_RGBA, AV_PIX_FMT_BGRA,
+    };
+    // BT.601 limited range, as set up by fill_rgb2yuv_table()
+    static const int32_t rgb2yuv[9] = {
+         8414, 16519,  3208, -4865, -9528, 14392, 14392, -12061, -2332,
+    };
+
+    // whole vectors may be read and written past width
+    LOCAL_ALIGNED_32(uint8_t, src, [LARGEST_INPUT_SIZE * 8 + 64]);
+    LOCAL_ALIGNED_32(int16_t, dstU0, [LARGEST_INPUT_SIZE + 32]);
+    LOCAL_ALIGNED_32(int16_t, dstV0, [LARGEST_INPUT_SIZE + 32]);
+    LOCAL_ALIGNED_32(int16_t, dstU1, [LARGEST_INPUT_SIZE + 32]);
+    LOCAL_ALIGNED_32(int16_t, dstV1, [LARGEST_INPUT_SIZE + 32]);
+    LOCAL_ALIGNED_32(uint32_t, tab, [16 + 40 * 4]);
+
+    randomize_buffers(src, LARGEST_INPUT_SIZE * 8 + 64);
+    memset(tab, 0, (16 + 40 * 4) * sizeof(tab[0]));
+    memcpy(tab, rgb2yuv, sizeof(rgb2yuv));
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (fmti = 0; fmti < FF_ARRAY_ELEMS(formats); fmti++) {
+        const char *name = av_get_pix_fmt_name(formats[fmti]);
+        ctx->srcFormat = formats[fmti];
+        ctx->dstFormat = AV_PIX_FMT_YUV420P;
+        ctx->dstBpc    = 8;
+
+        // packed RGB chroma is averaged over pairs of pixels when subsampled
+        for (half = 0; half < 1 + isAnyRGB(formats[fmti]); half++) {
+            ctx->chrSrcHSubSample = half;
+            ff_sws_init_scale(ctx);
+
+            for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+                int w = input_sizes[isi];
+
+                if (!half) {
+                    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dst, const uint8_t *src,
+                                      const uint8_t *src2, const uint8_t *src3,
+                                      int width, uint32_t *tab);
+
+                    if (check_func(ctx->lumToYV12, "%sToY_%d", name, w)) {
+                        memset(dstU0, 0, (LARGEST_INPUT_SIZE + 32) * sizeof(dstU0[0]));
+                        memset(dstU1, 0, (LARGEST_INPUT_SIZE + 32) * sizeof(dstU1[0]));
+
+                        call_ref((uint8_t*)dstU0, src, NULL, NULL, w, tab);
+                        call_new((uint8_t*)dstU1, src, NULL, NULL, w, tab);
+                        if (memcmp(dstU0, dstU1, w * sizeof(dstU0[0])))
+                            fail();
+                        if (w == LARGEST_INPUT_SIZE)
+                            bench_new((uint8_t*)dstU1, src, NULL, NULL, w, tab);
+                    }
+                }
+                {
+                    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dstU, uint8_t *dstV,
+                                      const uint8_t *src0, const uint8_t *src1,
+                                      const uint8_t *src2, int width, uint32_t *tab);
+
+                    if (check_func(ctx->chrToYV12, "%sToUV%s_%d", name, half ? "_half" : "", w)) {
+                        memset(dstU0, 0, (LARGEST_INPUT_SIZE + 32) * sizeof(dstU0[0]));
+                        memset(dstV0, 0, (LARGEST_INPUT_SIZE + 32) * sizeof(dstV0[0]));
+                        memset(dstU1, 0, (LARGEST_INPUT_SIZE + 32) * sizeof(dstU1[0]));
+                        memset(dstV1, 0, (LARGEST_INPUT_SIZE + 32) * sizeof(dstV1[0]));
+
+                        call_ref((uint8_t*)dstU0, (uint8_t*)dstV0, NULL, src, src, w, tab);
+                        call_new((uint8_t*)dstU1, (uint8_t*)dstV1, NULL, src, src, w, tab);
+                        if (memcmp(dstU0, dstU1, w * sizeof(dstU0[0])) ||
+                            memcmp(dstV0, dstV1, w * sizeof(dstV0[0])))
+                            fail();
+                        if (w == LARGEST_INPUT_SIZE)
+                            bench_new((uint8_t*)dstU1, (uint8_t*)dstV1, NULL, src, src, w, tab);
+                    }
+                }
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
+static void check_range_convert(void)
+{
+    struct SwsContext *ctx;
+    int from, isi, i;
+#define LARGEST_INPUT_SIZE 512
+    static const int input_sizes[] = {8, 24, 123, 128, 144, 256, 512};
+
+    LOCAL_ALIGNED_16(int16_t, srcU, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, srcV, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, dstU0, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, dstV0, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, dstU1, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, dstV1, [LARGEST_INPUT_SIZE]);
+
+    // the horizontal scaler output is 15-bit for 8-bit output
+    for (i = 0; i < LARGEST_INPUT_SIZE; i++) {
+        srcU[i] = rnd() & 0x7fff;
+        srcV[i] = rnd() & 0x7fff;
+    }
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (from = 0; from < 2; from++) {
+        const char *dir = from ? "from" : "to";
+        ctx->srcFormat = AV_PIX_FMT_YUV420P;
+        ctx->dstFormat = AV_PIX_FMT_YUV420P;
+        ctx->dstBpc    = 8;
+        ctx->srcRange  = from;
+        ctx->dstRange  = !from;
+        ff_sws_init_scale(ctx);
+
+        for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+            int w = input_sizes[isi];
+            {
+                declare_func(void, int16_t *dst, int width);
+
+                if (check_func(ctx->lumConvertRange, "lumRange%sJpeg_%d", dir, w)) {
+                    memcpy(dstU0, srcU, LARGEST_INPUT_SIZE * sizeof(srcU[0]));
+                    memcpy(dstU1, srcU, LARGEST_INPUT_SIZE * sizeof(srcU[0]));
+
+                    call_ref(dstU0, w);
+                    call_new(dstU1, w);
+                    if (memcmp(dstU0, dstU1, w * sizeof(dstU0[0])))
+                        fail();
+                    if (w == LARGEST_INPUT_SIZE)
+                        bench_new(dstU1, w);
+                }
+            }
+            {
+                declare_func(void, int16_t *dstU, int16_t *dstV, int width);
+
+                if (check_func(ctx->chrConvertRange, "chrRange%sJpeg_%d", dir, w)) {
+                    memcpy(dstU0, srcU, LARGEST_INPUT_SIZE * sizeof(srcU[0]));
+                    memcpy(dstV0, srcV, LARGEST_INPUT_SIZE * sizeof(srcV[0]));
+                    memcpy(dstU1, srcU, LARGEST_INPUT_SIZE * sizeof(srcU[0]));
+                    memcpy(dstV1, srcV, LARGEST_INPUT_SIZE * sizeof(srcV[0]));
+
+                    call_ref(dstU0, dstV0, w);
+                    call_new(dstU1, dstV1, w);
+                    if (memcmp(dstU0, dstU1, w * sizeof(dstU0[0])) ||
+                        memcmp(dstV0, dstV1, w * sizeof(dstV0[0])))
+                        fail();
+                    if (w == LARGEST_INPUT_SIZE)
+                        bench_new(dstU1, dstV1, w);
+                }
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
+static void check_fused(void)
+{
+    struct SwsContext *ctx;
+    int ratio, rgb, isi, i;
+#define FUSED_MAX_WIDTH 512
+    static const int widths[] = {16, 48, 128, 272, 512};
+    static const char *const ratios[] = {"2to1", "3to2"};
+    // BT.601 limited range, as set up by ff_yuv2rgb_c_init_tables()
+    static const int32_t coeffs[8] = {
+        8192, 9539, 0, 13074, -3209, -6660, 16525, 0,
+    };
+
+    LOCAL_ALIGNED_16(uint8_t, src0, [FUSED_MAX_WIDTH * 4]);
+    LOCAL_ALIGNED_16(uint8_t, src1, [FUSED_MAX_WIDTH * 4]);
+    LOCAL_ALIGNED_16(uint8_t, uv,   [FUSED_MAX_WIDTH * 2]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [FUSED_MAX_WIDTH * 4]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [FUSED_MAX_WIDTH * 4]);
+    LOCAL_ALIGNED_16(uint8_t, dstV0, [FUSED_MAX_WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, dstV1, [FUSED_MAX_WIDTH]);
+
+    randomize_buffers(src0, FUSED_MAX_WIDTH * 4);
+    randomize_buffers(src1, FUSED_MAX_WIDTH * 4);
+    randomize_buffers(uv,   FUSED_MAX_WIDTH * 2);
+    // saturate some pixels
+    for (i = 0; i < 16; i++) {
+        src0[i] = src1[i] = 255;
+        uv[i] = i < 8 ? 0 : 255;
+    }
+
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (ratio = 0; ratio < 2; ratio++) {
+        ctx->flags     = SWS_FAST_BILINEAR;
+        ctx->srcFormat = AV_PIX_FMT_NV12;
+        ctx->srcRange  = ctx->dstRange = 0;
+        ctx->dstW      = 1920;
+        ctx->dstH      = 1080;
+        ctx->srcW      = ratio ? 2880 : 3840;
+        ctx->srcH      = ratio ? 1620 : 2160;
+
+        // the YUV kernels of 2:1 are tested with the RGB ones
+        for (rgb = 0; rgb < 1 + !ratio; rgb++) {
+            ctx->dstFormat = rgb ? AV_PIX_FMT_RGBA : AV_PIX_FMT_YUV420P;
+            ff_sws_init_fused(ctx);
+
+            for (isi = 0; isi < FF_ARRAY_ELEMS(widths); isi++) {
+                int w = widths[isi];
+
+                if (rgb) {
+                    declare_func(void, uint8_t *dst, const uint8_t *src0,
+                                 const uint8_t *src1, const uint8_t *uv,
+                                 const int32_t *coeffs, int dstW);
+
+                    if (check_func(ctx->fused_rgb, "fused_rgb_%s_%d", ratios[ratio], w)) {
+                        memset(dst0, 0, FUSED_MAX_WIDTH * 4);
+                        memset(dst1, 0, FUSED_MAX_WIDTH * 4);
+                        call_ref(dst0, src0, src1, uv, coeffs, w);
+                        call_new(dst1, src0, src1, uv, coeffs, w);
+                        if (memcmp(dst0, dst1, FUSED_MAX_WIDTH * 4))
+                            fail();
+                        if (w == FUSED_MAX_WIDTH)
+                            bench_new(dst1, src0, src1, uv, coeffs, w);
+                    }
+                    continue;
+                }
+
+                {
+                    declare_func(void, uint8_t *dst, const uint8_t *src0,
+                                 const uint8_t *src1, int dstW);
+
+                    if (check_func(ctx->fused_plane, "fused_plane_%s_%d", ratios[ratio], w)) {
+                        memset(dst0, 0, FUSED_MAX_WIDTH);
+                        memset(dst1, 0, FUSED_MAX_WIDTH);
+                        call_ref(dst0, src0, src1, w);
+                        call_new(dst1, src0, src1, w);
+                        if (memcmp(dst0, dst1, FUSED_MAX_WIDTH))
+                            fail();
+                        if (w == FUSED_MAX_WIDTH)
+                            bench_new(dst1, src0, src1, w);
+                    }
+                }
+                {
+                    declare_func(void, uint8_t *dstU, uint8_t *dstV,
+                                 const uint8_t *src0, const uint8_t *src1, int dstW);
+
+                    if (check_func(ctx->fused_uv, "fused_uv_%s_%d", ratios[ratio], w)) {
+                        memset(dst0,  0, FUSED_MAX_WIDTH);
+                        memset(dst1,  0, FUSED_MAX_WIDTH);
+                        memset(dstV0, 0, FUSED_MAX_WIDTH);
+                        memset(dstV1, 0, FUSED_MAX_WIDTH);
+                        call_ref(dst0, dstV0, src0, src1, w);
+                        call_new(dst1, dstV1, src0, src1, w);
+                        if (memcmp(dst0, dst1, FUSED_MAX_WIDTH) ||
+                            memcmp(dstV0, dstV1, FUSED_MAX_WIDTH))
+                            fail();
+                        if (w == FUSED_MAX_WIDTH)
+                            bench_new(dst1, dstV1, src0, src1, w);
+                    }
+                }
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
+static void check_fused_hscale_uv(void)
+{
+    struct SwsContext *ctx;
+    int fi, ratio, isi, i;
+#define FUSED_HSCALE_MAX_WIDTH 512
+    static const int widths[] = {500, 512};
+    static const char *const ratios[] = {"2to1", "3to2"};
+    static const struct {
+        const char *name;
+        int flags;
+    } scalers[] = {
+        { "bilinear", SWS_BILINEAR },
+        { "bicubic",  SWS_BICUBIC  },
+    };
+
+    // interleaved chroma of the widest source, and the taps past its end
+    LOCAL_ALIGNED_16(uint8_t, src, [FUSED_HSCALE_MAX_WIDTH * 2 + 256]);
+    LOCAL_ALIGNED_16(int16_t, dstU0, [FUSED_HSCALE_MAX_WIDTH]);
+    LOCAL_ALIGNED_16(int16_t, dstV0, [FUSED_HSCALE_MAX_WIDTH]);
+    LOCAL_ALIGNED_16(int16_t, dstU1, [FUSED_HSCALE_MAX_WIDTH]);
+    LOCAL_ALIGNED_16(int16_t, dstV1, [FUSED_HSCALE_MAX_WIDTH]);
+
+    declare_func(void, int16_t *dstU, int16_t *dstV, int dstW, const uint8_t *src,
+                 const int16_t *filter, const int32_t *filterPos, int filterSize);
+
+    randomize_buffers(src, FUSED_HSCALE_MAX_WIDTH * 2 + 256);
+    // saturate some pixels
+    for (i = 0; i < 32; i++)
+        src[i] = i < 16 ? 0 : 255;
+
+    for (fi = 0; fi < FF_ARRAY_ELEMS(scalers); fi++) {
+        for (ratio = 0; ratio < 2; ratio++) {
+            for (isi = 0; isi < FF_ARRAY_ELEMS(widths); isi++) {
+                int dstW = widths[isi];
+
+                // the coefficients are the ones computed for these flags
+                ctx = sws_getContext(ratio ? dstW * 3 / 2 : dstW * 2, ratio ? 24 : 32,
+                                     AV_PIX_FMT_NV12, dstW, 16, AV_PIX_FMT_YUV420P,
+                                     scalers[fi].flags, NULL, NULL, NULL);
+                if (!ctx) {
+                    fail();
+                    continue;
+                }
+
+                if (check_func(ctx->fused_hscale_uv, "fused_hscale_uv_%s_%s_%d",
+                               scalers[fi].name, ratios[ratio], dstW)) {
+                    memset(dstU0, 0, FUSED_HSCALE_MAX_WIDTH * sizeof(int16_t));
+                    memset(dstV0, 0, FUSED_HSCALE_MAX_WIDTH * sizeof(int16_t));
+                    memset(dstU1, 0, FUSED_HSCALE_MAX_WIDTH * sizeof(int16_t));
+                    memset(dstV1, 0, FUSED_HSCALE_MAX_WIDTH * sizeof(int16_t));
+                    call_ref(dstU0, dstV0, ctx->chrDstW, src, ctx->hChrFilter,
+                             ctx->hChrFilterPos, ctx->hChrFilterSize);
+                    call_new(dstU1, dstV1, ctx->chrDstW, src, ctx->hChrFilter,
+                             ctx->hChrFilterPos, ctx->hChrFilterSize);
+                    if (memcmp(dstU0, dstU1, ctx->chrDstW * sizeof(int16_t)) ||
+                        memcmp(dstV0, dstV1, ctx->chrDstW * sizeof(int16_t)))
+                        fail();
+                    if (dstW == FUSED_HSCALE_MAX_WIDTH)
+                        bench_new(dstU1, dstV1, ctx->chrDstW, src, ctx->hChrFilter,
+                                  ctx->hChrFilterPos, ctx->hChrFilterSize);
+                }
+                sws_freeContext(ctx);
+            }
+        }
+    }
+}
+
 void checkasm_check_sw_scale(void)
 {
     check_hscale();
@@ -357,4 +924,17 @@ void checkasm_check_sw_scale(void)
     check_yuv2yuvX(0);
     check_yuv2yuvX(1);
     report("yuv2yuvX");
+    check_yuv2yuv_10();
+    report("yuv2yuv_10");
+    check_yuv2nv12cX();
+    report("yuv2nv12cX");
+    check_yuv2rgb_full_X();
+    report("yuv2rgb_full_X");
+    check_input();
+    report("input");
+    check_range_convert();
+    report("range_convert");
+    check_fused();
+    check_fused_hscale_uv();
+    report("fused");
 }
@@ -0,0 +1,130 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/framestats.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  72
+#define HEIGHT 4
+#define STRIDE (WIDTH * 4 + 16)
+
+static void randomize_buffer(uint8_t *buf, int size, int skewed)
+{
+    /* a few frequent values exercise repeated counter updates */
+    for (int i = 0; i < size; i++)
+        buf[i] = skewed && (rnd() & 1) ? 0x80 : rnd();
+}
+
+static void randomize_hist(uint32_t *hist0, uint32_t *hist1)
+{
+    for (int i = 0; i < 256; i++)
+        hist0[i] = hist1[i] = rnd() & 0xffff;
+}
+
+static void check_hist(const FrameStatsDSPContext *dsp, int uv, int bpp)
+{
+    LOCAL_ALIGNED_32(uint8_t,  src,      [STRIDE * HEIGHT]);
+    LOCAL_ALIGNED_32(uint32_t, hist_ref, [3 * 256]);
+    LOCAL_ALIGNED_32(uint32_t, hist_new, [3 * 256]);
+    static const int shifts[] = { 0, 2, 6, 8 };
+    int w, h, shift;
+
+    randomize_buffer(src, STRIDE * HEIGHT, rnd() & 1);
+    randomize_hist(hist_ref, hist_new);
+    randomize_hist(hist_ref + 256, hist_new + 256);
+    randomize_hist(hist_ref + 512, hist_new + 512);
+    w     = 1 + rnd() % WIDTH;
+    h     = 1 + rnd() % HEIGHT;
+    shift = shifts[rnd() % FF_ARRAY_ELEMS(shifts)];
+
+    if (bpp > 2) {
+        declare_func(void, uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                     ptrdiff_t width, ptrdiff_t height, int step);
+        /* the components of ARGB-like formats start at the second byte */
+        int off = bpp == 4 ? rnd() & 1 : 0;
+        if (check_func(dsp->hist8_rgb, "framestats_hist8_rgb%d", bpp)) {
+            call_ref(hist_ref, src + off, STRIDE, w, h, bpp);
+            call_new(hist_new, src + off, STRIDE, w, h, bpp);
+            if (memcmp(hist_ref, hist_new, 3 * 256 * sizeof(uint32_t)))
+                fail();
+            bench_new(hist_new, src, STRIDE, WIDTH, HEIGHT, bpp);
+        }
+    } else if (bpp == 1 && !uv) {
+        declare_func(void, uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                     ptrdiff_t width, ptrdiff_t height);
+        if (check_func(dsp->hist8, "framestats_hist8")) {
+            call_ref(hist_ref, src, STRIDE, w, h);
+            call_new(hist_new, src, STRIDE, w, h);
+            if (memcmp(hist_ref, hist_new, 3 * 256 * sizeof(uint32_t)))
+                fail();
+            bench_new(hist_new, src, STRIDE, WIDTH, HEIGHT);
+        }
+    } else if (bpp == 1) {
+        declare_func(void, uint32_t *hist_u, uint32_t *hist_v, const uint8_t *src,
+                     ptrdiff_t stride, ptrdiff_t width, ptrdiff_t height);
+        if (check_func(dsp->hist8_uv, "framestats_hist8_uv")) {
+            call_ref(hist_ref, hist_ref + 256, src, STRIDE, w, h);
+            call_new(hist_new, hist_new + 256, src, STRIDE, w, h);
+            if (memcmp(hist_ref, hist_new, 3 * 256 * sizeof(uint32_t)))
+                fail();
+            bench_new(hist_new, hist_new + 256, src, STRIDE, WIDTH, HEIGHT);
+        }
+    } else if (!uv) {
+        declare_func(void, uint32_t *hist, const uint8_t *src, ptrdiff_t stride,
+                     ptrdiff_t width, ptrdiff_t height, int shift);
+        if (check_func(dsp->hist16, "framestats_hist16")) {
+            call_ref(hist_ref, src, STRIDE, w, h, shift);
+            call_new(hist_new, src, STRIDE, w, h, shift);
+            if (memcmp(hist_ref, hist_new, 3 * 256 * sizeof(uint32_t)))
+                fail();
+            bench_new(hist_new, src, STRIDE, WIDTH, HEIGHT, 8);
+        }
+    } else {
+        declare_func(void, uint32_t *hist_u, uint32_t *hist_v, const uint8_t *src,
+                     ptrdiff_t stride, ptrdiff_t width, ptrdiff_t height, int shift);
+        if (check_func(dsp->hist16_uv, "framestats_hist16_uv")) {
+            call_ref(hist_ref, hist_ref + 256, src, STRIDE, w, h, shift);
+            call_new(hist_new, hist_new + 256, src, STRIDE, w, h, shift);
+            if (memcmp(hist_ref, hist_new, 3 * 256 * sizeof(uint32_t)))
+                fail();
+            bench_new(hist_new, hist_new + 256, src, STRIDE, WIDTH, HEIGHT, 8);
+        }
+    }
+}
+
+void checkasm_check_vf_framestats(void)
+{
+    FrameStatsDSPContext dsp;
+
+    ff_framestats_init(&dsp);
+
+    check_hist(&dsp, 0, 1);
+    check_hist(&dsp, 1, 1);
+    report("hist8");
+
+    check_hist(&dsp, 0, 2);
+    check_hist(&dsp, 1, 2);
+    report("hist16");
+
+    check_hist(&dsp, 0, 3);
+    check_hist(&dsp, 0, 4);
+    report("hist8_rgb");
+}
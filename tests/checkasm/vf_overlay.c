@@ -0,0 +1,103 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/vf_overlay_init.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH      96
+#define DST_SIZE   (WIDTH * 2 + 32)
+#define ALINESIZE  (WIDTH * 2 + 32)
+
+static const struct {
+    const char *name;
+    int format, pix_format, alpha_format;
+    int plane;
+    int dst_step;
+} tests[] = {
+    { "overlay_row_44",        OVERLAY_FORMAT_YUV444, AV_PIX_FMT_YUV444P, 0, 0, 1 },
+    { "overlay_row_22",        OVERLAY_FORMAT_YUV422, AV_PIX_FMT_YUV422P, 0, 1, 1 },
+    { "overlay_row_20",        OVERLAY_FORMAT_YUV420, AV_PIX_FMT_YUV420P, 0, 1, 1 },
+    { "overlay_row_20_nv",     OVERLAY_FORMAT_YUV420, AV_PIX_FMT_NV12,    0, 1, 2 },
+    { "overlay_row_y44_pm",    OVERLAY_FORMAT_YUV420, AV_PIX_FMT_YUV420P, 1, 0, 1 },
+    { "overlay_row_c44_pm",    OVERLAY_FORMAT_YUV444, AV_PIX_FMT_YUV444P, 1, 1, 1 },
+    { "overlay_row_c22_pm",    OVERLAY_FORMAT_YUV422, AV_PIX_FMT_YUV422P, 1, 1, 1 },
+    { "overlay_row_c20_pm",    OVERLAY_FORMAT_YUV420, AV_PIX_FMT_YUV420P, 1, 1, 1 },
+    { "overlay_row_c20_nv_pm", OVERLAY_FORMAT_YUV420, AV_PIX_FMT_NV12,    1, 1, 2 },
+};
+
+static int rnd_alpha(int i)
+{
+    /* subtitles and logos are mostly fully transparent or opaque */
+    if (i & 1) {
+        switch (rnd() % 4) {
+        case 0: return 0;
+        case 1: return 255;
+        }
+    }
+    return rnd() & 0xFF;
+}
+
+void checkasm_check_vf_overlay(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, dst_orig, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref,  [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new,  [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src,      [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, alpha,    [ALINESIZE * 2]);
+    OverlayContext s = { 0 };
+
+    declare_func(int, uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                 int w, ptrdiff_t alinesize);
+
+    for (int t = 0; t < FF_ARRAY_ELEMS(tests); t++) {
+        overlay_init_blend_row(&s, tests[t].format, tests[t].pix_format,
+                               tests[t].alpha_format, 0);
+
+        if (check_func(s.blend_row[tests[t].plane], "%s", tests[t].name)) {
+            for (int i = 0; i < 8; i++) {
+                const int w = i == 7 ? WIDTH : 1 + rnd() % WIDTH;
+                int ret_ref, ret_new;
+
+                for (int j = 0; j < DST_SIZE; j++)
+                    dst_orig[j] = rnd();
+                for (int j = 0; j < WIDTH; j++)
+                    src[j] = rnd();
+                for (int j = 0; j < ALINESIZE * 2; j++)
+                    alpha[j] = rnd_alpha(i);
+                memcpy(dst_ref, dst_orig, DST_SIZE);
+                memcpy(dst_new, dst_orig, DST_SIZE);
+
+                ret_ref = call_ref(dst_ref, NULL, src, alpha, w, ALINESIZE);
+                ret_new = call_new(dst_new, NULL, src, alpha, w, ALINESIZE);
+                /* the pixels not done are left to the generic code */
+                if (ret_new < 0 || ret_new > ret_ref ||
+                    memcmp(dst_ref, dst_new, ret_new * tests[t].dst_step) ||
+                    memcmp(dst_orig + ret_new * tests[t].dst_step,
+                           dst_new  + ret_new * tests[t].dst_step,
+                           DST_SIZE - ret_new * tests[t].dst_step))
+                    fail();
+            }
+            bench_new(dst_new, NULL, src, alpha, WIDTH, ALINESIZE);
+        }
+    }
+
+    report("overlay_row");
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/scene_sad.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  96
+#define HEIGHT 4
+#define STRIDE (WIDTH * 2 + 32)
+
+static void check_scene_sad(int depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src1, [STRIDE * HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, src2, [STRIDE * HEIGHT]);
+    ff_scene_sad_fn sad = ff_scene_sad_get_fn(depth);
+    uint64_t sum_ref, sum_new;
+    int i, w, h;
+
+    declare_func(void, const uint8_t *src1, ptrdiff_t stride1,
+                 const uint8_t *src2, ptrdiff_t stride2,
+                 ptrdiff_t width, ptrdiff_t height, uint64_t *sum);
+
+    if (check_func(sad, "scene_sad%d", depth)) {
+        for (i = 0; i < 8; i++) {
+            for (int j = 0; j < STRIDE * HEIGHT; j++) {
+                src1[j] = rnd();
+                src2[j] = rnd();
+            }
+            /* the last iteration covers the whole buffer, with multiples
+             * of the SIMD widths */
+            w = i == 7 ? WIDTH : 1 + rnd() % WIDTH;
+            h = i == 7 ? HEIGHT : 1 + rnd() % HEIGHT;
+            call_ref(src1, STRIDE, src2, STRIDE, w, h, &sum_ref);
+            call_new(src1, STRIDE, src2, STRIDE, w, h, &sum_new);
+            if (sum_ref != sum_new)
+                fail();
+        }
+        bench_new(src1, STRIDE, src2, STRIDE, WIDTH, HEIGHT, &sum_new);
+    }
+}
+
+void checkasm_check_vf_scene_sad(void)
+{
+    check_scene_sad(8);
+    report("scene_sad8");
+
+    check_scene_sad(16);
+    report("scene_sad16");
+}
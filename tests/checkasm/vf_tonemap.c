@@ -0,0 +1,85 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/vf_tonemap_init.h"
+#include "libavutil/mem.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH   64
+#define SSTRIDE (WIDTH * 2 * 2 + 32)
+#define DSTRIDE (WIDTH * 2 + 32)
+#define LUT_ENTRIES (TONEMAP_LUT_SIZE * TONEMAP_LUT_SIZE * TONEMAP_LUT_SIZE * 4)
+
+void checkasm_check_vf_tonemap(void)
+{
+    LOCAL_ALIGNED_32(uint16_t, srcy,  [SSTRIDE]);
+    LOCAL_ALIGNED_32(uint16_t, srcuv, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dsty_ref,  [DSTRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dsty_new,  [DSTRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dstuv_ref, [WIDTH * 2 + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dstuv_new, [WIDTH * 2 + 32]);
+    TonemapDSPContext dsp;
+    int16_t *lut = av_malloc(LUT_ENTRIES * sizeof(*lut));
+
+    declare_func(void, uint8_t *dsty, ptrdiff_t dsty_stride, uint8_t *dstuv,
+                 const uint16_t *srcy, ptrdiff_t srcy_stride,
+                 const uint16_t *srcuv, const int16_t *lut, int w);
+
+    if (!lut)
+        fail();
+
+    ff_tonemap_init(&dsp);
+
+    if (lut && check_func(dsp.yuv420, "tonemap_yuv420")) {
+        /* output values of 8.6 fixed point, with some headroom on both
+         * sides to exercise clipping */
+        for (int i = 0; i < LUT_ENTRIES; i++)
+            lut[i] = rnd() % (300 << TONEMAP_LUT_OUT_BITS) - (20 << TONEMAP_LUT_OUT_BITS);
+
+        for (int i = 0; i < 8; i++) {
+            /* the last iteration covers the whole buffer; odd iterations
+             * process a single line as done at the bottom of odd heights */
+            const int w = i == 7 ? WIDTH : 1 + rnd() % WIDTH;
+            const ptrdiff_t sstride = i & 1 ? 0 : SSTRIDE;
+            const ptrdiff_t dstride = i & 1 ? 0 : DSTRIDE;
+
+            for (int j = 0; j < SSTRIDE; j++)
+                srcy[j] = rnd();
+            for (int j = 0; j < WIDTH * 2; j++)
+                srcuv[j] = rnd();
+            memset(dsty_ref,  0, DSTRIDE * 2);
+            memset(dsty_new,  0, DSTRIDE * 2);
+            memset(dstuv_ref, 0, WIDTH * 2 + 32);
+            memset(dstuv_new, 0, WIDTH * 2 + 32);
+
+            call_ref(dsty_ref, dstride, dstuv_ref, srcy, sstride, srcuv, lut, w);
+            call_new(dsty_new, dstride, dstuv_new, srcy, sstride, srcuv, lut, w);
+            if (memcmp(dsty_ref, dsty_new, DSTRIDE * 2) ||
+                memcmp(dstuv_ref, dstuv_new, WIDTH * 2 + 32))
+                fail();
+        }
+        bench_new(dsty_new, DSTRIDE, dstuv_new, srcy, SSTRIDE, srcuv, lut, WIDTH);
+    }
+
+    av_free(lut);
+
+    report("tonemap_yuv420");
+}
@@ -1,4 +1,5 @@
-FATE_CHECKASM = fate-checkasm-aacpsdsp                                  \
+FATE_CHECKASM = fate-checkasm-aacencdsp                                 \
+                fate-checkasm-aacpsdsp                                  \
                 fate-checkasm-af_afir                                   \
                 fate-checkasm-alacdsp                                   \
                 fate-checkasm-audiodsp                                  \
@@ -15,6 +16,7 @@ FATE_CHECKASM = fate-checkasm-aacpsdsp                                  \
                 fate-checkasm-h264pred                                  \
                 fate-checkasm-h264qpel                                  \
                 fate-checkasm-hevc_add_res                              \
+                fate-checkasm-hevc_deblock                              \
                 fate-checkasm-hevc_idct                                 \
                 fate-checkasm-hevc_pel                                  \
                 fate-checkasm-hevc_sao                                  \
@@ -29,6 +31,7 @@ FATE_CHECKASM = fate-checkasm-aacpsdsp                                  \
                 fate-checkasm-sbrdsp                                    \
                 fate-checkasm-synth_filter                              \
                 fate-checkasm-sw_gbrp                                   \
+                fate-checkasm-sw_rematrix                               \
                 fate-checkasm-sw_rgb                                    \
                 fate-checkasm-sw_scale                                  \
                 fate-checkasm-utvideodsp                                \
@@ -38,10 +41,14 @@ FATE_CHECKASM = fate-checkasm-aacpsdsp                                  \
                 fate-checkasm-vf_blend                                  \
                 fate-checkasm-vf_colorspace                             \
                 fate-checkasm-vf_eq                                     \
+                fate-checkasm-vf_framestats                             \
                 fate-checkasm-vf_gblur                                  \
                 fate-checkasm-vf_hflip                                  \
                 fate-checkasm-vf_nlmeans                                \
+                fate-checkasm-vf_overlay                                \
+                fate-checkasm-vf_scene_sad                              \
                 fate-checkasm-vf_threshold                              \
+                fate-checkasm-vf_tonemap                                \
                 fate-checkasm-videodsp                                  \
                 fate-checkasm-vp8dsp                                    \
                 fate-checkasm-vp9dsp                                    \
@@ -401,6 +401,13 @@ FATE_AFILTER-yes += fate-filter-formats
 fate-filter-formats: libavfilter/tests/formats$(EXESUF)
 fate-filter-formats: CMD = run libavfilter/tests/formats$(EXESUF)
 
+FATE_AFILTER-$(call ALLYES, TESTSRC_FILTER TESTSRC2_FILTER SPLIT_FILTER HFLIP_FILTER \
+                            HSTACK_FILTER FORMAT_FILTER SCALE_FILTER NULLSINK_FILTER \
+                            SINE_FILTER AFORMAT_FILTER ARESAMPLE_FILTER ANULLSINK_FILTER) \
+                            += fate-filter-formats-cache
+fate-filter-formats-cache: libavfilter/tests/formatscache$(EXESUF)
+fate-filter-formats-cache: CMD = run libavfilter/tests/formatscache$(EXESUF)
+
 FATE_SAMPLES_AVCONV += $(FATE_AFILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_AFILTER-yes)
 fate-afilter: $(FATE_AFILTER-yes) $(FATE_AFILTER_SAMPLES-yes)
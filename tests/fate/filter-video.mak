@@ -378,6 +378,12 @@ fate-filter-fps-down-eof-pass: CMD = framecrc -lavfi testsrc2=r=7:d=3.5,fps=3:eo
 fate-filter-fps-start-drop: CMD = framecrc -lavfi testsrc2=r=7:d=3.5,fps=3:start_time=1.5
 fate-filter-fps-start-fill: CMD = framecrc -lavfi testsrc2=r=7:d=1.5,setpts=PTS+14,fps=3:start_time=1.5
 
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER FPS_FILTER SCALE_FILTER HFLIP_FILTER \
+                           TRANSPOSE_FILTER SHOWINFO_FILTER NEGATE_FILTER) \
+                           += fate-filter-fps-tag-duplicates
+fate-filter-fps-tag-duplicates: libavfilter/tests/duplicates$(EXESUF)
+fate-filter-fps-tag-duplicates: CMD = run libavfilter/tests/duplicates$(EXESUF)
+
 FATE_FILTER_SAMPLES-$(call FILTERDEMDEC, FPS SCALE, MOV, QTRLE) += fate-filter-fps-cfr fate-filter-fps fate-filter-fps-r
 fate-filter-fps-cfr: CMD = framecrc -auto_conversion_filters -i $(TARGET_SAMPLES)/qtrle/apple-animation-variable-fps-bug.mov -r 30 -vsync cfr -pix_fmt yuv420p
 fate-filter-fps-r:   CMD = framecrc -auto_conversion_filters -i $(TARGET_SAMPLES)/qtrle/apple-animation-variable-fps-bug.mov -r 30 -vf fps -pix_fmt yuv420p
@@ -721,6 +727,10 @@ FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER SPLIT_FILTER AVGBLUR_FILTER        \
                            METADATA_FILTER WRAPPED_AVFRAME_ENCODER NULL_MUXER \
                            PIPE_PROTOCOL) += $(FATE_FILTER_REFCMP_METADATA-yes)
 
+FATE_FILTER-yes += fate-filter-hwconvert
+fate-filter-hwconvert: libavfilter/tests/hwconvert$(EXESUF)
+fate-filter-hwconvert: CMD = run libavfilter/tests/hwconvert$(EXESUF)
+
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)
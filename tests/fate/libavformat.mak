@@ -6,6 +6,11 @@ FATE_LIBAVFORMAT-$(CONFIG_NETWORK) += fate-noproxy
 fate-noproxy: libavformat/tests/noproxy$(EXESUF)
 fate-noproxy: CMD = run libavformat/tests/noproxy$(EXESUF)
 
+FATE_HTTP_POOL-$(HAVE_THREADS) += fate-http-pool
+FATE_LIBAVFORMAT-$(CONFIG_HTTP_PROTOCOL) += $(FATE_HTTP_POOL-yes)
+fate-http-pool: libavformat/tests/http_pool$(EXESUF)
+fate-http-pool: CMD = run libavformat/tests/http_pool$(EXESUF)
+
 FATE_LIBAVFORMAT-$(CONFIG_FFRTMPCRYPT_PROTOCOL) += fate-rtmpdh
 fate-rtmpdh: libavformat/tests/rtmpdh$(EXESUF)
 fate-rtmpdh: CMD = run libavformat/tests/rtmpdh$(EXESUF)
@@ -2,10 +2,18 @@ FATE_LIBSWSCALE += fate-sws-pixdesc-query
 fate-sws-pixdesc-query: libswscale/tests/pixdesc_query$(EXESUF)
 fate-sws-pixdesc-query: CMD = run libswscale/tests/pixdesc_query$(EXESUF)
 
+FATE_LIBSWSCALE += fate-sws-filter-cache
+fate-sws-filter-cache: libswscale/tests/filter_cache$(EXESUF)
+fate-sws-filter-cache: CMD = run libswscale/tests/filter_cache$(EXESUF)
+
 FATE_LIBSWSCALE += fate-sws-floatimg-cmp
 fate-sws-floatimg-cmp: libswscale/tests/floatimg_cmp$(EXESUF)
 fate-sws-floatimg-cmp: CMD = run libswscale/tests/floatimg_cmp$(EXESUF)
 
+FATE_LIBSWSCALE += fate-sws-fused
+fate-sws-fused: libswscale/tests/fused$(EXESUF)
+fate-sws-fused: CMD = run libswscale/tests/fused$(EXESUF)
+
 SWS_SLICE_TEST-$(call DEMDEC, MATROSKA, VP9) += fate-sws-slice-yuv422-12bit-rgb48
 fate-sws-slice-yuv422-12bit-rgb48: CMD = run tools/scale_slice_test$(EXESUF) $(TARGET_SAMPLES)/vp9-test-vectors/vp93-2-20-12bit-yuv422.webm 150 100 rgb48
 
@@ -0,0 +1,317 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Compare CPU time and quality of the native AAC encoder coders.
+ *
+ * Every coder encodes the same signal, which is decoded again with the native
+ * decoder and compared against the input. The input is either raw interleaved
+ * native-endian float samples or, if no file is given, a synthetic mix of
+ * tones, sweeps, transients and noise.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if HAVE_UNISTD_H
+#include <unistd.h> /* for getopt */
+#endif
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/time.h"
+#include "libavcodec/avcodec.h"
+
+static const char *const coders[] = { "twoloop", "fast", "realtime" };
+
+typedef struct BenchResult {
+    double cpu;      ///< encoder CPU time in seconds, all threads
+    double wall;     ///< encoder wall clock time in seconds
+    double snr;      ///< signal to noise ratio of the decoded signal in dB
+    int64_t bytes;   ///< total size of the encoded packets
+} BenchResult;
+
+static float *synth_signal(int nb_samples, int channels, int rate)
+{
+    float *pcm = av_malloc_array(nb_samples, channels * sizeof(*pcm));
+    AVChannelLayout layout;
+    AVLFG lfg;
+    int i, ch;
+
+    if (!pcm)
+        return NULL;
+    av_channel_layout_default(&layout, channels);
+    av_lfg_init(&lfg, 0xaac);
+    for (i = 0; i < nb_samples; i++) {
+        const double t = (double)i / rate;
+        for (ch = 0; ch < channels; ch++) {
+            double f, sweep, burst, noise;
+
+            /* only the lowest few spectral lines are coded for LFE channels */
+            if (av_channel_layout_channel_from_index(&layout, ch) == AV_CHAN_LOW_FREQUENCY) {
+                pcm[i * channels + ch] = 0.3 * sin(2 * M_PI * 40.0 * t);
+                continue;
+            }
+            f     = 220.0 * (ch + 1);
+            sweep = 100.0 + 4000.0 * fmod(t * 0.25, 1.0);
+            burst = fmod(t * 2.0 + ch * 0.1, 1.0) < 0.05 ? 0.3 : 0.0;
+            noise = (av_lfg_get(&lfg) / (double)UINT_MAX - 0.5) * 0.02;
+
+            pcm[i * channels + ch] = 0.25 * sin(2 * M_PI * f * t) +
+                                     0.10 * sin(2 * M_PI * 3.01 * f * t) +
+                                     0.08 * sin(2 * M_PI * sweep * t) +
+                                     burst * sin(2 * M_PI * 1500.0 * t) + noise;
+        }
+    }
+    return pcm;
+}
+
+static int decode_packet(AVCodecContext *dec, AVPacket *pkt, AVFrame *frame,
+                         float *out, int *nb_out, int max_out)
+{
+    int ret = avcodec_send_packet(dec, pkt);
+    if (ret < 0)
+        return ret;
+
+    while ((ret = avcodec_receive_frame(dec, frame)) >= 0) {
+        const int channels = frame->ch_layout.nb_channels;
+        int i, ch;
+        for (i = 0; i < frame->nb_samples && *nb_out < max_out; i++, (*nb_out)++)
+            for (ch = 0; ch < channels; ch++)
+                out[*nb_out * channels + ch] = ((const float *)frame->extended_data[ch])[i];
+        av_frame_unref(frame);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int run_coder(const char *coder, const float *pcm, int nb_samples,
+                     int channels, int rate, int64_t bit_rate, int threads,
+                     BenchResult *res)
+{
+    const AVCodec *enc_codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+    const AVCodec *dec_codec = avcodec_find_decoder(AV_CODEC_ID_AAC);
+    AVCodecContext *enc = NULL, *dec = NULL;
+    AVFrame *frame = NULL, *dframe = NULL;
+    AVPacket *pkt = NULL;
+    float *out = NULL;
+    int nb_out = 0, max_out, pos = 0, i, ch, ret;
+    double sig = 0.0, err = 0.0;
+    int64_t t0;
+    clock_t c0;
+
+    memset(res, 0, sizeof(*res));
+    if (!enc_codec || !dec_codec)
+        return AVERROR_ENCODER_NOT_FOUND;
+
+    enc    = avcodec_alloc_context3(enc_codec);
+    dec    = avcodec_alloc_context3(dec_codec);
+    frame  = av_frame_alloc();
+    dframe = av_frame_alloc();
+    pkt    = av_packet_alloc();
+    if (!enc || !dec || !frame || !dframe || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    enc->sample_fmt   = AV_SAMPLE_FMT_FLTP;
+    enc->sample_rate  = rate;
+    enc->bit_rate     = bit_rate;
+    enc->thread_count = threads;
+    av_channel_layout_default(&enc->ch_layout, channels);
+    if ((ret = av_opt_set(enc->priv_data, "aac_coder", coder, 0)) < 0 ||
+        (ret = avcodec_open2(enc, enc_codec, NULL)) < 0)
+        goto end;
+
+    dec->sample_rate = rate;
+    av_channel_layout_default(&dec->ch_layout, channels);
+    dec->extradata = av_mallocz(enc->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!dec->extradata) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    memcpy(dec->extradata, enc->extradata, enc->extradata_size);
+    dec->extradata_size = enc->extradata_size;
+    if ((ret = avcodec_open2(dec, dec_codec, NULL)) < 0)
+        goto end;
+
+    max_out = nb_samples + enc->initial_padding + 2 * enc->frame_size;
+    out = av_calloc(max_out, channels * sizeof(*out));
+    if (!out) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    frame->format     = enc->sample_fmt;
+    frame->nb_samples = enc->frame_size;
+    if ((ret = av_channel_layout_copy(&frame->ch_layout, &enc->ch_layout)) < 0 ||
+        (ret = av_frame_get_buffer(frame, 0)) < 0)
+        goto end;
+
+    for (;;) {
+        const int n = FFMIN(enc->frame_size, nb_samples - pos);
+
+        if (n > 0) {
+            if ((ret = av_frame_make_writable(frame)) < 0)
+                goto end;
+            frame->nb_samples = n;
+            frame->pts        = pos;
+            for (ch = 0; ch < channels; ch++)
+                for (i = 0; i < n; i++)
+                    ((float *)frame->extended_data[ch])[i] = pcm[(pos + i) * channels + ch];
+            pos += n;
+        }
+
+        t0 = av_gettime_relative();
+        c0 = clock();
+        ret = avcodec_send_frame(enc, n > 0 ? frame : NULL);
+        res->cpu  += (double)(clock() - c0) / CLOCKS_PER_SEC;
+        res->wall += (av_gettime_relative() - t0) / 1000000.0;
+        if (ret < 0)
+            goto end;
+
+        for (;;) {
+            t0 = av_gettime_relative();
+            c0 = clock();
+            ret = avcodec_receive_packet(enc, pkt);
+            res->cpu  += (double)(clock() - c0) / CLOCKS_PER_SEC;
+            res->wall += (av_gettime_relative() - t0) / 1000000.0;
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+                break;
+            if (ret < 0)
+                goto end;
+            res->bytes += pkt->size;
+            ret = decode_packet(dec, pkt, dframe, out, &nb_out, max_out);
+            av_packet_unref(pkt);
+            if (ret < 0)
+                goto end;
+        }
+        if (n <= 0)
+            break;
+    }
+
+    /* the decoder output starts with the encoder delay */
+    for (i = 0; i < nb_samples && i + enc->initial_padding < nb_out; i++) {
+        for (ch = 0; ch < channels; ch++) {
+            float a = pcm[i * channels + ch];
+            float b = out[(i + enc->initial_padding) * channels + ch];
+            sig += a * a;
+            err += (a - b) * (a - b);
+        }
+    }
+    res->snr = err > 0.0 ? 10.0 * log10(sig / err) : INFINITY;
+    ret = 0;
+
+end:
+    av_free(out);
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    av_frame_free(&dframe);
+    avcodec_free_context(&enc);
+    avcodec_free_context(&dec);
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [-r rate] [-c channels] [-b bitrate] [-t threads] [-d seconds] [input.f32]\n"
+           "Encode raw interleaved float input, or a synthetic signal, with every AAC coder\n"
+           "and report encoder CPU time and SNR of the decoded signal.\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    int rate = 48000, channels = 2, threads = 1, seconds = 20;
+    int64_t bit_rate = 128000;
+    float *pcm = NULL;
+    int nb_samples, i, opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "hr:c:b:t:d:")) != -1) {
+        switch (opt) {
+        case 'r': rate     = atoi(optarg); break;
+        case 'c': channels = atoi(optarg); break;
+        case 'b': bit_rate = strtoll(optarg, NULL, 10); break;
+        case 't': threads  = atoi(optarg); break;
+        case 'd': seconds  = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt != 'h';
+        }
+    }
+    av_log_set_level(AV_LOG_WARNING);
+    if (rate <= 0 || channels <= 0 || channels > 8 || seconds <= 0 || bit_rate <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (optind < argc) {
+        FILE *f = fopen(argv[optind], "rb");
+        long size;
+        if (!f) {
+            fprintf(stderr, "Cannot open %s\n", argv[optind]);
+            return 1;
+        }
+        fseek(f, 0, SEEK_END);
+        size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        nb_samples = size / (channels * sizeof(*pcm));
+        pcm = av_malloc_array(nb_samples, channels * sizeof(*pcm));
+        if (pcm && fread(pcm, channels * sizeof(*pcm), nb_samples, f) != nb_samples)
+            av_freep(&pcm);
+        fclose(f);
+    } else {
+        nb_samples = rate * seconds;
+        pcm = synth_signal(nb_samples, channels, rate);
+    }
+    if (!pcm || !nb_samples) {
+        fprintf(stderr, "Failed to get input samples\n");
+        av_free(pcm);
+        return 1;
+    }
+
+    printf("%d samples, %d channels, %d Hz, %"PRId64" bit/s, %d thread(s)\n",
+           nb_samples, channels, rate, bit_rate, threads);
+    printf("%-10s %10s %10s %10s %10s %10s\n",
+           "coder", "kbit/s", "SNR (dB)", "CPU (s)", "wall (s)", "x realtime");
+    for (i = 0; i < FF_ARRAY_ELEMS(coders); i++) {
+        const double duration = (double)nb_samples / rate;
+        BenchResult res;
+
+        if ((ret = run_coder(coders[i], pcm, nb_samples, channels, rate,
+                             bit_rate, threads, &res)) < 0) {
+            fprintf(stderr, "%s: %s\n", coders[i], av_err2str(ret));
+            break;
+        }
+        printf("%-10s %10.1f %10.2f %10.3f %10.3f %10.1f\n", coders[i],
+               res.bytes * 8 / duration / 1000, res.snr, res.cpu, res.wall,
+               res.cpu > 0 ? duration / res.cpu : INFINITY);
+    }
+
+    av_free(pcm);
+    return ret < 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Compare the fused NV12 scaling converters of libswscale with the generic
+ * scaler.
+ *
+ * The fused converters are only used when a whole picture is passed at once,
+ * so feeding the same context with slices of the source runs the generic
+ * path with identical settings. The generic bilinear scaler is timed too,
+ * the PSNR is measured against it. With the bilinear and bicubic scalers, the
+ * fused converters give the same output as the generic path.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if HAVE_UNISTD_H
+#include <unistd.h> /* for getopt */
+#endif
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+#include "libavutil/common.h"
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+#include "libswscale/swscale.h"
+
+#define SLICE_H 16
+
+typedef struct BenchCase {
+    enum AVPixelFormat dst_format;
+    int num, den;                   ///< destination size relative to the source
+    int flags;
+    const char *scaler;
+} BenchCase;
+
+static const BenchCase cases[] = {
+    { AV_PIX_FMT_YUV420P, 1, 2, SWS_FAST_BILINEAR, "fast_bilinear" },
+    { AV_PIX_FMT_YUV420P, 2, 3, SWS_FAST_BILINEAR, "fast_bilinear" },
+    { AV_PIX_FMT_RGBA,    1, 2, SWS_FAST_BILINEAR, "fast_bilinear" },
+    { AV_PIX_FMT_BGRA,    1, 2, SWS_FAST_BILINEAR, "fast_bilinear" },
+    { AV_PIX_FMT_YUV420P, 1, 2, SWS_BILINEAR,      "bilinear" },
+    { AV_PIX_FMT_YUV420P, 2, 3, SWS_BILINEAR,      "bilinear" },
+    { AV_PIX_FMT_YUV420P, 1, 2, SWS_BICUBIC,       "bicubic" },
+    { AV_PIX_FMT_YUV420P, 2, 3, SWS_BICUBIC,       "bicubic" },
+};
+
+static void fill_source(AVFrame *src)
+{
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+    for (int y = 0; y < src->height; y++)
+        for (int x = 0; x < src->width; x++)
+            src->data[0][y * src->linesize[0] + x] =
+                128 + 96 * sin(x * 0.011) * cos(y * 0.017) + (av_lfg_get(&lfg) & 7);
+    for (int y = 0; y < src->height / 2; y++)
+        for (int x = 0; x < src->width; x++)
+            src->data[1][y * src->linesize[1] + x] =
+                128 + 64 * sin(x * 0.007 + (x & 1)) + (av_lfg_get(&lfg) & 3);
+}
+
+/* PSNR of the first plane, which holds luma or packed RGB */
+static double psnr(const AVFrame *a, const AVFrame *b)
+{
+    const int w = av_image_get_linesize(a->format, a->width, 0);
+    double err = 0;
+
+    for (int y = 0; y < a->height; y++) {
+        for (int x = 0; x < w; x++) {
+            int d = a->data[0][y * a->linesize[0] + x] - b->data[0][y * b->linesize[0] + x];
+            err += d * d;
+        }
+    }
+    return err > 0 ? 10 * log10(255.0 * 255 * w * a->height / err) : INFINITY;
+}
+
+/* @return the time per frame in ms, or a negative error code */
+static double scale(struct SwsContext *sws, const AVFrame *src, AVFrame *dst,
+                    int frames, int slices)
+{
+    int64_t t0 = av_gettime_relative();
+
+    for (int i = 0; i < frames; i++) {
+        for (int y = 0; y < src->height; y += slices ? SLICE_H : src->height) {
+            const uint8_t *data[4] = {
+                src->data[0] + y * src->linesize[0],
+                src->data[1] + y / 2 * src->linesize[1],
+            };
+            int ret = sws_scale(sws, data, src->linesize, y,
+                                FFMIN(slices ? SLICE_H : src->height, src->height - y),
+                                dst->data, dst->linesize);
+            if (ret < 0)
+                return ret;
+        }
+    }
+    return (av_gettime_relative() - t0) / 1000.0 / frames;
+}
+
+static int run_case(const BenchCase *bc, const AVFrame *src, int frames)
+{
+    const int dst_w = src->width  * bc->num / bc->den;
+    const int dst_h = src->height * bc->num / bc->den;
+    struct SwsContext *fused = NULL, *bilinear = NULL;
+    AVFrame *dst[3] = { NULL };
+    double t[3];
+    int ret = AVERROR(ENOMEM);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++) {
+        if (!(dst[i] = av_frame_alloc()))
+            goto end;
+        dst[i]->format = bc->dst_format;
+        dst[i]->width  = dst_w;
+        dst[i]->height = dst_h;
+        if ((ret = av_frame_get_buffer(dst[i], 0)) < 0)
+            goto end;
+    }
+
+    fused    = sws_getContext(src->width, src->height, src->format, dst_w, dst_h,
+                              bc->dst_format, bc->flags, NULL, NULL, NULL);
+    bilinear = sws_getContext(src->width, src->height, src->format, dst_w, dst_h,
+                              bc->dst_format, SWS_BILINEAR, NULL, NULL, NULL);
+    if (!fused || !bilinear) {
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+
+    if ((t[0] = scale(fused,    src, dst[0], frames, 0)) < 0 ||
+        (t[1] = scale(fused,    src, dst[1], frames, 1)) < 0 ||
+        (t[2] = scale(bilinear, src, dst[2], frames, 1)) < 0) {
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+
+    printf("%-8s %-13s %4dx%-4d %10.3f %10.3f %10.3f %10.2f\n",
+           av_get_pix_fmt_name(bc->dst_format), bc->scaler, dst_w, dst_h,
+           t[0], t[1], t[2], psnr(dst[0], dst[2]));
+    ret = 0;
+
+end:
+    for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++)
+        av_frame_free(&dst[i]);
+    sws_freeContext(fused);
+    sws_freeContext(bilinear);
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [-s size] [-n frames]\n"
+           "Time the fused NV12 scaling converters against the generic scaler.\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    int w = 1920, h = 1080, frames = 100, opt, ret;
+    AVFrame *src;
+
+    while ((opt = getopt(argc, argv, "hs:n:")) != -1) {
+        switch (opt) {
+        case 's':
+            if (av_parse_video_size(&w, &h, optarg) < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'n': frames = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt != 'h';
+        }
+    }
+    /* the fused converters require sizes divisible by 4 for 2:1 and by 6 for 3:2 */
+    if (frames <= 0 || w % 12 || h % 12) {
+        fprintf(stderr, "The size must be a multiple of 12 and frames positive\n");
+        return 1;
+    }
+
+    src = av_frame_alloc();
+    if (!src)
+        return 1;
+    src->format = AV_PIX_FMT_NV12;
+    src->width  = w;
+    src->height = h;
+    if ((ret = av_frame_get_buffer(src, 0)) < 0) {
+        av_frame_free(&src);
+        return 1;
+    }
+    fill_source(src);
+
+    printf("nv12 %dx%d, %d frames, ms per frame\n", w, h, frames);
+    printf("%-8s %-13s %9s %10s %10s %10s %10s\n",
+           "output", "scaler", "size", "fused", "generic", "bilinear", "PSNR (dB)");
+    for (int i = 0; i < FF_ARRAY_ELEMS(cases); i++) {
+        if ((ret = run_case(&cases[i], src, frames)) < 0) {
+            fprintf(stderr, "%s: %s\n", av_get_pix_fmt_name(cases[i].dst_format),
+                    av_err2str(ret));
+            break;
+        }
+    }
+
+    av_frame_free(&src);
+    return ret < 0;
+}